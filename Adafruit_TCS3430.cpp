@@ -31,8 +31,122 @@
 
 #include <Wire.h>
 
+#include <new>
+
+#include "Adafruit_TCS3430_Color.h"
 #include "Arduino.h"
 
+/** Registers covered by tcs3430_config_t, in TCS3430_CHANGED_* bit order */
+static const uint8_t kConfigRegs[TCS3430_CONFIG_REGS] = {
+    TCS3430_REG_ENABLE,    TCS3430_REG_ATIME,     TCS3430_REG_WTIME,
+    TCS3430_REG_AILTL,     TCS3430_REG_AILTH,     TCS3430_REG_AIHTL,
+    TCS3430_REG_AIHTH,     TCS3430_REG_PERS,      TCS3430_REG_CFG0,
+    TCS3430_REG_CFG1,      TCS3430_REG_CFG2,      TCS3430_REG_CFG3,
+    TCS3430_REG_AZ_CONFIG, TCS3430_REG_INTENAB};
+
+/** Position of each register in a configuration image */
+enum {
+  kImgEnable,
+  kImgAtime,
+  kImgWtime,
+  kImgAiltl,
+  kImgAilth,
+  kImgAihtl,
+  kImgAihth,
+  kImgPers,
+  kImgCfg0,
+  kImgCfg1,
+  kImgCfg2,
+  kImgCfg3,
+  kImgAzConfig,
+  kImgIntenab
+};
+
+/*!
+ *    @brief  Replace a field in a register image entry
+ *    @tparam F Adafruit_TCS3430_Field descriptor
+ *    @param  image Register image, indexed like kConfigRegs
+ *    @param  index Entry holding F's register
+ *    @param  value New field value
+ */
+template <class F>
+static inline void setField(uint8_t* image, uint8_t index, uint8_t value) {
+  image[index] = F::set(image[index], value);
+}
+
+#ifdef TCS3430_INSTRUMENT
+/*!
+ *    @brief  Charges the bus traffic made during a public call to that
+ *            method, if it is the outermost public call in progress
+ */
+class Adafruit_TCS3430_StatsScope {
+ public:
+  /*!
+   *    @brief  Enter a method
+   *    @param  sensor Driver being called
+   *    @param  api Method being entered
+   */
+  Adafruit_TCS3430_StatsScope(Adafruit_TCS3430* sensor, uint8_t api) {
+    _sensor = NULL;
+    if (sensor->_stats_api == TCS3430_API_COUNT) {
+      _sensor = sensor;
+      sensor->_stats_api = api;
+      sensor->_stats_entry = sensor->_stats.total;
+      sensor->_stats.calls[api]++;
+    }
+  }
+
+  /*!
+   *    @brief  Leave the method, adding what it did to its row
+   */
+  ~Adafruit_TCS3430_StatsScope() {
+    if (!_sensor) {
+      return;
+    }
+    const tcs3430_io_stats_t& now = _sensor->_stats.total;
+    const tcs3430_io_stats_t& entry = _sensor->_stats_entry;
+    tcs3430_io_stats_t& row = _sensor->_stats.api[_sensor->_stats_api];
+    row.transactions += now.transactions - entry.transactions;
+    row.bytes_read += now.bytes_read - entry.bytes_read;
+    row.bytes_written += now.bytes_written - entry.bytes_written;
+    row.micros += now.micros - entry.micros;
+    _sensor->_stats_api = TCS3430_API_COUNT;
+  }
+
+ private:
+  Adafruit_TCS3430* _sensor; ///< Driver, NULL if not the outermost call
+};
+
+/** Account a public method's bus traffic (see Adafruit_TCS3430_Stats.h) */
+#define TCS3430_TRACE(id)                                                      \
+  Adafruit_TCS3430_StatsScope stats_scope(this, TCS3430_API_##id)
+#else
+/** Account a public method's bus traffic (see Adafruit_TCS3430_Stats.h) */
+#define TCS3430_TRACE(id)
+#endif
+
+/*!
+ *    @brief  Write a bit field. The descriptor's mask and shift fold into
+ *            constants here; the read-modify-write itself is shared.
+ *    @tparam F Adafruit_TCS3430_Field descriptor
+ *    @param  value Field value
+ *    @return true on success
+ */
+template <class F>
+inline bool Adafruit_TCS3430::writeField(uint8_t value) {
+  return writeMasked(F::reg, F::mask, F::set(0, value));
+}
+
+/*!
+ *    @brief  Read a bit field, from the shadow cache when possible
+ *    @tparam F Adafruit_TCS3430_Field descriptor
+ *    @return Field value
+ */
+template <class F>
+inline uint8_t Adafruit_TCS3430::readField() {
+  return readMasked(F::reg, F::mask) >> F::shift;
+}
+
 /*!
  *    @brief  Instantiates a new TCS3430 class
  */
@@ -42,13 +156,14 @@ Adafruit_TCS3430::Adafruit_TCS3430() {}
  *    @brief  Cleans up the TCS3430
  */
 Adafruit_TCS3430::~Adafruit_TCS3430() {
-  if (i2c_dev) {
-    delete i2c_dev;
+  if (_busio) {
+    _busio->~Adafruit_TCS3430_BusIO();
   }
 }
 
 /*!
- *    @brief  Sets up the hardware and initializes I2C
+ *    @brief  Sets up the hardware and initializes I2C. Powers on with ALS
+ *            enabled and wait disabled, in a single ENABLE write.
  *    @param  addr
  *            The I2C address to be used.
  *    @param  theWire
@@ -56,44 +171,214 @@ Adafruit_TCS3430::~Adafruit_TCS3430() {
  *    @return True if initialization was successful, otherwise false.
  */
 bool Adafruit_TCS3430::begin(uint8_t addr, TwoWire* theWire) {
-  if (i2c_dev) {
-    delete i2c_dev;
-  }
+  TCS3430_TRACE(BEGIN);
+  attachDevice(addr, theWire);
+  return beginAttached();
+}
 
-  i2c_dev = new Adafruit_I2CDevice(addr, theWire);
+/*!
+ *    @brief  Sets up the hardware over another transport, e.g.
+ *            Adafruit_TCS3430_LinuxI2C or an Adafruit_TCS3430_Async.h
+ *            backend. Otherwise the same as begin(addr, theWire).
+ *    @param  transport Bus to use; must outlive the driver's use of it
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_TCS3430::begin(Adafruit_TCS3430_Transport* transport) {
+  TCS3430_TRACE(BEGIN);
+  attachTransport(transport);
+  return beginAttached();
+}
 
-  if (!i2c_dev->begin()) {
+/*!
+ *    @brief  begin() once the transport is attached
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_TCS3430::beginAttached() {
+  // The ID read below doubles as the presence check
+  if (!_bus->begin()) {
     return false;
   }
 
   // Check chip ID
-  Adafruit_BusIO_Register id_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ID);
-  uint8_t chip_id = id_reg.read();
-  if (chip_id != 0xDC) {
+  uint8_t chip_id = 0;
+  if (!busRead(TCS3430_REG_ID, &chip_id, 1) || chip_id != 0xDC) {
     return false;
   }
 
-  // Power on and enable ALS
-  if (!powerOn(true)) {
+  _shadow_valid = 0;
+  _amux_ir2 = -1;
+  _fresh_known = false;
+  _meas_state = TCS3430_MEAS_IDLE;
+  if (_cache_enabled && !resync()) {
     return false;
   }
-  if (!ALSEnable(true)) {
-    return false;
+
+  // PON and AEN together, so auto-zero runs before the first integration
+  markStart();
+  return writeConfigRegister(TCS3430_REG_ENABLE, 0x03);
+}
+
+/*!
+ *    @brief  Fast start after an MCU sleep or reset: instead of begin()
+ *            and a full reconfiguration, check the sensor against a
+ *            snapshot from saveSnapshot() with one 17-byte burst of
+ *            ENABLE through CFG1. CFG2, CFG3, AZ_CONFIG and INTENAB are
+ *            not read when that block matches with PON set: they only
+ *            change by a power cycle, which also clears ENABLE, or by
+ *            another bus master. If anything differs, the ID is checked
+ *            and the snapshot is written back like applyConfig().
+ *    @param  snapshot Saved configuration
+ *    @param  addr The I2C address to be used.
+ *    @param  theWire The Wire object to be used for I2C connections.
+ *    @return Whether the sensor matched, was restored, or neither
+ */
+tcs3430_resume_t Adafruit_TCS3430::resume(const tcs3430_snapshot_t* snapshot,
+                                          uint8_t addr, TwoWire* theWire) {
+  TCS3430_TRACE(RESUME);
+  attachDevice(addr, theWire);
+  return resumeAttached(snapshot);
+}
+
+/*!
+ *    @brief  Fast start over another transport, otherwise the same as
+ *            resume(snapshot, addr, theWire)
+ *    @param  snapshot Saved configuration
+ *    @param  transport Bus to use; must outlive the driver's use of it
+ *    @return Whether the sensor matched, was restored, or neither
+ */
+tcs3430_resume_t Adafruit_TCS3430::resume(
+    const tcs3430_snapshot_t* snapshot, Adafruit_TCS3430_Transport* transport) {
+  TCS3430_TRACE(RESUME);
+  attachTransport(transport);
+  return resumeAttached(snapshot);
+}
+
+/*!
+ *    @brief  resume() once the transport is attached
+ *    @param  snapshot Saved configuration
+ *    @return Whether the sensor matched, was restored, or neither
+ */
+tcs3430_resume_t Adafruit_TCS3430::resumeAttached(
+    const tcs3430_snapshot_t* snapshot) {
+  _shadow_valid = 0;
+  _amux_ir2 = -1;
+  _meas_state = TCS3430_MEAS_IDLE;
+  if (snapshotCheck(snapshot->regs) != snapshot->check || !_bus->begin()) {
+    return TCS3430_RESUME_FAILED;
   }
 
+  uint8_t block[TCS3430_REG_CFG1 - TCS3430_REG_ENABLE + 1];
+  if (!busRead(TCS3430_REG_ENABLE, block, sizeof(block))) {
+    return TCS3430_RESUME_FAILED;
+  }
+  bool match = true;
+  bool powered = TCS3430_FIELD_PON::get(snapshot->regs[kImgEnable]);
+  for (uint8_t i = 0; match && i < TCS3430_CONFIG_REGS; i++) {
+    uint8_t reg = kConfigRegs[i];
+    uint8_t value;
+    if (reg <= TCS3430_REG_CFG1) {
+      value = block[reg - TCS3430_REG_ENABLE];
+    } else if (powered) {
+      continue;
+    } else if (!busRead(reg, &value, 1)) {
+      return TCS3430_RESUME_FAILED;
+    }
+    match = (value == snapshot->regs[i]);
+  }
+
+  if (match) {
+    for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+      storeShadow(kConfigRegs[i], snapshot->regs[i]);
+    }
+    noteThresholds(snapshot->regs);
+    _amux_ir2 = TCS3430_FIELD_AMUX::get(snapshot->regs[kImgCfg1]);
+    _settling = false;
+    return TCS3430_RESUME_MATCHED;
+  }
+
+  uint8_t chip_id = 0;
+  uint8_t current[TCS3430_CONFIG_REGS];
+  if (!busRead(TCS3430_REG_ID, &chip_id, 1) || chip_id != 0xDC ||
+      !readConfigImage(current) ||
+      !writeConfigImage(current, snapshot->regs, NULL)) {
+    return TCS3430_RESUME_FAILED;
+  }
+  return TCS3430_RESUME_RESTORED;
+}
+
+/*!
+ *    @brief  Save the configuration for resume(). Cheap with the shadow
+ *            cache enabled: only the thresholds are read.
+ *    @param  snapshot Destination, e.g. in RTC or retained RAM
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::saveSnapshot(tcs3430_snapshot_t* snapshot) {
+  TCS3430_TRACE(SAVE_SNAPSHOT);
+  if (!_bus || !readConfigImage(snapshot->regs)) {
+    return false;
+  }
+  snapshot->check = snapshotCheck(snapshot->regs);
   return true;
 }
 
+/*!
+ *    @brief  Construct the BusIO transport in the object's own storage,
+ *            replacing any previous transport. No heap is used.
+ *    @param  addr The I2C address to be used.
+ *    @param  theWire The Wire object to be used for I2C connections.
+ */
+void Adafruit_TCS3430::attachDevice(uint8_t addr, TwoWire* theWire) {
+  attachTransport(NULL);
+  _busio = new (_busio_storage) Adafruit_TCS3430_BusIO(addr, theWire);
+  _bus = _busio;
+}
+
+/*!
+ *    @brief  Switch to a caller's transport, releasing the BusIO one
+ *    @param  transport Bus to use, or NULL for none
+ */
+void Adafruit_TCS3430::attachTransport(Adafruit_TCS3430_Transport* transport) {
+  if (_busio) {
+    _busio->~Adafruit_TCS3430_BusIO();
+    _busio = NULL;
+  }
+  _bus = transport;
+}
+
+/*!
+ *    @brief  Check byte for a snapshot's register image
+ *    @param  regs TCS3430_CONFIG_REGS bytes
+ *    @return Rotate-and-xor of the bytes, seeded so all-zero RAM fails
+ */
+uint8_t Adafruit_TCS3430::snapshotCheck(const uint8_t* regs) {
+  uint8_t check = 0xA5;
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    check = (uint8_t)((check << 1) | (check >> 7)) ^ regs[i];
+  }
+  return check;
+}
+
+/*!
+ *    @brief  Cycle length a register image sets up
+ *    @param  image TCS3430_CONFIG_REGS bytes, TCS3430_CHANGED_* order
+ *    @return Cycle length in microseconds
+ */
+uint32_t Adafruit_TCS3430::imageCycleMicros(const uint8_t* image) {
+  return cycleMicros(image[kImgAtime],
+                     TCS3430_FIELD_WEN::get(image[kImgEnable]),
+                     image[kImgWtime],
+                     TCS3430_FIELD_WLONG::get(image[kImgCfg0]));
+}
+
 /*!
  *    @brief  Set integration cycles
  *    @param  cycles Number of integration cycles (1-256)
  *    @return true on success
  */
 bool Adafruit_TCS3430::setIntegrationCycles(uint8_t cycles) {
-  Adafruit_BusIO_Register atime_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ATIME);
-  return atime_reg.write(cycles);
+  TCS3430_TRACE(SET_INTEGRATION_CYCLES);
+  markConfigChange();
+  return writeConfigRegister(TCS3430_REG_ATIME, cycles);
 }
 
 /*!
@@ -101,19 +386,36 @@ bool Adafruit_TCS3430::setIntegrationCycles(uint8_t cycles) {
  *    @return Current integration cycles
  */
 uint8_t Adafruit_TCS3430::getIntegrationCycles() {
-  Adafruit_BusIO_Register atime_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ATIME);
-  return atime_reg.read();
+  TCS3430_TRACE(GET_INTEGRATION_CYCLES);
+  uint8_t cycles = 0;
+  readConfigRegister(TCS3430_REG_ATIME, &cycles);
+  return cycles;
+}
+
+/*!
+ *    @brief  Convert a time to an ATIME/WTIME register value, rounding
+ *            down to whole 2.78 ms steps and clamping to 1-256 steps
+ *            rather than wrapping
+ *    @param  ms Time in ms
+ *    @return Steps - 1
+ */
+uint8_t Adafruit_TCS3430::msToCycles(float ms) {
+  float cycles = (ms / 2.78) - 1;
+  if (!(cycles > 0)) {
+    return 0;
+  }
+  return cycles >= 255 ? 255 : (uint8_t)cycles;
 }
 
 /*!
  *    @brief  Set integration time in milliseconds
- *    @param  ms Integration time in ms
+ *    @param  ms Integration time in ms, 2.78 to 711.68; values outside
+ *            are clamped
  *    @return true on success
  */
 bool Adafruit_TCS3430::setIntegrationTime(float ms) {
-  uint8_t cycles = (uint8_t)((ms / 2.78) - 1);
-  return setIntegrationCycles(cycles);
+  TCS3430_TRACE(SET_INTEGRATION_TIME);
+  return setIntegrationCycles(msToCycles(ms));
 }
 
 /*!
@@ -121,6 +423,7 @@ bool Adafruit_TCS3430::setIntegrationTime(float ms) {
  *    @return Integration time in ms
  */
 float Adafruit_TCS3430::getIntegrationTime() {
+  TCS3430_TRACE(GET_INTEGRATION_TIME);
   uint8_t cycles = getIntegrationCycles();
   return (cycles + 1) * 2.78;
 }
@@ -131,11 +434,9 @@ float Adafruit_TCS3430::getIntegrationTime() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::waitEnable(bool enable) {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits wen_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 3);
-  return wen_bit.write(enable);
+  TCS3430_TRACE(WAIT_ENABLE);
+  markConfigChange();
+  return writeField<TCS3430_FIELD_WEN>(enable);
 }
 
 /*!
@@ -143,11 +444,8 @@ bool Adafruit_TCS3430::waitEnable(bool enable) {
  *    @return true if wait is enabled
  */
 bool Adafruit_TCS3430::isWaitEnabled() {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits wen_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 3);
-  return wen_bit.read();
+  TCS3430_TRACE(IS_WAIT_ENABLED);
+  return readField<TCS3430_FIELD_WEN>();
 }
 
 /*!
@@ -156,11 +454,13 @@ bool Adafruit_TCS3430::isWaitEnabled() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::ALSEnable(bool enable) {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits aen_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 1);
-  return aen_bit.write(enable);
+  TCS3430_TRACE(ALS_ENABLE);
+  if (enable) {
+    markStart();
+  } else {
+    markConfigChange(false);
+  }
+  return writeField<TCS3430_FIELD_AEN>(enable);
 }
 
 /*!
@@ -168,11 +468,8 @@ bool Adafruit_TCS3430::ALSEnable(bool enable) {
  *    @return true if ALS is enabled
  */
 bool Adafruit_TCS3430::isALSEnabled() {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits aen_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 1);
-  return aen_bit.read();
+  TCS3430_TRACE(IS_ALS_ENABLED);
+  return readField<TCS3430_FIELD_AEN>();
 }
 
 /*!
@@ -181,11 +478,13 @@ bool Adafruit_TCS3430::isALSEnabled() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::powerOn(bool enable) {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits pon_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 0);
-  return pon_bit.write(enable);
+  TCS3430_TRACE(POWER_ON);
+  if (enable) {
+    markStart();
+  } else {
+    markConfigChange(false);
+  }
+  return writeField<TCS3430_FIELD_PON>(enable);
 }
 
 /*!
@@ -193,11 +492,8 @@ bool Adafruit_TCS3430::powerOn(bool enable) {
  *    @return true if powered on
  */
 bool Adafruit_TCS3430::isPoweredOn() {
-  Adafruit_BusIO_Register enable_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_ENABLE);
-  Adafruit_BusIO_RegisterBits pon_bit =
-      Adafruit_BusIO_RegisterBits(&enable_reg, 1, 0);
-  return pon_bit.read();
+  TCS3430_TRACE(IS_POWERED_ON);
+  return readField<TCS3430_FIELD_PON>();
 }
 
 /*!
@@ -206,9 +502,9 @@ bool Adafruit_TCS3430::isPoweredOn() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setWaitCycles(uint8_t cycles) {
-  Adafruit_BusIO_Register wtime_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_WTIME);
-  return wtime_reg.write(cycles);
+  TCS3430_TRACE(SET_WAIT_CYCLES);
+  markConfigChange();
+  return writeConfigRegister(TCS3430_REG_WTIME, cycles);
 }
 
 /*!
@@ -216,19 +512,23 @@ bool Adafruit_TCS3430::setWaitCycles(uint8_t cycles) {
  *    @return Current wait cycles
  */
 uint8_t Adafruit_TCS3430::getWaitCycles() {
-  Adafruit_BusIO_Register wtime_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_WTIME);
-  return wtime_reg.read();
+  TCS3430_TRACE(GET_WAIT_CYCLES);
+  uint8_t cycles = 0;
+  readConfigRegister(TCS3430_REG_WTIME, &cycles);
+  return cycles;
 }
 
 /*!
- *    @brief  Set wait time in milliseconds
- *    @param  ms Wait time in ms
+ *    @brief  Set wait time in milliseconds. WLONG (setWaitLong()) then
+ *            multiplies it by 12; Adafruit_TCS3430_DutyCycle picks these
+ *            settings for a sample period.
+ *    @param  ms Wait time in ms, 2.78 to 711.68; values outside are
+ *            clamped
  *    @return true on success
  */
 bool Adafruit_TCS3430::setWaitTime(float ms) {
-  uint8_t cycles = (uint8_t)((ms / 2.78) - 1);
-  return setWaitCycles(cycles);
+  TCS3430_TRACE(SET_WAIT_TIME);
+  return setWaitCycles(msToCycles(ms));
 }
 
 /*!
@@ -236,6 +536,7 @@ bool Adafruit_TCS3430::setWaitTime(float ms) {
  *    @return Wait time in ms
  */
 float Adafruit_TCS3430::getWaitTime() {
+  TCS3430_TRACE(GET_WAIT_TIME);
   uint8_t cycles = getWaitCycles();
   return (cycles + 1) * 2.78;
 }
@@ -246,9 +547,13 @@ float Adafruit_TCS3430::getWaitTime() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setALSThresholdLow(uint16_t threshold) {
-  Adafruit_BusIO_Register threshold_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AILTL, 2, LSBFIRST);
-  return threshold_reg.write(threshold);
+  TCS3430_TRACE(SET_ALS_THRESHOLD_LOW);
+  uint8_t buffer[2] = {(uint8_t)threshold, (uint8_t)(threshold >> 8)};
+  if (!busWrite(TCS3430_REG_AILTL, buffer, sizeof(buffer))) {
+    return false;
+  }
+  _thresh_low = threshold;
+  return true;
 }
 
 /*!
@@ -256,9 +561,10 @@ bool Adafruit_TCS3430::setALSThresholdLow(uint16_t threshold) {
  *    @return Current low threshold value
  */
 uint16_t Adafruit_TCS3430::getALSThresholdLow() {
-  Adafruit_BusIO_Register threshold_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AILTL, 2, LSBFIRST);
-  return threshold_reg.read();
+  TCS3430_TRACE(GET_ALS_THRESHOLD_LOW);
+  uint8_t buffer[2] = {0xFF, 0xFF};
+  busRead(TCS3430_REG_AILTL, buffer, sizeof(buffer));
+  return buffer[0] | ((uint16_t)buffer[1] << 8);
 }
 
 /*!
@@ -267,9 +573,13 @@ uint16_t Adafruit_TCS3430::getALSThresholdLow() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setALSThresholdHigh(uint16_t threshold) {
-  Adafruit_BusIO_Register threshold_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AIHTL, 2, LSBFIRST);
-  return threshold_reg.write(threshold);
+  TCS3430_TRACE(SET_ALS_THRESHOLD_HIGH);
+  uint8_t buffer[2] = {(uint8_t)threshold, (uint8_t)(threshold >> 8)};
+  if (!busWrite(TCS3430_REG_AIHTL, buffer, sizeof(buffer))) {
+    return false;
+  }
+  _thresh_high = threshold;
+  return true;
 }
 
 /*!
@@ -277,9 +587,55 @@ bool Adafruit_TCS3430::setALSThresholdHigh(uint16_t threshold) {
  *    @return Current high threshold value
  */
 uint16_t Adafruit_TCS3430::getALSThresholdHigh() {
-  Adafruit_BusIO_Register threshold_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AIHTL, 2, LSBFIRST);
-  return threshold_reg.read();
+  TCS3430_TRACE(GET_ALS_THRESHOLD_HIGH);
+  uint8_t buffer[2] = {0xFF, 0xFF};
+  busRead(TCS3430_REG_AIHTL, buffer, sizeof(buffer));
+  return buffer[0] | ((uint16_t)buffer[1] << 8);
+}
+
+/*!
+ *    @brief  Set both ALS thresholds in one 4-byte burst
+ *    @param  low Low threshold value
+ *    @param  high High threshold value
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setALSThresholds(uint16_t low, uint16_t high) {
+  TCS3430_TRACE(SET_ALS_THRESHOLDS);
+  uint8_t buffer[4] = {(uint8_t)low, (uint8_t)(low >> 8), (uint8_t)high,
+                       (uint8_t)(high >> 8)};
+  if (!busWrite(TCS3430_REG_AILTL, buffer, sizeof(buffer))) {
+    return false;
+  }
+  _thresh_low = low;
+  _thresh_high = high;
+  return true;
+}
+
+/*!
+ *    @brief  Keep the threshold window centred on the light level. After
+ *            every interrupt drained by service(), the window is moved to
+ *            CH0 +/- the band with one 4-byte threshold write; the
+ *            STATUS+data burst has already cleared the interrupt. Use with
+ *            beginCapture(ring, false) and a persistence filter, so INT
+ *            only fires (and the ring only fills) when the light moves
+ *            out of the band. Until the first interrupt the window is
+ *            inverted, so it fires on the first cycle(s) and centres
+ *            itself.
+ *    @param  percent Half-width of the band as a percentage of CH0
+ *    @param  min_counts Smallest half-width in counts, so a dark scene
+ *            does not fire on noise. With percent 0 the band is fixed.
+ *            Both 0 stops tracking, leaving the last window in place.
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setThresholdTracking(uint8_t percent,
+                                            uint16_t min_counts) {
+  TCS3430_TRACE(SET_THRESHOLD_TRACKING);
+  _track_pct = percent;
+  _track_min = min_counts;
+  if (!percent && !min_counts) {
+    return true;
+  }
+  return setALSThresholds(0xFFFF, 0);
 }
 
 /*!
@@ -288,11 +644,8 @@ uint16_t Adafruit_TCS3430::getALSThresholdHigh() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setInterruptPersistence(tcs3430_pers_t persistence) {
-  Adafruit_BusIO_Register pers_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_PERS);
-  Adafruit_BusIO_RegisterBits apers_bits =
-      Adafruit_BusIO_RegisterBits(&pers_reg, 4, 0);
-  return apers_bits.write(persistence);
+  TCS3430_TRACE(SET_INTERRUPT_PERSISTENCE);
+  return writeField<TCS3430_FIELD_PERS>(persistence);
 }
 
 /*!
@@ -300,11 +653,8 @@ bool Adafruit_TCS3430::setInterruptPersistence(tcs3430_pers_t persistence) {
  *    @return Current persistence setting
  */
 tcs3430_pers_t Adafruit_TCS3430::getInterruptPersistence() {
-  Adafruit_BusIO_Register pers_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_PERS);
-  Adafruit_BusIO_RegisterBits apers_bits =
-      Adafruit_BusIO_RegisterBits(&pers_reg, 4, 0);
-  return (tcs3430_pers_t)apers_bits.read();
+  TCS3430_TRACE(GET_INTERRUPT_PERSISTENCE);
+  return (tcs3430_pers_t)readField<TCS3430_FIELD_PERS>();
 }
 
 /*!
@@ -313,11 +663,9 @@ tcs3430_pers_t Adafruit_TCS3430::getInterruptPersistence() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setWaitLong(bool enable) {
-  Adafruit_BusIO_Register cfg0_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG0);
-  Adafruit_BusIO_RegisterBits wlong_bit =
-      Adafruit_BusIO_RegisterBits(&cfg0_reg, 1, 2);
-  return wlong_bit.write(enable);
+  TCS3430_TRACE(SET_WAIT_LONG);
+  markConfigChange();
+  return writeField<TCS3430_FIELD_WLONG>(enable);
 }
 
 /*!
@@ -325,36 +673,45 @@ bool Adafruit_TCS3430::setWaitLong(bool enable) {
  *    @return true if 12x wait time multiplier is enabled
  */
 bool Adafruit_TCS3430::getWaitLong() {
-  Adafruit_BusIO_Register cfg0_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG0);
-  Adafruit_BusIO_RegisterBits wlong_bit =
-      Adafruit_BusIO_RegisterBits(&cfg0_reg, 1, 2);
-  return wlong_bit.read();
+  TCS3430_TRACE(GET_WAIT_LONG);
+  return readField<TCS3430_FIELD_WLONG>();
 }
 
 /*!
  *    @brief  Set ALS MUX to IR2 or X channel
  *    @param  enable true for IR2, false for X channel
+ *    @param  settle false if the caller tracks which integrations saw the
+ *            switch itself (e.g. Adafruit_TCS3430_Interleave): the data is
+ *            then not marked as settling and no change is counted
  *    @return true on success
  */
-bool Adafruit_TCS3430::setALSMUX_IR2(bool enable) {
-  Adafruit_BusIO_Register cfg1_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG1);
-  Adafruit_BusIO_RegisterBits amux_bit =
-      Adafruit_BusIO_RegisterBits(&cfg1_reg, 1, 3);
-  return amux_bit.write(enable);
+bool Adafruit_TCS3430::setALSMUX_IR2(bool enable, bool settle) {
+  TCS3430_TRACE(SET_ALSMUX_IR2);
+  if (settle) {
+    markConfigChange(false);
+  }
+  if (!writeField<TCS3430_FIELD_AMUX>(enable)) {
+    _amux_ir2 = -1;
+    return false;
+  }
+  _amux_ir2 = enable;
+  return true;
 }
 
 /*!
- *    @brief  Get ALS MUX setting
- *    @return true if IR2 channel, false if X channel
+ *    @brief  Get ALS MUX setting. If CFG1 cannot be read the mux state
+ *            stays unknown, so frames read afterwards are not VALID.
+ *    @return true if IR2 channel, false if X channel or on failure
  */
 bool Adafruit_TCS3430::getALSMUX_IR2() {
-  Adafruit_BusIO_Register cfg1_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG1);
-  Adafruit_BusIO_RegisterBits amux_bit =
-      Adafruit_BusIO_RegisterBits(&cfg1_reg, 1, 3);
-  return amux_bit.read();
+  TCS3430_TRACE(GET_ALSMUX_IR2);
+  uint8_t cfg1;
+  if (!readConfigRegister(TCS3430_FIELD_AMUX::reg, &cfg1)) {
+    _amux_ir2 = -1;
+    return false;
+  }
+  _amux_ir2 = TCS3430_FIELD_AMUX::get(cfg1);
+  return _amux_ir2;
 }
 
 /*!
@@ -363,29 +720,23 @@ bool Adafruit_TCS3430::getALSMUX_IR2() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::setALSGain(tcs3430_gain_t gain) {
-  Adafruit_BusIO_Register cfg1_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG1);
-  Adafruit_BusIO_RegisterBits again_bits =
-      Adafruit_BusIO_RegisterBits(&cfg1_reg, 2, 0);
-
-  if (gain == TCS3430_GAIN_128X) {
-    Adafruit_BusIO_Register cfg2_reg =
-        Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG2);
-    Adafruit_BusIO_RegisterBits hgain_bit =
-        Adafruit_BusIO_RegisterBits(&cfg2_reg, 1, 4);
-    if (!again_bits.write(TCS3430_GAIN_64X) || !hgain_bit.write(1)) {
-      return false;
-    }
-  } else {
-    Adafruit_BusIO_Register cfg2_reg =
-        Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG2);
-    Adafruit_BusIO_RegisterBits hgain_bit =
-        Adafruit_BusIO_RegisterBits(&cfg2_reg, 1, 4);
-    if (!again_bits.write(gain) || !hgain_bit.write(0)) {
-      return false;
-    }
+  TCS3430_TRACE(SET_ALS_GAIN);
+  bool hgain = (gain == TCS3430_GAIN_128X);
+  uint8_t again = hgain ? (uint8_t)TCS3430_GAIN_64X : (uint8_t)gain;
+  markConfigChange(false);
+
+  if (!writeField<TCS3430_FIELD_AGAIN>(again)) {
+    return false;
   }
-  return true;
+
+  // With a valid shadow copy of CFG2 we can skip the HGAIN write entirely
+  // when it is already in the requested state.
+  int8_t slot = shadowSlot(TCS3430_REG_CFG2);
+  if (_cache_enabled && (_shadow_valid & ((uint16_t)1 << slot)) &&
+      (bool)TCS3430_FIELD_HGAIN::get(_shadow[slot]) == hgain) {
+    return true;
+  }
+  return writeField<TCS3430_FIELD_HGAIN>(hgain);
 }
 
 /*!
@@ -393,18 +744,9 @@ bool Adafruit_TCS3430::setALSGain(tcs3430_gain_t gain) {
  *    @return Current gain setting
  */
 tcs3430_gain_t Adafruit_TCS3430::getALSGain() {
-  Adafruit_BusIO_Register cfg1_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG1);
-  Adafruit_BusIO_RegisterBits again_bits =
-      Adafruit_BusIO_RegisterBits(&cfg1_reg, 2, 0);
-
-  Adafruit_BusIO_Register cfg2_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG2);
-  Adafruit_BusIO_RegisterBits hgain_bit =
-      Adafruit_BusIO_RegisterBits(&cfg2_reg, 1, 4);
-
-  uint8_t again_val = again_bits.read();
-  bool hgain_val = hgain_bit.read();
+  TCS3430_TRACE(GET_ALS_GAIN);
+  uint8_t again_val = readField<TCS3430_FIELD_AGAIN>();
+  bool hgain_val = readField<TCS3430_FIELD_HGAIN>();
 
   if (again_val == TCS3430_GAIN_64X && hgain_val) {
     return TCS3430_GAIN_128X;
@@ -412,16 +754,47 @@ tcs3430_gain_t Adafruit_TCS3430::getALSGain() {
   return (tcs3430_gain_t)again_val;
 }
 
+/*!
+ *    @brief  Typical effective gain for a gain setting. 64X and 128X are
+ *            the characterised values (66 and 137), not the nominal ones.
+ *    @param  gain Gain setting
+ *    @return Gain multiplier
+ */
+uint8_t Adafruit_TCS3430::gainMultiplier(tcs3430_gain_t gain) {
+  switch (gain) {
+    case TCS3430_GAIN_1X:
+      return 1;
+    case TCS3430_GAIN_4X:
+      return 4;
+    case TCS3430_GAIN_16X:
+      return 16;
+    case TCS3430_GAIN_64X:
+      return 66;
+    case TCS3430_GAIN_128X:
+      return 137;
+    default:
+      return 1;
+  }
+}
+
+/*!
+ *    @brief  Maximum channel count for an ATIME value: 1024 counts per
+ *            2.78ms step, less one, capped at 16 bits
+ *    @param  atime ATIME register value
+ *    @return Full scale count
+ */
+uint16_t Adafruit_TCS3430::fullScale(uint8_t atime) {
+  uint32_t counts = ((uint32_t)atime + 1) * 1024 - 1;
+  return counts > 65535 ? 65535 : counts;
+}
+
 /*!
  *    @brief  Check if ALS is saturated
  *    @return true if saturated
  */
 bool Adafruit_TCS3430::isALSSaturated() {
-  Adafruit_BusIO_Register status_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_STATUS);
-  Adafruit_BusIO_RegisterBits asat_bit =
-      Adafruit_BusIO_RegisterBits(&status_reg, 1, 7);
-  return asat_bit.read();
+  TCS3430_TRACE(IS_ALS_SATURATED);
+  return readField<TCS3430_FIELD_ASAT>();
 }
 
 /*!
@@ -429,10 +802,10 @@ bool Adafruit_TCS3430::isALSSaturated() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::clearALSSaturated() {
-  // Write 0x80 to STATUS to clear saturation flag
-  Adafruit_BusIO_Register status_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_STATUS);
-  return status_reg.write(0x80);
+  TCS3430_TRACE(CLEAR_ALS_SATURATED);
+  // STATUS is write-1-to-clear
+  uint8_t clear = TCS3430_STATUS_ASAT;
+  return busWrite(TCS3430_REG_STATUS, &clear, 1);
 }
 
 /*!
@@ -440,11 +813,8 @@ bool Adafruit_TCS3430::clearALSSaturated() {
  *    @return true if interrupt is active
  */
 bool Adafruit_TCS3430::isALSInterrupt() {
-  Adafruit_BusIO_Register status_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_STATUS);
-  Adafruit_BusIO_RegisterBits aint_bit =
-      Adafruit_BusIO_RegisterBits(&status_reg, 1, 4);
-  return aint_bit.read();
+  TCS3430_TRACE(IS_ALS_INTERRUPT);
+  return readField<TCS3430_FIELD_AINT>();
 }
 
 /*!
@@ -452,12 +822,12 @@ bool Adafruit_TCS3430::isALSInterrupt() {
  *    @return true on success
  */
 bool Adafruit_TCS3430::clearALSInterrupt() {
+  TCS3430_TRACE(CLEAR_ALS_INTERRUPT);
   // Write 0xFF to STATUS to clear all flags. Note: if the threshold
   // condition still exists and ALS is running, AINT will re-fire
   // on the next integration cycle.
-  Adafruit_BusIO_Register status_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_STATUS);
-  return status_reg.write(0xFF);
+  uint8_t clear = 0xFF;
+  return busWrite(TCS3430_REG_STATUS, &clear, 1);
 }
 
 /*!
@@ -470,6 +840,7 @@ bool Adafruit_TCS3430::clearALSInterrupt() {
  */
 bool Adafruit_TCS3430::getChannels(uint16_t* x, uint16_t* y, uint16_t* z,
                                    uint16_t* ir1) {
+  TCS3430_TRACE(GET_CHANNELS);
   bool was_ir2 = getALSMUX_IR2();
   if (was_ir2) {
     if (!setALSMUX_IR2(false)) {
@@ -478,9 +849,7 @@ bool Adafruit_TCS3430::getChannels(uint16_t* x, uint16_t* y, uint16_t* z,
   }
 
   uint8_t buffer[8];
-  Adafruit_BusIO_Register data_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CH0DATAL, 8);
-  if (!data_reg.read(buffer, 8)) {
+  if (!busRead(TCS3430_REG_CH0DATAL, buffer, sizeof(buffer))) {
     if (was_ir2) {
       setALSMUX_IR2(true);
     }
@@ -500,152 +869,1396 @@ bool Adafruit_TCS3430::getChannels(uint16_t* x, uint16_t* y, uint16_t* z,
 }
 
 /*!
- *    @brief  Read IR2 (CH3) by switching AMUX to IR2
- *    @return IR2 channel value
+ *    @brief  Read IR2 (CH3) by switching AMUX to IR2. Blocking: spins in
+ *            yield() for up to two cycles. This is a compatibility wrapper
+ *            around startIR2() / poll(); new code should use those to keep
+ *            the main loop running while the sensor integrates.
+ *    @return IR2 channel value, 0 on failure or if CH3 was not IR2
  */
 uint16_t Adafruit_TCS3430::getIR2() {
-  uint16_t ir2 = 0;
-  bool was_ir2 = getALSMUX_IR2();
+  TCS3430_TRACE(GET_IR2);
+  if (!startIR2()) {
+    return 0;
+  }
 
-  if (!setALSMUX_IR2(true)) {
+  tcs3430_frame_t frame;
+  tcs3430_poll_t result;
+  while ((result = poll(&frame)) == TCS3430_POLL_PENDING) {
+    yield();
+  }
+  if (result != TCS3430_POLL_READY ||
+      !(frame.flags & TCS3430_FRAME_CH3_IR2)) {
     return 0;
   }
+  return frame.ch3;
+}
 
-  delay((uint16_t)getIntegrationTime());
+/*!
+ *    @brief  Read STATUS and all four channels in a single 9-byte burst.
+ *            CH3 is labelled from the tracked AMUX state, so no CFG1 read
+ *            is needed once the mux has been set or read.
+ *    @param  frame Pointer to the frame to fill
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::readFrame(tcs3430_frame_t* frame) {
+  TCS3430_TRACE(READ_FRAME);
+  // A failed AMUX read leaves _amux_ir2 unknown; the burst still goes
+  // ahead but the frame is not flagged VALID
+  if (_amux_ir2 < 0) {
+    getALSMUX_IR2();
+  }
 
-  Adafruit_BusIO_Register ch3_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CH3DATAL, 2, LSBFIRST);
-  ir2 = ch3_reg.read();
+  uint8_t buffer[9];
+  if (!busRead(TCS3430_REG_STATUS, buffer, sizeof(buffer))) {
+    frame->flags = 0;
+    return false;
+  }
+  decodeFrame(buffer, frame);
+  return true;
+}
 
-  if (!was_ir2) {
-    setALSMUX_IR2(false);
+/*!
+ *    @brief  Start a readFrame() burst without waiting for it. With an
+ *            Adafruit_TCS3430_Async.h transport the call returns at once
+ *            and done runs when the transfer completes; a blocking
+ *            transport runs it before returning. One burst at a time.
+ *    @param  frame Filled in before done is called; must stay valid
+ *    @param  done Called with the result, possibly from an interrupt
+ *    @param  context Passed to done
+ *    @return false if a burst is already pending or no sensor is attached
+ */
+bool Adafruit_TCS3430::readFrameAsync(tcs3430_frame_t* frame,
+                                      tcs3430_frame_cb_t done,
+                                      void* context) {
+  TCS3430_TRACE(READ_FRAME_ASYNC);
+  if (!_bus || _async_busy) {
+    return false;
   }
+  if (_amux_ir2 < 0) {
+    getALSMUX_IR2();
+  }
+  _async_frame = frame;
+  _async_done = done;
+  _async_context = context;
+  _async.reg = TCS3430_REG_STATUS;
+  _async.len = sizeof(_async_buffer);
+  _async.write = false;
+  _async.data = _async_buffer;
+  _async.done = frameAsyncDone;
+  _async.context = this;
+  _async_busy = true;
+#ifdef TCS3430_INSTRUMENT
+  _async_start = micros();
+#endif
+  if (!_bus->submit(&_async)) {
+    _async_busy = false;
+    return false;
+  }
+  return true;
+}
 
-  return ir2;
+/*!
+ *    @brief  Check whether a readFrameAsync() burst has yet to complete
+ *    @return true while pending
+ */
+bool Adafruit_TCS3430::isFrameAsyncPending() {
+  TCS3430_TRACE(IS_FRAME_ASYNC_PENDING);
+  return _async_busy;
 }
 
 /*!
- *    @brief  Set interrupt clear on read mode
- *    @param  enable true to enable clear on read
- *    @return true on success
+ *    @brief  Completion of a readFrameAsync() burst
+ *    @param  transfer The driver's _async transfer
+ *    @param  ok Whether it succeeded
  */
-bool Adafruit_TCS3430::setInterruptClearOnRead(bool enable) {
-  Adafruit_BusIO_Register cfg3_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG3);
-  Adafruit_BusIO_RegisterBits int_read_clear_bit =
-      Adafruit_BusIO_RegisterBits(&cfg3_reg, 1, 7);
-  return int_read_clear_bit.write(enable);
+void Adafruit_TCS3430::frameAsyncDone(tcs3430_transfer_t* transfer,
+                                      bool ok) {
+  Adafruit_TCS3430* sensor = (Adafruit_TCS3430*)transfer->context;
+#ifdef TCS3430_INSTRUMENT
+  sensor->countTransfer(TCS3430_REG_STATUS, transfer->len, 1,
+                        micros() - sensor->_async_start);
+#endif
+  tcs3430_frame_t* frame = sensor->_async_frame;
+  if (ok) {
+    sensor->decodeFrame(sensor->_async_buffer, frame);
+  } else {
+    frame->flags = 0;
+  }
+  sensor->_async_busy = false;
+  if (sensor->_async_done) {
+    sensor->_async_done(frame, ok, sensor->_async_context);
+  }
 }
 
 /*!
- *    @brief  Get interrupt clear on read mode
- *    @return true if clear on read is enabled
+ *    @brief  Fill in a frame from a STATUS + channel data burst
+ *    @param  buffer The 9 bytes read from STATUS on
+ *    @param  frame Destination, timestamped now
  */
-bool Adafruit_TCS3430::getInterruptClearOnRead() {
-  Adafruit_BusIO_Register cfg3_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG3);
-  Adafruit_BusIO_RegisterBits int_read_clear_bit =
-      Adafruit_BusIO_RegisterBits(&cfg3_reg, 1, 7);
-  return int_read_clear_bit.read();
+void Adafruit_TCS3430::decodeFrame(const uint8_t* buffer,
+                                   tcs3430_frame_t* frame) {
+  frame->timestamp = micros();
+  frame->status = buffer[0];
+  frame->z = buffer[1] | ((uint16_t)buffer[2] << 8);
+  frame->y = buffer[3] | ((uint16_t)buffer[4] << 8);
+  frame->ir1 = buffer[5] | ((uint16_t)buffer[6] << 8);
+  frame->ch3 = buffer[7] | ((uint16_t)buffer[8] << 8);
+
+  frame->flags = 0;
+  if (_amux_ir2 >= 0) {
+    frame->flags |= TCS3430_FRAME_VALID;
+  }
+  if (_amux_ir2 > 0) {
+    frame->flags |= TCS3430_FRAME_CH3_IR2;
+  }
+  if (buffer[0] & TCS3430_STATUS_ASAT) {
+    frame->flags |= TCS3430_FRAME_SATURATED;
+  }
+  if (buffer[0] & TCS3430_STATUS_AINT) {
+    frame->flags |= TCS3430_FRAME_INTERRUPT;
+  }
 }
 
 /*!
- *    @brief  Set sleep after interrupt mode
- *    @param  enable true to enable sleep after interrupt
+ *    @brief  Use a per-device color matrix (see
+ *            Adafruit_TCS3430_Calibration.h) in getCIE(), getCCT(),
+ *            getLux() and their fixed point versions. Only the pointer is
+ *            kept, so the matrix must outlive its use.
+ *    @param  matrix Matrix to use, NULL for the default
+ */
+void Adafruit_TCS3430::setColorMatrix(const tcs3430_matrix_t* matrix) {
+  _matrix = matrix;
+}
+
+/*!
+ *    @brief  Read the channels and compute CIE 1931 chromaticity using
+ *            the color matrix (see setColorMatrix())
+ *    @param  x Pointer to store CIE x
+ *    @param  y Pointer to store CIE y
  *    @return true on success
  */
-bool Adafruit_TCS3430::setSleepAfterInterrupt(bool enable) {
-  Adafruit_BusIO_Register cfg3_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG3);
-  Adafruit_BusIO_RegisterBits sai_bit =
-      Adafruit_BusIO_RegisterBits(&cfg3_reg, 1, 4);
-  return sai_bit.write(enable);
+bool Adafruit_TCS3430::getCIE(float* x, float* y) {
+  TCS3430_TRACE(GET_CIE);
+#ifdef TCS3430_FIXED_POINT
+  uint16_t qx, qy;
+  if (!getCIEFixed(&qx, &qy)) {
+    return false;
+  }
+  *x = qx * (1.0f / 32768);
+  *y = qy * (1.0f / 32768);
+  return true;
+#else
+  uint16_t cx, cy, cz, cir1;
+  if (!getChannels(&cx, &cy, &cz, &cir1)) {
+    return false;
+  }
+  tcs3430_xyz_t xyz;
+  Adafruit_TCS3430_Color::rawToXYZ(cx, cy, cz, cir1, &xyz, _matrix);
+  return Adafruit_TCS3430_Color::xyzToCIE(&xyz, x, y);
+#endif
 }
 
 /*!
- *    @brief  Get sleep after interrupt mode
- *    @return true if sleep after interrupt is enabled
+ *    @brief  Read the channels and compute correlated color temperature
+ *    @return CCT in kelvin, 0 on failure
  */
-bool Adafruit_TCS3430::getSleepAfterInterrupt() {
-  Adafruit_BusIO_Register cfg3_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_CFG3);
-  Adafruit_BusIO_RegisterBits sai_bit =
-      Adafruit_BusIO_RegisterBits(&cfg3_reg, 1, 4);
-  return sai_bit.read();
+float Adafruit_TCS3430::getCCT() {
+  TCS3430_TRACE(GET_CCT);
+#ifdef TCS3430_FIXED_POINT
+  return getCCTFixed();
+#else
+  float x, y;
+  if (!getCIE(&x, &y)) {
+    return 0.0f;
+  }
+  return Adafruit_TCS3430_Color::cieToCCT(x, y);
+#endif
 }
 
 /*!
- *    @brief  Set auto-zero mode
- *    @param  enable true to enable auto-zero
+ *    @brief  Read the channels and compute illuminance for the current
+ *            gain and integration time
+ *    @return Lux, 0 on failure
+ */
+float Adafruit_TCS3430::getLux() {
+  TCS3430_TRACE(GET_LUX);
+#ifdef TCS3430_FIXED_POINT
+  return getLuxFixed() * (1.0f / 256);
+#else
+  uint16_t cx, cy, cz, cir1;
+  if (!getChannels(&cx, &cy, &cz, &cir1)) {
+    return 0.0f;
+  }
+  tcs3430_xyz_t xyz;
+  Adafruit_TCS3430_Color::rawToXYZ(cx, cy, cz, cir1, &xyz, _matrix);
+  return Adafruit_TCS3430_Color::lux(xyz.Y, getALSGain(),
+                                     getIntegrationCycles());
+#endif
+}
+
+/*!
+ *    @brief  Read the channels and compute CIE 1931 chromaticity without
+ *            floating point
+ *    @param  x Pointer to store CIE x, Q15
+ *    @param  y Pointer to store CIE y, Q15
  *    @return true on success
  */
-bool Adafruit_TCS3430::setAutoZeroMode(bool enable) {
-  Adafruit_BusIO_Register az_config_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AZ_CONFIG);
-  Adafruit_BusIO_RegisterBits az_mode_bit =
-      Adafruit_BusIO_RegisterBits(&az_config_reg, 1, 7);
-  return az_mode_bit.write(enable);
+bool Adafruit_TCS3430::getCIEFixed(uint16_t* x, uint16_t* y) {
+  TCS3430_TRACE(GET_CIE_FIXED);
+  uint16_t cx, cy, cz, cir1;
+  if (!getChannels(&cx, &cy, &cz, &cir1)) {
+    return false;
+  }
+  tcs3430_xyz_fixed_t xyz;
+  Adafruit_TCS3430_Color::rawToXYZFixed(cx, cy, cz, cir1, &xyz, _matrix);
+  return Adafruit_TCS3430_Color::xyzToCIEFixed(&xyz, x, y);
 }
 
 /*!
- *    @brief  Get auto-zero mode
- *    @return true if auto-zero is enabled
+ *    @brief  Read the channels and compute CCT without floating point
+ *    @return CCT in kelvin, 0 on failure
  */
-bool Adafruit_TCS3430::getAutoZeroMode() {
-  Adafruit_BusIO_Register az_config_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AZ_CONFIG);
-  Adafruit_BusIO_RegisterBits az_mode_bit =
-      Adafruit_BusIO_RegisterBits(&az_config_reg, 1, 7);
-  return az_mode_bit.read();
+uint16_t Adafruit_TCS3430::getCCTFixed() {
+  TCS3430_TRACE(GET_CCT_FIXED);
+  uint16_t x, y;
+  if (!getCIEFixed(&x, &y)) {
+    return 0;
+  }
+  return Adafruit_TCS3430_Color::cieToCCTFixed(x, y);
 }
 
 /*!
- *    @brief  Set auto-zero interval
- *    @param  n Run auto-zero every N measurements
- *    @return true on success
+ *    @brief  Read the channels and compute illuminance without floating
+ *            point
+ *    @return Lux in Q8 (256 = 1 lux), 0 on failure
  */
-bool Adafruit_TCS3430::setRunAutoZeroEveryN(uint8_t n) {
-  Adafruit_BusIO_Register az_config_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AZ_CONFIG);
-  Adafruit_BusIO_RegisterBits az_nth_bits =
-      Adafruit_BusIO_RegisterBits(&az_config_reg, 7, 0);
-  return az_nth_bits.write(n);
+uint32_t Adafruit_TCS3430::getLuxFixed() {
+  TCS3430_TRACE(GET_LUX_FIXED);
+  uint16_t cx, cy, cz, cir1;
+  if (!getChannels(&cx, &cy, &cz, &cir1)) {
+    return 0;
+  }
+  tcs3430_xyz_fixed_t xyz;
+  Adafruit_TCS3430_Color::rawToXYZFixed(cx, cy, cz, cir1, &xyz, _matrix);
+  return Adafruit_TCS3430_Color::luxFixed(xyz.Y, getALSGain(),
+                                          getIntegrationCycles());
 }
 
 /*!
- *    @brief  Get auto-zero interval
- *    @return Auto-zero interval (every N measurements)
+ *    @brief  Start a non-blocking IR2 measurement. Switches AMUX to IR2
+ *            and returns immediately; poll() reads CH3 once a full
+ *            integration with the new mux setting has completed and then
+ *            restores the previous mux setting.
+ *    @return true if the measurement was started, false if one is
+ *            already running or the mux could not be read or set
  */
-uint8_t Adafruit_TCS3430::getRunAutoZeroEveryN() {
-  Adafruit_BusIO_Register az_config_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_AZ_CONFIG);
-  Adafruit_BusIO_RegisterBits az_nth_bits =
-      Adafruit_BusIO_RegisterBits(&az_config_reg, 7, 0);
-  return az_nth_bits.read();
+bool Adafruit_TCS3430::startIR2() {
+  TCS3430_TRACE(START_IR2);
+  if (_meas_state != TCS3430_MEAS_IDLE) {
+    return false;
+  }
+  // The mux has to be known to put it back afterwards
+  if (_amux_ir2 < 0) {
+    getALSMUX_IR2();
+    if (_amux_ir2 < 0) {
+      return false;
+    }
+  }
+
+  _meas_restore_x = (_amux_ir2 == 0);
+  if (_meas_restore_x && !setALSMUX_IR2(true)) {
+    return false;
+  }
+  _meas_deadline = freshDeadline();
+  _meas_state = TCS3430_MEAS_IR2;
+  return true;
 }
 
 /*!
- *    @brief  Enable/disable saturation interrupt
- *    @param  enable true to enable saturation interrupt
- *    @return true on success
+ *    @brief  Start waiting for the next fresh frame: one integrated
+ *            entirely after the last gain, ATIME, AMUX or enable change
+ *            and after this call. Returns immediately; collect the frame
+ *            with poll().
+ *    @return true if the measurement was started
  */
-bool Adafruit_TCS3430::enableSaturationInt(bool enable) {
-  Adafruit_BusIO_Register intenab_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_INTENAB);
-  Adafruit_BusIO_RegisterBits asien_bit =
-      Adafruit_BusIO_RegisterBits(&intenab_reg, 1, 7);
-  return asien_bit.write(enable);
+bool Adafruit_TCS3430::startFrame() {
+  TCS3430_TRACE(START_FRAME);
+  if (_meas_state != TCS3430_MEAS_IDLE) {
+    return false;
+  }
+
+  _meas_deadline = freshDeadline();
+  // Without a pending change, one full cycle from now guarantees a new one
+  uint32_t next = micros() + getCycleMicros();
+  if ((int32_t)(next - _meas_deadline) > 0) {
+    _meas_deadline = next;
+  }
+  _meas_restore_x = false;
+  _meas_state = TCS3430_MEAS_FRAME;
+  return true;
 }
 
 /*!
- *    @brief  Enable/disable ALS interrupt
- *    @param  enable true to enable ALS interrupt
- *    @return true on success
+ *    @brief  Advance a measurement started with startIR2() or startFrame().
+ *            Never blocks: returns PENDING until the data is due, then does
+ *            the frame read (and mux restore for IR2) and returns READY.
+ *    @param  frame Pointer to the frame filled in on READY
+ *    @return Measurement state
  */
-bool Adafruit_TCS3430::enableALSInt(bool enable) {
-  Adafruit_BusIO_Register intenab_reg =
-      Adafruit_BusIO_Register(i2c_dev, TCS3430_REG_INTENAB);
-  Adafruit_BusIO_RegisterBits aien_bit =
-      Adafruit_BusIO_RegisterBits(&intenab_reg, 1, 4);
-  return aien_bit.write(enable);
-}
\ No newline at end of file
+tcs3430_poll_t Adafruit_TCS3430::poll(tcs3430_frame_t* frame) {
+  TCS3430_TRACE(POLL);
+  if (_meas_state == TCS3430_MEAS_IDLE) {
+    return TCS3430_POLL_IDLE;
+  }
+  if ((int32_t)(micros() - _meas_deadline) < 0) {
+    return TCS3430_POLL_PENDING;
+  }
+
+  bool ok = readFrame(frame);
+  if (_meas_restore_x && !setALSMUX_IR2(false)) {
+    ok = false;
+  }
+  _meas_state = TCS3430_MEAS_IDLE;
+  return ok ? TCS3430_POLL_READY : TCS3430_POLL_ERROR;
+}
+
+/*!
+ *    @brief  Abandon a measurement in progress, restoring the mux if needed
+ */
+void Adafruit_TCS3430::cancelMeasurement() {
+  TCS3430_TRACE(CANCEL_MEASUREMENT);
+  if (_meas_state != TCS3430_MEAS_IDLE && _meas_restore_x) {
+    setALSMUX_IR2(false);
+  }
+  _meas_state = TCS3430_MEAS_IDLE;
+}
+
+/*!
+ *    @brief  Get the length of one full ALS cycle: integration plus the
+ *            wait time when WEN is set (x12 with WLONG)
+ *    @return Cycle length in microseconds
+ */
+uint32_t Adafruit_TCS3430::getCycleMicros() {
+  TCS3430_TRACE(GET_CYCLE_MICROS);
+  // ENABLE, ATIME and WTIME in one burst unless the cache holds them;
+  // the reserved address between reads back as 0
+  static const uint8_t regs[] = {TCS3430_REG_ENABLE, TCS3430_REG_ATIME,
+                                 TCS3430_REG_WTIME};
+  uint8_t block[TCS3430_REG_WTIME - TCS3430_REG_ENABLE + 1] = {0};
+  bool cached = _cache_enabled;
+  for (uint8_t i = 0; i < sizeof(regs); i++) {
+    if (!(_shadow_valid & ((uint16_t)1 << shadowSlot(regs[i])))) {
+      cached = false;
+    }
+  }
+  if (cached || busRead(TCS3430_REG_ENABLE, block, sizeof(block))) {
+    for (uint8_t i = 0; i < sizeof(regs); i++) {
+      uint8_t* value = &block[regs[i] - TCS3430_REG_ENABLE];
+      if (cached) {
+        readConfigRegister(regs[i], value);
+      } else {
+        storeShadow(regs[i], *value);
+      }
+    }
+  }
+  bool wait_enable = TCS3430_FIELD_WEN::get(block[0]);
+  return cycleMicros(block[TCS3430_REG_ATIME - TCS3430_REG_ENABLE],
+                     wait_enable,
+                     block[TCS3430_REG_WTIME - TCS3430_REG_ENABLE],
+                     wait_enable && getWaitLong());
+}
+
+/*!
+ *    @brief  Length of one full ALS cycle for a set of timing values
+ *    @param  atime ATIME
+ *    @param  wait_enable WEN
+ *    @param  wtime WTIME
+ *    @param  wait_long WLONG
+ *    @return Cycle length in microseconds
+ */
+uint32_t Adafruit_TCS3430::cycleMicros(uint8_t atime, bool wait_enable,
+                                       uint8_t wtime, bool wait_long) {
+  uint32_t cycle = (uint32_t)(atime + 1) * TCS3430_STEP_MICROS;
+  if (wait_enable) {
+    uint32_t wait = (uint32_t)(wtime + 1) * TCS3430_STEP_MICROS;
+    if (wait_long) {
+      wait *= 12;
+    }
+    cycle += wait;
+  }
+  return cycle;
+}
+
+/*!
+ *    @brief  Restart the ALS cycle by toggling AEN. Unlike other changes
+ *            this gives a known boundary, so the data is fresh after the
+ *            auto-zero pass and one cycle rather than two cycles. Useful
+ *            for starting several sensors together.
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::restartCycle() {
+  TCS3430_TRACE(RESTART_CYCLE);
+  if (!ALSEnable(false) || !ALSEnable(true)) {
+    return false;
+  }
+  // AEN 0 -> 1 runs an auto-zero pass before the first integration;
+  // ALSEnable() left the cycle length in _fresh_cycle
+  _fresh_at = micros() + (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS +
+              _fresh_cycle;
+  _fresh_known = true;
+  return true;
+}
+
+/*!
+ *    @brief  Check if a configuration change is still working its way
+ *            through the ADC, i.e. the current data may predate it
+ *    @return true if the data registers may be stale
+ */
+bool Adafruit_TCS3430::isSettling() {
+  TCS3430_TRACE(IS_SETTLING);
+  if (!_settling) {
+    return false;
+  }
+  if ((int32_t)(micros() - freshDeadline()) >= 0) {
+    _settling = false;
+  }
+  return _settling;
+}
+
+/*!
+ *    @brief  Count of settings changes that affect the data or the cycle
+ *            timing, so a helper such as Adafruit_TCS3430_Scheduler can
+ *            tell when to start over
+ *    @return Changes so far, wrapping at 65536
+ */
+uint16_t Adafruit_TCS3430::getConfigChangeCount() {
+  return _config_changes;
+}
+
+/*!
+ *    @brief  When the latest such change was made
+ *    @return Time in micros()
+ */
+uint32_t Adafruit_TCS3430::getConfigChangeMicros() {
+  return _changed_at;
+}
+
+/*!
+ *    @brief  Note that a setting affecting the data or cycle timing is
+ *            about to change. The cycle the change lands in keeps the
+ *            timing from before it, so a timing change records that cycle
+ *            now, while the registers still hold it. Other changes leave
+ *            the cycle alone, so it can be read back later if needed.
+ *    @param  timing false if the change leaves the cycle length alone
+ *            (gain, AMUX)
+ *    @param  cycle Cycle length up to this change if the caller knows it,
+ *            0 to use the known one or read it back
+ */
+void Adafruit_TCS3430::markConfigChange(bool timing, uint32_t cycle) {
+  if (cycle == 0 && _fresh_known) {
+    cycle = _fresh_cycle;
+  } else if (cycle == 0 && timing) {
+    cycle = getCycleMicros();
+  }
+  uint32_t now = micros();
+  // An earlier change that has not worked through yet may have left a
+  // longer cycle running. 0 stands for the cycle in the registers.
+  uint32_t outgoing = cycle;
+  if (_settling && _outgoing_cycle > outgoing &&
+      (int32_t)(now - (_changed_at + _outgoing_cycle)) < 0) {
+    outgoing = _outgoing_cycle;
+  }
+  _outgoing_cycle = outgoing;
+  _changed_at = now;
+  _settling = true;
+  _fresh_known = !timing && cycle != 0;
+  if (_fresh_known) {
+    _fresh_at = now + outgoing + cycle;
+  }
+  _config_changes++;
+}
+
+/*!
+ *    @brief  Note a change that may start the ALS from idle (PON or AEN
+ *            0 -> 1). An auto-zero pass then runs before the first
+ *            integration, and stands in for the cycle in progress when
+ *            it is the longer. The cycle length itself does not change.
+ */
+void Adafruit_TCS3430::markStart() {
+  uint32_t cycle = _fresh_known ? _fresh_cycle : getCycleMicros();
+  uint32_t az = (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS;
+  markConfigChange(true, cycle > az ? cycle : az);
+  _fresh_cycle = cycle;
+  _fresh_at = _changed_at + _outgoing_cycle + cycle;
+  _fresh_known = true;
+}
+
+/*!
+ *    @brief  Time by which a full cycle will have completed since the last
+ *            configuration change. The change may land anywhere in the
+ *            cycle in progress, which still runs with the old timing, so
+ *            allow that cycle plus a full new one.
+ *    @return Deadline in micros()
+ */
+uint32_t Adafruit_TCS3430::freshDeadline() {
+  if (!_settling) {
+    return micros();
+  }
+  if (!_fresh_known) {
+    _fresh_cycle = getCycleMicros();
+    uint32_t outgoing = _outgoing_cycle ? _outgoing_cycle : _fresh_cycle;
+    _fresh_at = _changed_at + outgoing + _fresh_cycle;
+    _fresh_known = true;
+  }
+  return _fresh_at;
+}
+
+/*!
+ *    @brief  Start INT-driven capture into a ring buffer. Turns on
+ *            INT_READ_CLEAR so the STATUS+data burst in service() also
+ *            releases INT, and enables the ALS interrupt. Attach an ISR
+ *            on the INT pin that calls handleInterrupt().
+ *    @param  ring Ring buffer that receives the captured frames
+ *    @param  every_cycle true to set persistence to every ALS cycle, so
+ *            each integration produces a frame; false to keep the
+ *            current thresholds and persistence as a trigger
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::beginCapture(
+    Adafruit_TCS3430_RingBase<tcs3430_frame_t>* ring, bool every_cycle) {
+  TCS3430_TRACE(BEGIN_CAPTURE);
+  if (!ring || _event_queue) {
+    return false;
+  }
+  if (_amux_ir2 < 0) {
+    getALSMUX_IR2();
+  }
+
+  _capture_restore_clear = getInterruptClearOnRead();
+  if (!setInterruptClearOnRead(true)) {
+    return false;
+  }
+  if (every_cycle && !setInterruptPersistence(TCS3430_PERS_EVERY)) {
+    return false;
+  }
+
+  _int_pending = 0;
+  _int_missed = 0;
+  _capture_ring = ring;
+  return clearALSInterrupt() && enableALSInt(true);
+}
+
+/*!
+ *    @brief  Stop INT-driven capture and disable the ALS interrupt
+ */
+void Adafruit_TCS3430::endCapture() {
+  TCS3430_TRACE(END_CAPTURE);
+  if (!_capture_ring) {
+    return;
+  }
+  _capture_ring = NULL;
+  enableALSInt(false);
+  setInterruptClearOnRead(_capture_restore_clear);
+  clearALSInterrupt();
+}
+
+/*!
+ *    @brief  Start INT-driven event decoding: instead of a frame per
+ *            interrupt, service() pushes what happened (crossed the high
+ *            or low threshold, saturated, or plain data ready) to a
+ *            queue, for one 3-byte STATUS+CH0 read and one STATUS write
+ *            per interrupt. CH0 is compared against the thresholds as
+ *            last written through this driver (read once here), so set
+ *            them with the driver. Turns INT_READ_CLEAR off, so that
+ *            write clears only the flags reported, and enables the ALS
+ *            interrupt; thresholds and persistence are left as set.
+ *            Attach an ISR on the INT pin that calls handleInterrupt().
+ *            Not available during beginCapture().
+ *    @param  queue Ring buffer that receives the events
+ *    @param  saturation true to also enable the saturation interrupt and
+ *            report TCS3430_EVENT_SATURATED
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::beginEvents(
+    Adafruit_TCS3430_RingBase<tcs3430_event_t>* queue, bool saturation) {
+  TCS3430_TRACE(BEGIN_EVENTS);
+  if (!queue || _capture_ring) {
+    return false;
+  }
+  uint8_t buffer[4];
+  if (!busRead(TCS3430_REG_AILTL, buffer, sizeof(buffer))) {
+    return false;
+  }
+  _thresh_low = buffer[0] | ((uint16_t)buffer[1] << 8);
+  _thresh_high = buffer[2] | ((uint16_t)buffer[3] << 8);
+
+  _capture_restore_clear = getInterruptClearOnRead();
+  if (!setInterruptClearOnRead(false)) {
+    return false;
+  }
+
+  _int_pending = 0;
+  _int_missed = 0;
+  _event_saturation = saturation;
+  _event_queue = queue;
+  return clearALSInterrupt() && (!saturation || enableSaturationInt(true)) &&
+         enableALSInt(true);
+}
+
+/*!
+ *    @brief  Stop event decoding and disable the interrupts it enabled
+ */
+void Adafruit_TCS3430::endEvents() {
+  TCS3430_TRACE(END_EVENTS);
+  if (!_event_queue) {
+    return;
+  }
+  _event_queue = NULL;
+  enableALSInt(false);
+  if (_event_saturation) {
+    enableSaturationInt(false);
+  }
+  setInterruptClearOnRead(_capture_restore_clear);
+  clearALSInterrupt();
+}
+
+/*!
+ *    @brief  Note an INT edge. Safe to call from an ISR: touches no bus
+ *            and only records the time of the edge.
+ */
+void Adafruit_TCS3430::handleInterrupt() {
+  _int_at = micros();
+  _int_pending = _int_pending + 1;
+}
+
+/*!
+ *    @brief  Drain a pending interrupt into the capture ring: one 9-byte
+ *            STATUS+data burst, which also clears the interrupt through
+ *            INT_READ_CLEAR. With beginEvents() instead, classify it into
+ *            the event queue. With setThresholdTracking() on, the
+ *            threshold window is then re-centred. Call from loop() or a
+ *            task.
+ *    @return Number of frames or events added (0 or 1; up to 2 events)
+ */
+uint8_t Adafruit_TCS3430::service() {
+  TCS3430_TRACE(SERVICE);
+  if ((!_capture_ring && !_event_queue) || !_int_pending) {
+    return 0;
+  }
+
+  noInterrupts();
+  uint8_t pending = _int_pending;
+  uint32_t at = _int_at;
+  _int_pending = 0;
+  interrupts();
+
+  // Only the newest integration is in the data registers
+  _int_missed += pending - 1;
+  if (_event_queue) {
+    return serviceEvents(at);
+  }
+
+  tcs3430_frame_t frame;
+  if (!readFrame(&frame)) {
+    // The burst never reached STATUS, so INT_READ_CLEAR did not clear it
+    retryInterrupt();
+    return 0;
+  }
+  frame.timestamp = at;
+  trackThresholds(frame.z);
+  return _capture_ring->push(frame) ? 1 : 0;
+}
+
+/*!
+ *    @brief  Classify the interrupt behind an INT edge into the event
+ *            queue: read STATUS and CH0 in one burst, then clear just the
+ *            flags found with one write (STATUS is write-1-to-clear).
+ *    @param  at micros() of the edge
+ *    @return Number of events added (0 to 2)
+ */
+uint8_t Adafruit_TCS3430::serviceEvents(uint32_t at) {
+  uint8_t buffer[3];
+  if (!busRead(TCS3430_REG_STATUS, buffer, sizeof(buffer))) {
+    retryInterrupt();
+    return 0;
+  }
+  uint8_t mask = TCS3430_STATUS_AINT;
+  if (_event_saturation) {
+    mask |= TCS3430_STATUS_ASAT;
+  }
+  uint8_t handled = buffer[0] & mask;
+  if (!handled) {
+    return 0;
+  }
+  if (!busWrite(TCS3430_REG_STATUS, &handled, 1)) {
+    retryInterrupt();
+    return 0;
+  }
+
+  tcs3430_event_t event;
+  event.timestamp = at;
+  event.ch0 = buffer[1] | ((uint16_t)buffer[2] << 8);
+  event.status = buffer[0];
+  uint8_t added = 0;
+  if (handled & TCS3430_STATUS_ASAT) {
+    event.type = TCS3430_EVENT_SATURATED;
+    added += _event_queue->push(event);
+  }
+  if (handled & TCS3430_STATUS_AINT) {
+    // An inverted window fires every cycle, like persistence every cycle
+    if (_thresh_low <= _thresh_high && event.ch0 > _thresh_high) {
+      event.type = TCS3430_EVENT_CROSSED_HIGH;
+    } else if (_thresh_low <= _thresh_high && event.ch0 < _thresh_low) {
+      event.type = TCS3430_EVENT_CROSSED_LOW;
+    } else {
+      event.type = TCS3430_EVENT_DATA_READY;
+    }
+    added += _event_queue->push(event);
+  }
+  trackThresholds(event.ch0);
+  return added;
+}
+
+/*!
+ *    @brief  Put back an interrupt that a bus error kept service() from
+ *            clearing. INT is still asserted, so no new edge comes: the
+ *            next call retries it.
+ */
+void Adafruit_TCS3430::retryInterrupt() {
+  noInterrupts();
+  _int_pending = _int_pending + 1;
+  interrupts();
+}
+
+/*!
+ *    @brief  Re-centre the threshold window on CH0 when
+ *            setThresholdTracking() is on
+ *    @param  ch0 Latest CH0
+ */
+void Adafruit_TCS3430::trackThresholds(uint16_t ch0) {
+  if (!_track_pct && !_track_min) {
+    return;
+  }
+  // A failed write leaves the old window, which fires again and retries
+  uint32_t half = (uint32_t)ch0 * _track_pct / 100;
+  if (half < _track_min) {
+    half = _track_min;
+  }
+  uint32_t high = ch0 + half;
+  setALSThresholds(ch0 > half ? ch0 - half : 0, high > 65535 ? 65535 : high);
+}
+
+/*!
+ *    @brief  Remember the thresholds of a configuration image that is now
+ *            on the chip, for classifying events
+ *    @param  image Configuration image
+ */
+void Adafruit_TCS3430::noteThresholds(const uint8_t* image) {
+  _thresh_low = image[kImgAiltl] | ((uint16_t)image[kImgAilth] << 8);
+  _thresh_high = image[kImgAihtl] | ((uint16_t)image[kImgAihth] << 8);
+}
+
+/*!
+ *    @brief  Number of INT edges that could not be captured because
+ *            another was still pending when they arrived
+ *    @return Missed interrupt count since beginCapture()
+ */
+uint32_t Adafruit_TCS3430::getMissedInterrupts() {
+  return _int_missed;
+}
+
+/*!
+ *    @brief  Set interrupt clear on read mode
+ *    @param  enable true to enable clear on read
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setInterruptClearOnRead(bool enable) {
+  TCS3430_TRACE(SET_INTERRUPT_CLEAR_ON_READ);
+  return writeField<TCS3430_FIELD_INT_READ_CLEAR>(enable);
+}
+
+/*!
+ *    @brief  Get interrupt clear on read mode
+ *    @return true if clear on read is enabled
+ */
+bool Adafruit_TCS3430::getInterruptClearOnRead() {
+  TCS3430_TRACE(GET_INTERRUPT_CLEAR_ON_READ);
+  return readField<TCS3430_FIELD_INT_READ_CLEAR>();
+}
+
+/*!
+ *    @brief  Set sleep after interrupt mode
+ *    @param  enable true to enable sleep after interrupt
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setSleepAfterInterrupt(bool enable) {
+  TCS3430_TRACE(SET_SLEEP_AFTER_INTERRUPT);
+  return writeField<TCS3430_FIELD_SAI>(enable);
+}
+
+/*!
+ *    @brief  Get sleep after interrupt mode
+ *    @return true if sleep after interrupt is enabled
+ */
+bool Adafruit_TCS3430::getSleepAfterInterrupt() {
+  TCS3430_TRACE(GET_SLEEP_AFTER_INTERRUPT);
+  return readField<TCS3430_FIELD_SAI>();
+}
+
+/*!
+ *    @brief  Set auto-zero mode
+ *    @param  enable true to enable auto-zero
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setAutoZeroMode(bool enable) {
+  TCS3430_TRACE(SET_AUTO_ZERO_MODE);
+  return writeField<TCS3430_FIELD_AZ_MODE>(enable);
+}
+
+/*!
+ *    @brief  Get auto-zero mode
+ *    @return true if auto-zero is enabled
+ */
+bool Adafruit_TCS3430::getAutoZeroMode() {
+  TCS3430_TRACE(GET_AUTO_ZERO_MODE);
+  return readField<TCS3430_FIELD_AZ_MODE>();
+}
+
+/*!
+ *    @brief  Set auto-zero interval
+ *    @param  n Run auto-zero every N measurements
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::setRunAutoZeroEveryN(uint8_t n) {
+  TCS3430_TRACE(SET_RUN_AUTO_ZERO_EVERY_N);
+  return writeField<TCS3430_FIELD_AZ_NTH>(n);
+}
+
+/*!
+ *    @brief  Get auto-zero interval
+ *    @return Auto-zero interval (every N measurements)
+ */
+uint8_t Adafruit_TCS3430::getRunAutoZeroEveryN() {
+  TCS3430_TRACE(GET_RUN_AUTO_ZERO_EVERY_N);
+  return readField<TCS3430_FIELD_AZ_NTH>();
+}
+
+/*!
+ *    @brief  Enable/disable saturation interrupt
+ *    @param  enable true to enable saturation interrupt
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::enableSaturationInt(bool enable) {
+  TCS3430_TRACE(ENABLE_SATURATION_INT);
+  return writeField<TCS3430_FIELD_ASIEN>(enable);
+}
+
+/*!
+ *    @brief  Enable/disable ALS interrupt
+ *    @param  enable true to enable ALS interrupt
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::enableALSInt(bool enable) {
+  TCS3430_TRACE(ENABLE_ALS_INT);
+  return writeField<TCS3430_FIELD_AIEN>(enable);
+}
+
+/*!
+ *    @brief  Enable or disable the shadow register cache. When enabled,
+ *            ENABLE, ATIME, WTIME, PERS, CFG0-CFG3, AZ_CONFIG and INTENAB
+ *            are mirrored
+ *            in RAM: setters become a single write and getters make no
+ *            bus traffic. Enabling after begin() resyncs immediately.
+ *    @param  enable true to use the shadow cache
+ */
+void Adafruit_TCS3430::enableRegisterCache(bool enable) {
+  TCS3430_TRACE(ENABLE_REGISTER_CACHE);
+  _cache_enabled = enable;
+  _shadow_valid = 0;
+  if (enable && _bus) {
+    resync();
+  }
+}
+
+/*!
+ *    @brief  Check if the shadow register cache is enabled
+ *    @return true if the cache is in use
+ */
+bool Adafruit_TCS3430::isRegisterCacheEnabled() {
+  return _cache_enabled;
+}
+
+/*!
+ *    @brief  Discard the shadow cache and reload it from the chip. Call
+ *            this if the sensor may have been changed behind our back
+ *            (power cycle, another bus master, etc).
+ *    @return true on success, false if any register read failed
+ */
+bool Adafruit_TCS3430::resync() {
+  TCS3430_TRACE(RESYNC);
+  _shadow_valid = 0;
+  if (!_bus || !_cache_enabled) {
+    return false;
+  }
+
+  // ENABLE through CFG1 in one burst; reserved addresses read back as 0
+  uint8_t buffer[TCS3430_REG_CFG1 - TCS3430_REG_ENABLE + 1];
+  if (!busRead(TCS3430_REG_ENABLE, buffer, sizeof(buffer))) {
+    return false;
+  }
+
+  static const uint8_t block_regs[] = {
+      TCS3430_REG_ENABLE, TCS3430_REG_ATIME, TCS3430_REG_WTIME,
+      TCS3430_REG_PERS,   TCS3430_REG_CFG0,  TCS3430_REG_CFG1};
+  for (uint8_t i = 0; i < sizeof(block_regs); i++) {
+    int8_t slot = shadowSlot(block_regs[i]);
+    _shadow[slot] = buffer[block_regs[i] - TCS3430_REG_ENABLE];
+    _shadow_valid |= ((uint16_t)1 << slot);
+  }
+
+  static const uint8_t single_regs[] = {TCS3430_REG_CFG2, TCS3430_REG_CFG3,
+                                        TCS3430_REG_AZ_CONFIG,
+                                        TCS3430_REG_INTENAB};
+  for (uint8_t i = 0; i < sizeof(single_regs); i++) {
+    uint8_t value;
+    if (!readConfigRegister(single_regs[i], &value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Apply a whole configuration with as few transactions as
+ *            possible. Only registers whose value changes are written,
+ *            and adjacent ones go out as one burst (WTIME through AIHTH,
+ *            PERS and CFG0). If the ADC settings change while ALS is
+ *            running, AEN is dropped first and ENABLE is written last, as
+ *            the datasheet asks (parameters before AEN), so no cycle mixes
+ *            old and new settings. Threshold, persistence and interrupt
+ *            changes alone do not restart the cycle.
+ *    @param  config Settings to apply
+ *    @param  changed Optional: set to the TCS3430_CHANGED_* mask of the
+ *            registers that were written
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::applyConfig(const tcs3430_config_t* config,
+                                   uint16_t* changed) {
+  TCS3430_TRACE(APPLY_CONFIG);
+  if (changed) {
+    *changed = 0;
+  }
+
+  uint8_t current[TCS3430_CONFIG_REGS];
+  if (!readConfigImage(current)) {
+    return false;
+  }
+
+  uint8_t target[TCS3430_CONFIG_REGS];
+  memcpy(target, current, sizeof(target));
+  bool hgain = (config->gain == TCS3430_GAIN_128X);
+  uint8_t again = hgain ? (uint8_t)TCS3430_GAIN_64X : (uint8_t)config->gain;
+  setField<TCS3430_FIELD_PON>(target, kImgEnable, config->power);
+  setField<TCS3430_FIELD_AEN>(target, kImgEnable, config->als_enable);
+  setField<TCS3430_FIELD_WEN>(target, kImgEnable, config->wait_enable);
+  target[kImgAtime] = config->atime;
+  target[kImgWtime] = config->wtime;
+  target[kImgAiltl] = (uint8_t)config->threshold_low;
+  target[kImgAilth] = (uint8_t)(config->threshold_low >> 8);
+  target[kImgAihtl] = (uint8_t)config->threshold_high;
+  target[kImgAihth] = (uint8_t)(config->threshold_high >> 8);
+  setField<TCS3430_FIELD_PERS>(target, kImgPers, config->persistence);
+  setField<TCS3430_FIELD_WLONG>(target, kImgCfg0, config->wait_long);
+  setField<TCS3430_FIELD_AGAIN>(target, kImgCfg1, again);
+  setField<TCS3430_FIELD_AMUX>(target, kImgCfg1, config->amux_ir2);
+  setField<TCS3430_FIELD_HGAIN>(target, kImgCfg2, hgain);
+  setField<TCS3430_FIELD_INT_READ_CLEAR>(target, kImgCfg3,
+                                         config->int_read_clear);
+  setField<TCS3430_FIELD_SAI>(target, kImgCfg3, config->sleep_after_int);
+  setField<TCS3430_FIELD_AZ_MODE>(target, kImgAzConfig, config->az_mode);
+  setField<TCS3430_FIELD_AZ_NTH>(target, kImgAzConfig, config->az_nth);
+  setField<TCS3430_FIELD_ASIEN>(target, kImgIntenab, config->saturation_int);
+  setField<TCS3430_FIELD_AIEN>(target, kImgIntenab, config->als_int);
+
+  return writeConfigImage(current, target, changed);
+}
+
+/*!
+ *    @brief  Write the registers that differ between two images, for
+ *            applyConfig() and resume()
+ *    @param  current What the chip holds now
+ *    @param  target What it should hold
+ *    @param  changed Optional: set to the TCS3430_CHANGED_* mask of the
+ *            registers that were written
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::writeConfigImage(const uint8_t* current,
+                                        const uint8_t* target,
+                                        uint16_t* changed) {
+  uint16_t mask = 0;
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    if (target[i] != current[i]) {
+      mask |= (uint16_t)1 << i;
+    }
+  }
+  if (changed) {
+    *changed = mask;
+  }
+  if (!mask) {
+    return true;
+  }
+
+  bool ok = true;
+  uint8_t enable = current[kImgEnable];
+  if ((mask & TCS3430_CHANGED_ADC) && (enable & TCS3430_FIELD_AEN::mask)) {
+    enable &= ~TCS3430_FIELD_AEN::mask;
+    ok = busWrite(TCS3430_REG_ENABLE, &enable, 1);
+  }
+
+  // ENABLE (image slot 0) is written last
+  for (uint8_t i = 1; ok && i < TCS3430_CONFIG_REGS; i++) {
+    if (!(mask & ((uint16_t)1 << i))) {
+      continue;
+    }
+    uint8_t len = 1;
+    while (i + len < TCS3430_CONFIG_REGS &&
+           (mask & ((uint16_t)1 << (i + len))) &&
+           kConfigRegs[i + len] == kConfigRegs[i] + len) {
+      len++;
+    }
+    ok = busWrite(kConfigRegs[i], &target[i], len);
+    i += len - 1;
+  }
+
+  bool restarted = false;
+  if (ok && enable != target[kImgEnable]) {
+    restarted = TCS3430_FIELD_AEN::get(target[kImgEnable]) &&
+                !TCS3430_FIELD_AEN::get(enable);
+    ok = busWrite(TCS3430_REG_ENABLE, &target[kImgEnable], 1);
+  }
+
+  if (!ok) {
+    // Part of the configuration may have landed
+    _shadow_valid = 0;
+    _amux_ir2 = -1;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    storeShadow(kConfigRegs[i], target[i]);
+  }
+  noteThresholds(target);
+  _amux_ir2 = TCS3430_FIELD_AMUX::get(target[kImgCfg1]);
+  if (mask & (TCS3430_CHANGED_ADC | TCS3430_CHANGED_ENABLE)) {
+    // Both images are at hand, so neither cycle needs reading back
+    markConfigChange(true, imageCycleMicros(current));
+    _fresh_cycle = imageCycleMicros(target);
+    _fresh_at = _changed_at + _outgoing_cycle + _fresh_cycle;
+    _fresh_known = true;
+  }
+  if (restarted) {
+    // Like restartCycle(): the cycle boundary is known
+    _fresh_at = micros() +
+                (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS +
+                _fresh_cycle;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Read every user setting: one burst for ENABLE through CFG1
+ *            (just the thresholds when the shadow cache already holds the
+ *            rest) plus CFG2, CFG3, AZ_CONFIG and INTENAB, which come from
+ *            the cache when it is enabled
+ *    @param  config Filled with the current settings
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::readConfig(tcs3430_config_t* config) {
+  TCS3430_TRACE(READ_CONFIG);
+  uint8_t image[TCS3430_CONFIG_REGS];
+  if (!readConfigImage(image)) {
+    return false;
+  }
+
+  config->power = TCS3430_FIELD_PON::get(image[kImgEnable]);
+  config->als_enable = TCS3430_FIELD_AEN::get(image[kImgEnable]);
+  config->wait_enable = TCS3430_FIELD_WEN::get(image[kImgEnable]);
+  config->atime = image[kImgAtime];
+  config->wtime = image[kImgWtime];
+  config->wait_long = TCS3430_FIELD_WLONG::get(image[kImgCfg0]);
+  config->threshold_low = image[kImgAiltl] | ((uint16_t)image[kImgAilth] << 8);
+  config->threshold_high =
+      image[kImgAihtl] | ((uint16_t)image[kImgAihth] << 8);
+  config->persistence =
+      (tcs3430_pers_t)TCS3430_FIELD_PERS::get(image[kImgPers]);
+  config->gain = (tcs3430_gain_t)TCS3430_FIELD_AGAIN::get(image[kImgCfg1]);
+  if (config->gain == TCS3430_GAIN_64X &&
+      TCS3430_FIELD_HGAIN::get(image[kImgCfg2])) {
+    config->gain = TCS3430_GAIN_128X;
+  }
+  config->amux_ir2 = TCS3430_FIELD_AMUX::get(image[kImgCfg1]);
+  config->int_read_clear = TCS3430_FIELD_INT_READ_CLEAR::get(image[kImgCfg3]);
+  config->sleep_after_int = TCS3430_FIELD_SAI::get(image[kImgCfg3]);
+  config->az_mode = TCS3430_FIELD_AZ_MODE::get(image[kImgAzConfig]);
+  config->az_nth = TCS3430_FIELD_AZ_NTH::get(image[kImgAzConfig]);
+  config->saturation_int = TCS3430_FIELD_ASIEN::get(image[kImgIntenab]);
+  config->als_int = TCS3430_FIELD_AIEN::get(image[kImgIntenab]);
+  _amux_ir2 = config->amux_ir2;
+  return true;
+}
+
+/*!
+ *    @brief  Read the configuration registers into an image in
+ *            kConfigRegs order, using the shadow cache where it is valid
+ *    @param  image TCS3430_CONFIG_REGS bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::readConfigImage(uint8_t* image) {
+  // ENABLE through CFG1 in one burst; reserved addresses read back as 0
+  uint8_t block[TCS3430_REG_CFG1 - TCS3430_REG_ENABLE + 1];
+  uint8_t first = TCS3430_REG_ENABLE;
+  uint8_t len = sizeof(block);
+  bool cached = _cache_enabled;
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    int8_t slot = shadowSlot(kConfigRegs[i]);
+    if (kConfigRegs[i] <= TCS3430_REG_CFG1 && slot >= 0 &&
+        !(_shadow_valid & ((uint16_t)1 << slot))) {
+      cached = false;
+    }
+  }
+  if (cached) {
+    // Only the thresholds are not cached
+    first = TCS3430_REG_AILTL;
+    len = TCS3430_REG_AIHTH - TCS3430_REG_AILTL + 1;
+  }
+  if (!busRead(first, &block[first - TCS3430_REG_ENABLE], len)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    uint8_t reg = kConfigRegs[i];
+    if (reg >= first && reg < first + len) {
+      image[i] = block[reg - TCS3430_REG_ENABLE];
+      storeShadow(reg, image[i]);
+    } else if (!readConfigRegister(reg, &image[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Record a value the chip is known to hold, if the register is
+ *            in the shadow cache
+ *    @param  reg Register address
+ *    @param  value Register value
+ */
+void Adafruit_TCS3430::storeShadow(uint8_t reg, uint8_t value) {
+  int8_t slot = _cache_enabled ? shadowSlot(reg) : -1;
+  if (slot >= 0) {
+    _shadow[slot] = value;
+    _shadow_valid |= ((uint16_t)1 << slot);
+  }
+}
+
+/*!
+ *    @brief  Map a register address to its shadow cache slot
+ *    @param  reg Register address
+ *    @return Slot index, or -1 if the register is not cached
+ */
+int8_t Adafruit_TCS3430::shadowSlot(uint8_t reg) {
+  switch (reg) {
+    case TCS3430_REG_ENABLE:
+      return 0;
+    case TCS3430_REG_PERS:
+      return 1;
+    case TCS3430_REG_CFG0:
+      return 2;
+    case TCS3430_REG_CFG1:
+      return 3;
+    case TCS3430_REG_CFG2:
+      return 4;
+    case TCS3430_REG_CFG3:
+      return 5;
+    case TCS3430_REG_AZ_CONFIG:
+      return 6;
+    case TCS3430_REG_INTENAB:
+      return 7;
+    case TCS3430_REG_ATIME:
+      return 8;
+    case TCS3430_REG_WTIME:
+      return 9;
+    default:
+      return -1;
+  }
+}
+
+/*!
+ *    @brief  Read a single byte register, served from the shadow cache
+ *            when possible
+ *    @param  reg Register address
+ *    @param  value Pointer to store the register value
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::readConfigRegister(uint8_t reg, uint8_t* value) {
+  int8_t slot = _cache_enabled ? shadowSlot(reg) : -1;
+  if (slot >= 0 && (_shadow_valid & ((uint16_t)1 << slot))) {
+    *value = _shadow[slot];
+    return true;
+  }
+
+  if (!busRead(reg, value, 1)) {
+    return false;
+  }
+  if (slot >= 0) {
+    _shadow[slot] = *value;
+    _shadow_valid |= ((uint16_t)1 << slot);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Write a single byte register and keep the shadow cache in sync
+ *    @param  reg Register address
+ *    @param  value Value to write
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::writeConfigRegister(uint8_t reg, uint8_t value) {
+  int8_t slot = _cache_enabled ? shadowSlot(reg) : -1;
+  if (!busWrite(reg, &value, 1)) {
+    // We no longer know what the chip holds
+    if (slot >= 0) {
+      _shadow_valid &= ~((uint16_t)1 << slot);
+    }
+    return false;
+  }
+  if (slot >= 0) {
+    _shadow[slot] = value;
+    _shadow_valid |= ((uint16_t)1 << slot);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Replace bits of a register. A single write when the register
+ *            is cached, otherwise a read-modify-write over the bus.
+ *    @param  reg Register address
+ *    @param  mask Bits to replace
+ *    @param  bits New bits, already in position
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::writeMasked(uint8_t reg, uint8_t mask, uint8_t bits) {
+  uint8_t current;
+  if (!readConfigRegister(reg, &current)) {
+    return false;
+  }
+  return writeConfigRegister(reg, (current & ~mask) | bits);
+}
+
+/*!
+ *    @brief  Read bits of a register, from the shadow cache when possible
+ *    @param  reg Register address
+ *    @param  mask Bits to keep
+ *    @return Register value under the mask, 0 on failure
+ */
+uint8_t Adafruit_TCS3430::readMasked(uint8_t reg, uint8_t mask) {
+  uint8_t current = 0;
+  readConfigRegister(reg, &current);
+  return current & mask;
+}
+
+/*!
+ *    @brief  Read registers in one transaction. All register reads go
+ *            through here.
+ *    @param  reg First register address
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::busRead(uint8_t reg, uint8_t* buffer, uint8_t len) {
+#ifdef TCS3430_INSTRUMENT
+  uint32_t start = micros();
+#endif
+  bool ok = _bus->read(reg, buffer, len);
+#ifdef TCS3430_INSTRUMENT
+  countTransfer(reg, len, 1, micros() - start);
+#endif
+  return ok;
+}
+
+/*!
+ *    @brief  Write registers in one transaction. All register writes go
+ *            through here.
+ *    @param  reg First register address
+ *    @param  buffer Data
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430::busWrite(uint8_t reg, const uint8_t* buffer,
+                                uint8_t len) {
+#ifdef TCS3430_INSTRUMENT
+  uint32_t start = micros();
+#endif
+  bool ok = _bus->write(reg, buffer, len);
+#ifdef TCS3430_INSTRUMENT
+  countTransfer(reg, 0, 1 + len, micros() - start);
+#endif
+  return ok;
+}
+
+#ifdef TCS3430_INSTRUMENT
+/*!
+ *    @brief  Add one transaction to the totals and its register's row
+ *    @param  reg First register address
+ *    @param  read Data bytes received
+ *    @param  written Bytes sent, register address included
+ *    @param  elapsed Microseconds the transaction took
+ */
+void Adafruit_TCS3430::countTransfer(uint8_t reg, uint8_t read,
+                                     uint8_t written, uint32_t elapsed) {
+  tcs3430_io_stats_t* rows[2] = {
+      &_stats.total, &_stats.reg[Adafruit_TCS3430_Stats::registerRow(reg)]};
+  for (uint8_t i = 0; i < 2; i++) {
+    rows[i]->transactions++;
+    rows[i]->bytes_read += read;
+    rows[i]->bytes_written += written;
+    rows[i]->micros += elapsed;
+  }
+}
+#endif
+
+/*!
+ *    @brief  Copy the bus statistics gathered since the last resetStats().
+ *            All zero unless built with -DTCS3430_INSTRUMENT.
+ *    @param  snapshot Destination
+ */
+void Adafruit_TCS3430::getStats(tcs3430_stats_t* snapshot) {
+#ifdef TCS3430_INSTRUMENT
+  *snapshot = _stats;
+#else
+  memset(snapshot, 0, sizeof(*snapshot));
+#endif
+}
+
+/*!
+ *    @brief  Zero the bus statistics
+ */
+void Adafruit_TCS3430::resetStats() {
+#ifdef TCS3430_INSTRUMENT
+  memset(&_stats, 0, sizeof(_stats));
+#endif
+}
+
+/*!
+ *    @brief  Print the bus statistics, one line per method and register
+ *            that made traffic. Prints nothing unless built with
+ *            -DTCS3430_INSTRUMENT.
+ *    @param  out Stream to print to, e.g. Serial
+ */
+void Adafruit_TCS3430::printStats(Print& out) {
+#ifdef TCS3430_INSTRUMENT
+  Adafruit_TCS3430_Stats::print(&_stats, out);
+#else
+  (void)out;
+#endif
+}
@@ -20,6 +20,9 @@
 #include <Adafruit_BusIO_Register.h>
 #include <Adafruit_I2CDevice.h>
 
+#include "Adafruit_TCS3430_Ring.h"
+#include "Adafruit_TCS3430_Stats.h"
+#include "Adafruit_TCS3430_Transport.h"
 #include "Arduino.h"
 
 /*=========================================================================
@@ -84,6 +87,141 @@
 #define TCS3430_REG_INTENAB 0xDD
 /*=========================================================================*/
 
+/*=========================================================================
+    STATUS / FRAME FLAGS
+    -----------------------------------------------------------------------*/
+/** STATUS: ALS saturation */
+#define TCS3430_STATUS_ASAT 0x80
+/** STATUS: ALS interrupt */
+#define TCS3430_STATUS_AINT 0x10
+
+/** Frame: burst succeeded and CH3 source is known */
+#define TCS3430_FRAME_VALID 0x01
+/** Frame: ASAT was set */
+#define TCS3430_FRAME_SATURATED 0x02
+/** Frame: AINT was set */
+#define TCS3430_FRAME_INTERRUPT 0x04
+/** Frame: CH3 holds IR2 (AMUX=1) rather than X */
+#define TCS3430_FRAME_CH3_IR2 0x08
+/** Five-channel frame: Y/Z/IR1 moved between the X and IR2 halves */
+#define TCS3430_FRAME_CHANGED 0x10
+/*=========================================================================*/
+
+/*=========================================================================
+    applyConfig() CHANGED REGISTER MASK
+    -----------------------------------------------------------------------*/
+/** Registers covered by tcs3430_config_t */
+#define TCS3430_CONFIG_REGS 14
+/** Changed: ENABLE */
+#define TCS3430_CHANGED_ENABLE 0x0001
+/** Changed: ATIME */
+#define TCS3430_CHANGED_ATIME 0x0002
+/** Changed: WTIME */
+#define TCS3430_CHANGED_WTIME 0x0004
+/** Changed: AILTL */
+#define TCS3430_CHANGED_AILTL 0x0008
+/** Changed: AILTH */
+#define TCS3430_CHANGED_AILTH 0x0010
+/** Changed: AIHTL */
+#define TCS3430_CHANGED_AIHTL 0x0020
+/** Changed: AIHTH */
+#define TCS3430_CHANGED_AIHTH 0x0040
+/** Changed: PERS */
+#define TCS3430_CHANGED_PERS 0x0080
+/** Changed: CFG0 */
+#define TCS3430_CHANGED_CFG0 0x0100
+/** Changed: CFG1 */
+#define TCS3430_CHANGED_CFG1 0x0200
+/** Changed: CFG2 */
+#define TCS3430_CHANGED_CFG2 0x0400
+/** Changed: CFG3 */
+#define TCS3430_CHANGED_CFG3 0x0800
+/** Changed: AZ_CONFIG */
+#define TCS3430_CHANGED_AZ_CONFIG 0x1000
+/** Changed: INTENAB */
+#define TCS3430_CHANGED_INTENAB 0x2000
+/** Registers that change what or when the ADC integrates */
+#define TCS3430_CHANGED_ADC                                                    \
+  (TCS3430_CHANGED_ATIME | TCS3430_CHANGED_WTIME | TCS3430_CHANGED_CFG0 |      \
+   TCS3430_CHANGED_CFG1 | TCS3430_CHANGED_CFG2 | TCS3430_CHANGED_AZ_CONFIG)
+/*=========================================================================*/
+
+/** Number of configuration registers held in the shadow cache */
+#define TCS3430_SHADOW_COUNT 10
+/** Length of one ATIME/WTIME step in microseconds */
+#define TCS3430_STEP_MICROS 2780
+/** Steps of the auto-zero pass that starts the first cycle after power-up */
+#define TCS3430_AZ_STEPS 5
+
+/*!
+ *    @brief  A register bit field described at compile time, so masks and
+ *            shifts fold into constants at every use
+ *    @tparam REG Register address
+ *    @tparam SHIFT Position of the field's LSB
+ *    @tparam BITS Width of the field
+ */
+template <uint8_t REG, uint8_t SHIFT, uint8_t BITS>
+struct Adafruit_TCS3430_Field {
+  static const uint8_t reg = REG;                          ///< Register
+  static const uint8_t shift = SHIFT;                      ///< LSB position
+  static const uint8_t mask = ((1u << BITS) - 1) << SHIFT; ///< Field bits
+
+  /*!
+   *    @brief  Extract the field from a register value
+   *    @param  value Register value
+   *    @return Field value
+   */
+  static uint8_t get(uint8_t value) {
+    return (value & mask) >> SHIFT;
+  }
+
+  /*!
+   *    @brief  Replace the field in a register value
+   *    @param  value Register value
+   *    @param  field New field value
+   *    @return Updated register value
+   */
+  static uint8_t set(uint8_t value, uint8_t field) {
+    return (value & ~mask) | ((field << SHIFT) & mask);
+  }
+};
+
+/** Power on */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_ENABLE, 0, 1> TCS3430_FIELD_PON;
+/** ALS enable */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_ENABLE, 1, 1> TCS3430_FIELD_AEN;
+/** Wait enable */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_ENABLE, 3, 1> TCS3430_FIELD_WEN;
+/** Interrupt persistence */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_PERS, 0, 4> TCS3430_FIELD_PERS;
+/** Wait x12 */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG0, 2, 1> TCS3430_FIELD_WLONG;
+/** ALS gain */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG1, 0, 2> TCS3430_FIELD_AGAIN;
+/** IR2 rather than X on CH3 */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG1, 3, 1> TCS3430_FIELD_AMUX;
+/** 128x gain with AGAIN=64x */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG2, 4, 1> TCS3430_FIELD_HGAIN;
+/** ALS saturation */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_STATUS, 7, 1> TCS3430_FIELD_ASAT;
+/** ALS interrupt */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_STATUS, 4, 1> TCS3430_FIELD_AINT;
+/** Clear interrupts on STATUS read */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG3, 7, 1>
+    TCS3430_FIELD_INT_READ_CLEAR;
+/** Sleep after interrupt */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_CFG3, 4, 1> TCS3430_FIELD_SAI;
+/** Auto-zero mode */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_AZ_CONFIG, 7, 1>
+    TCS3430_FIELD_AZ_MODE;
+/** Auto-zero every nth cycle */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_AZ_CONFIG, 0, 7>
+    TCS3430_FIELD_AZ_NTH;
+/** Saturation interrupt enable */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_INTENAB, 7, 1> TCS3430_FIELD_ASIEN;
+/** ALS interrupt enable */
+typedef Adafruit_TCS3430_Field<TCS3430_REG_INTENAB, 4, 1> TCS3430_FIELD_AIEN;
+
 /** Interrupt persistence values for PERS register */
 typedef enum {
   TCS3430_PERS_EVERY = 0x0, ///< Every ALS cycle
@@ -113,6 +251,93 @@ typedef enum {
   TCS3430_GAIN_128X = 0x4 ///< 128x gain (requires HGAIN bit set)
 } tcs3430_gain_t;
 
+/** Result of polling a non-blocking measurement */
+typedef enum {
+  TCS3430_POLL_IDLE,    ///< No measurement in progress
+  TCS3430_POLL_PENDING, ///< Data not due yet, poll again later
+  TCS3430_POLL_READY,   ///< Frame has been read
+  TCS3430_POLL_ERROR    ///< Bus error while reading or restoring the mux
+} tcs3430_poll_t;
+
+/** Kind of non-blocking measurement in progress */
+typedef enum {
+  TCS3430_MEAS_IDLE,  ///< Nothing in progress
+  TCS3430_MEAS_FRAME, ///< Waiting for a fresh frame
+  TCS3430_MEAS_IR2    ///< Waiting for IR2 on CH3
+} tcs3430_meas_t;
+
+/** One STATUS + channel data sample, read in a single burst from 0x93 */
+typedef struct {
+  uint32_t timestamp; ///< micros() when the burst completed
+  uint16_t z;         ///< CH0: Z tristimulus
+  uint16_t y;         ///< CH1: Y tristimulus
+  uint16_t ir1;       ///< CH2: IR1
+  uint16_t ch3;       ///< CH3: X or IR2, see TCS3430_FRAME_CH3_IR2
+  uint8_t status;     ///< Raw STATUS register
+  uint8_t flags;      ///< TCS3430_FRAME_* flags
+} tcs3430_frame_t;
+
+/** Called when a readFrameAsync() burst finishes, possibly from an
+ *  interrupt; frame is only filled in when ok */
+typedef void (*tcs3430_frame_cb_t)(tcs3430_frame_t* frame, bool ok,
+                                   void* context);
+
+/** What an interrupt reported, see beginEvents() */
+typedef enum {
+  TCS3430_EVENT_DATA_READY,   ///< AINT, CH0 inside the threshold window
+  TCS3430_EVENT_CROSSED_HIGH, ///< AINT, CH0 above the high threshold
+  TCS3430_EVENT_CROSSED_LOW,  ///< AINT, CH0 below the low threshold
+  TCS3430_EVENT_SATURATED     ///< ASAT
+} tcs3430_event_type_t;
+
+/** One classified interrupt */
+typedef struct {
+  uint32_t timestamp; ///< micros() of the INT edge
+  uint16_t ch0;       ///< CH0 (Z) of the integration that raised it
+  uint8_t type;       ///< tcs3430_event_type_t
+  uint8_t status;     ///< Raw STATUS
+} tcs3430_event_t;
+
+/** 3x4 color matrix: rows X', Y', Z'; columns X, Y, Z, IR1 */
+typedef struct {
+  float m[12];     ///< Coefficients, for the float path
+  int16_t q14[12]; ///< The same in Q14, for the fixed point path
+} tcs3430_matrix_t;
+
+/** Every user setting, for applyConfig() / readConfig() */
+typedef struct {
+  bool power;                 ///< PON
+  bool als_enable;            ///< AEN
+  bool wait_enable;           ///< WEN
+  uint8_t atime;              ///< Integration steps - 1
+  uint8_t wtime;              ///< Wait steps - 1
+  bool wait_long;             ///< WLONG: wait x12
+  uint16_t threshold_low;     ///< AILT
+  uint16_t threshold_high;    ///< AIHT
+  tcs3430_pers_t persistence; ///< PERS
+  tcs3430_gain_t gain;        ///< AGAIN, with HGAIN for 128X
+  bool amux_ir2;              ///< AMUX: IR2 rather than X on CH3
+  bool int_read_clear;        ///< INT_READ_CLEAR
+  bool sleep_after_int;       ///< SAI
+  bool az_mode;               ///< AZ_MODE
+  uint8_t az_nth;             ///< AZ_NTH_ITERATION
+  bool saturation_int;        ///< ASIEN
+  bool als_int;               ///< AIEN
+} tcs3430_config_t;
+
+/** Saved configuration for resume(), e.g. in RTC or retained RAM */
+typedef struct {
+  uint8_t regs[TCS3430_CONFIG_REGS]; ///< Registers, TCS3430_CHANGED_* order
+  uint8_t check;                     ///< Rejects uninitialised RAM
+} tcs3430_snapshot_t;
+
+/** Outcome of resume() */
+typedef enum {
+  TCS3430_RESUME_MATCHED,  ///< Chip still held the snapshot, nothing written
+  TCS3430_RESUME_RESTORED, ///< Chip had lost it (e.g. power cycle), rewritten
+  TCS3430_RESUME_FAILED    ///< No sensor, bus error or invalid snapshot
+} tcs3430_resume_t;
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            TCS3430 Color and ALS Sensor
@@ -123,6 +348,13 @@ class Adafruit_TCS3430 {
   ~Adafruit_TCS3430();
 
   bool begin(uint8_t addr = TCS3430_DEFAULT_ADDR, TwoWire* theWire = &Wire);
+  bool begin(Adafruit_TCS3430_Transport* transport);
+  tcs3430_resume_t resume(const tcs3430_snapshot_t* snapshot,
+                          uint8_t addr = TCS3430_DEFAULT_ADDR,
+                          TwoWire* theWire = &Wire);
+  tcs3430_resume_t resume(const tcs3430_snapshot_t* snapshot,
+                          Adafruit_TCS3430_Transport* transport);
+  bool saveSnapshot(tcs3430_snapshot_t* snapshot);
 
   bool setIntegrationCycles(uint8_t cycles);
   uint8_t getIntegrationCycles();
@@ -138,6 +370,8 @@ class Adafruit_TCS3430 {
   uint16_t getALSThresholdLow();
   bool setALSThresholdHigh(uint16_t threshold);
   uint16_t getALSThresholdHigh();
+  bool setALSThresholds(uint16_t low, uint16_t high);
+  bool setThresholdTracking(uint8_t percent, uint16_t min_counts = 0);
 
   bool setInterruptPersistence(tcs3430_pers_t persistence);
   tcs3430_pers_t getInterruptPersistence();
@@ -145,10 +379,12 @@ class Adafruit_TCS3430 {
   bool setWaitLong(bool enable);
   bool getWaitLong();
 
-  bool setALSMUX_IR2(bool enable);
+  bool setALSMUX_IR2(bool enable, bool settle = true);
   bool getALSMUX_IR2();
   bool setALSGain(tcs3430_gain_t gain);
   tcs3430_gain_t getALSGain();
+  static uint8_t gainMultiplier(tcs3430_gain_t gain);
+  static uint16_t fullScale(uint8_t atime);
 
   bool isALSSaturated();
   bool clearALSSaturated();
@@ -157,6 +393,40 @@ class Adafruit_TCS3430 {
 
   bool getChannels(uint16_t* x, uint16_t* y, uint16_t* z, uint16_t* ir1);
   uint16_t getIR2();
+  bool readFrame(tcs3430_frame_t* frame);
+  bool readFrameAsync(tcs3430_frame_t* frame, tcs3430_frame_cb_t done,
+                      void* context = NULL);
+  bool isFrameAsyncPending();
+
+  void setColorMatrix(const tcs3430_matrix_t* matrix);
+  bool getCIE(float* x, float* y);
+  float getCCT();
+  float getLux();
+  bool getCIEFixed(uint16_t* x, uint16_t* y);
+  uint16_t getCCTFixed();
+  uint32_t getLuxFixed();
+
+  bool startIR2();
+  bool startFrame();
+  tcs3430_poll_t poll(tcs3430_frame_t* frame);
+  void cancelMeasurement();
+  uint32_t getCycleMicros();
+  bool restartCycle();
+  bool isSettling();
+  uint16_t getConfigChangeCount();
+  uint32_t getConfigChangeMicros();
+  static uint32_t cycleMicros(uint8_t atime, bool wait_enable, uint8_t wtime,
+                              bool wait_long);
+
+  bool beginCapture(Adafruit_TCS3430_RingBase<tcs3430_frame_t>* ring,
+                    bool every_cycle = true);
+  void endCapture();
+  bool beginEvents(Adafruit_TCS3430_RingBase<tcs3430_event_t>* queue,
+                   bool saturation = true);
+  void endEvents();
+  void handleInterrupt();
+  uint8_t service();
+  uint32_t getMissedInterrupts();
   bool setInterruptClearOnRead(bool enable);
   bool getInterruptClearOnRead();
   bool setSleepAfterInterrupt(bool enable);
@@ -175,8 +445,102 @@ class Adafruit_TCS3430 {
   bool powerOn(bool enable);
   bool isPoweredOn();
 
+  bool applyConfig(const tcs3430_config_t* config, uint16_t* changed = NULL);
+  bool readConfig(tcs3430_config_t* config);
+
+  void enableRegisterCache(bool enable);
+  bool isRegisterCacheEnabled();
+  bool resync();
+
+  void getStats(tcs3430_stats_t* snapshot);
+  void resetStats();
+  void printStats(Print& out);
+
  private:
-  Adafruit_I2CDevice* i2c_dev = NULL; ///< Pointer to I2C bus interface
+  int8_t shadowSlot(uint8_t reg);
+  bool readConfigRegister(uint8_t reg, uint8_t* value);
+  bool writeConfigRegister(uint8_t reg, uint8_t value);
+  template <class F> bool writeField(uint8_t value);
+  bool writeMasked(uint8_t reg, uint8_t mask, uint8_t bits);
+  uint8_t readMasked(uint8_t reg, uint8_t mask);
+  template <class F> uint8_t readField();
+  void markConfigChange(bool timing = true, uint32_t cycle = 0);
+  void markStart();
+  uint32_t freshDeadline();
+  uint8_t serviceEvents(uint32_t at);
+  void retryInterrupt();
+  void trackThresholds(uint16_t ch0);
+  void noteThresholds(const uint8_t* image);
+  void attachDevice(uint8_t addr, TwoWire* theWire);
+  void attachTransport(Adafruit_TCS3430_Transport* transport);
+  tcs3430_resume_t resumeAttached(const tcs3430_snapshot_t* snapshot);
+  bool beginAttached();
+  void decodeFrame(const uint8_t* buffer, tcs3430_frame_t* frame);
+  static void frameAsyncDone(tcs3430_transfer_t* transfer, bool ok);
+  bool writeConfigImage(const uint8_t* current, const uint8_t* target,
+                        uint16_t* changed);
+  static uint8_t snapshotCheck(const uint8_t* regs);
+  static uint32_t imageCycleMicros(const uint8_t* image);
+  bool readConfigImage(uint8_t* image);
+  void storeShadow(uint8_t reg, uint8_t value);
+  static uint8_t msToCycles(float ms);
+  bool busRead(uint8_t reg, uint8_t* buffer, uint8_t len);
+  bool busWrite(uint8_t reg, const uint8_t* buffer, uint8_t len);
+
+  Adafruit_TCS3430_Transport* _bus = NULL; ///< Transport in use
+  Adafruit_TCS3430_BusIO* _busio = NULL;   ///< Own transport, in _busio_storage
+  alignas(Adafruit_TCS3430_BusIO) uint8_t
+      _busio_storage[sizeof(Adafruit_TCS3430_BusIO)]; ///< In-object, not heap
+  bool _cache_enabled = false;        ///< Shadow register cache in use
+  uint16_t _shadow_valid = 0;         ///< Bitmask of valid shadow slots
+  uint8_t _shadow[TCS3430_SHADOW_COUNT] = {0}; ///< Cached register values
+  int8_t _amux_ir2 = -1; ///< Last known AMUX state, -1 if unknown
+
+  uint32_t _changed_at = 0;     ///< micros() of the last config change
+  uint16_t _config_changes = 0; ///< markConfigChange() calls, wrapping
+  uint32_t _outgoing_cycle = 0; ///< In progress at _changed_at, 0: current
+  uint32_t _fresh_at = 0;       ///< micros() when post-change data is due
+  bool _fresh_known = false;    ///< _fresh_at computed for the last change
+  uint32_t _fresh_cycle = 0;    ///< Cycle length after the last change
+  bool _settling = false;       ///< Data may predate the last change
+  tcs3430_meas_t _meas_state = TCS3430_MEAS_IDLE; ///< Measurement in flight
+  uint32_t _meas_deadline = 0;  ///< micros() when the measurement is due
+  bool _meas_restore_x = false; ///< Switch AMUX back to X when done
+
+  Adafruit_TCS3430_RingBase<tcs3430_frame_t>* _capture_ring =
+      NULL;                           ///< Destination of captured frames
+  Adafruit_TCS3430_RingBase<tcs3430_event_t>* _event_queue =
+      NULL;                           ///< Destination of classified events
+  bool _event_saturation = false;      ///< ASAT handled as an event
+  uint16_t _thresh_low = 0;            ///< AILT as last written
+  uint16_t _thresh_high = 0xFFFF;      ///< AIHT as last written
+  bool _capture_restore_clear = false; ///< INT_READ_CLEAR to restore
+  volatile uint8_t _int_pending = 0;   ///< INT edges not yet serviced
+  volatile uint32_t _int_at = 0;       ///< micros() of the latest INT edge
+  uint32_t _int_missed = 0; ///< Edges that arrived while one was pending
+  uint8_t _track_pct = 0;   ///< Tracking half-width, % of CH0
+  uint16_t _track_min = 0;  ///< Tracking half-width floor, counts
+  const tcs3430_matrix_t* _matrix = NULL; ///< Color matrix, NULL for default
+
+  tcs3430_transfer_t _async;           ///< readFrameAsync() burst
+  uint8_t _async_buffer[9];            ///< STATUS and channel data
+  tcs3430_frame_t* _async_frame;       ///< Where the burst is decoded to
+  tcs3430_frame_cb_t _async_done;      ///< Caller's callback
+  void* _async_context;                ///< For the callback
+  volatile bool _async_busy = false;   ///< Burst submitted, not completed
+#ifdef TCS3430_INSTRUMENT
+  uint32_t _async_start = 0; ///< micros() the burst was submitted
+#endif
+
+#ifdef TCS3430_INSTRUMENT
+  friend class Adafruit_TCS3430_StatsScope;
+  void countTransfer(uint8_t reg, uint8_t read, uint8_t written,
+                     uint32_t elapsed);
+
+  tcs3430_stats_t _stats = {};            ///< Counters since resetStats()
+  uint8_t _stats_api = TCS3430_API_COUNT; ///< Outermost method in progress
+  tcs3430_io_stats_t _stats_entry = {};   ///< Totals when it was entered
+#endif
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,194 @@
+/*!
+ *  @file Adafruit_TCS3430_Async.cpp
+ *
+ * 	Queued, non-blocking register transport for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Async.h"
+
+/*!
+ *    @brief  Completion callback of the blocking calls
+ *    @param  transfer Finished transfer; context points at its result
+ *    @param  ok Whether it succeeded
+ */
+static void blockingDone(tcs3430_transfer_t* transfer, bool ok) {
+  *(volatile int8_t*)transfer->context = ok ? 1 : 0;
+}
+
+/*!
+ *    @brief  Queue a transfer and wait for it, behind any already queued
+ *    @param  transport Queue to use
+ *    @param  transfer Transfer with everything but the callback set
+ *    @return true on success
+ */
+static bool runBlocking(Adafruit_TCS3430_AsyncTransport* transport,
+                        tcs3430_transfer_t* transfer) {
+  volatile int8_t result = -1;
+  transfer->done = blockingDone;
+  transfer->context = (void*)&result;
+  if (!transport->submit(transfer)) {
+    return false;
+  }
+  while (result < 0) {
+    transport->service();
+    yield();
+  }
+  return result > 0;
+}
+
+/*!
+ *    @brief  Read registers, waiting for the transfer to finish
+ *    @param  reg First register address
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_AsyncTransport::read(uint8_t reg, uint8_t* buffer,
+                                           uint8_t len) {
+  tcs3430_transfer_t transfer;
+  transfer.reg = reg;
+  transfer.len = len;
+  transfer.write = false;
+  transfer.data = buffer;
+  return runBlocking(this, &transfer);
+}
+
+/*!
+ *    @brief  Write registers, waiting for the transfer to finish
+ *    @param  reg First register address
+ *    @param  buffer Data
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_AsyncTransport::write(uint8_t reg,
+                                            const uint8_t* buffer,
+                                            uint8_t len) {
+  tcs3430_transfer_t transfer;
+  transfer.reg = reg;
+  transfer.len = len;
+  transfer.write = true;
+  transfer.data = (uint8_t*)buffer;
+  return runBlocking(this, &transfer);
+}
+
+/*!
+ *    @brief  Queue a transfer and return at once. Transfers run in the
+ *            order submitted.
+ *    @param  transfer Transfer to run; it and its data must stay valid,
+ *            and it must not be submitted again, until its callback
+ *    @return true (the queue cannot fill)
+ */
+bool Adafruit_TCS3430_AsyncTransport::submit(tcs3430_transfer_t* transfer) {
+  transfer->next = NULL;
+  noInterrupts();
+  bool idle = _head == NULL;
+  if (idle) {
+    _head = transfer;
+  } else {
+    _tail->next = transfer;
+  }
+  _tail = transfer;
+  interrupts();
+  if (idle) {
+    start();
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Report that the transfer given to startTransfer() finished.
+ *            For backends; safe to call from an interrupt. Runs its
+ *            callback, then starts the next transfer.
+ *    @param  ok Whether it succeeded
+ */
+void Adafruit_TCS3430_AsyncTransport::complete(bool ok) {
+  noInterrupts();
+  tcs3430_transfer_t* done = _head;
+  if (!done) {
+    interrupts();
+    return;
+  }
+  tcs3430_transfer_t* next = done->next;
+  _head = next;
+  if (!next) {
+    _tail = NULL;
+  }
+  interrupts();
+  if (done->done) {
+    done->done(done, ok);
+  }
+  // A transfer the callback submitted to an empty queue started itself
+  if (next) {
+    start();
+  }
+}
+
+/*!
+ *    @brief  Check whether every submitted transfer has completed
+ *    @return true if the queue is empty
+ */
+bool Adafruit_TCS3430_AsyncTransport::isIdle() {
+  return _head == NULL;
+}
+
+/*!
+ *    @brief  Hand the head of the queue to the backend
+ */
+void Adafruit_TCS3430_AsyncTransport::start() {
+  if (!startTransfer(_head)) {
+    complete(false);
+  }
+}
+
+/*!
+ *    @brief  Instantiates a loop() runner
+ *    @param  bus Blocking transport the transfers run on
+ */
+Adafruit_TCS3430_AsyncLoop::Adafruit_TCS3430_AsyncLoop(
+    Adafruit_TCS3430_Transport* bus)
+    : _bus(bus) {}
+
+/*!
+ *    @brief  Prepare the underlying bus
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_AsyncLoop::begin() {
+  return _bus->begin();
+}
+
+/*!
+ *    @brief  Run the transfer at the head of the queue, if any. One
+ *            transfer per call, so a long queue drains over several
+ *            loop() passes.
+ */
+void Adafruit_TCS3430_AsyncLoop::service() {
+  tcs3430_transfer_t* transfer = _ready;
+  if (!transfer) {
+    return;
+  }
+  _ready = NULL;
+  bool ok = transfer->write
+                ? _bus->write(transfer->reg, transfer->data, transfer->len)
+                : _bus->read(transfer->reg, transfer->data, transfer->len);
+  complete(ok);
+}
+
+/*!
+ *    @brief  Note the transfer; service() runs it
+ *    @param  transfer Transfer at the head of the queue
+ *    @return true
+ */
+bool Adafruit_TCS3430_AsyncLoop::startTransfer(tcs3430_transfer_t* transfer) {
+  _ready = transfer;
+  return true;
+}
@@ -0,0 +1,90 @@
+/*!
+ *  @file Adafruit_TCS3430_Async.h
+ *
+ * 	Queued, non-blocking register transport for the TCS3430: transfers
+ * 	are started by a backend (DMA, interrupt-driven I2C, or the loop()
+ * 	runner here) and finish with a completion callback
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_ASYNC_H
+#define _ADAFRUIT_TCS3430_ASYNC_H
+
+#include "Adafruit_TCS3430_Transport.h"
+
+/*!
+ *    @brief  Transfer queue shared by the asynchronous backends. submit()
+ *            links the caller's transfer into a FIFO and returns; the
+ *            backend runs one transfer at a time and reports each with
+ *            complete(), which calls its callback and starts the next.
+ *            The queue is intrusive, so it has no capacity limit and uses
+ *            no storage of its own. The blocking read() and write() the
+ *            driver uses queue a transfer and call service() until it is
+ *            done, so the whole driver works over any backend while
+ *            readFrameAsync() and direct submit() calls do not block.
+ */
+class Adafruit_TCS3430_AsyncTransport : public Adafruit_TCS3430_Transport {
+ public:
+  bool read(uint8_t reg, uint8_t* buffer, uint8_t len);
+  bool write(uint8_t reg, const uint8_t* buffer, uint8_t len);
+  bool submit(tcs3430_transfer_t* transfer);
+  void complete(bool ok);
+  bool isIdle();
+
+  /*!
+   *    @brief  Give a polled backend time to make progress. Call from
+   *            loop(); the blocking read() and write() call it while they
+   *            wait. Backends completed by an interrupt need do nothing.
+   */
+  virtual void service() {}
+
+ protected:
+  /*!
+   *    @brief  Start a transfer on the bus and return without waiting.
+   *            Call complete() when it finishes, from any context; it
+   *            may be called before this returns.
+   *    @param  transfer Transfer at the head of the queue
+   *    @return false if it could not be started; it then completes as
+   *            failed
+   */
+  virtual bool startTransfer(tcs3430_transfer_t* transfer) = 0;
+
+ private:
+  void start();
+
+  tcs3430_transfer_t* volatile _head = NULL; ///< Running transfer
+  tcs3430_transfer_t* volatile _tail = NULL; ///< Last queued transfer
+};
+
+/*!
+ *    @brief  Asynchronous backend that runs each queued transfer over a
+ *            blocking transport the next time service() is called, so
+ *            bus work happens at a point the sketch chooses (e.g. after
+ *            its time-critical part of loop()). Also the reference for
+ *            writing a DMA backend.
+ */
+class Adafruit_TCS3430_AsyncLoop : public Adafruit_TCS3430_AsyncTransport {
+ public:
+  Adafruit_TCS3430_AsyncLoop(Adafruit_TCS3430_Transport* bus);
+
+  bool begin();
+  void service();
+
+ protected:
+  bool startTransfer(tcs3430_transfer_t* transfer);
+
+ private:
+  Adafruit_TCS3430_Transport* _bus;            ///< Where transfers run
+  tcs3430_transfer_t* volatile _ready = NULL;  ///< Started, not yet run
+};
+
+#endif
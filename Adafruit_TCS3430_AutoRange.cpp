@@ -0,0 +1,244 @@
+/*!
+ *  @file Adafruit_TCS3430_AutoRange.cpp
+ *
+ * 	Automatic gain / integration time ranging for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_AutoRange.h"
+
+/*!
+ *    @brief  Instantiates an auto-range controller
+ *    @param  sensor Sensor to control, already begun
+ */
+Adafruit_TCS3430_AutoRange::Adafruit_TCS3430_AutoRange(
+    Adafruit_TCS3430* sensor)
+    : _sensor(sensor), _gain(TCS3430_GAIN_1X) {}
+
+/*!
+ *    @brief  Pick up the sensor's current setting and set the ATIME range
+ *            the controller may use. The longest ATIME bounds the time
+ *            per sample; 63 (64 steps, 178ms) is the shortest that
+ *            reaches the full 16-bit range.
+ *    @param  max_atime Longest ATIME allowed
+ *    @param  min_atime Shortest ATIME allowed
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_AutoRange::begin(uint8_t max_atime, uint8_t min_atime) {
+  if (min_atime > max_atime) {
+    return false;
+  }
+  _min_atime = min_atime;
+  _max_atime = max_atime;
+  _gain = _sensor->getALSGain();
+  _atime = _sensor->getIntegrationCycles();
+  _converged = false;
+  _asat_stale = false;
+  _cycles = 0;
+  _convergence_cycles = 0;
+  return true;
+}
+
+/*!
+ *    @brief  Set the aim point and hysteresis band, in percent of full
+ *            scale. Nothing changes while the brightest channel stays
+ *            between low and high.
+ *    @param  target_pct Fill level to jump to when re-ranging
+ *    @param  low_pct Re-range when the signal drops below this
+ *    @param  high_pct Re-range when the signal rises above this
+ */
+void Adafruit_TCS3430_AutoRange::setTarget(uint8_t target_pct, uint8_t low_pct,
+                                           uint8_t high_pct) {
+  _target_pct = target_pct;
+  _low_pct = low_pct;
+  _high_pct = high_pct;
+}
+
+/*!
+ *    @brief  Feed one frame. Frames read while the sensor is still
+ *            settling after a change are skipped, so this can be called on
+ *            every frame.
+ *    @param  frame Frame from readFrame(), poll() or the capture ring
+ *    @return What the controller did
+ */
+tcs3430_agc_t Adafruit_TCS3430_AutoRange::update(
+    const tcs3430_frame_t* frame) {
+  // VALID only says the mux state is known; the counts may still come
+  // from an integration that ran with the previous setting
+  if (!(frame->flags & TCS3430_FRAME_VALID) || _sensor->isSettling()) {
+    return TCS3430_AGC_SKIPPED;
+  }
+  if (_cycles < 255) {
+    _cycles++;
+  }
+
+  uint16_t peak = frame->z;
+  if (frame->y > peak) {
+    peak = frame->y;
+  }
+  if (frame->ir1 > peak) {
+    peak = frame->ir1;
+  }
+  if (frame->ch3 > peak) {
+    peak = frame->ch3;
+  }
+
+  // ASAT is sticky, so it is cleared below once acted on; otherwise every
+  // later frame would look saturated too. The cycle that was running when
+  // the setting changed may set it again after that, so the first frame
+  // after a change is judged by its counts alone.
+  bool asat = frame->flags & TCS3430_FRAME_SATURATED;
+  if (asat && _asat_stale) {
+    if (!_sensor->clearALSSaturated()) {
+      return TCS3430_AGC_ERROR;
+    }
+    asat = false;
+  }
+  _asat_stale = false;
+
+  uint32_t full = Adafruit_TCS3430::fullScale(_atime);
+  bool saturated = asat || (uint32_t)peak >= full;
+  if (!saturated && (uint32_t)peak * 100 >= full * _low_pct &&
+      (uint32_t)peak * 100 <= full * _high_pct) {
+    if (!_converged) {
+      _converged = true;
+      _convergence_cycles = _cycles;
+    }
+    return TCS3430_AGC_SETTLED;
+  }
+  if (asat && !_sensor->clearALSSaturated()) {
+    return TCS3430_AGC_ERROR;
+  }
+
+  // Light level as counts per (gain x step), in 1/256ths. A saturated
+  // reading says nothing about how far over we are, so assume 16x.
+  uint32_t sensitivity =
+      (uint32_t)Adafruit_TCS3430::gainMultiplier(_gain) * (_atime + 1);
+  uint32_t counts = saturated ? full * 16 : (peak ? peak : 1);
+  uint32_t rate = (counts << 8) / sensitivity;
+  if (rate == 0) {
+    rate = 1;
+  }
+
+  // For each gain, take the longest ATIME that keeps the signal at or
+  // under the target. Below 64 steps full scale grows with ATIME, so the
+  // fill level there is set by gain alone and may end up over the target.
+  // Keep the pair giving the most counts without passing the target; if
+  // that would still be under the band, take the in-band pair closest to
+  // the target instead. Ties go to the shorter integration.
+  uint32_t target_counts = (uint32_t)65535 * _target_pct / 100;
+  tcs3430_gain_t best_gain = TCS3430_GAIN_1X;
+  uint8_t best_atime = _min_atime;
+  uint32_t best_counts = 0;
+  uint32_t best_full = 1;
+  tcs3430_gain_t over_gain = TCS3430_GAIN_1X;
+  uint8_t over_atime = 0;
+  uint32_t over_counts = 0;
+  uint32_t over_full = 1;
+  for (uint8_t g = TCS3430_GAIN_1X; g <= TCS3430_GAIN_128X; g++) {
+    uint32_t per_step =
+        (rate * Adafruit_TCS3430::gainMultiplier((tcs3430_gain_t)g)) >> 8;
+    if (per_step == 0) {
+      per_step = 1;
+    }
+    uint32_t steps = target_counts / per_step;
+    if (steps > (uint32_t)_max_atime + 1) {
+      steps = (uint32_t)_max_atime + 1;
+    }
+    if (steps < (uint32_t)_min_atime + 1) {
+      steps = (uint32_t)_min_atime + 1;
+    }
+    uint32_t expected = per_step * steps;
+    uint32_t g_full = Adafruit_TCS3430::fullScale(steps - 1);
+    if (expected * 100 <= g_full * _target_pct) {
+      if (expected > best_counts ||
+          (expected == best_counts && steps - 1 < best_atime)) {
+        best_counts = expected;
+        best_full = g_full;
+        best_gain = (tcs3430_gain_t)g;
+        best_atime = steps - 1;
+      }
+    } else if (expected * 100 <= g_full * _high_pct) {
+      // Fill levels compared as expected / full, cross-multiplied
+      uint64_t fill = (uint64_t)expected * over_full;
+      uint64_t other = (uint64_t)over_counts * g_full;
+      if (!over_counts || fill < other ||
+          (fill == other && steps - 1 < over_atime)) {
+        over_counts = expected;
+        over_full = g_full;
+        over_gain = (tcs3430_gain_t)g;
+        over_atime = steps - 1;
+      }
+    }
+  }
+  if (over_counts && best_counts * 100 < best_full * _low_pct) {
+    best_gain = over_gain;
+    best_atime = over_atime;
+  }
+
+  if (best_gain == _gain && best_atime == _atime) {
+    if (!_converged) {
+      _converged = true;
+      _convergence_cycles = _cycles;
+    }
+    return TCS3430_AGC_LIMITED;
+  }
+
+  if (_converged) {
+    // A new disturbance; start counting again
+    _cycles = 1;
+  }
+  _converged = false;
+  if (!_sensor->setALSGain(best_gain) ||
+      !_sensor->setIntegrationCycles(best_atime)) {
+    return TCS3430_AGC_ERROR;
+  }
+  _gain = best_gain;
+  _atime = best_atime;
+  _asat_stale = true;
+  return TCS3430_AGC_ADJUSTED;
+}
+
+/*!
+ *    @brief  Check if the signal is in band (or as close as the allowed
+ *            range can get it)
+ *    @return true if converged
+ */
+bool Adafruit_TCS3430_AutoRange::isConverged() {
+  return _converged;
+}
+
+/*!
+ *    @brief  Number of valid frames the most recent convergence took,
+ *            counting the frame that triggered re-ranging and the one
+ *            that landed in band
+ *    @return Frame count, 0 if not converged yet
+ */
+uint8_t Adafruit_TCS3430_AutoRange::getConvergenceCycles() {
+  return _convergence_cycles;
+}
+
+/*!
+ *    @brief  Gain currently selected by the controller
+ *    @return Gain setting
+ */
+tcs3430_gain_t Adafruit_TCS3430_AutoRange::getGain() {
+  return _gain;
+}
+
+/*!
+ *    @brief  ATIME currently selected by the controller
+ *    @return ATIME register value
+ */
+uint8_t Adafruit_TCS3430_AutoRange::getATIME() {
+  return _atime;
+}
@@ -0,0 +1,65 @@
+/*!
+ *  @file Adafruit_TCS3430_AutoRange.h
+ *
+ * 	Automatic gain / integration time ranging for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_AUTORANGE_H
+#define _ADAFRUIT_TCS3430_AUTORANGE_H
+
+#include "Adafruit_TCS3430.h"
+
+/** Outcome of feeding one frame to the auto-range controller */
+typedef enum {
+  TCS3430_AGC_SKIPPED,  ///< Frame not valid (settling or bus error)
+  TCS3430_AGC_ADJUSTED, ///< Gain and/or ATIME changed
+  TCS3430_AGC_SETTLED,  ///< Signal within the hysteresis band
+  TCS3430_AGC_LIMITED,  ///< Out of band but already at the range limit
+  TCS3430_AGC_ERROR     ///< Writing the new setting failed
+} tcs3430_agc_t;
+
+/*!
+ *    @brief  Auto-range controller. Estimates the light level from the
+ *            brightest channel, then jumps straight to the gain/ATIME pair
+ *            that puts it at the target fraction of full scale.
+ */
+class Adafruit_TCS3430_AutoRange {
+ public:
+  Adafruit_TCS3430_AutoRange(Adafruit_TCS3430* sensor);
+
+  bool begin(uint8_t max_atime = 63, uint8_t min_atime = 0);
+  void setTarget(uint8_t target_pct = 50, uint8_t low_pct = 20,
+                 uint8_t high_pct = 80);
+  tcs3430_agc_t update(const tcs3430_frame_t* frame);
+
+  bool isConverged();
+  uint8_t getConvergenceCycles();
+  tcs3430_gain_t getGain();
+  uint8_t getATIME();
+
+ private:
+  Adafruit_TCS3430* _sensor;     ///< Sensor being controlled
+  tcs3430_gain_t _gain;          ///< Current gain
+  uint8_t _atime = 0;            ///< Current ATIME
+  uint8_t _min_atime = 0;        ///< Shortest ATIME allowed
+  uint8_t _max_atime = 63;       ///< Longest ATIME allowed
+  uint8_t _target_pct = 50;      ///< Aim point, % of full scale
+  uint8_t _low_pct = 20;         ///< Re-range below this
+  uint8_t _high_pct = 80;        ///< Re-range above this
+  bool _converged = false;       ///< Last valid frame was in band
+  bool _asat_stale = false;      ///< ASAT may predate the last change
+  uint8_t _cycles = 0;           ///< Frames since the last disturbance
+  uint8_t _convergence_cycles = 0; ///< Frames the last convergence took
+};
+
+#endif
@@ -0,0 +1,226 @@
+/*!
+ *  @file Adafruit_TCS3430_Batch.cpp
+ *
+ * 	Batch conversion of logged TCS3430 raw channels
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Batch.h"
+
+#include <string.h>
+
+#if defined(TCS3430_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+/** Hand-written SSE2 kernel */
+#define TCS3430_BATCH_SSE2
+#elif defined(TCS3430_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+/** Hand-written NEON kernel (AArch64, which has vector divide) */
+#define TCS3430_BATCH_NEON
+#endif
+
+/*!
+ *    @brief  Convert count samples. Equivalent to rawToXYZ(), xyzToCIE(),
+ *            cieToCCT() and lux() on each sample, writing only the
+ *            outputs that are not NULL.
+ *    @param  in Raw channel arrays and gain/ATIME metadata
+ *    @param  out Output arrays, each at least count long (or NULL)
+ *    @param  count Number of samples
+ *    @param  matrix Color matrix, NULL for the default
+ */
+void Adafruit_TCS3430_Batch::convert(const tcs3430_raw_batch_t* in,
+                                     const tcs3430_color_batch_t* out,
+                                     uint32_t count,
+                                     const tcs3430_matrix_t* matrix) {
+  const float* m =
+      (matrix ? matrix : Adafruit_TCS3430_Color::defaultMatrix())->m;
+  for (uint32_t first = 0; first < count; first += TCS3430_BATCH_BLOCK) {
+    uint32_t left = count - first;
+    convertBlock(in, out, first,
+                 left < TCS3430_BATCH_BLOCK ? left : TCS3430_BATCH_BLOCK, m);
+  }
+}
+
+/*!
+ *    @brief  Which arithmetic kernel this build uses
+ *    @return "sse2", "neon" or "portable"
+ */
+const char* Adafruit_TCS3430_Batch::kernel() {
+#if defined(TCS3430_BATCH_SSE2)
+  return "sse2";
+#elif defined(TCS3430_BATCH_NEON)
+  return "neon";
+#else
+  return "portable";
+#endif
+}
+
+/*!
+ *    @brief  Convert up to one block of samples
+ *    @param  in Raw channel arrays and gain/ATIME metadata
+ *    @param  out Output arrays
+ *    @param  first Index of the block's first sample
+ *    @param  n Samples in the block, at most TCS3430_BATCH_BLOCK
+ *    @param  m 12 float matrix coefficients
+ */
+void Adafruit_TCS3430_Batch::convertBlock(const tcs3430_raw_batch_t* in,
+                                          const tcs3430_color_batch_t* out,
+                                          uint32_t first, uint8_t n,
+                                          const float* m) {
+  const uint16_t* xs = in->x + first;
+  const uint16_t* ys = in->y + first;
+  const uint16_t* zs = in->z + first;
+  const uint16_t* is = in->ir1 + first;
+  float X[TCS3430_BATCH_BLOCK], Y[TCS3430_BATCH_BLOCK], Z[TCS3430_BATCH_BLOCK];
+  float cx[TCS3430_BATCH_BLOCK], cy[TCS3430_BATCH_BLOCK];
+  float cct[TCS3430_BATCH_BLOCK], lux[TCS3430_BATCH_BLOCK];
+  float gain_scale[TCS3430_BATCH_BLOCK], time_scale[TCS3430_BATCH_BLOCK];
+
+  // Table lookups first, so the arithmetic below has no gathers. The
+  // factors are the ones lux() uses, kept apart to round the same way.
+  for (uint8_t i = 0; i < n; i++) {
+    tcs3430_gain_t gain =
+        in->gain ? (tcs3430_gain_t)in->gain[first + i] : in->gain_all;
+    uint8_t atime = in->atime ? in->atime[first + i] : in->atime_all;
+    gain_scale[i] = 16.0f / Adafruit_TCS3430::gainMultiplier(gain);
+    time_scale[i] = 100.0f / ((atime + 1) * 2.78f);
+  }
+
+  uint8_t i = 0;
+#if defined(TCS3430_BATCH_SSE2)
+  const __m128i zero16 = _mm_setzero_si128();
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= n; i += 4) {
+    __m128 in4[4];
+    const uint16_t* src[4] = {xs, ys, zs, is};
+    for (uint8_t c = 0; c < 4; c++) {
+      __m128i raw = _mm_loadl_epi64((const __m128i*)(src[c] + i));
+      in4[c] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, zero16));
+    }
+    __m128 xyz[3];
+    for (uint8_t row = 0; row < 3; row++) {
+      const float* r = &m[row * 4];
+      __m128 v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[0]), in4[0]),
+                            _mm_mul_ps(_mm_set1_ps(r[1]), in4[1]));
+      v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(r[2]), in4[2]));
+      xyz[row] = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(r[3]), in4[3]));
+    }
+    __m128 sum = _mm_add_ps(_mm_add_ps(xyz[0], xyz[1]), xyz[2]);
+    __m128 lit = _mm_cmpgt_ps(sum, zero);
+    __m128 qx = _mm_and_ps(lit, _mm_div_ps(xyz[0], sum));
+    __m128 qy = _mm_and_ps(lit, _mm_div_ps(xyz[1], sum));
+
+    __m128 den = _mm_sub_ps(_mm_set1_ps(0.1858f), qy);
+    __m128 nn = _mm_div_ps(_mm_sub_ps(qx, _mm_set1_ps(0.3320f)), den);
+    __m128 poly = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(449.0f), nn),
+                                        nn),
+                             nn);
+    poly = _mm_add_ps(
+        poly, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3525.0f), nn), nn));
+    poly = _mm_add_ps(poly, _mm_mul_ps(_mm_set1_ps(6823.3f), nn));
+    poly = _mm_add_ps(poly, _mm_set1_ps(5520.33f));
+    __m128 defined =
+        _mm_and_ps(_mm_cmpgt_ps(qx, zero), _mm_cmpneq_ps(den, zero));
+
+    __m128 l = _mm_mul_ps(_mm_mul_ps(xyz[1], _mm_loadu_ps(&gain_scale[i])),
+                          _mm_loadu_ps(&time_scale[i]));
+
+    _mm_storeu_ps(&X[i], xyz[0]);
+    _mm_storeu_ps(&Y[i], xyz[1]);
+    _mm_storeu_ps(&Z[i], xyz[2]);
+    _mm_storeu_ps(&cx[i], qx);
+    _mm_storeu_ps(&cy[i], qy);
+    _mm_storeu_ps(&cct[i], _mm_and_ps(defined, poly));
+    _mm_storeu_ps(&lux[i], _mm_and_ps(_mm_cmpgt_ps(xyz[1], zero), l));
+  }
+#elif defined(TCS3430_BATCH_NEON)
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t in4[4];
+    const uint16_t* src[4] = {xs, ys, zs, is};
+    for (uint8_t c = 0; c < 4; c++) {
+      in4[c] = vcvtq_f32_u32(vmovl_u16(vld1_u16(src[c] + i)));
+    }
+    float32x4_t xyz[3];
+    for (uint8_t row = 0; row < 3; row++) {
+      const float* r = &m[row * 4];
+      float32x4_t v = vaddq_f32(vmulq_n_f32(in4[0], r[0]),
+                                vmulq_n_f32(in4[1], r[1]));
+      v = vaddq_f32(v, vmulq_n_f32(in4[2], r[2]));
+      xyz[row] = vaddq_f32(v, vmulq_n_f32(in4[3], r[3]));
+    }
+    float32x4_t sum = vaddq_f32(vaddq_f32(xyz[0], xyz[1]), xyz[2]);
+    uint32x4_t lit = vcgtq_f32(sum, zero);
+    float32x4_t qx = vbslq_f32(lit, vdivq_f32(xyz[0], sum), zero);
+    float32x4_t qy = vbslq_f32(lit, vdivq_f32(xyz[1], sum), zero);
+
+    float32x4_t den = vsubq_f32(vdupq_n_f32(0.1858f), qy);
+    float32x4_t nn = vdivq_f32(vsubq_f32(qx, vdupq_n_f32(0.3320f)), den);
+    float32x4_t poly = vmulq_f32(vmulq_f32(vmulq_n_f32(nn, 449.0f), nn), nn);
+    poly = vaddq_f32(poly, vmulq_f32(vmulq_n_f32(nn, 3525.0f), nn));
+    poly = vaddq_f32(poly, vmulq_n_f32(nn, 6823.3f));
+    poly = vaddq_f32(poly, vdupq_n_f32(5520.33f));
+    uint32x4_t defined =
+        vandq_u32(vcgtq_f32(qx, zero), vmvnq_u32(vceqq_f32(den, zero)));
+
+    float32x4_t l = vmulq_f32(vmulq_f32(xyz[1], vld1q_f32(&gain_scale[i])),
+                              vld1q_f32(&time_scale[i]));
+
+    vst1q_f32(&X[i], xyz[0]);
+    vst1q_f32(&Y[i], xyz[1]);
+    vst1q_f32(&Z[i], xyz[2]);
+    vst1q_f32(&cx[i], qx);
+    vst1q_f32(&cy[i], qy);
+    vst1q_f32(&cct[i], vbslq_f32(defined, poly, zero));
+    vst1q_f32(&lux[i], vbslq_f32(vcgtq_f32(xyz[1], zero), l, zero));
+  }
+#endif
+
+  // Portable loops, one stage each and free of branches so they
+  // vectorise; with a SIMD kernel they only handle the last few samples.
+  // Quotients are taken unconditionally and then selected, so no
+  // division sits behind a condition.
+  for (uint8_t j = i; j < n; j++) {
+    float fx = xs[j], fy = ys[j], fz = zs[j], fi = is[j];
+    X[j] = m[0] * fx + m[1] * fy + m[2] * fz + m[3] * fi;
+    Y[j] = m[4] * fx + m[5] * fy + m[6] * fz + m[7] * fi;
+    Z[j] = m[8] * fx + m[9] * fy + m[10] * fz + m[11] * fi;
+  }
+  for (uint8_t j = i; j < n; j++) {
+    float sum = X[j] + Y[j] + Z[j];
+    float qx = X[j] / sum;
+    float qy = Y[j] / sum;
+    cx[j] = sum > 0.0f ? qx : 0.0f;
+    cy[j] = sum > 0.0f ? qy : 0.0f;
+  }
+  for (uint8_t j = i; j < n; j++) {
+    float den = 0.1858f - cy[j];
+    float nn = (cx[j] - 0.3320f) / den;
+    float c = (449.0f * nn * nn * nn) + (3525.0f * nn * nn) +
+              (6823.3f * nn) + 5520.33f;
+    cct[j] = (cx[j] > 0.0f && den != 0.0f) ? c : 0.0f;
+  }
+  for (uint8_t j = i; j < n; j++) {
+    float l = Y[j] * gain_scale[j] * time_scale[j];
+    lux[j] = Y[j] > 0.0f ? l : 0.0f;
+  }
+
+  size_t bytes = n * sizeof(float);
+  float* dest[7] = {out->X,     out->Y,   out->Z,  out->cie_x,
+                    out->cie_y, out->cct, out->lux};
+  const float* src[7] = {X, Y, Z, cx, cy, cct, lux};
+  for (uint8_t k = 0; k < 7; k++) {
+    if (dest[k]) {
+      memcpy(dest[k] + first, src[k], bytes);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/*!
+ *  @file Adafruit_TCS3430_Batch.h
+ *
+ * 	Batch conversion of logged TCS3430 raw channels to XYZ, CIE x,y, CCT
+ * 	and lux over structure-of-arrays buffers
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_BATCH_H
+#define _ADAFRUIT_TCS3430_BATCH_H
+
+#include "Adafruit_TCS3430_Color.h"
+
+/*
+ * The batch path computes exactly what the per-sample float functions in
+ * Adafruit_TCS3430_Color compute (rawToXYZ, xyzToCIE, cieToCCT, lux), in
+ * the same order, so results match them. Samples are processed in blocks
+ * of TCS3430_BATCH_BLOCK: the gain/ATIME table lookups run first, then
+ * branch-free arithmetic loops over the block that compilers vectorise at
+ * -O3 (or -O2 -ftree-vectorize).
+ *
+ * Build with -DTCS3430_SIMD (a compiler flag, like TCS3430_FIXED_POINT)
+ * to use hand-written SSE2 (x86) or NEON (AArch64) kernels for the
+ * arithmetic instead. Other targets ignore the flag.
+ */
+
+/** Samples converted per block */
+#define TCS3430_BATCH_BLOCK 64
+
+/** Raw channels, one array per channel. Gain and ATIME arrays are
+ *  optional; when NULL every sample uses the single value given. */
+typedef struct {
+  const uint16_t* x;       ///< CH3 with AMUX on X
+  const uint16_t* y;       ///< CH1
+  const uint16_t* z;       ///< CH0
+  const uint16_t* ir1;     ///< CH2
+  const uint8_t* gain;     ///< tcs3430_gain_t per sample, or NULL
+  const uint8_t* atime;    ///< ATIME per sample, or NULL
+  tcs3430_gain_t gain_all; ///< Gain of every sample when gain is NULL
+  uint8_t atime_all;       ///< ATIME of every sample when atime is NULL
+} tcs3430_raw_batch_t;
+
+/** Output arrays. Any may be NULL to skip that output. */
+typedef struct {
+  float* X;     ///< CIE X
+  float* Y;     ///< CIE Y
+  float* Z;     ///< CIE Z
+  float* cie_x; ///< CIE 1931 x, 0 if X+Y+Z is not positive
+  float* cie_y; ///< CIE 1931 y, 0 if X+Y+Z is not positive
+  float* cct;   ///< McCamy CCT in kelvin, 0 if undefined
+  float* lux;   ///< Illuminance, 0 if Y is negative
+} tcs3430_color_batch_t;
+
+/*!
+ *    @brief  Structure-of-arrays color conversion for offline processing
+ */
+class Adafruit_TCS3430_Batch {
+ public:
+  static void convert(const tcs3430_raw_batch_t* in,
+                      const tcs3430_color_batch_t* out, uint32_t count,
+                      const tcs3430_matrix_t* matrix = NULL);
+  static const char* kernel();
+
+ private:
+  static void convertBlock(const tcs3430_raw_batch_t* in,
+                           const tcs3430_color_batch_t* out, uint32_t first,
+                           uint8_t n, const float* m);
+};
+
+#endif
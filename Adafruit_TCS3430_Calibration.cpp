@@ -0,0 +1,230 @@
+/*!
+ *  @file Adafruit_TCS3430_Calibration.cpp
+ *
+ * 	Per-device color matrix calibration for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Calibration.h"
+
+#include <math.h>
+
+/*!
+ *    @brief  Instantiates an empty calibration
+ */
+Adafruit_TCS3430_Calibration::Adafruit_TCS3430_Calibration() {
+  reset();
+}
+
+/*!
+ *    @brief  Discard every sample
+ */
+void Adafruit_TCS3430_Calibration::reset() {
+  for (uint8_t i = 0; i < 4; i++) {
+    for (uint8_t j = 0; j < 4; j++) {
+      _r[i][j] = 0.0f;
+    }
+    for (uint8_t o = 0; o < 3; o++) {
+      _qb[o][i] = 0.0f;
+    }
+  }
+  for (uint8_t o = 0; o < 3; o++) {
+    _rss[o] = 0.0f;
+  }
+  _count = 0;
+}
+
+/*!
+ *    @brief  Add one pair of raw channels and the XYZ the matrix should
+ *            turn them into. Use at least four light sources of
+ *            different spectra; more samples average out noise.
+ *    @param  x CH3 with AMUX on X
+ *    @param  y CH1
+ *    @param  z CH0
+ *    @param  ir1 CH2
+ *    @param  reference Target tristimulus values, in the units
+ *            rawToXYZ() should produce for these counts
+ */
+void Adafruit_TCS3430_Calibration::addSample(uint16_t x, uint16_t y,
+                                             uint16_t z, uint16_t ir1,
+                                             const tcs3430_xyz_t* reference) {
+  float a[4] = {(float)x, (float)y, (float)z, (float)ir1};
+  float b[3] = {reference->X, reference->Y, reference->Z};
+
+  // Rotate the new row into R, zeroing it column by column; what is left
+  // of the references is this sample's contribution to the residual
+  for (uint8_t k = 0; k < 4; k++) {
+    if (a[k] == 0.0f) {
+      continue;
+    }
+    float r = sqrtf(_r[k][k] * _r[k][k] + a[k] * a[k]);
+    float c = _r[k][k] / r;
+    float s = a[k] / r;
+    _r[k][k] = r;
+    for (uint8_t j = k + 1; j < 4; j++) {
+      float t = _r[k][j];
+      _r[k][j] = c * t + s * a[j];
+      a[j] = c * a[j] - s * t;
+    }
+    for (uint8_t o = 0; o < 3; o++) {
+      float t = _qb[o][k];
+      _qb[o][k] = c * t + s * b[o];
+      b[o] = c * b[o] - s * t;
+    }
+  }
+  for (uint8_t o = 0; o < 3; o++) {
+    _rss[o] += b[o] * b[o];
+  }
+  if (_count < 0xFFFF) {
+    _count++;
+  }
+}
+
+/*!
+ *    @brief  Read the channels and add them against a reference measured
+ *            with a lux meter / colorimeter. The reference is scaled from
+ *            lux to counts at the sensor's gain and integration time, the
+ *            inverse of Adafruit_TCS3430_Color::lux(), so getLux() reads
+ *            in lux with the fitted matrix at any setting.
+ *    @param  sensor Sensor to read, with AMUX on X
+ *    @param  reference Reference tristimulus values, Y in lux
+ *    @return true if the channels were read and the sample added
+ */
+bool Adafruit_TCS3430_Calibration::addReading(Adafruit_TCS3430* sensor,
+                                              const tcs3430_xyz_t* reference) {
+  uint16_t x, y, z, ir1;
+  if (!sensor->getChannels(&x, &y, &z, &ir1)) {
+    return false;
+  }
+  float scale = Adafruit_TCS3430::gainMultiplier(sensor->getALSGain()) /
+                16.0f * ((sensor->getIntegrationCycles() + 1) * 2.78f) /
+                100.0f;
+  tcs3430_xyz_t counts = {reference->X * scale, reference->Y * scale,
+                          reference->Z * scale};
+  addSample(x, y, z, ir1, &counts);
+  return true;
+}
+
+/*!
+ *    @brief  Number of samples added since the last reset()
+ *    @return Sample count
+ */
+uint16_t Adafruit_TCS3430_Calibration::getSampleCount() {
+  return _count;
+}
+
+/*!
+ *    @brief  Solve for the matrix that best maps the samples onto their
+ *            references
+ *    @param  matrix Filled in on TCS3430_CAL_OK, untouched otherwise
+ *    @return Outcome
+ */
+tcs3430_cal_t Adafruit_TCS3430_Calibration::fit(tcs3430_matrix_t* matrix) {
+  if (_count < 4) {
+    return TCS3430_CAL_TOO_FEW;
+  }
+  float largest = 0.0f;
+  for (uint8_t k = 0; k < 4; k++) {
+    if (fabsf(_r[k][k]) > largest) {
+      largest = fabsf(_r[k][k]);
+    }
+  }
+  for (uint8_t k = 0; k < 4; k++) {
+    if (fabsf(_r[k][k]) <= largest * 1e-5f) {
+      return TCS3430_CAL_SINGULAR;
+    }
+  }
+
+  // Back substitution, one output row at a time
+  float m[12];
+  for (uint8_t o = 0; o < 3; o++) {
+    for (int8_t k = 3; k >= 0; k--) {
+      float v = _qb[o][k];
+      for (uint8_t j = k + 1; j < 4; j++) {
+        v -= _r[k][j] * m[o * 4 + j];
+      }
+      m[o * 4 + k] = v / _r[k][k];
+    }
+  }
+  return Adafruit_TCS3430_Color::loadMatrix(m, matrix) ? TCS3430_CAL_OK
+                                                       : TCS3430_CAL_RANGE;
+}
+
+/*!
+ *    @brief  How well the fitted matrix reproduces the references: the
+ *            RMS of the X, Y and Z errors over every sample, in reference
+ *            units. Valid once fit() would succeed.
+ *    @return RMS error, 0 with no samples
+ */
+float Adafruit_TCS3430_Calibration::getRMSError() {
+  if (_count == 0) {
+    return 0.0f;
+  }
+  return sqrtf((_rss[0] + _rss[1] + _rss[2]) / (3.0f * _count));
+}
+
+/*!
+ *    @brief  Serialise a matrix. The blob holds the Q14 coefficients, so
+ *            after load() both paths use them (the float path to within
+ *            one part in 32768).
+ *    @param  matrix Matrix to store
+ *    @param  blob Filled in, ready to write to EEPROM or flash
+ */
+void Adafruit_TCS3430_Calibration::save(const tcs3430_matrix_t* matrix,
+                                        tcs3430_cal_blob_t* blob) {
+  blob->magic = TCS3430_CAL_MAGIC;
+  blob->version = TCS3430_CAL_VERSION;
+  for (uint8_t i = 0; i < 12; i++) {
+    uint16_t q = (uint16_t)matrix->q14[i];
+    blob->coefficients[2 * i] = q & 0xFF;
+    blob->coefficients[2 * i + 1] = q >> 8;
+  }
+  blob->check = blobCheck(blob);
+}
+
+/*!
+ *    @brief  Restore a matrix saved with save()
+ *    @param  blob Blob as read back from storage
+ *    @param  matrix Filled in on success
+ *    @return false (matrix untouched) if the blob is blank, corrupt or
+ *            from an unknown version
+ */
+bool Adafruit_TCS3430_Calibration::load(const tcs3430_cal_blob_t* blob,
+                                        tcs3430_matrix_t* matrix) {
+  if (blob->magic != TCS3430_CAL_MAGIC ||
+      blob->version != TCS3430_CAL_VERSION || blob->check != blobCheck(blob)) {
+    return false;
+  }
+  float m[12];
+  for (uint8_t i = 0; i < 12; i++) {
+    int16_t q = (int16_t)(blob->coefficients[2 * i] |
+                          ((uint16_t)blob->coefficients[2 * i + 1] << 8));
+    m[i] = q * (1.0f / 16384);
+  }
+  return Adafruit_TCS3430_Color::loadMatrix(m, matrix);
+}
+
+/*!
+ *    @brief  Check byte over a blob's magic, version and coefficients,
+ *            the same rotate-and-xor as the driver's resume snapshot
+ *    @param  blob Blob to check
+ *    @return Check byte
+ */
+uint8_t Adafruit_TCS3430_Calibration::blobCheck(
+    const tcs3430_cal_blob_t* blob) {
+  const uint8_t* bytes = (const uint8_t*)blob;
+  uint8_t check = 0xA5;
+  for (uint8_t i = 0; i < sizeof(*blob) - 1; i++) {
+    check = (uint8_t)((check << 1) | (check >> 7)) ^ bytes[i];
+  }
+  return check;
+}
@@ -0,0 +1,75 @@
+/*!
+ *  @file Adafruit_TCS3430_Calibration.h
+ *
+ * 	Per-device color matrix calibration for the TCS3430: least-squares
+ * 	fit of a 3x4 matrix against reference XYZ, and a compact blob to keep
+ * 	it in EEPROM or flash
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_CALIBRATION_H
+#define _ADAFRUIT_TCS3430_CALIBRATION_H
+
+#include "Adafruit_TCS3430_Color.h"
+
+/** First byte of a calibration blob */
+#define TCS3430_CAL_MAGIC 0xC3
+/** Blob layout version written by save() */
+#define TCS3430_CAL_VERSION 1
+
+/** Outcome of a fit */
+typedef enum {
+  TCS3430_CAL_OK,       ///< Matrix fitted
+  TCS3430_CAL_TOO_FEW,  ///< Fewer than 4 samples
+  TCS3430_CAL_SINGULAR, ///< Samples too alike to separate the 4 channels
+  TCS3430_CAL_RANGE     ///< Fitted matrix outside the fixed point limits
+} tcs3430_cal_t;
+
+/** Color matrix as stored: Q14 coefficients, little endian, row major */
+typedef struct {
+  uint8_t magic;            ///< TCS3430_CAL_MAGIC
+  uint8_t version;          ///< TCS3430_CAL_VERSION
+  uint8_t coefficients[24]; ///< 12 x int16 Q14
+  uint8_t check;            ///< Check byte over the bytes before it
+} tcs3430_cal_blob_t;
+
+/*!
+ *    @brief  Least-squares color matrix fit. Each sample is folded into a
+ *            4x4 triangular factor by Givens rotations as it arrives, so
+ *            memory use is fixed, no samples are kept, and the fit is as
+ *            well conditioned as a QR solve even in 32-bit float.
+ */
+class Adafruit_TCS3430_Calibration {
+ public:
+  Adafruit_TCS3430_Calibration();
+
+  void reset();
+  void addSample(uint16_t x, uint16_t y, uint16_t z, uint16_t ir1,
+                 const tcs3430_xyz_t* reference);
+  bool addReading(Adafruit_TCS3430* sensor, const tcs3430_xyz_t* reference);
+  uint16_t getSampleCount();
+  tcs3430_cal_t fit(tcs3430_matrix_t* matrix);
+  float getRMSError();
+
+  static void save(const tcs3430_matrix_t* matrix, tcs3430_cal_blob_t* blob);
+  static bool load(const tcs3430_cal_blob_t* blob, tcs3430_matrix_t* matrix);
+
+ private:
+  static uint8_t blobCheck(const tcs3430_cal_blob_t* blob);
+
+  float _r[4][4];      ///< Upper triangular factor
+  float _qb[3][4];     ///< Rotated references, one row per output
+  float _rss[3];       ///< Residual sum of squares per output
+  uint16_t _count = 0; ///< Samples added
+};
+
+#endif
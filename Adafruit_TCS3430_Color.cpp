@@ -0,0 +1,259 @@
+/*!
+ *  @file Adafruit_TCS3430_Color.cpp
+ *
+ * 	Colorimetry for the TCS3430 in float and fixed point
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Color.h"
+
+static const tcs3430_matrix_t kDefaultMatrix = {
+    {TCS3430_DEFAULT_MATRIX(TCS3430_CM_FLOAT)},
+    {TCS3430_DEFAULT_MATRIX(TCS3430_CM_Q14)}};
+
+/*!
+ *    @brief  The built-in matrix, TCS3430_DEFAULT_MATRIX
+ *    @return Matrix used when none is given
+ */
+const tcs3430_matrix_t* Adafruit_TCS3430_Color::defaultMatrix() {
+  return &kDefaultMatrix;
+}
+
+/*!
+ *    @brief  Build a color matrix from float coefficients, rounding them
+ *            to Q14 for the fixed point path
+ *    @param  coefficients 12 coefficients, rows X', Y', Z' of X, Y, Z, IR1
+ *    @param  matrix Filled in on success
+ *    @return false (matrix untouched) if a coefficient is 2 or more in
+ *            magnitude, or a row's coefficients of one sign add up to 4
+ *            or more, which the fixed point path cannot hold
+ */
+bool Adafruit_TCS3430_Color::loadMatrix(const float* coefficients,
+                                        tcs3430_matrix_t* matrix) {
+  int16_t q14[12];
+  for (uint8_t row = 0; row < 3; row++) {
+    int32_t pos = 0, neg = 0;
+    for (uint8_t col = 0; col < 4; col++) {
+      float c = coefficients[row * 4 + col] * 16384;
+      if (!(c > -32768.0f && c < 32767.5f)) {
+        return false;
+      }
+      int16_t q = (int16_t)(c + (c < 0 ? -0.5f : 0.5f));
+      if (q >= 0) {
+        pos += q;
+      } else {
+        neg -= q;
+      }
+      q14[row * 4 + col] = q;
+    }
+    if (pos >= 4 * 16384 || neg >= 4 * 16384) {
+      return false;
+    }
+  }
+  for (uint8_t i = 0; i < 12; i++) {
+    matrix->m[i] = coefficients[i];
+    matrix->q14[i] = q14[i];
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Apply the color matrix to raw channels
+ *    @param  x CH3 with AMUX on X
+ *    @param  y CH1
+ *    @param  z CH0
+ *    @param  ir1 CH2
+ *    @param  xyz Pointer to store the tristimulus values
+ *    @param  matrix Color matrix, NULL for the default
+ */
+void Adafruit_TCS3430_Color::rawToXYZ(uint16_t x, uint16_t y, uint16_t z,
+                                      uint16_t ir1, tcs3430_xyz_t* xyz,
+                                      const tcs3430_matrix_t* matrix) {
+  const float* coefficients = (matrix ? matrix : &kDefaultMatrix)->m;
+  float out[3];
+  for (uint8_t row = 0; row < 3; row++) {
+    const float* m = &coefficients[row * 4];
+    out[row] = m[0] * x + m[1] * y + m[2] * z + m[3] * ir1;
+  }
+  xyz->X = out[0];
+  xyz->Y = out[1];
+  xyz->Z = out[2];
+}
+
+/*!
+ *    @brief  Convert tristimulus values to CIE 1931 chromaticity
+ *    @param  xyz Tristimulus values
+ *    @param  cie_x Pointer to store CIE x
+ *    @param  cie_y Pointer to store CIE y
+ *    @return false if X+Y+Z is not positive (x,y set to 0)
+ */
+bool Adafruit_TCS3430_Color::xyzToCIE(const tcs3430_xyz_t* xyz, float* cie_x,
+                                      float* cie_y) {
+  float sum = xyz->X + xyz->Y + xyz->Z;
+  if (sum <= 0.0f) {
+    *cie_x = 0.0f;
+    *cie_y = 0.0f;
+    return false;
+  }
+  *cie_x = xyz->X / sum;
+  *cie_y = xyz->Y / sum;
+  return true;
+}
+
+/*!
+ *    @brief  Correlated color temperature using McCamy's approximation
+ *    @param  cie_x CIE x
+ *    @param  cie_y CIE y
+ *    @return CCT in kelvin, 0 if undefined
+ */
+float Adafruit_TCS3430_Color::cieToCCT(float cie_x, float cie_y) {
+  if (cie_x <= 0.0f || (0.1858f - cie_y) == 0.0f) {
+    return 0.0f;
+  }
+  float n = (cie_x - 0.3320f) / (0.1858f - cie_y);
+  return (449.0f * n * n * n) + (3525.0f * n * n) + (6823.3f * n) + 5520.33f;
+}
+
+/*!
+ *    @brief  Illuminance from the Y tristimulus value, normalised to
+ *            16x gain and 100ms integration
+ *    @param  Y Y tristimulus value
+ *    @param  gain Gain the sample was taken with
+ *    @param  atime ATIME the sample was taken with
+ *    @return Lux, 0 if Y is negative
+ */
+float Adafruit_TCS3430_Color::lux(float Y, tcs3430_gain_t gain,
+                                  uint8_t atime) {
+  if (Y <= 0.0f) {
+    return 0.0f;
+  }
+  float integration_ms = (atime + 1) * 2.78f;
+  return Y * (16.0f / Adafruit_TCS3430::gainMultiplier(gain)) *
+         (100.0f / integration_ms);
+}
+
+/*!
+ *    @brief  Apply the Q14 color matrix to raw channels
+ *    @param  x CH3 with AMUX on X
+ *    @param  y CH1
+ *    @param  z CH0
+ *    @param  ir1 CH2
+ *    @param  xyz Pointer to store the tristimulus values, Q4
+ *    @param  matrix Color matrix, NULL for the default
+ */
+void Adafruit_TCS3430_Color::rawToXYZFixed(uint16_t x, uint16_t y, uint16_t z,
+                                           uint16_t ir1,
+                                           tcs3430_xyz_fixed_t* xyz,
+                                           const tcs3430_matrix_t* matrix) {
+  const int16_t* coefficients = (matrix ? matrix : &kDefaultMatrix)->q14;
+  const uint16_t in[4] = {x, y, z, ir1};
+  int32_t out[3];
+  for (uint8_t row = 0; row < 3; row++) {
+    const int16_t* m = &coefficients[row * 4];
+    // Positive and negative terms are summed apart: each side is under
+    // 2^32 as long as a row's coefficients of one sign add up to < 4
+    uint32_t pos = 0, neg = 0;
+    for (uint8_t col = 0; col < 4; col++) {
+      if (m[col] >= 0) {
+        pos += (uint32_t)m[col] * in[col];
+      } else {
+        neg += (uint32_t)(-m[col]) * in[col];
+      }
+    }
+    out[row] = pos > neg ? (int32_t)((pos - neg + 512) >> 10) : 0; // -> Q4
+  }
+  xyz->X = out[0];
+  xyz->Y = out[1];
+  xyz->Z = out[2];
+}
+
+/*!
+ *    @brief  Convert fixed point tristimulus values to CIE 1931 x,y
+ *    @param  xyz Tristimulus values, Q4
+ *    @param  cie_x Pointer to store CIE x, Q15
+ *    @param  cie_y Pointer to store CIE y, Q15
+ *    @return false if X+Y+Z is zero (x,y set to 0)
+ */
+bool Adafruit_TCS3430_Color::xyzToCIEFixed(const tcs3430_xyz_fixed_t* xyz,
+                                           uint16_t* cie_x, uint16_t* cie_y) {
+  uint32_t X = xyz->X, Y = xyz->Y;
+  uint32_t sum = X + Y + (uint32_t)xyz->Z;
+  if (sum == 0) {
+    *cie_x = 0;
+    *cie_y = 0;
+    return false;
+  }
+
+  // Scale so sum < 2^16, keeping (X << 15) inside 32 bits
+  while (sum >= 65536) {
+    X >>= 1;
+    Y >>= 1;
+    sum >>= 1;
+  }
+  *cie_x = ((X << 15) + sum / 2) / sum;
+  *cie_y = ((Y << 15) + sum / 2) / sum;
+  return true;
+}
+
+/*!
+ *    @brief  McCamy CCT in fixed point
+ *    @param  cie_x CIE x, Q15
+ *    @param  cie_y CIE y, Q15
+ *    @return CCT in kelvin, 0 if undefined
+ */
+uint16_t Adafruit_TCS3430_Color::cieToCCTFixed(uint16_t cie_x,
+                                               uint16_t cie_y) {
+  // 0.3320 and 0.1858 in Q15
+  int32_t num = (int32_t)cie_x - 10879;
+  int32_t den = 6088 - (int32_t)cie_y;
+  if (cie_x == 0 || den == 0) {
+    return 0;
+  }
+
+  // n in Q12, clamped well outside McCamy's useful range so the cubic
+  // cannot overflow
+  int32_t n = (num * 4096) / den;
+  if (n > 4 * 4096) {
+    n = 4 * 4096;
+  } else if (n < -4 * 4096) {
+    n = -4 * 4096;
+  }
+  int32_t n2 = (n * n) >> 12;
+  int32_t n3 = (n2 * n) >> 12;
+
+  // 449 n^3 + 3525 n^2 + 6823.3 n + 5520.33, all in Q12
+  int32_t cct = 449 * n3 + 3525 * n2 + ((68233 * n) / 10) + 22611272;
+  if (cct <= 0) {
+    return 0;
+  }
+  cct = (cct + 2048) >> 12;
+  return cct > 65535 ? 65535 : cct;
+}
+
+/*!
+ *    @brief  Illuminance in fixed point, normalised to 16x gain and 100ms
+ *    @param  Y Y tristimulus value, Q4
+ *    @param  gain Gain the sample was taken with
+ *    @param  atime ATIME the sample was taken with
+ *    @return Lux, Q8
+ */
+uint32_t Adafruit_TCS3430_Color::luxFixed(int32_t Y, tcs3430_gain_t gain,
+                                          uint8_t atime) {
+  if (Y <= 0) {
+    return 0;
+  }
+  // lux = Y * 16 * 100 / (gain * steps * 2.78)
+  //     = Y_q4 * 9208.6 / (gain * steps) in Q8
+  uint32_t div = (uint32_t)Adafruit_TCS3430::gainMultiplier(gain) * (atime + 1);
+  uint64_t lux = ((uint64_t)Y * 92086 / 10 + div / 2) / div;
+  return lux > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)lux;
+}
@@ -0,0 +1,109 @@
+/*!
+ *  @file Adafruit_TCS3430_Color.h
+ *
+ * 	Colorimetry for the TCS3430: raw channels to CIE XYZ, CIE 1931 x,y,
+ * 	correlated color temperature and lux, in float and fixed point.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_COLOR_H
+#define _ADAFRUIT_TCS3430_COLOR_H
+
+#include "Adafruit_TCS3430.h"
+
+/*
+ * Build with -DTCS3430_FIXED_POINT (a compiler flag: a #define in the
+ * sketch does not reach the library's .cpp files) to make getCIE(),
+ * getCCT() and getLux() use the integer path below, converting to float
+ * only at the very end. The *Fixed() functions are always available.
+ *
+ * Fixed point formats:
+ *  - XYZ: int32, counts in Q4, negative results clamped to 0
+ *  - CIE x,y: uint16, Q15 (32768 = 1.0)
+ *  - CCT: uint16, kelvin
+ *  - Lux: uint32, Q8 (256 = 1 lux)
+ * Matrix coefficients are held in Q14 (|c| < 2) and the positive and
+ * negative terms of each row are summed separately, so a four term dot
+ * product of 16-bit counts fits in 32 bits: no 64-bit multiplies except
+ * one in lux. A per-device matrix (loadMatrix()) must meet the same
+ * limits: |c| < 2 and each row's coefficients of one sign adding up to
+ * less than 4.
+ *
+ * Accuracy of the fixed path against a double-precision reference,
+ * measured over 20M random channel sets with positive XYZ (errors are
+ * absolute counts from coefficient rounding, so they shrink as the signal
+ * grows, and are worst where IR cancels most of large raw counts):
+ *  - X+Y+Z >= 1000 counts: CIE x,y within 0.0015, CCT within 20 K
+ *    (2000-12000 K), lux within 0.5%
+ *  - X+Y+Z >= 10000 counts: CIE x,y within 0.00015, CCT within 7 K,
+ *    lux within 0.08%
+ *  - CCT is only meaningful on McCamy's main branch, n > -1.28: further
+ *    from the Planckian locus the cubic turns back through 2000-12000 K
+ *  - Lux saturates at 16.7M lux (the top of Q8 in 32 bits)
+ * extras/host/tests/color_test.cpp checks these bounds.
+ */
+
+/*!
+ * Default color matrix, the ams AN000571 "low IR" matrix for LED/CFL
+ * sources. Rows are X', Y', Z'; columns are X, Y, Z, IR1. Both the float
+ * and fixed point paths are generated from this one list.
+ */
+#define TCS3430_DEFAULT_MATRIX(M)                                              \
+  M(-0.28837) M(0.58484) M(1.55207) M(-1.21521)                                \
+  M(-0.30518) M(0.60817) M(1.62203) M(-1.25651)                                \
+  M(-0.23132) M(0.46517) M(1.22896) M(-0.95905)
+
+/** Float coefficient from a matrix entry */
+#define TCS3430_CM_FLOAT(v) (float)(v),
+/** Q14 coefficient from a matrix entry, rounded to nearest */
+#define TCS3430_CM_Q14(v) (int16_t)((v) * 16384 + ((v) < 0 ? -0.5 : 0.5)),
+
+/** Tristimulus values in float */
+typedef struct {
+  float X; ///< CIE X
+  float Y; ///< CIE Y (luminance)
+  float Z; ///< CIE Z
+} tcs3430_xyz_t;
+
+/** Tristimulus values in fixed point (Q4 counts) */
+typedef struct {
+  int32_t X; ///< CIE X, Q4
+  int32_t Y; ///< CIE Y (luminance), Q4
+  int32_t Z; ///< CIE Z, Q4
+} tcs3430_xyz_fixed_t;
+
+/*!
+ *    @brief  Stateless color conversions shared by the driver and
+ *            applications that already hold raw channel data
+ */
+class Adafruit_TCS3430_Color {
+ public:
+  static bool loadMatrix(const float* coefficients, tcs3430_matrix_t* matrix);
+  static const tcs3430_matrix_t* defaultMatrix();
+
+  static void rawToXYZ(uint16_t x, uint16_t y, uint16_t z, uint16_t ir1,
+                       tcs3430_xyz_t* xyz,
+                       const tcs3430_matrix_t* matrix = NULL);
+  static bool xyzToCIE(const tcs3430_xyz_t* xyz, float* cie_x, float* cie_y);
+  static float cieToCCT(float cie_x, float cie_y);
+  static float lux(float Y, tcs3430_gain_t gain, uint8_t atime);
+
+  static void rawToXYZFixed(uint16_t x, uint16_t y, uint16_t z, uint16_t ir1,
+                            tcs3430_xyz_fixed_t* xyz,
+                            const tcs3430_matrix_t* matrix = NULL);
+  static bool xyzToCIEFixed(const tcs3430_xyz_fixed_t* xyz, uint16_t* cie_x,
+                            uint16_t* cie_y);
+  static uint16_t cieToCCTFixed(uint16_t cie_x, uint16_t cie_y);
+  static uint32_t luxFixed(int32_t Y, tcs3430_gain_t gain, uint8_t atime);
+};
+
+#endif
@@ -0,0 +1,255 @@
+/*!
+ *  @file Adafruit_TCS3430_DutyCycle.cpp
+ *
+ * 	Sample period planner for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_DutyCycle.h"
+
+/*!
+ *    @brief  Instantiates a planner
+ *    @param  sensor Sensor to pace, already begun
+ */
+Adafruit_TCS3430_DutyCycle::Adafruit_TCS3430_DutyCycle(
+    Adafruit_TCS3430* sensor)
+    : _sensor(sensor) {}
+
+/*!
+ *    @brief  Choose the lowest-current scheme that delivers a sample at
+ *            least every period_ms with at most latency_ms latency.
+ *            Latency is how stale the newest sample can be when the host
+ *            asks for one, or for POWER_DOWN how long it waits for one:
+ *            - CONTINUOUS, WAIT, WAIT_LONG: one sensor cycle. The cycle is
+ *              the longest the wait settings give within both limits.
+ *            - SAI: the period less the integration, since each read
+ *              starts the next integration and the result waits for the
+ *              following read.
+ *            - POWER_DOWN: auto-zero plus integration after power-up.
+ *    @param  period_ms Longest acceptable time between samples, up to
+ *            about 71 minutes
+ *    @param  latency_ms Longest acceptable latency
+ *    @param  atime Integration time to plan for (ATIME)
+ *    @param  host_timed Allow SAI and POWER_DOWN, which rely on poll()
+ *            being called on time rather than the sensor's own timer
+ *    @param  plan Filled with the choice; when nothing meets both limits,
+ *            the free-running scheme closest to them
+ *    @return true if the plan meets both limits
+ */
+bool Adafruit_TCS3430_DutyCycle::plan(uint32_t period_ms, uint32_t latency_ms,
+                                      uint8_t atime, bool host_timed,
+                                      tcs3430_duty_plan_t* plan) {
+  const uint32_t longest_ms = 0xFFFFFFFF / 1000;
+  uint32_t period = (period_ms < longest_ms ? period_ms : longest_ms) * 1000;
+  uint32_t latency =
+      (latency_ms < longest_ms ? latency_ms : longest_ms) * 1000;
+  uint32_t integration = (uint32_t)(atime + 1) * TCS3430_STEP_MICROS;
+
+  tcs3430_duty_plan_t best;
+  best.mode = TCS3430_DUTY_CONTINUOUS;
+  best.atime = atime;
+  best.wtime = 0;
+  best.period_us = best.latency_us = best.active_us = integration;
+  estimate(&best, 0, 0);
+
+  // Free running: stretch the wait as far as both limits allow
+  uint32_t target = period < latency ? period : latency;
+  if (target > integration) {
+    uint32_t spare = target - integration;
+    const tcs3430_duty_mode_t modes[2] = {TCS3430_DUTY_WAIT,
+                                          TCS3430_DUTY_WAIT_LONG};
+    for (uint8_t i = 0; i < 2; i++) {
+      uint32_t step = TCS3430_STEP_MICROS * (i ? 12 : 1);
+      uint32_t steps = spare / step;
+      if (steps == 0) {
+        continue;
+      }
+      if (steps > 256) {
+        steps = 256;
+      }
+      tcs3430_duty_plan_t wait = best;
+      wait.mode = modes[i];
+      wait.wtime = steps - 1;
+      wait.period_us = wait.latency_us = integration + steps * step;
+      estimate(&wait, steps * step, 0);
+      if (wait.current_ua < best.current_ua) {
+        best = wait;
+      }
+    }
+  }
+  bool met = best.period_us <= period && best.latency_us <= latency;
+
+  // Host timed: the sensor sleeps between samples instead of waiting
+  if (host_timed) {
+    uint32_t az = (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS;
+    const tcs3430_duty_mode_t modes[2] = {TCS3430_DUTY_SAI,
+                                          TCS3430_DUTY_POWER_DOWN};
+    for (uint8_t i = 0; i < 2; i++) {
+      tcs3430_duty_plan_t sleep = best;
+      sleep.mode = modes[i];
+      sleep.wtime = 0;
+      sleep.period_us = period;
+      sleep.active_us = integration + (i ? az : 0);
+      if (period < sleep.active_us) {
+        continue;
+      }
+      sleep.latency_us = i ? sleep.active_us : period - integration;
+      estimate(&sleep, 0, period - sleep.active_us);
+      if (sleep.latency_us <= latency &&
+          (!met || sleep.current_ua < best.current_ua)) {
+        best = sleep;
+        met = true;
+      }
+    }
+  }
+  *plan = best;
+  return met;
+}
+
+/*!
+ *    @brief  Plan for the sensor's current ATIME and apply the result
+ *    @param  period_ms Longest acceptable time between samples
+ *    @param  latency_ms Longest acceptable latency, see plan()
+ *    @param  host_timed Allow SAI and POWER_DOWN
+ *    @return false if no scheme meets both limits (nothing is changed) or
+ *            on a bus error
+ */
+bool Adafruit_TCS3430_DutyCycle::begin(uint32_t period_ms,
+                                       uint32_t latency_ms, bool host_timed) {
+  tcs3430_duty_plan_t p;
+  if (!plan(period_ms, latency_ms, _sensor->getIntegrationCycles(),
+            host_timed, &p)) {
+    return false;
+  }
+  return apply(&p);
+}
+
+/*!
+ *    @brief  Configure the sensor for a plan in one applyConfig(). Every
+ *            mode sets persistence to every cycle and INT_READ_CLEAR, so
+ *            AINT marks a new sample and reading it clears the flag; SAI
+ *            also enables the ALS interrupt, which it sleeps on. Threshold
+ *            interrupts are not available while a plan runs.
+ *    @param  plan Plan from plan()
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_DutyCycle::apply(const tcs3430_duty_plan_t* plan) {
+  _running = false;
+  tcs3430_config_t config;
+  if (!_sensor->readConfig(&config)) {
+    return false;
+  }
+  config.power = plan->mode != TCS3430_DUTY_POWER_DOWN;
+  config.als_enable = true;
+  config.atime = plan->atime;
+  config.wait_enable = plan->mode == TCS3430_DUTY_WAIT ||
+                       plan->mode == TCS3430_DUTY_WAIT_LONG;
+  config.wtime = plan->wtime;
+  config.wait_long = plan->mode == TCS3430_DUTY_WAIT_LONG;
+  config.persistence = TCS3430_PERS_EVERY;
+  config.int_read_clear = true;
+  config.sleep_after_int = plan->mode == TCS3430_DUTY_SAI;
+  if (plan->mode == TCS3430_DUTY_SAI) {
+    config.als_int = true;
+  }
+  if (!_sensor->applyConfig(&config)) {
+    return false;
+  }
+  // Clear any AINT from before, so the first sample is a new one
+  tcs3430_frame_t frame;
+  if (config.power && !_sensor->readFrame(&frame)) {
+    return false;
+  }
+  _plan = *plan;
+  _awake = false;
+  _tick = _due = micros();
+  _running = true;
+  return true;
+}
+
+/*!
+ *    @brief  The plan in force
+ *    @return Plan, valid once begin() or apply() has succeeded
+ */
+const tcs3430_duty_plan_t* Adafruit_TCS3430_DutyCycle::getPlan() {
+  return &_plan;
+}
+
+/*!
+ *    @brief  Run the plan. Call often; never blocks. Host-timed modes
+ *            wake the sensor when a sample is due, free-running ones
+ *            just collect each new sample. The first sample is taken
+ *            straight after apply(), then one per period.
+ *    @param  frame Filled in on READY
+ *    @return READY with a new sample, PENDING, IDLE before apply(), or
+ *            ERROR on a bus error (poll again to retry)
+ */
+tcs3430_poll_t Adafruit_TCS3430_DutyCycle::poll(tcs3430_frame_t* frame) {
+  if (!_running) {
+    return TCS3430_POLL_IDLE;
+  }
+  uint32_t now = micros();
+  if ((int32_t)(now - _due) < 0) {
+    return TCS3430_POLL_PENDING;
+  }
+  if (_plan.mode == TCS3430_DUTY_POWER_DOWN && !_awake) {
+    if (!_sensor->powerOn(true)) {
+      return TCS3430_POLL_ERROR;
+    }
+    _awake = true;
+    _due = now + _plan.active_us;
+    return TCS3430_POLL_PENDING;
+  }
+  if (!_sensor->readFrame(frame)) {
+    return TCS3430_POLL_ERROR;
+  }
+  if (!(frame->flags & TCS3430_FRAME_INTERRUPT)) {
+    // Not done yet: the oscillator runs slow, or a cycle was in flight
+    _due = now + TCS3430_STEP_MICROS;
+    return TCS3430_POLL_PENDING;
+  }
+  if (_awake) {
+    _awake = false;
+    if (!_sensor->powerOn(false)) {
+      return TCS3430_POLL_ERROR;
+    }
+  }
+
+  if (_plan.mode == TCS3430_DUTY_SAI ||
+      _plan.mode == TCS3430_DUTY_POWER_DOWN) {
+    _tick += _plan.period_us;
+    if ((int32_t)(now - _tick) >= 0) {
+      // Polled too late for one or more ticks: start again from now
+      _tick = now + _plan.period_us;
+    }
+    _due = _tick;
+  } else {
+    // Look a step early; the sensor's oscillator sets the pace
+    _due = frame->timestamp + _plan.period_us - TCS3430_STEP_MICROS;
+  }
+  return TCS3430_POLL_READY;
+}
+
+/*!
+ *    @brief  Fill in a plan's average current from its time in each state
+ *    @param  plan Plan with period_us and active_us set
+ *    @param  wait_us Time per period in the wait state
+ *    @param  sleep_us Time per period asleep or powered down
+ */
+void Adafruit_TCS3430_DutyCycle::estimate(tcs3430_duty_plan_t* plan,
+                                          uint32_t wait_us,
+                                          uint32_t sleep_us) {
+  plan->current_ua = ((float)plan->active_us * TCS3430_IDD_ACTIVE_UA +
+                      (float)wait_us * TCS3430_IDD_WAIT_UA +
+                      (float)sleep_us * TCS3430_IDD_SLEEP_UA) /
+                     plan->period_us;
+}
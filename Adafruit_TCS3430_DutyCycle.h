@@ -0,0 +1,88 @@
+/*!
+ *  @file Adafruit_TCS3430_DutyCycle.h
+ *
+ * 	Sample period planner for the TCS3430: picks the wait, WLONG, sleep
+ * 	after interrupt or power-down scheme that meets a period and latency
+ * 	at the lowest supply current, and runs it
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_DUTYCYCLE_H
+#define _ADAFRUIT_TCS3430_DUTYCYCLE_H
+
+#include "Adafruit_TCS3430.h"
+
+// Supply current model: typical datasheet figures. Define these before
+// including the library to plan with currents measured on your board.
+#ifndef TCS3430_IDD_ACTIVE_UA
+/** Supply current while integrating or auto-zeroing, uA */
+#define TCS3430_IDD_ACTIVE_UA 100.0f
+#endif
+#ifndef TCS3430_IDD_WAIT_UA
+/** Supply current in the wait state, uA */
+#define TCS3430_IDD_WAIT_UA 30.0f
+#endif
+#ifndef TCS3430_IDD_SLEEP_UA
+/** Supply current powered down or asleep after an interrupt, uA */
+#define TCS3430_IDD_SLEEP_UA 0.7f
+#endif
+
+/** How samples are paced */
+typedef enum {
+  TCS3430_DUTY_CONTINUOUS, ///< Back-to-back integrations, wait off
+  TCS3430_DUTY_WAIT,       ///< WTIME wait after each integration
+  TCS3430_DUTY_WAIT_LONG,  ///< WTIME x12 (WLONG) wait after each integration
+  TCS3430_DUTY_SAI,        ///< Host timed, asleep (SAI) between samples
+  TCS3430_DUTY_POWER_DOWN  ///< Host timed, powered down between samples
+} tcs3430_duty_mode_t;
+
+/** A planned duty cycle and what it achieves */
+typedef struct {
+  tcs3430_duty_mode_t mode; ///< Pacing scheme
+  uint8_t atime;            ///< ATIME it was planned for
+  uint8_t wtime;            ///< WTIME for the wait modes
+  uint32_t period_us;       ///< Time between samples
+  uint32_t latency_us;      ///< Worst-case sample age or wait, see plan()
+  uint32_t active_us;       ///< Integration (and auto-zero) per sample
+  float current_ua;         ///< Estimated average supply current
+} tcs3430_duty_plan_t;
+
+/*!
+ *    @brief  Duty cycle planner and runner. The free-running modes use the
+ *            sensor's own wait timer (the INT pin can wake the host); the
+ *            host-timed modes sleep the sensor between samples and need
+ *            poll() called on time, but draw much less current.
+ */
+class Adafruit_TCS3430_DutyCycle {
+ public:
+  Adafruit_TCS3430_DutyCycle(Adafruit_TCS3430* sensor);
+
+  static bool plan(uint32_t period_ms, uint32_t latency_ms, uint8_t atime,
+                   bool host_timed, tcs3430_duty_plan_t* plan);
+  bool begin(uint32_t period_ms, uint32_t latency_ms, bool host_timed = true);
+  bool apply(const tcs3430_duty_plan_t* plan);
+  const tcs3430_duty_plan_t* getPlan();
+  tcs3430_poll_t poll(tcs3430_frame_t* frame);
+
+ private:
+  static void estimate(tcs3430_duty_plan_t* plan, uint32_t wait_us,
+                       uint32_t sleep_us);
+
+  Adafruit_TCS3430* _sensor;   ///< Sensor being paced
+  tcs3430_duty_plan_t _plan;   ///< Plan in force
+  bool _running = false;       ///< apply() succeeded
+  bool _awake = false;         ///< POWER_DOWN: powered up for a sample
+  uint32_t _tick = 0;          ///< micros() the next sample is due
+  uint32_t _due = 0;           ///< micros() of the next bus access
+};
+
+#endif
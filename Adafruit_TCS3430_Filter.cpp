@@ -0,0 +1,206 @@
+/*!
+ *  @file Adafruit_TCS3430_Filter.cpp
+ *
+ * 	Heap-free, fixed-point streaming filter for TCS3430 frames
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Filter.h"
+
+/*!
+ *    @brief  Round an IIR state to whole counts
+ *    @param  state IIR state, TCS3430_FILTER_IIR_FRAC fractional bits
+ *    @return Counts
+ */
+static uint16_t iirOutput(int32_t state) {
+  return (state + ((int32_t)1 << (TCS3430_FILTER_IIR_FRAC - 1))) >>
+         TCS3430_FILTER_IIR_FRAC;
+}
+
+/*!
+ *    @brief  Configure every stage and start from empty
+ *    @param  decimation Input frames per output frame, 1 to 255
+ *    @param  iir_shift Smoothing: each output moves 1/2^shift of the way to
+ *            the new sample; 0 turns the IIR off
+ *    @param  median_taps Median length, odd and at most the capacity; 1
+ *            turns the median off
+ *    @return false if median_taps is not supported (the median is off)
+ */
+bool Adafruit_TCS3430_FilterBase::begin(uint8_t decimation, uint8_t iir_shift,
+                                        uint8_t median_taps) {
+  setDecimation(decimation);
+  setIIR(iir_shift);
+  bool ok = setMedian(median_taps);
+  if (!ok) {
+    _taps = 1;
+  }
+  reset();
+  return ok;
+}
+
+/*!
+ *    @brief  Set how many input frames make one output frame. Restarts
+ *            the current window.
+ *    @param  decimation Frames per output, 0 is taken as 1
+ */
+void Adafruit_TCS3430_FilterBase::setDecimation(uint8_t decimation) {
+  _decimation = decimation ? decimation : 1;
+  _count = 0;
+  _flags = 0;
+}
+
+/*!
+ *    @brief  Set the IIR smoothing. The time constant is about 2^shift
+ *            input frames.
+ *    @param  shift 0 (off) to 15
+ */
+void Adafruit_TCS3430_FilterBase::setIIR(uint8_t shift) {
+  _shift = shift > 15 ? 15 : shift;
+}
+
+/*!
+ *    @brief  Set the median length. Clears the median history.
+ *    @param  taps Odd, from 1 (off) to the filter's capacity
+ *    @return false (and nothing changes) if taps is not supported
+ */
+bool Adafruit_TCS3430_FilterBase::setMedian(uint8_t taps) {
+  if (!(taps & 1) || taps > _capacity) {
+    return false;
+  }
+  _taps = taps;
+  _filled = 0;
+  _next = 0;
+  return true;
+}
+
+/*!
+ *    @brief  Forget all history: the median, the IIR state and the
+ *            current window. Call after changing gain or integration time,
+ *            since counts before and after are not comparable.
+ */
+void Adafruit_TCS3430_FilterBase::reset() {
+  _filled = 0;
+  _next = 0;
+  _primed = false;
+  _count = 0;
+  _flags = 0;
+}
+
+/*!
+ *    @brief  Feed one frame. Frames without TCS3430_FRAME_VALID are
+ *            ignored. A change of CH3 source (X / IR2) resets the filter,
+ *            so the two are never mixed.
+ *    @param  frame Frame from readFrame(), poll() or the capture ring
+ *    @param  out Filled in when a window completes
+ *    @return true if out holds a new output frame
+ */
+bool Adafruit_TCS3430_FilterBase::update(const tcs3430_frame_t* frame,
+                                         tcs3430_filtered_t* out) {
+  if (!(frame->flags & TCS3430_FRAME_VALID)) {
+    return false;
+  }
+  uint8_t ch3_mode = frame->flags & TCS3430_FRAME_CH3_IR2;
+  if (ch3_mode != _ch3_mode) {
+    reset();
+    _ch3_mode = ch3_mode;
+  }
+
+  const uint16_t sample[TCS3430_FILTER_CHANNELS] = {frame->z, frame->y,
+                                                     frame->ir1, frame->ch3};
+  uint8_t slot = _next;
+  _next = (uint8_t)(slot + 1) >= _taps ? 0 : slot + 1;
+  if (_filled < _taps) {
+    _filled++;
+  }
+  bool first = (_count == 0);
+  _count++;
+
+  for (uint8_t c = 0; c < TCS3430_FILTER_CHANNELS; c++) {
+    uint16_t x = sample[c];
+    _history[c * _capacity + slot] = x;
+    int32_t filtered = (int32_t)median(c) << TCS3430_FILTER_IIR_FRAC;
+    if (_primed && _shift) {
+      // Round each step to nearest, ties towards the old value, so the
+      // state ends within half a count of a constant input
+      int32_t diff = filtered - _iir[c];
+      int32_t half = ((int32_t)1 << (_shift - 1)) - (diff < 0);
+      _iir[c] += (diff + half) >> _shift;
+    } else {
+      _iir[c] = filtered;
+    }
+
+    // Welford on the raw counts, mean in 1/256ths
+    int32_t xq = (int32_t)x << 8;
+    if (first) {
+      _min[c] = x;
+      _max[c] = x;
+      _mean[c] = xq;
+      _m2[c] = 0;
+      continue;
+    }
+    if (x < _min[c]) {
+      _min[c] = x;
+    }
+    if (x > _max[c]) {
+      _max[c] = x;
+    }
+    int32_t delta = xq - _mean[c];
+    _mean[c] += delta / _count;
+    _m2[c] += (uint64_t)((int64_t)delta * (xq - _mean[c]));
+  }
+  _primed = true;
+  _flags |= frame->flags;
+
+  if (_count < _decimation) {
+    return false;
+  }
+  out->timestamp = frame->timestamp;
+  out->z = iirOutput(_iir[TCS3430_FILTER_Z]);
+  out->y = iirOutput(_iir[TCS3430_FILTER_Y]);
+  out->ir1 = iirOutput(_iir[TCS3430_FILTER_IR1]);
+  out->ch3 = iirOutput(_iir[TCS3430_FILTER_CH3]);
+  out->flags = _flags;
+  out->count = _count;
+  for (uint8_t c = 0; c < TCS3430_FILTER_CHANNELS; c++) {
+    out->stats[c].min = _min[c];
+    out->stats[c].max = _max[c];
+    out->stats[c].mean = (_mean[c] + 128) >> 8;
+    out->stats[c].variance = (uint32_t)((_m2[c] / _count) >> 16);
+  }
+  _count = 0;
+  _flags = 0;
+  return true;
+}
+
+/*!
+ *    @brief  Median of a channel's history. While the history is still
+ *            filling, the median of the samples so far.
+ *    @param  channel tcs3430_filter_ch_t
+ *    @return Median count
+ */
+uint16_t Adafruit_TCS3430_FilterBase::median(uint8_t channel) {
+  const uint16_t* row = &_history[channel * _capacity];
+  if (_filled == 1) {
+    return row[0];
+  }
+  uint16_t sorted[TCS3430_FILTER_MAX_TAPS];
+  for (uint8_t i = 0; i < _filled; i++) {
+    uint16_t v = row[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > v) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = v;
+  }
+  return sorted[_filled / 2];
+}
@@ -0,0 +1,129 @@
+/*!
+ *  @file Adafruit_TCS3430_Filter.h
+ *
+ * 	Heap-free, fixed-point streaming filter for TCS3430 frames: median
+ * 	spike rejection, exponential smoothing and K:1 decimation with
+ * 	per-window statistics
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_FILTER_H
+#define _ADAFRUIT_TCS3430_FILTER_H
+
+#include "Adafruit_TCS3430.h"
+
+/** Channels carried by a frame, in tcs3430_frame_t order */
+#define TCS3430_FILTER_CHANNELS 4
+/** Longest median supported */
+#define TCS3430_FILTER_MAX_TAPS 15
+/** Fractional bits of the IIR state; at least the largest shift, so the
+    output settles on a constant input */
+#define TCS3430_FILTER_IIR_FRAC 15
+
+/** Index of each channel in tcs3430_filtered_t::stats */
+typedef enum {
+  TCS3430_FILTER_Z,   ///< CH0: Z
+  TCS3430_FILTER_Y,   ///< CH1: Y
+  TCS3430_FILTER_IR1, ///< CH2: IR1
+  TCS3430_FILTER_CH3  ///< CH3: X or IR2
+} tcs3430_filter_ch_t;
+
+/** Raw-count statistics of one channel over a decimation window */
+typedef struct {
+  uint16_t min;      ///< Smallest raw count
+  uint16_t max;      ///< Largest raw count
+  uint16_t mean;     ///< Mean raw count, rounded
+  uint32_t variance; ///< Population variance, counts squared
+} tcs3430_channel_stats_t;
+
+/** One filtered output frame, produced once per decimation window */
+typedef struct {
+  uint32_t timestamp; ///< Timestamp of the last input frame in the window
+  uint16_t z;         ///< Filtered CH0: Z
+  uint16_t y;         ///< Filtered CH1: Y
+  uint16_t ir1;       ///< Filtered CH2: IR1
+  uint16_t ch3;       ///< Filtered CH3: X or IR2, see TCS3430_FRAME_CH3_IR2
+  uint8_t flags;      ///< TCS3430_FRAME_* flags OR'd over the window
+  uint8_t count;      ///< Input frames in the window
+  tcs3430_channel_stats_t stats[TCS3430_FILTER_CHANNELS]; ///< Per channel
+} tcs3430_filtered_t;
+
+/*!
+ *    @brief  Streaming filter, independent of median capacity, so code can
+ *            take any Adafruit_TCS3430_Filter<TAPS>. Each valid frame goes
+ *            through an N-tap median, then an exponential IIR
+ *            (y += (x - y) / 2^shift, 15 fractional bits), and every K
+ *            frames one output frame is emitted along with the min, max,
+ *            mean and variance (Welford) of the raw counts in the window.
+ */
+class Adafruit_TCS3430_FilterBase {
+ public:
+  bool begin(uint8_t decimation = 1, uint8_t iir_shift = 0,
+             uint8_t median_taps = 1);
+  void setDecimation(uint8_t decimation);
+  void setIIR(uint8_t shift);
+  bool setMedian(uint8_t taps);
+  void reset();
+  bool update(const tcs3430_frame_t* frame, tcs3430_filtered_t* out);
+
+ protected:
+  /*!
+   *    @brief  Bind the filter to its median history
+   *    @param  history Array of TCS3430_FILTER_CHANNELS * capacity samples
+   *    @param  capacity Most median taps supported
+   */
+  Adafruit_TCS3430_FilterBase(uint16_t* history, uint8_t capacity)
+      : _history(history), _capacity(capacity) {}
+
+ private:
+  uint16_t median(uint8_t channel);
+
+  uint16_t* _history;             ///< Median history, one row per channel
+  uint8_t _capacity;              ///< Rows' length
+  uint8_t _taps = 1;              ///< Median taps in use, odd
+  uint8_t _filled = 0;            ///< Samples in the median history
+  uint8_t _next = 0;              ///< History slot written next
+  uint8_t _shift = 0;             ///< IIR shift, 0 for no smoothing
+  uint8_t _decimation = 1;        ///< Input frames per output frame
+  bool _primed = false;           ///< IIR state holds a sample
+  uint8_t _ch3_mode = 0;          ///< TCS3430_FRAME_CH3_IR2 of the history
+  uint8_t _count = 0;             ///< Frames in the current window
+  uint8_t _flags = 0;             ///< Flags OR'd over the window
+  int32_t _iir[TCS3430_FILTER_CHANNELS];   ///< IIR state, 15 fraction bits
+  uint16_t _min[TCS3430_FILTER_CHANNELS];  ///< Window minimum
+  uint16_t _max[TCS3430_FILTER_CHANNELS];  ///< Window maximum
+  int32_t _mean[TCS3430_FILTER_CHANNELS];  ///< Welford mean, 8 fraction bits
+  uint64_t _m2[TCS3430_FILTER_CHANNELS];   ///< Welford M2, 16 fraction bits
+};
+
+/*!
+ *    @brief  Streaming filter with storage for up to TAPS median taps
+ *    @tparam TAPS Longest median, odd, from 1 to 15
+ */
+template <uint8_t TAPS>
+class Adafruit_TCS3430_Filter : public Adafruit_TCS3430_FilterBase {
+  static_assert(TAPS >= 1 && TAPS <= TCS3430_FILTER_MAX_TAPS && (TAPS & 1),
+                "Median taps must be odd, from 1 to 15");
+
+ public:
+  /*!
+   *    @brief  Create a filter that passes frames through unchanged until
+   *            begin() configures it
+   */
+  Adafruit_TCS3430_Filter()
+      : Adafruit_TCS3430_FilterBase(_storage, TAPS) {}
+
+ private:
+  uint16_t _storage[TCS3430_FILTER_CHANNELS * TAPS]; ///< Median history
+};
+
+#endif
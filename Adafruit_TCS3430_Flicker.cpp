@@ -0,0 +1,186 @@
+/*!
+ *  @file Adafruit_TCS3430_Flicker.cpp
+ *
+ * 	High-rate Y capture and flicker measurement for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Flicker.h"
+
+/** Longest gap between samples before capture() gives up: room for the
+ *  auto-zero pass that may precede an integration */
+#define TCS3430_FLICKER_TIMEOUT_US (10 * (uint32_t)TCS3430_STEP_MICROS)
+
+/*!
+ *    @brief  Instantiates a flicker meter
+ *    @param  sensor Sensor to sample, already begun
+ */
+Adafruit_TCS3430_Flicker::Adafruit_TCS3430_Flicker(Adafruit_TCS3430* sensor)
+    : _sensor(sensor) {}
+
+/*!
+ *    @brief  Capture Y once per ALS cycle at the fastest cycle the sensor
+ *            has: ATIME=0, wait off. With persistence 0 every cycle sets
+ *            AINT and INT_READ_CLEAR clears it on the STATUS read, so
+ *            back-to-back frame reads tell new data from old without any
+ *            pacing guesswork. Each timestamp is the midpoint between the
+ *            read that found the sample and the one before, so it is
+ *            within half a frame read of the end of the integration
+ *            (about 0.55 ms at 100 kHz, 0.15 ms with Wire at 400 kHz). The
+ *            previous settings are restored afterwards; the INT pin stays
+ *            quiet throughout. Not for use with beginCapture() or
+ *            interleaved mode running.
+ *    @param  samples Array to fill
+ *    @param  count Number of samples to capture
+ *    @return true if every sample was captured and the settings restored
+ */
+bool Adafruit_TCS3430_Flicker::capture(tcs3430_flicker_sample_t* samples,
+                                       uint16_t count) {
+  if (count == 0) {
+    return false;
+  }
+  tcs3430_config_t saved;
+  if (!_sensor->readConfig(&saved)) {
+    return false;
+  }
+  tcs3430_config_t fast = saved;
+  fast.power = true;
+  fast.als_enable = true;
+  fast.wait_enable = false;
+  fast.atime = 0;
+  fast.persistence = TCS3430_PERS_EVERY;
+  fast.int_read_clear = true;
+  fast.sleep_after_int = false;
+  fast.saturation_int = false;
+  fast.als_int = false;
+  if (!_sensor->applyConfig(&fast)) {
+    return false;
+  }
+
+  // The first read clears any AINT left from before the switch
+  tcs3430_frame_t frame;
+  bool ok = _sensor->readFrame(&frame);
+  uint32_t last_read = frame.timestamp;
+  uint32_t last_sample = last_read;
+  uint16_t i = 0;
+  while (ok && i < count) {
+    ok = _sensor->readFrame(&frame);
+    if (!ok) {
+      break;
+    }
+    if (frame.flags & TCS3430_FRAME_INTERRUPT) {
+      samples[i].timestamp = last_read + (frame.timestamp - last_read) / 2;
+      samples[i].y = frame.y;
+      i++;
+      last_sample = frame.timestamp;
+    } else if (frame.timestamp - last_sample > TCS3430_FLICKER_TIMEOUT_US) {
+      ok = false;
+    }
+    last_read = frame.timestamp;
+  }
+
+  if (!_sensor->applyConfig(&saved)) {
+    ok = false;
+  }
+  return ok;
+}
+
+/*!
+ *    @brief  Measure flicker in a capture, without floating point.
+ *            Percent flicker is 100 * (max - min) / (max + min); the
+ *            flicker index is the area above the mean over the total area.
+ *            The frequency comes from rising crossings of the mean, with
+ *            a hysteresis of 1/8 of the swing to ignore noise, each
+ *            crossing time interpolated between the samples either side.
+ *    @param  samples Samples from capture()
+ *    @param  count Number of samples, at least 2
+ *    @param  result Filled with the measurement; frequency is 0 when
+ *            fewer than two crossings are found
+ *    @return false if there are too few samples
+ */
+bool Adafruit_TCS3430_Flicker::analyze(const tcs3430_flicker_sample_t* samples,
+                                       uint16_t count,
+                                       tcs3430_flicker_t* result) {
+  if (count < 2) {
+    return false;
+  }
+  uint32_t sum = 0;
+  uint16_t lo = 0xFFFF, hi = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t y = samples[i].y;
+    sum += y;
+    if (y < lo) {
+      lo = y;
+    }
+    if (y > hi) {
+      hi = y;
+    }
+  }
+  uint16_t mean = sum / count;
+  result->min = lo;
+  result->max = hi;
+  result->mean = mean;
+  result->interval_us =
+      (samples[count - 1].timestamp - samples[0].timestamp) / (count - 1);
+  result->percent =
+      (lo + hi) ? (uint32_t)(hi - lo) * 100 * 256 / ((uint32_t)lo + hi) : 0;
+
+  uint32_t above = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (samples[i].y > mean) {
+      above += samples[i].y - mean;
+    }
+  }
+  result->index = sum ? (uint64_t)above * 32768 / sum : 0;
+
+  result->frequency_mhz = 0;
+  uint16_t hysteresis = (hi - lo) / 8;
+  if (hysteresis == 0) {
+    return true;
+  }
+  int32_t low = (int32_t)mean - hysteresis;
+  int32_t high = (int32_t)mean + hysteresis;
+  bool armed = false;
+  uint16_t below = 0;
+  uint16_t crossings = 0;
+  uint32_t first = 0, last = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t y = samples[i].y;
+    if ((int32_t)y < low) {
+      armed = true;
+    }
+    if (!armed) {
+      continue;
+    }
+    if (y <= mean) {
+      below = i;
+    } else if ((int32_t)y > high) {
+      // The mean is crossed between samples below and below + 1
+      const tcs3430_flicker_sample_t* a = &samples[below];
+      const tcs3430_flicker_sample_t* b = &samples[below + 1];
+      uint32_t at = a->timestamp + (uint64_t)(mean - a->y) *
+                                       (b->timestamp - a->timestamp) /
+                                       (b->y - a->y);
+      if (crossings == 0) {
+        first = at;
+      }
+      last = at;
+      crossings++;
+      armed = false;
+    }
+  }
+  if (crossings >= 2 && last != first) {
+    result->frequency_mhz =
+        (uint64_t)(crossings - 1) * 1000000000 / (last - first);
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+/*!
+ *  @file Adafruit_TCS3430_Flicker.h
+ *
+ * 	High-rate Y capture and flicker measurement (frequency, percent
+ * 	flicker, flicker index) for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_FLICKER_H
+#define _ADAFRUIT_TCS3430_FLICKER_H
+
+#include "Adafruit_TCS3430.h"
+
+/** One CH1 (Y) sample from a flicker capture */
+typedef struct {
+  uint32_t timestamp; ///< micros() estimate of the end of the integration
+  uint16_t y;         ///< CH1: Y
+} tcs3430_flicker_sample_t;
+
+/** Flicker measurement over a capture */
+typedef struct {
+  uint32_t frequency_mhz; ///< Dominant frequency in millihertz, 0 if none
+  uint16_t percent;       ///< Percent flicker, Q8 (256 = 1%)
+  uint16_t index;         ///< Flicker index, Q15 (32768 = 1.0)
+  uint16_t min;           ///< Smallest sample
+  uint16_t max;           ///< Largest sample
+  uint16_t mean;          ///< Mean sample
+  uint32_t interval_us;   ///< Mean time between samples
+} tcs3430_flicker_t;
+
+/*!
+ *    @brief  Flicker mode. capture() runs the sensor at ATIME=0 (2.78 ms,
+ *            about 360 samples/s) with wait off and collects Y once per
+ *            cycle; analyze() estimates the flicker from the samples.
+ *            Frequencies above half the sample rate (about 180 Hz) alias.
+ */
+class Adafruit_TCS3430_Flicker {
+ public:
+  Adafruit_TCS3430_Flicker(Adafruit_TCS3430* sensor);
+
+  bool capture(tcs3430_flicker_sample_t* samples, uint16_t count);
+  static bool analyze(const tcs3430_flicker_sample_t* samples,
+                      uint16_t count, tcs3430_flicker_t* result);
+
+ private:
+  Adafruit_TCS3430* _sensor; ///< Sensor being sampled
+};
+
+#endif
@@ -0,0 +1,287 @@
+/*!
+ *  @file Adafruit_TCS3430_HDR.cpp
+ *
+ * 	Extended-range (HDR) measurement for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_HDR.h"
+
+/** Exposure index of the high sensitivity setting */
+#define HDR_HIGH 0
+/** Exposure index of the low sensitivity setting */
+#define HDR_LOW 1
+
+/*!
+ *    @brief  Instantiates an HDR controller
+ *    @param  sensor Sensor to drive, already begun
+ */
+Adafruit_TCS3430_HDR::Adafruit_TCS3430_HDR(Adafruit_TCS3430* sensor)
+    : _sensor(sensor) {}
+
+/*!
+ *    @brief  Start alternating exposures. Sets persistence to every
+ *            cycle, the ALS interrupt and SAI, with the wait off and AMUX
+ *            on X, in one applyConfig(); end() puts the old settings
+ *            back. Threshold interrupts are not available meanwhile.
+ *    @param  high High sensitivity exposure, for the shadows
+ *    @param  low Low sensitivity exposure, for the highlights; should
+ *            collect at least 8x less light than high
+ *    @param  change_percent Y or Z change between two reads of one
+ *            exposure flagged as TCS3430_FRAME_CHANGED
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_HDR::begin(tcs3430_exposure_t high,
+                                 tcs3430_exposure_t low,
+                                 uint8_t change_percent) {
+  _running = false;
+  _exposure[HDR_HIGH] = high;
+  _exposure[HDR_LOW] = low;
+  _change_pct = change_percent;
+  _have[HDR_HIGH] = _have[HDR_LOW] = false;
+  if (!_sensor->readConfig(&_restore)) {
+    return false;
+  }
+
+  tcs3430_config_t config = _restore;
+  config.power = true;
+  config.als_enable = true;
+  config.wait_enable = false;
+  config.atime = high.atime;
+  config.gain = high.gain;
+  config.amux_ir2 = false;
+  config.persistence = TCS3430_PERS_EVERY;
+  config.int_read_clear = false;
+  config.sleep_after_int = true;
+  config.als_int = true;
+  if (!_sensor->applyConfig(&config) || !_sensor->clearALSInterrupt()) {
+    return false;
+  }
+  _current = HDR_HIGH;
+  _due = micros() + (uint32_t)(high.atime + 1) * TCS3430_STEP_MICROS;
+  _running = true;
+  return true;
+}
+
+/*!
+ *    @brief  Stop alternating and restore the settings from before
+ *            begin()
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_HDR::end() {
+  if (!_running) {
+    return true;
+  }
+  _running = false;
+  return _sensor->applyConfig(&_restore) && _sensor->clearALSInterrupt();
+}
+
+/*!
+ *    @brief  Run the exposures. Call often; never blocks. When an
+ *            integration has finished, reads it, starts the other
+ *            exposure and fuses the two latest.
+ *    @param  frame Filled in on READY. Flags: VALID; SATURATED if a
+ *            channel is past the knee even in the low exposure (it
+ *            holds the low exposure's value, a lower bound); CHANGED if
+ *            the newer exposure moved by more than change_percent since
+ *            its previous read, so the pair may not match.
+ *    @return READY with a fused frame, PENDING, IDLE before begin(), or
+ *            ERROR on a bus error (poll again to retry)
+ */
+tcs3430_poll_t Adafruit_TCS3430_HDR::poll(tcs3430_hdr_frame_t* frame) {
+  if (!_running) {
+    return TCS3430_POLL_IDLE;
+  }
+  uint32_t now = micros();
+  if ((int32_t)(now - _due) < 0) {
+    return TCS3430_POLL_PENDING;
+  }
+  tcs3430_frame_t f;
+  if (!_sensor->readFrame(&f)) {
+    return TCS3430_POLL_ERROR;
+  }
+  if (!(f.flags & TCS3430_FRAME_INTERRUPT)) {
+    // Still integrating: auto-zero ran first, or the oscillator is slow
+    _due = now + TCS3430_STEP_MICROS / 2;
+    return TCS3430_POLL_PENDING;
+  }
+
+  // Asleep until the interrupt is cleared: switch while nothing runs
+  uint8_t done = _current;
+  _moved = _have[done] && moved(done, &_last[done], &f);
+  _last[done] = f;
+  _have[done] = true;
+  if (!switchTo(done ^ 1)) {
+    return TCS3430_POLL_ERROR;
+  }
+  if (!_have[done ^ 1]) {
+    return TCS3430_POLL_PENDING;
+  }
+  fuse(frame);
+  return TCS3430_POLL_READY;
+}
+
+/*!
+ *    @brief  Ratio of the brightest to the faintest level the two
+ *            exposures resolve: the low exposure's knee over one count of
+ *            the high exposure
+ *    @return Dynamic range, e.g. 1000000 for 120 dB
+ */
+uint32_t Adafruit_TCS3430_HDR::getDynamicRange() {
+  uint32_t top = normalize(
+      (uint32_t)Adafruit_TCS3430::fullScale(_exposure[HDR_LOW].atime) *
+          TCS3430_HDR_KNEE / 256,
+      _exposure[HDR_LOW]);
+  uint32_t lsb = normalize(1, _exposure[HDR_HIGH]);
+  return lsb ? top / lsb : top;
+}
+
+/*!
+ *    @brief  Convert counts to Q16 counts per step at 1x gain
+ *    @param  counts Raw channel counts
+ *    @param  exposure Setting they were taken at
+ *    @return Normalised value, rounded to nearest
+ */
+uint32_t Adafruit_TCS3430_HDR::normalize(uint16_t counts,
+                                         tcs3430_exposure_t exposure) {
+  uint32_t div = (uint32_t)Adafruit_TCS3430::gainMultiplier(exposure.gain) *
+                 (exposure.atime + 1);
+  return (((uint64_t)counts << 16) + div / 2) / div;
+}
+
+/*!
+ *    @brief  Apply a color matrix to a fused frame
+ *    @param  frame Fused frame
+ *    @param  xyz Tristimulus values per step at 1x gain; for lux use
+ *            Adafruit_TCS3430_Color::lux(xyz->Y, TCS3430_GAIN_1X, 0)
+ *    @param  matrix Color matrix, NULL for the default
+ */
+void Adafruit_TCS3430_HDR::toXYZ(const tcs3430_hdr_frame_t* frame,
+                                 tcs3430_xyz_t* xyz,
+                                 const tcs3430_matrix_t* matrix) {
+  const float* m =
+      (matrix ? matrix : Adafruit_TCS3430_Color::defaultMatrix())->m;
+  const float scale = 1.0f / 65536;
+  float ch[4] = {frame->x * scale, frame->y * scale, frame->z * scale,
+                 frame->ir1 * scale};
+  float out[3];
+  for (uint8_t row = 0; row < 3; row++) {
+    out[row] = m[row * 4] * ch[0] + m[row * 4 + 1] * ch[1] +
+               m[row * 4 + 2] * ch[2] + m[row * 4 + 3] * ch[3];
+  }
+  xyz->X = out[0];
+  xyz->Y = out[1];
+  xyz->Z = out[2];
+}
+
+/*!
+ *    @brief  Load an exposure and start its integration
+ *    @param  index Exposure to switch to
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_HDR::switchTo(uint8_t index) {
+  const tcs3430_exposure_t& e = _exposure[index];
+  if (!_sensor->setIntegrationCycles(e.atime) ||
+      !_sensor->setALSGain(e.gain) || !_sensor->clearALSInterrupt()) {
+    return false;
+  }
+  _current = index;
+  _due = micros() + (uint32_t)(e.atime + 1) * TCS3430_STEP_MICROS;
+  return true;
+}
+
+/*!
+ *    @brief  Check whether the light moved between two reads of the same
+ *            exposure, by Y and Z like interleaved acquisition. Only
+ *            channels the exposure contributes to the fused frame count,
+ *            so the noise of a few counts in the low exposure of a dim
+ *            scene does not flag every frame.
+ *    @param  index Exposure both frames were taken at
+ *    @param  before Earlier frame
+ *    @param  after Later frame
+ *    @return true if Y or Z changed by more than change_percent
+ */
+bool Adafruit_TCS3430_HDR::moved(uint8_t index, const tcs3430_frame_t* before,
+                                 const tcs3430_frame_t* after) {
+  const tcs3430_frame_t& hi = index == HDR_HIGH ? *after : _last[HDR_HIGH];
+  uint32_t knee_hi =
+      (uint32_t)Adafruit_TCS3430::fullScale(_exposure[HDR_HIGH].atime) *
+      TCS3430_HDR_KNEE / 256;
+  bool hi_sat = hi.status & TCS3430_STATUS_ASAT;
+  const uint16_t a[2] = {before->y, before->z};
+  const uint16_t b[2] = {after->y, after->z};
+  const uint16_t h[2] = {hi.y, hi.z};
+  for (uint8_t i = 0; i < 2; i++) {
+    bool used = index == HDR_HIGH ? !hi_sat && h[i] < knee_hi
+                                  : hi_sat || h[i] > knee_hi / 2;
+    if (!used) {
+      continue;
+    }
+    uint32_t diff = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    uint32_t ref = a[i] > b[i] ? a[i] : b[i];
+    if (diff * 100 > ref * _change_pct) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+ *    @brief  Blend the latest high and low exposure channel by channel
+ *    @param  frame Destination
+ */
+void Adafruit_TCS3430_HDR::fuse(tcs3430_hdr_frame_t* frame) {
+  const tcs3430_frame_t& hi = _last[HDR_HIGH];
+  const tcs3430_frame_t& lo = _last[HDR_LOW];
+  uint32_t knee_hi =
+      (uint32_t)Adafruit_TCS3430::fullScale(_exposure[HDR_HIGH].atime) *
+      TCS3430_HDR_KNEE / 256;
+  uint32_t knee_lo =
+      (uint32_t)Adafruit_TCS3430::fullScale(_exposure[HDR_LOW].atime) *
+      TCS3430_HDR_KNEE / 256;
+  bool hi_sat = hi.status & TCS3430_STATUS_ASAT;
+  bool lo_sat = lo.status & TCS3430_STATUS_ASAT;
+
+  const uint16_t raw_hi[4] = {hi.ch3, hi.y, hi.z, hi.ir1};
+  const uint16_t raw_lo[4] = {lo.ch3, lo.y, lo.z, lo.ir1};
+  uint32_t out[4];
+  frame->flags = TCS3430_FRAME_VALID;
+  frame->low_mask = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    uint32_t v_hi = normalize(raw_hi[i], _exposure[HDR_HIGH]);
+    uint32_t v_lo = normalize(raw_lo[i], _exposure[HDR_LOW]);
+    if (hi_sat || raw_hi[i] >= knee_hi) {
+      out[i] = v_lo;
+      frame->low_mask |= 1 << i;
+      if (lo_sat || raw_lo[i] >= knee_lo) {
+        frame->flags |= TCS3430_FRAME_SATURATED;
+      }
+      continue;
+    }
+    if (raw_hi[i] <= knee_hi / 2) {
+      out[i] = v_hi;
+    } else {
+      // Crossfade: all high at half the knee, all low at the knee
+      uint32_t w = (knee_hi - raw_hi[i]) * 256 / (knee_hi - knee_hi / 2);
+      out[i] = ((uint64_t)v_hi * w + (uint64_t)v_lo * (256 - w)) >> 8;
+      frame->low_mask |= 1 << i;
+    }
+  }
+  if (_moved) {
+    frame->flags |= TCS3430_FRAME_CHANGED;
+  }
+  frame->timestamp = _last[_current ^ 1].timestamp;
+  frame->x = out[0];
+  frame->y = out[1];
+  frame->z = out[2];
+  frame->ir1 = out[3];
+}
@@ -0,0 +1,102 @@
+/*!
+ *  @file Adafruit_TCS3430_HDR.h
+ *
+ * 	Extended-range (HDR) measurement for the TCS3430: alternates a high
+ * 	and a low sensitivity exposure and fuses them into 32-bit channels
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HDR_H
+#define _ADAFRUIT_TCS3430_HDR_H
+
+#include "Adafruit_TCS3430_Color.h"
+
+/*
+ * Fused channels are in Q16 counts per 2.78 ms step at 1x gain: each
+ * exposure's counts divided by gainMultiplier(gain) * (ATIME + 1). That
+ * unit is the same for both exposures, so they blend directly, and it
+ * tops out at 1024 (the ADC's per-step limit), so Q16 fits 32 bits with
+ * resolution to spare at 128x. The Color functions take it like raw
+ * counts at 1x and ATIME 0: rawToXYZ via toXYZ(), then
+ * lux(xyz.Y, TCS3430_GAIN_1X, 0).
+ *
+ * Each channel comes from the high exposure while it is below half the
+ * saturation knee, from the low exposure above the knee, and is a linear
+ * crossfade of the two in between, so the fused value is continuous as
+ * the light rises through the switch-over. A frame with ASAT set is not
+ * used for any channel.
+ */
+
+/** Fraction of full scale, in 1/256, above which a channel is not used */
+#define TCS3430_HDR_KNEE 224
+
+/** One exposure setting */
+typedef struct {
+  tcs3430_gain_t gain; ///< ALS gain, TCS3430_GAIN_128X for HGAIN
+  uint8_t atime;       ///< Integration steps - 1
+} tcs3430_exposure_t;
+
+/** An extended-range sample */
+typedef struct {
+  uint32_t timestamp; ///< micros() when the newer exposure was read
+  uint32_t x;         ///< CH3 (X), Q16 counts per step at 1x
+  uint32_t y;         ///< CH1 (Y), Q16 counts per step at 1x
+  uint32_t z;         ///< CH0 (Z), Q16 counts per step at 1x
+  uint32_t ir1;       ///< CH2 (IR1), Q16 counts per step at 1x
+  uint8_t flags;      ///< TCS3430_FRAME_* flags, see poll()
+  uint8_t low_mask;   ///< Channels using the low exposure: X, Y, Z, IR1 bits
+} tcs3430_hdr_frame_t;
+
+/*!
+ *    @brief  HDR acquisition. The sensor sleeps after each integration
+ *            (SAI), so switching exposure never mixes settings within an
+ *            integration and needs no timing prediction; poll() reads
+ *            the result, switches, and clears the interrupt to start the
+ *            next integration. Every exposure produces a fused frame with
+ *            the latest of the other, so there is no settling time.
+ *            Turn the register cache on (enableRegisterCache()) to save
+ *            the read half of each settings write.
+ */
+class Adafruit_TCS3430_HDR {
+ public:
+  Adafruit_TCS3430_HDR(Adafruit_TCS3430* sensor);
+
+  bool begin(tcs3430_exposure_t high = {TCS3430_GAIN_128X, 35},
+             tcs3430_exposure_t low = {TCS3430_GAIN_1X, 8},
+             uint8_t change_percent = 10);
+  bool end();
+  tcs3430_poll_t poll(tcs3430_hdr_frame_t* frame);
+  uint32_t getDynamicRange();
+
+  static uint32_t normalize(uint16_t counts, tcs3430_exposure_t exposure);
+  static void toXYZ(const tcs3430_hdr_frame_t* frame, tcs3430_xyz_t* xyz,
+                    const tcs3430_matrix_t* matrix = NULL);
+
+ private:
+  bool switchTo(uint8_t index);
+  bool moved(uint8_t index, const tcs3430_frame_t* before,
+             const tcs3430_frame_t* after);
+  void fuse(tcs3430_hdr_frame_t* frame);
+
+  Adafruit_TCS3430* _sensor;          ///< Sensor being driven
+  tcs3430_config_t _restore;          ///< Settings before begin()
+  tcs3430_exposure_t _exposure[2];    ///< High, low
+  tcs3430_frame_t _last[2];           ///< Latest frame of each exposure
+  bool _have[2] = {false, false};     ///< _last holds a frame
+  uint8_t _current = 0;               ///< Exposure integrating now
+  uint8_t _change_pct = 10;           ///< Change flagged as CHANGED
+  bool _moved = false;                ///< Newest exposure moved, see poll()
+  bool _running = false;              ///< begin() succeeded
+  uint32_t _due = 0;                  ///< micros() of the next read
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*!
+ *  @file Adafruit_TCS3430_Interleave.cpp
+ *
+ * 	Interleaved five-channel acquisition for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Interleave.h"
+
+/*!
+ *    @brief  Instantiates interleaved acquisition
+ *    @param  sensor Sensor to drive, already begun
+ */
+Adafruit_TCS3430_Interleave::Adafruit_TCS3430_Interleave(
+    Adafruit_TCS3430* sensor)
+    : _sensor(sensor) {}
+
+/*!
+ *    @brief  Start interleaved acquisition. Enables a minimum (2.78ms)
+ *            wait if WEN is off, cancels a measurement in progress, and
+ *            restarts the ALS cycle so the boundaries are known. Call
+ *            poll() often - at least once per gap.
+ *    @param  change_percent Y or Z difference between the two halves,
+ *            in percent, above which a frame is flagged CHANGED
+ *    @return true on success; on failure WEN/WTIME are put back
+ */
+bool Adafruit_TCS3430_Interleave::begin(uint8_t change_percent) {
+  if (_running) {
+    return false;
+  }
+  _sensor->cancelMeasurement();
+  _restore_wen = !_sensor->isWaitEnabled();
+  _restore_wtime = _sensor->getWaitCycles();
+  if (_restore_wen &&
+      (!_sensor->setWaitCycles(0) || !_sensor->waitEnable(true))) {
+    return false;
+  }
+  _change_pct = change_percent;
+  if (!restart()) {
+    // Not running, so end() will not put the wait back
+    if (_restore_wen) {
+      _sensor->waitEnable(false);
+      _sensor->setWaitCycles(_restore_wtime);
+    }
+    return false;
+  }
+  _running = true;
+  return true;
+}
+
+/*!
+ *    @brief  Stop interleaved acquisition, leaving AMUX on X and putting
+ *            WEN/WTIME back the way they were
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_Interleave::end() {
+  if (!_running) {
+    return true;
+  }
+  _running = false;
+
+  bool ok = _sensor->setALSMUX_IR2(false);
+  if (_restore_wen) {
+    ok = _sensor->waitEnable(false) && ok;
+    ok = _sensor->setWaitCycles(_restore_wtime) && ok;
+  }
+  return ok;
+}
+
+/*!
+ *    @brief  Service interleaved acquisition. Cheap to call in a tight
+ *            loop: does nothing until the predicted end of integration,
+ *            then one 9-byte burst read and one CFG1 write.
+ *    @param  frame Five-channel frame, filled in on READY
+ *    @return READY with a new frame, PENDING (nothing new yet), IDLE
+ *            before begin() or ERROR on a bus error
+ */
+tcs3430_poll_t Adafruit_TCS3430_Interleave::poll(tcs3430_frame5_t* frame) {
+  if (!_running) {
+    return TCS3430_POLL_IDLE;
+  }
+  // A settings change elsewhere moved the cycle: start it over
+  if (_sensor->getConfigChangeCount() != _changes && !restart()) {
+    return TCS3430_POLL_ERROR;
+  }
+  uint32_t now = micros();
+  if ((int32_t)(now - _due) < 0) {
+    return TCS3430_POLL_PENDING;
+  }
+
+  // If we were late, the newest completed integration is a later one
+  uint32_t end = _due + ((now - _due) / _period) * _period;
+
+  tcs3430_frame_t half;
+  if (!_sensor->readFrame(&half)) {
+    return TCS3430_POLL_ERROR;
+  }
+
+  // Identical data usually means the integration has not finished yet
+  // (the oscillator runs slower than nominal); look again shortly. A
+  // truly static (e.g. dark) scene is accepted after a full step.
+  uint16_t raw[4] = {half.z, half.y, half.ir1, half.ch3};
+  if (memcmp(raw, _last, sizeof(raw)) == 0 && _retries < 4) {
+    _retries++;
+    _due = now + TCS3430_STEP_MICROS / 4;
+    return TCS3430_POLL_PENDING;
+  }
+  memcpy(_last, raw, sizeof(raw));
+  _retries = 0;
+  _due = end + _period;
+
+  // Only use the integration if the mux was switched before it began
+  bool clean = (int32_t)(end - _integration - _mux_at) >= 0;
+  if (!clean) {
+    return TCS3430_POLL_PENDING;
+  }
+
+  bool produced = false;
+  if (!(half.flags & TCS3430_FRAME_CH3_IR2)) {
+    _x = half;
+    _x_end = end;
+    _have_x = true;
+  } else if (_have_x) {
+    frame->timestamp = half.timestamp;
+    frame->x = _x.ch3;
+    frame->y = _x.y;
+    frame->z = _x.z;
+    frame->ir1 = _x.ir1;
+    frame->ir2 = half.ch3;
+    frame->flags = TCS3430_FRAME_VALID;
+    if ((_x.flags | half.flags) & TCS3430_FRAME_SATURATED) {
+      frame->flags |= TCS3430_FRAME_SATURATED;
+    }
+
+    uint32_t dy = (half.y > _x.y) ? half.y - _x.y : _x.y - half.y;
+    uint32_t dz = (half.z > _x.z) ? half.z - _x.z : _x.z - half.z;
+    uint32_t ref_y = (_x.y > half.y) ? _x.y : half.y;
+    uint32_t ref_z = (_x.z > half.z) ? _x.z : half.z;
+    if (dy * 100 > ref_y * _change_pct || dz * 100 > ref_z * _change_pct ||
+        (int32_t)(end - _x_end) > (int32_t)_period) {
+      frame->flags |= TCS3430_FRAME_CHANGED;
+    }
+    _have_x = false;
+    produced = true;
+  }
+
+  // Flip for the next integration; if we are already past the wait gap,
+  // the next integration is mixed and will be skipped as unclean.
+  if (!flip(!(half.flags & TCS3430_FRAME_CH3_IR2))) {
+    // Where the mux ended up is unknown: start over on the next call, as
+    // after a settings change
+    _changes = ~_sensor->getConfigChangeCount();
+    return TCS3430_POLL_ERROR;
+  }
+  return produced ? TCS3430_POLL_READY : TCS3430_POLL_PENDING;
+}
+
+/*!
+ *    @brief  Restart the cycle with the mux on X so integration 0 starts
+ *            now, at the current settings
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_Interleave::restart() {
+  _integration =
+      (uint32_t)(_sensor->getIntegrationCycles() + 1) * TCS3430_STEP_MICROS;
+  _period = _sensor->getCycleMicros();
+  _have_x = false;
+  memset(_last, 0, sizeof(_last));
+  _retries = 0;
+  // Whatever happens to the mux write, leave the ALS running
+  bool ok = _sensor->ALSEnable(false) && flip(false);
+  if (!_sensor->ALSEnable(true) || !ok) {
+    return false;
+  }
+  // AEN 0 -> 1 runs an auto-zero pass before the first integration
+  _due = micros() + (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS +
+         _integration;
+  _changes = _sensor->getConfigChangeCount();
+  return true;
+}
+
+/*!
+ *    @brief  Switch AMUX without marking the data as settling; the clean
+ *            check in poll() tracks freshness instead
+ *    @param  ir2 true for IR2 on CH3
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_Interleave::flip(bool ir2) {
+  if (!_sensor->setALSMUX_IR2(ir2, false)) {
+    return false;
+  }
+  _mux_at = micros();
+  return true;
+}
@@ -0,0 +1,72 @@
+/*!
+ *  @file Adafruit_TCS3430_Interleave.h
+ *
+ * 	Interleaved five-channel acquisition for the TCS3430: flips AMUX
+ * 	between X and IR2 on integration boundaries and pairs the halves
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_INTERLEAVE_H
+#define _ADAFRUIT_TCS3430_INTERLEAVE_H
+
+#include "Adafruit_TCS3430.h"
+
+/** X, Y, Z, IR1 and IR2 from a pair of consecutive interleaved cycles */
+typedef struct {
+  uint32_t timestamp; ///< micros() when the IR2 half was read
+  uint16_t x;         ///< X from the first (AMUX=0) cycle
+  uint16_t y;         ///< Y from the X cycle
+  uint16_t z;         ///< Z from the X cycle
+  uint16_t ir1;       ///< IR1 from the X cycle
+  uint16_t ir2;       ///< IR2 from the second (AMUX=1) cycle
+  uint8_t flags;      ///< TCS3430_FRAME_* flags, CHANGED if light moved
+} tcs3430_frame5_t;
+
+/*!
+ *    @brief  Interleaved X/IR2 acquisition. AMUX is flipped in the wait
+ *            gap after each integration, so every cycle is usable instead
+ *            of discarding one per switch, and consecutive X and IR2
+ *            cycles are paired into a tcs3430_frame5_t. Keeps its own
+ *            state, so a driver that does not interleave carries none of
+ *            it; a settings change made on the driver meanwhile restarts
+ *            the cycle.
+ */
+class Adafruit_TCS3430_Interleave {
+ public:
+  Adafruit_TCS3430_Interleave(Adafruit_TCS3430* sensor);
+
+  bool begin(uint8_t change_percent = 6);
+  bool end();
+  tcs3430_poll_t poll(tcs3430_frame5_t* frame);
+
+ private:
+  bool restart();
+  bool flip(bool ir2);
+
+  Adafruit_TCS3430* _sensor;  ///< Sensor being driven
+  bool _running = false;      ///< begin() succeeded
+  bool _restore_wen = false;  ///< WEN was off before begin()
+  uint8_t _restore_wtime = 0; ///< WTIME before begin()
+  uint8_t _change_pct = 0;    ///< Y/Z delta (%) flagged as CHANGED
+  uint16_t _changes = 0;      ///< getConfigChangeCount() after restart()
+  uint32_t _integration = 0;  ///< Integration length in us
+  uint32_t _period = 0;       ///< Full cycle (integration + wait) in us
+  uint32_t _due = 0;          ///< Predicted end of next integration
+  uint32_t _mux_at = 0;       ///< micros() of the last AMUX write
+  uint32_t _x_end = 0;        ///< Integration end of the held X half
+  bool _have_x = false;       ///< An X half is waiting for its IR2 pair
+  tcs3430_frame_t _x;         ///< Held X half
+  uint16_t _last[4] = {0};    ///< Last raw channels, for early reads
+  uint8_t _retries = 0;       ///< Early reads in a row
+};
+
+#endif
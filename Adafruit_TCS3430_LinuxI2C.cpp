@@ -0,0 +1,200 @@
+/*!
+ *  @file Adafruit_TCS3430_LinuxI2C.cpp
+ *
+ * 	Linux i2c-dev register transport for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_LinuxI2C.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/*!
+ *    @brief  Instantiates an i2c-dev transport
+ *    @param  device Adapter device node, e.g. "/dev/i2c-1"; the string
+ *            must outlive the transport
+ *    @param  addr The I2C address to be used.
+ */
+Adafruit_TCS3430_LinuxI2C::Adafruit_TCS3430_LinuxI2C(const char* device,
+                                                     uint8_t addr)
+    : _device(device), _addr(addr) {}
+
+/*!
+ *    @brief  Closes the adapter
+ */
+Adafruit_TCS3430_LinuxI2C::~Adafruit_TCS3430_LinuxI2C() {
+  closeBus();
+}
+
+/*!
+ *    @brief  Open the adapter and pick combined I2C_RDWR transactions, or
+ *            SMBus I2C block transfers when the adapter only does SMBus
+ *    @return false if the adapter cannot be opened or supports neither
+ */
+bool Adafruit_TCS3430_LinuxI2C::begin() {
+  closeBus();
+  if (!openBus()) {
+    return false;
+  }
+  unsigned long funcs = functions();
+  _combined = funcs & I2C_FUNC_I2C;
+  if (!_combined && (funcs & I2C_FUNC_SMBUS_I2C_BLOCK) !=
+                        I2C_FUNC_SMBUS_I2C_BLOCK) {
+    closeBus();
+    return false;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Read registers in one transaction
+ *    @param  reg First register address
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_LinuxI2C::read(uint8_t reg, uint8_t* buffer,
+                                     uint8_t len) {
+  if (_combined) {
+    struct i2c_msg msgs[2];
+    msgs[0].addr = _addr;
+    msgs[0].flags = 0;
+    msgs[0].len = 1;
+    msgs[0].buf = &reg;
+    msgs[1].addr = _addr;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len = len;
+    msgs[1].buf = buffer;
+    return transfer(msgs, 2);
+  }
+  union i2c_smbus_data data;
+  if (len > I2C_SMBUS_BLOCK_MAX) {
+    return false;
+  }
+  data.block[0] = len;
+  if (!smbus(I2C_SMBUS_READ, reg, &data) || data.block[0] != len) {
+    return false;
+  }
+  memcpy(buffer, data.block + 1, len);
+  return true;
+}
+
+/*!
+ *    @brief  Write registers in one transaction
+ *    @param  reg First register address
+ *    @param  buffer Data
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_LinuxI2C::write(uint8_t reg, const uint8_t* buffer,
+                                      uint8_t len) {
+  if (len > I2C_SMBUS_BLOCK_MAX) {
+    return false;
+  }
+  if (_combined) {
+    uint8_t bytes[1 + I2C_SMBUS_BLOCK_MAX];
+    bytes[0] = reg;
+    memcpy(bytes + 1, buffer, len);
+    struct i2c_msg msg;
+    msg.addr = _addr;
+    msg.flags = 0;
+    msg.len = 1 + len;
+    msg.buf = bytes;
+    return transfer(&msg, 1);
+  }
+  union i2c_smbus_data data;
+  data.block[0] = len;
+  memcpy(data.block + 1, buffer, len);
+  return smbus(I2C_SMBUS_WRITE, reg, &data);
+}
+
+/*!
+ *    @brief  Check which kind of transfer begin() chose
+ *    @return true for combined I2C_RDWR transactions, false for SMBus
+ */
+bool Adafruit_TCS3430_LinuxI2C::isCombined() {
+  return _combined;
+}
+
+/*!
+ *    @brief  Open the adapter device node
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_LinuxI2C::openBus() {
+  _fd = open(_device, O_RDWR);
+  if (_fd < 0) {
+    return false;
+  }
+  // SMBus transfers go to the address set here. I2C_RDWR carries its own,
+  // so a kernel driver already bound to the address only stops SMBus.
+  ioctl(_fd, I2C_SLAVE, _addr);
+  return true;
+}
+
+/*!
+ *    @brief  Close the adapter device node, if open
+ */
+void Adafruit_TCS3430_LinuxI2C::closeBus() {
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+/*!
+ *    @brief  Ask the adapter what it supports
+ *    @return I2C_FUNC_* bits, 0 on failure
+ */
+unsigned long Adafruit_TCS3430_LinuxI2C::functions() {
+  unsigned long funcs = 0;
+  if (ioctl(_fd, I2C_FUNCS, &funcs) < 0) {
+    return 0;
+  }
+  return funcs;
+}
+
+/*!
+ *    @brief  Run messages as one combined transaction (I2C_RDWR)
+ *    @param  msgs Messages
+ *    @param  count Number of messages
+ *    @return true if every message was transferred
+ */
+bool Adafruit_TCS3430_LinuxI2C::transfer(struct i2c_msg* msgs,
+                                         uint8_t count) {
+  struct i2c_rdwr_ioctl_data rdwr;
+  rdwr.msgs = msgs;
+  rdwr.nmsgs = count;
+  return ioctl(_fd, I2C_RDWR, &rdwr) == count;
+}
+
+/*!
+ *    @brief  Run an SMBus I2C block transfer (I2C_SMBUS)
+ *    @param  read_write I2C_SMBUS_READ or I2C_SMBUS_WRITE
+ *    @param  command Register address
+ *    @param  data Length in block[0], then the data
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_LinuxI2C::smbus(uint8_t read_write, uint8_t command,
+                                      union i2c_smbus_data* data) {
+  struct i2c_smbus_ioctl_data args;
+  args.read_write = read_write;
+  args.command = command;
+  args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+  args.data = data;
+  return ioctl(_fd, I2C_SMBUS, &args) == 0;
+}
+
+#endif
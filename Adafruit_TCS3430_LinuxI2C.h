@@ -0,0 +1,75 @@
+/*!
+ *  @file Adafruit_TCS3430_LinuxI2C.h
+ *
+ * 	Linux i2c-dev (/dev/i2c-N) register transport for the TCS3430, for
+ * 	running the driver on Linux hosts such as gateways and SBCs
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_LINUXI2C_H
+#define _ADAFRUIT_TCS3430_LINUXI2C_H
+
+#include "Adafruit_TCS3430.h"
+
+#if defined(__linux__)
+
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+
+/*
+ * Each register burst is one I2C_RDWR ioctl: the register address write
+ * and the data read are two messages of a single combined transaction
+ * (repeated start), a write is one message. Adapters without plain I2C
+ * support, such as the kernel's i2c-stub, are driven with SMBus I2C block
+ * transfers instead, which limits bursts to I2C_SMBUS_BLOCK_MAX bytes;
+ * the driver never needs more. To try the driver against i2c-stub:
+ *
+ *   modprobe i2c-stub chip_addr=0x39
+ *   i2cset -y <bus> 0x39 0x92 0xdc     (the chip ID begin() checks)
+ *
+ * The ioctls go through protected virtual methods, so a test can replace
+ * the kernel with an in-process fake (extras/host/sim/SimI2CDev.h).
+ */
+
+/*!
+ *    @brief  Transport over a Linux /dev/i2c-N adapter
+ */
+class Adafruit_TCS3430_LinuxI2C : public Adafruit_TCS3430_Transport {
+ public:
+  Adafruit_TCS3430_LinuxI2C(const char* device = "/dev/i2c-1",
+                            uint8_t addr = TCS3430_DEFAULT_ADDR);
+  virtual ~Adafruit_TCS3430_LinuxI2C();
+
+  bool begin();
+  bool read(uint8_t reg, uint8_t* buffer, uint8_t len);
+  bool write(uint8_t reg, const uint8_t* buffer, uint8_t len);
+  bool isCombined();
+
+ protected:
+  virtual bool openBus();
+  virtual void closeBus();
+  virtual unsigned long functions();
+  virtual bool transfer(struct i2c_msg* msgs, uint8_t count);
+  virtual bool smbus(uint8_t read_write, uint8_t command,
+                     union i2c_smbus_data* data);
+
+  const char* _device; ///< Adapter device node
+  uint8_t _addr;       ///< 7-bit sensor address
+  int _fd = -1;        ///< Open adapter, -1 when closed
+
+ private:
+  bool _combined = false; ///< I2C_RDWR available, else SMBus block
+};
+
+#endif
+
+#endif
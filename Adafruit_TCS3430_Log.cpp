@@ -0,0 +1,409 @@
+/*!
+ *  @file Adafruit_TCS3430_Log.cpp
+ *
+ * 	Compact binary log of TCS3430 frames
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Log.h"
+
+#include <string.h>
+
+/*!
+ *    @brief  Append an unsigned varint, 7 bits per byte, low first
+ *    @param  value Value to encode
+ *    @param  out Where to write; up to 5 bytes
+ *    @return Bytes written
+ */
+static uint8_t putVarint(uint32_t value, uint8_t* out) {
+  uint8_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+/*!
+ *    @brief  Read an unsigned varint of at most 5 bytes
+ *    @param  data Log bytes
+ *    @param  cursor Position, advanced past the varint
+ *    @param  end Limit the varint must not cross
+ *    @param  value Decoded value
+ *    @return false if the varint runs past end or is too long
+ */
+static bool getVarint(const uint8_t* data, uint32_t* cursor, uint32_t end,
+                      uint32_t* value) {
+  uint32_t v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (*cursor >= end) {
+      return false;
+    }
+    uint8_t b = data[(*cursor)++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *value = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+ *    @brief  Check byte over a block's length, count and payload, the same
+ *            rotate-and-xor as the calibration blob
+ *    @param  bytes First byte after the marker
+ *    @param  length Bytes to cover
+ *    @return Check byte
+ */
+static uint8_t blockCheck(const uint8_t* bytes, uint32_t length) {
+  uint8_t check = 0xA5;
+  for (uint32_t i = 0; i < length; i++) {
+    check = (uint8_t)((check << 1) | (check >> 7)) ^ bytes[i];
+  }
+  return check;
+}
+
+/*!
+ *    @brief  Start a log: write the header
+ *    @param  out Destination, e.g. an SD File or Serial
+ *    @return true if the header was written
+ */
+bool Adafruit_TCS3430_LogWriterBase::begin(Print* out) {
+  _out = out;
+  _used = 0;
+  _block_count = 0;
+  _frames = 0;
+  _written = 0;
+  resetState();
+  uint8_t header[TCS3430_LOG_HEADER_SIZE];
+  memcpy(header, TCS3430_LOG_MAGIC, 4);
+  header[4] = TCS3430_LOG_VERSION;
+  header[5] = 0;
+  header[6] = _capacity & 0xFF;
+  header[7] = _capacity >> 8;
+  return emit(header, sizeof(header));
+}
+
+/*!
+ *    @brief  Add a frame to the log. Only full blocks reach the output,
+ *            so most calls just encode into the buffer.
+ *    @param  frame Frame from readFrame() or an interrupt capture
+ *    @param  gain ALS gain the frame was read at
+ *    @param  atime ATIME the frame was read at
+ *    @return false if a block had to be written and the write failed; the
+ *            frame is not logged
+ */
+bool Adafruit_TCS3430_LogWriterBase::append(const tcs3430_frame_t* frame,
+                                            tcs3430_gain_t gain,
+                                            uint8_t atime) {
+  if (!_out) {
+    return false;
+  }
+  uint8_t record[TCS3430_LOG_MAX_RECORD];
+  uint8_t length = encode(frame, gain, atime, record);
+  if (_used + length > _capacity) {
+    if (!flush()) {
+      return false;
+    }
+    length = encode(frame, gain, atime, record);
+  }
+  memcpy(_buffer + _used, record, length);
+  _used += length;
+  _block_count++;
+  _frames++;
+
+  _timestamp = frame->timestamp;
+  _channels[0] = frame->z;
+  _channels[1] = frame->y;
+  _channels[2] = frame->ir1;
+  _channels[3] = frame->ch3;
+  _gain = gain;
+  _atime = atime;
+  _status = frame->status;
+  _flags = frame->flags;
+  return true;
+}
+
+/*!
+ *    @brief  Write out the records buffered so far as a block. Call before
+ *            closing the file; blocks written this way are just shorter.
+ *    @return true if the block was written (or there was nothing to write)
+ */
+bool Adafruit_TCS3430_LogWriterBase::flush() {
+  if (!_out) {
+    return false;
+  }
+  if (_block_count == 0) {
+    return true;
+  }
+  uint8_t head[5] = {TCS3430_LOG_BLOCK_MARKER, (uint8_t)(_used & 0xFF),
+                     (uint8_t)(_used >> 8), (uint8_t)(_block_count & 0xFF),
+                     (uint8_t)(_block_count >> 8)};
+  uint8_t check = blockCheck(head + 1, 4);
+  for (uint16_t i = 0; i < _used; i++) {
+    check = (uint8_t)((check << 1) | (check >> 7)) ^ _buffer[i];
+  }
+  bool ok = emit(head, sizeof(head)) && emit(_buffer, _used) &&
+            emit(&check, 1);
+  _used = 0;
+  _block_count = 0;
+  resetState();
+  return ok;
+}
+
+/*!
+ *    @brief  Frames appended since begin(), including ones still buffered
+ *    @return Frame count
+ */
+uint32_t Adafruit_TCS3430_LogWriterBase::getFrameCount() {
+  return _frames;
+}
+
+/*!
+ *    @brief  Bytes handed to the output since begin()
+ *    @return Byte count
+ */
+uint32_t Adafruit_TCS3430_LogWriterBase::getBytesWritten() {
+  return _written;
+}
+
+/*!
+ *    @brief  Encode one record against the previous one
+ *    @param  frame Frame to encode
+ *    @param  gain ALS gain
+ *    @param  atime ATIME
+ *    @param  out At least TCS3430_LOG_MAX_RECORD bytes
+ *    @return Record length
+ */
+uint8_t Adafruit_TCS3430_LogWriterBase::encode(const tcs3430_frame_t* frame,
+                                               tcs3430_gain_t gain,
+                                               uint8_t atime, uint8_t* out) {
+  uint8_t tag = 0;
+  if (gain != _gain || atime != _atime) {
+    tag |= TCS3430_LOG_TAG_SETTINGS;
+  }
+  if (frame->status != _status) {
+    tag |= TCS3430_LOG_TAG_STATUS;
+  }
+  if (frame->flags != _flags) {
+    tag |= TCS3430_LOG_TAG_FLAGS;
+  }
+  uint8_t n = 0;
+  out[n++] = tag;
+  n += putVarint(frame->timestamp - _timestamp, out + n);
+  uint16_t channels[4] = {frame->z, frame->y, frame->ir1, frame->ch3};
+  for (uint8_t c = 0; c < 4; c++) {
+    int32_t delta = (int32_t)channels[c] - _channels[c];
+    n += putVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31), out + n);
+  }
+  if (tag & TCS3430_LOG_TAG_SETTINGS) {
+    out[n++] = gain;
+    out[n++] = atime;
+  }
+  if (tag & TCS3430_LOG_TAG_STATUS) {
+    out[n++] = frame->status;
+  }
+  if (tag & TCS3430_LOG_TAG_FLAGS) {
+    out[n++] = frame->flags;
+  }
+  return n;
+}
+
+/*!
+ *    @brief  Write bytes to the output and count them
+ *    @param  bytes Bytes to write
+ *    @param  length Number of bytes
+ *    @return true if all were accepted
+ */
+bool Adafruit_TCS3430_LogWriterBase::emit(const uint8_t* bytes,
+                                          uint16_t length) {
+  size_t n = _out->write(bytes, length);
+  _written += n;
+  return n == length;
+}
+
+/*!
+ *    @brief  Reset the delta base, as every block starts
+ */
+void Adafruit_TCS3430_LogWriterBase::resetState() {
+  _timestamp = 0;
+  for (uint8_t c = 0; c < 4; c++) {
+    _channels[c] = 0;
+  }
+  _gain = 0;
+  _atime = 0;
+  _status = 0;
+  _flags = 0;
+}
+
+/*!
+ *    @brief  Open a log held in memory
+ *    @param  data Log bytes, which must stay valid while reading
+ *    @param  length Log length
+ *    @return false if the header is missing or from an unknown version
+ */
+bool Adafruit_TCS3430_LogReader::begin(const uint8_t* data, uint32_t length) {
+  _data = NULL;
+  if (length < TCS3430_LOG_HEADER_SIZE ||
+      memcmp(data, TCS3430_LOG_MAGIC, 4) != 0 ||
+      data[4] != TCS3430_LOG_VERSION) {
+    return false;
+  }
+  _data = data;
+  _length = length;
+  rewind();
+  return true;
+}
+
+/*!
+ *    @brief  Decode the next record. Damaged or truncated blocks are
+ *            skipped and counted in getSkippedBytes().
+ *    @param  record Filled with the record
+ *    @return false at the end of the log
+ */
+bool Adafruit_TCS3430_LogReader::next(tcs3430_log_record_t* record) {
+  if (!_data) {
+    return false;
+  }
+  while (true) {
+    if (_left == 0 && !openBlock()) {
+      return false;
+    }
+    if (decode(record)) {
+      _left--;
+      if (_left == 0 && _cursor != _end) {
+        _skipped += _end - _cursor;
+      }
+      _prev = *record;
+      return true;
+    }
+    // Check byte matched but the records do not parse: drop the rest
+    _skipped += _end - _cursor;
+    _left = 0;
+  }
+}
+
+/*!
+ *    @brief  Go back to the first record
+ */
+void Adafruit_TCS3430_LogReader::rewind() {
+  _pos = TCS3430_LOG_HEADER_SIZE;
+  _cursor = _end = _pos;
+  _left = 0;
+  _blocks = 0;
+  _skipped = 0;
+}
+
+/*!
+ *    @brief  Block payload capacity the log was written with
+ *    @return Capacity in bytes, 0 if no log is open
+ */
+uint16_t Adafruit_TCS3430_LogReader::getBlockCapacity() {
+  return _data ? _data[6] | ((uint16_t)_data[7] << 8) : 0;
+}
+
+/*!
+ *    @brief  Valid blocks reached so far
+ *    @return Block count
+ */
+uint32_t Adafruit_TCS3430_LogReader::getBlockCount() {
+  return _blocks;
+}
+
+/*!
+ *    @brief  Bytes passed over so far because they were not part of a
+ *            valid block: damage, a truncated last block, or garbage
+ *    @return Byte count
+ */
+uint32_t Adafruit_TCS3430_LogReader::getSkippedBytes() {
+  return _skipped;
+}
+
+/*!
+ *    @brief  Find the next block whose length fits and whose check byte
+ *            matches, scanning byte by byte past anything else
+ *    @return false when no block is left
+ */
+bool Adafruit_TCS3430_LogReader::openBlock() {
+  while (_pos + TCS3430_LOG_BLOCK_OVERHEAD <= _length) {
+    const uint8_t* b = _data + _pos;
+    uint32_t payload = b[1] | ((uint16_t)b[2] << 8);
+    uint16_t count = b[3] | ((uint16_t)b[4] << 8);
+    uint32_t end = _pos + 5 + payload;
+    if (b[0] == TCS3430_LOG_BLOCK_MARKER && count > 0 && end < _length &&
+        blockCheck(b + 1, 4 + payload) == _data[end]) {
+      _cursor = _pos + 5;
+      _end = end;
+      _left = count;
+      _pos = end + 1;
+      _blocks++;
+      memset(&_prev, 0, sizeof(_prev));
+      return true;
+    }
+    _pos++;
+    _skipped++;
+  }
+  _skipped += _length - _pos;
+  _pos = _length;
+  return false;
+}
+
+/*!
+ *    @brief  Decode one record of the open block against the previous one
+ *    @param  record Filled with the record
+ *    @return false if the record runs past the block
+ */
+bool Adafruit_TCS3430_LogReader::decode(tcs3430_log_record_t* record) {
+  if (_cursor >= _end) {
+    return false;
+  }
+  uint8_t tag = _data[_cursor++];
+  if (tag & ~(TCS3430_LOG_TAG_SETTINGS | TCS3430_LOG_TAG_STATUS |
+              TCS3430_LOG_TAG_FLAGS)) {
+    return false;
+  }
+  uint32_t delta;
+  if (!getVarint(_data, &_cursor, _end, &delta)) {
+    return false;
+  }
+  *record = _prev;
+  record->frame.timestamp = _prev.frame.timestamp + delta;
+  uint16_t* channels[4] = {&record->frame.z, &record->frame.y,
+                           &record->frame.ir1, &record->frame.ch3};
+  for (uint8_t c = 0; c < 4; c++) {
+    uint32_t zigzag;
+    if (!getVarint(_data, &_cursor, _end, &zigzag)) {
+      return false;
+    }
+    int32_t d = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    *channels[c] = (uint16_t)(*channels[c] + d);
+  }
+  uint8_t extra = ((tag & TCS3430_LOG_TAG_SETTINGS) ? 2 : 0) +
+                  ((tag & TCS3430_LOG_TAG_STATUS) ? 1 : 0) +
+                  ((tag & TCS3430_LOG_TAG_FLAGS) ? 1 : 0);
+  if (_end - _cursor < extra) {
+    return false;
+  }
+  if (tag & TCS3430_LOG_TAG_SETTINGS) {
+    record->gain = (tcs3430_gain_t)_data[_cursor++];
+    record->atime = _data[_cursor++];
+  }
+  if (tag & TCS3430_LOG_TAG_STATUS) {
+    record->frame.status = _data[_cursor++];
+  }
+  if (tag & TCS3430_LOG_TAG_FLAGS) {
+    record->frame.flags = _data[_cursor++];
+  }
+  return true;
+}
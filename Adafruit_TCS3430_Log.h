@@ -0,0 +1,160 @@
+/*!
+ *  @file Adafruit_TCS3430_Log.h
+ *
+ * 	Compact binary log of TCS3430 frames: a streaming encoder with a fixed
+ * 	buffer for the device, and a zero-copy decoder over a byte array (a
+ * 	memory-mapped file on a host)
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_LOG_H
+#define _ADAFRUIT_TCS3430_LOG_H
+
+#include "Adafruit_TCS3430.h"
+
+/*
+ * Layout, all multi-byte fields little endian:
+ *
+ *   header  'T' 'C' 'S' 'L', version, 0, block capacity (u16)
+ *   block   0xB5, payload length (u16), frame count (u16), payload,
+ *           check byte over length, count and payload
+ *
+ * Each block is a checkpoint: delta state starts from zero, so a block
+ * decodes on its own and a damaged or truncated one is skipped without
+ * losing the rest. A record is a tag byte, then the timestamp delta as an
+ * unsigned varint, then the zigzag varint deltas of z, y, ir1 and ch3,
+ * then whichever of gain + ATIME, status and flags the tag says changed.
+ */
+
+/** Header magic, 4 bytes */
+#define TCS3430_LOG_MAGIC "TCSL"
+/** Format version written by the encoder */
+#define TCS3430_LOG_VERSION 1
+/** Header length in bytes */
+#define TCS3430_LOG_HEADER_SIZE 8
+/** First byte of every block */
+#define TCS3430_LOG_BLOCK_MARKER 0xB5
+/** Block bytes around the payload: marker, length, count, check */
+#define TCS3430_LOG_BLOCK_OVERHEAD 6
+/** Longest encoded record: tag, 5 byte timestamp, 4 x 3 byte channels,
+ *  gain, ATIME, status and flags */
+#define TCS3430_LOG_MAX_RECORD 22
+
+/** Record tag: gain and ATIME bytes follow */
+#define TCS3430_LOG_TAG_SETTINGS 0x01
+/** Record tag: status byte follows */
+#define TCS3430_LOG_TAG_STATUS 0x02
+/** Record tag: flags byte follows */
+#define TCS3430_LOG_TAG_FLAGS 0x04
+
+/** One decoded log entry */
+typedef struct {
+  tcs3430_frame_t frame; ///< Frame as read from the sensor
+  tcs3430_gain_t gain;   ///< ALS gain it was read at
+  uint8_t atime;         ///< ATIME it was read at
+} tcs3430_log_record_t;
+
+/*!
+ *    @brief  Streaming log encoder, independent of buffer size, so code
+ *            can take any Adafruit_TCS3430_LogWriter<BYTES>. Records are
+ *            delta coded into the buffer, which goes out as one block
+ *            when the next record might not fit or on flush().
+ */
+class Adafruit_TCS3430_LogWriterBase {
+ public:
+  bool begin(Print* out);
+  bool append(const tcs3430_frame_t* frame, tcs3430_gain_t gain,
+              uint8_t atime);
+  bool flush();
+  uint32_t getFrameCount();
+  uint32_t getBytesWritten();
+
+ protected:
+  /*!
+   *    @brief  Bind the encoder to its block buffer
+   *    @param  buffer Payload buffer
+   *    @param  capacity Buffer length, at least TCS3430_LOG_MAX_RECORD
+   */
+  Adafruit_TCS3430_LogWriterBase(uint8_t* buffer, uint16_t capacity)
+      : _buffer(buffer), _capacity(capacity) {}
+
+ private:
+  uint8_t encode(const tcs3430_frame_t* frame, tcs3430_gain_t gain,
+                 uint8_t atime, uint8_t* out);
+  bool emit(const uint8_t* bytes, uint16_t length);
+  void resetState();
+
+  uint8_t* _buffer;          ///< Payload of the block being built
+  uint16_t _capacity;        ///< Buffer length
+  uint16_t _used = 0;        ///< Payload bytes in the buffer
+  uint16_t _block_count = 0; ///< Records in the buffer
+  Print* _out = NULL;        ///< Where blocks go
+  uint32_t _frames = 0;      ///< Records appended since begin()
+  uint32_t _written = 0;     ///< Bytes emitted since begin()
+  uint32_t _timestamp = 0;   ///< Previous record's timestamp
+  uint16_t _channels[4];     ///< Previous record's z, y, ir1, ch3
+  uint8_t _gain = 0;         ///< Previous record's gain
+  uint8_t _atime = 0;        ///< Previous record's ATIME
+  uint8_t _status = 0;       ///< Previous record's status
+  uint8_t _flags = 0;        ///< Previous record's flags
+};
+
+/*!
+ *    @brief  Streaming log encoder with a BYTES byte block buffer
+ *    @tparam BYTES Block payload capacity; larger blocks amortise the 6
+ *            byte block overhead, smaller ones lose less on a power cut
+ */
+template <uint16_t BYTES>
+class Adafruit_TCS3430_LogWriter : public Adafruit_TCS3430_LogWriterBase {
+  static_assert(BYTES >= TCS3430_LOG_MAX_RECORD,
+                "Block buffer must hold at least one record");
+
+ public:
+  /*!
+   *    @brief  Create an encoder; begin() starts the log
+   */
+  Adafruit_TCS3430_LogWriter()
+      : Adafruit_TCS3430_LogWriterBase(_storage, BYTES) {}
+
+ private:
+  uint8_t _storage[BYTES]; ///< Block payload
+};
+
+/*!
+ *    @brief  Log decoder over a complete log held in memory. Records are
+ *            decoded straight from the caller's bytes, nothing is copied.
+ */
+class Adafruit_TCS3430_LogReader {
+ public:
+  bool begin(const uint8_t* data, uint32_t length);
+  bool next(tcs3430_log_record_t* record);
+  void rewind();
+  uint16_t getBlockCapacity();
+  uint32_t getBlockCount();
+  uint32_t getSkippedBytes();
+
+ private:
+  bool openBlock();
+  bool decode(tcs3430_log_record_t* record);
+
+  const uint8_t* _data = NULL; ///< Whole log
+  uint32_t _length = 0;        ///< Log length
+  uint32_t _pos = 0;           ///< Where the next block search starts
+  uint32_t _cursor = 0;        ///< Next record in the open block
+  uint32_t _end = 0;           ///< End of the open block's payload
+  uint16_t _left = 0;          ///< Records left in the open block
+  uint32_t _blocks = 0;        ///< Valid blocks opened
+  uint32_t _skipped = 0;       ///< Bytes outside valid blocks
+  tcs3430_log_record_t _prev;  ///< Previous record, the delta base
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*!
+ *  @file Adafruit_TCS3430_MuxArray.cpp
+ *
+ * 	Manager for many TCS3430s behind I2C multiplexers
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_MuxArray.h"
+
+/*!
+ *    @brief  Bind the array to its storage
+ *    @param  sensors Sensor storage
+ *    @param  slots Slot storage
+ *    @param  count Number of sensors
+ *    @param  mux_addr Address of the first multiplexer
+ *    @param  theWire The Wire object shared by the muxes and sensors
+ */
+Adafruit_TCS3430_MuxArrayBase::Adafruit_TCS3430_MuxArrayBase(
+    Adafruit_TCS3430* sensors, tcs3430_mux_slot_t* slots, uint8_t count,
+    uint8_t mux_addr, TwoWire* theWire)
+    : _sensors(sensors),
+      _slots(slots),
+      _count(count),
+      _mux_addr(mux_addr),
+      _wire(theWire) {
+  for (uint8_t i = 0; i < count; i++) {
+    _slots[i].channel = i;
+    _slots[i].present = false;
+    _slots[i].due = 0;
+    _slots[i].last = 0;
+    _slots[i].retries = 0;
+  }
+}
+
+/*!
+ *    @brief  Move a sensor to a different mux channel. Call before begin().
+ *    @param  index Sensor index
+ *    @param  channel Mux channel (mux number * 8 + port)
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_MuxArrayBase::setChannel(uint8_t index,
+                                               uint8_t channel) {
+  if (index >= _count || channel >= 64) {
+    return false;
+  }
+  _slots[index].channel = channel;
+  return true;
+}
+
+/*!
+ *    @brief  Find and initialise every sensor. Each one gets the shadow
+ *            register cache, so reconfiguring it later costs no reads.
+ *    @return true if all sensors were found
+ */
+bool Adafruit_TCS3430_MuxArrayBase::begin() {
+  bool all = true;
+  _selected = TCS3430_MUX_NONE;
+  for (uint8_t i = 0; i < _count; i++) {
+    _slots[i].present = false;
+    if (!select(i)) {
+      all = false;
+      continue;
+    }
+    _sensors[i].enableRegisterCache(true);
+    _slots[i].present = _sensors[i].begin(TCS3430_DEFAULT_ADDR, _wire);
+    all = all && _slots[i].present;
+  }
+  return all;
+}
+
+/*!
+ *    @brief  Signature of a frame's channel data, to spot early reads
+ *    @param  frame Frame to summarise
+ *    @return Signature
+ */
+static uint16_t frameSignature(const tcs3430_frame_t* frame) {
+  return frame->z ^ (frame->y << 3) ^ (frame->ir1 << 6) ^ (frame->ch3 << 9) ^
+         (frame->ch3 >> 7);
+}
+
+/*!
+ *    @brief  Restart integration on every sensor back to back, so they
+ *            all finish within a few bus transactions of each other. The
+ *            first frames come after the auto-zero pass that follows the
+ *            restart plus one integration.
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_MuxArrayBase::startAll() {
+  bool ok = true;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!_slots[i].present) {
+      continue;
+    }
+    tcs3430_frame_t frame;
+    if (!select(i) || !_sensors[i].restartCycle() ||
+        !_sensors[i].readFrame(&frame)) {
+      ok = false;
+      continue;
+    }
+    // The data registers hold the old result until the first integration
+    // ends; remember it so harvest() does not take it for a new one
+    _slots[i].due = micros() +
+                    (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS +
+                    _sensors[i].getCycleMicros();
+    _slots[i].last = frameSignature(&frame);
+    _slots[i].retries = 0;
+  }
+  _next = 0;
+  return ok;
+}
+
+/*!
+ *    @brief  Read the next sensor whose integration has finished, going
+ *            round-robin from the last one read. Sensors that are not due
+ *            cost nothing; the mux is only switched to read one.
+ *    @param  frame Pointer to the frame to fill
+ *    @param  index Pointer to store the sensor index the frame came from
+ *    @return true if a frame was read
+ */
+bool Adafruit_TCS3430_MuxArrayBase::harvest(tcs3430_frame_t* frame,
+                                            uint8_t* index) {
+  uint32_t now = micros();
+  for (uint8_t k = 0; k < _count; k++) {
+    uint8_t i = (_next + k) % _count;
+    tcs3430_mux_slot_t* slot = &_slots[i];
+    uint32_t retry_at =
+        slot->due + (uint32_t)slot->retries * (TCS3430_STEP_MICROS / 4);
+    if (!slot->present || (int32_t)(now - retry_at) < 0) {
+      continue;
+    }
+    if (!select(i) || !_sensors[i].readFrame(frame)) {
+      continue;
+    }
+
+    // Unchanged data usually means this sensor's oscillator is a little
+    // slow and the integration has not finished; look again shortly. A
+    // truly static (e.g. dark) scene is accepted once a quarter of a
+    // cycle, and at least a step, has gone by.
+    uint32_t cycle = _sensors[i].getCycleMicros();
+    uint32_t patience = cycle / 4;
+    if (patience < TCS3430_STEP_MICROS) {
+      patience = TCS3430_STEP_MICROS;
+    }
+    uint16_t sig = frameSignature(frame);
+    bool changed = sig != slot->last;
+    if (!changed && now - slot->due < patience) {
+      if (slot->retries < 255) {
+        slot->retries++;
+      }
+      continue;
+    }
+    slot->last = sig;
+
+    // A change found by looking again marks where this sensor's cycle
+    // really ends; a static scene keeps the predicted timing. Then move
+    // to the next boundary after now, skipping any cycles we were too
+    // late for.
+    if (changed && slot->retries) {
+      slot->due = now;
+    }
+    slot->retries = 0;
+    slot->due += ((now - slot->due) / cycle + 1) * cycle;
+
+    *index = i;
+    _next = i + 1;
+    return true;
+  }
+  return false;
+}
+
+/*!
+ *    @brief  Route the bus to a sensor, switching muxes only if needed
+ *    @param  index Sensor index
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_MuxArrayBase::select(uint8_t index) {
+  if (index >= _count) {
+    return false;
+  }
+  return selectChannel(_slots[index].channel);
+}
+
+/*!
+ *    @brief  Number of sensors in the array
+ *    @return Sensor count
+ */
+uint8_t Adafruit_TCS3430_MuxArrayBase::count() {
+  return _count;
+}
+
+/*!
+ *    @brief  Check if begin() found a sensor
+ *    @param  index Sensor index
+ *    @return true if present
+ */
+bool Adafruit_TCS3430_MuxArrayBase::isPresent(uint8_t index) {
+  return index < _count && _slots[index].present;
+}
+
+/*!
+ *    @brief  Access a sensor, e.g. to configure it. Call select(index)
+ *            first so its transactions reach the right chip.
+ *    @param  index Sensor index
+ *    @return Pointer to the sensor, NULL if out of range
+ */
+Adafruit_TCS3430* Adafruit_TCS3430_MuxArrayBase::sensor(uint8_t index) {
+  return index < _count ? &_sensors[index] : NULL;
+}
+
+/*!
+ *    @brief  Select a mux channel, turning off the previous mux if the
+ *            channel lives on a different one
+ *    @param  channel Mux channel
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_MuxArrayBase::selectChannel(uint8_t channel) {
+  if (channel == _selected) {
+    return true;
+  }
+  uint8_t mux = channel >> 3;
+  if (_selected != TCS3430_MUX_NONE && (_selected >> 3) != mux &&
+      !writeMux(_selected >> 3, 0)) {
+    _selected = TCS3430_MUX_NONE;
+    return false;
+  }
+  if (!writeMux(mux, 1 << (channel & 7))) {
+    _selected = TCS3430_MUX_NONE;
+    return false;
+  }
+  _selected = channel;
+  return true;
+}
+
+/*!
+ *    @brief  Write a mux's port enable register
+ *    @param  mux Mux number, added to the base address
+ *    @param  ports Bitmask of ports to enable
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_MuxArrayBase::writeMux(uint8_t mux, uint8_t ports) {
+  Adafruit_I2CDevice mux_dev = Adafruit_I2CDevice(_mux_addr + mux, _wire);
+  return mux_dev.write(&ports, 1);
+}
@@ -0,0 +1,95 @@
+/*!
+ *  @file Adafruit_TCS3430_MuxArray.h
+ *
+ * 	Manager for many TCS3430s (fixed address 0x39) behind TCA9548A-style
+ * 	I2C multiplexers, with overlapped integration
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_MUXARRAY_H
+#define _ADAFRUIT_TCS3430_MUXARRAY_H
+
+#include "Adafruit_TCS3430.h"
+
+/** Default I2C address of the first multiplexer */
+#define TCS3430_MUX_DEFAULT_ADDR 0x70
+/** No mux channel selected */
+#define TCS3430_MUX_NONE 0xFF
+
+/** Per-sensor bookkeeping for the mux array */
+typedef struct {
+  uint8_t channel;  ///< Mux channel: mux (addr + channel / 8), port % 8
+  bool present;     ///< begin() found the sensor
+  uint32_t due;     ///< micros() when the next frame is expected
+  uint16_t last;    ///< Signature of the last frame, to spot early reads
+  uint8_t retries;  ///< Early reads in a row
+} tcs3430_mux_slot_t;
+
+/*!
+ *    @brief  Capacity-independent part of Adafruit_TCS3430_MuxArray.
+ *            Channels 0-7 are on the mux at the base address, 8-15 on
+ *            the next address up, and so on; selecting a port on one mux
+ *            turns the previously used mux off.
+ */
+class Adafruit_TCS3430_MuxArrayBase {
+ public:
+  bool setChannel(uint8_t index, uint8_t channel);
+  bool begin();
+  bool startAll();
+  bool harvest(tcs3430_frame_t* frame, uint8_t* index);
+  bool select(uint8_t index);
+
+  uint8_t count();
+  bool isPresent(uint8_t index);
+  Adafruit_TCS3430* sensor(uint8_t index);
+
+ protected:
+  Adafruit_TCS3430_MuxArrayBase(Adafruit_TCS3430* sensors,
+                                tcs3430_mux_slot_t* slots, uint8_t count,
+                                uint8_t mux_addr, TwoWire* theWire);
+
+ private:
+  bool selectChannel(uint8_t channel);
+  bool writeMux(uint8_t mux, uint8_t ports);
+
+  Adafruit_TCS3430* _sensors;     ///< Sensor storage
+  tcs3430_mux_slot_t* _slots;     ///< Slot storage
+  uint8_t _count;                 ///< Number of sensors
+  uint8_t _mux_addr;              ///< Address of mux 0
+  TwoWire* _wire;                 ///< Shared bus
+  uint8_t _selected = TCS3430_MUX_NONE; ///< Channel currently selected
+  uint8_t _next = 0;              ///< Round-robin start for harvest()
+};
+
+/*!
+ *    @brief  Owns N sensors on mux channels
+ *    @tparam N Number of sensors
+ */
+template <uint8_t N>
+class Adafruit_TCS3430_MuxArray : public Adafruit_TCS3430_MuxArrayBase {
+ public:
+  /*!
+   *    @brief  Create the array. Sensor i starts out on channel i.
+   *    @param  mux_addr Address of the first multiplexer
+   *    @param  theWire The Wire object shared by the muxes and sensors
+   */
+  Adafruit_TCS3430_MuxArray(uint8_t mux_addr = TCS3430_MUX_DEFAULT_ADDR,
+                            TwoWire* theWire = &Wire)
+      : Adafruit_TCS3430_MuxArrayBase(_sensor_storage, _slot_storage, N,
+                                      mux_addr, theWire) {}
+
+ private:
+  Adafruit_TCS3430 _sensor_storage[N]; ///< The sensors
+  tcs3430_mux_slot_t _slot_storage[N]; ///< Their bookkeeping
+};
+
+#endif
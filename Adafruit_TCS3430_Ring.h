@@ -0,0 +1,159 @@
+/*!
+ *  @file Adafruit_TCS3430_Ring.h
+ *
+ * 	Fixed-size, heap-free single-producer/single-consumer ring buffer used
+ * 	by the TCS3430 driver to hand samples from service() to the
+ * 	application.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_RING_H
+#define _ADAFRUIT_TCS3430_RING_H
+
+#include <stdint.h>
+
+/** Keep the compiler (and CPU, on multicore parts) from reordering the
+ *  slot copy and the index update */
+#define TCS3430_RING_BARRIER() __sync_synchronize()
+
+/*!
+ *    @brief  Ring buffer interface, independent of capacity, so the driver
+ *            can take any Adafruit_TCS3430_Ring<T, N>. Exactly one context
+ *            may push and one (possibly different) context may pop.
+ */
+template <typename T>
+class Adafruit_TCS3430_RingBase {
+ public:
+  /*!
+   *    @brief  Add an item. Producer side only.
+   *    @param  item Item to copy in
+   *    @return false (and the overrun count is bumped) if the ring is full
+   */
+  bool push(const T& item) {
+    uint8_t head = _head;
+    if ((uint8_t)(head - _tail) > _mask) {
+      _overruns++;
+      return false;
+    }
+    _buf[head & _mask] = item;
+    TCS3430_RING_BARRIER();
+    _head = head + 1;
+    return true;
+  }
+
+  /*!
+   *    @brief  Remove the oldest item. Consumer side only.
+   *    @param  item Pointer to copy the item to
+   *    @return false if the ring is empty
+   */
+  bool pop(T* item) {
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    TCS3430_RING_BARRIER();
+    *item = _buf[tail & _mask];
+    TCS3430_RING_BARRIER();
+    _tail = tail + 1;
+    return true;
+  }
+
+  /*!
+   *    @brief  Remove up to max items in one go. Consumer side only.
+   *    @param  items Array to copy the items to
+   *    @param  max Size of the array
+   *    @return Number of items copied
+   */
+  uint8_t popBatch(T* items, uint8_t max) {
+    uint8_t tail = _tail;
+    uint8_t count = _head - tail;
+    if (count > max) {
+      count = max;
+    }
+    TCS3430_RING_BARRIER();
+    for (uint8_t i = 0; i < count; i++) {
+      items[i] = _buf[(uint8_t)(tail + i) & _mask];
+    }
+    TCS3430_RING_BARRIER();
+    _tail = tail + count;
+    return count;
+  }
+
+  /*!
+   *    @brief  Number of items waiting
+   *    @return Item count
+   */
+  uint8_t available() const {
+    return (uint8_t)(_head - _tail);
+  }
+
+  /*!
+   *    @brief  Maximum number of items held
+   *    @return Capacity
+   */
+  uint8_t capacity() const {
+    return _mask + 1;
+  }
+
+  /*!
+   *    @brief  Number of items dropped because the ring was full
+   *    @return Overrun count
+   */
+  uint32_t overruns() const {
+    return _overruns;
+  }
+
+  /*!
+   *    @brief  Discard everything waiting. Consumer side only.
+   */
+  void clear() {
+    _tail = _head;
+  }
+
+ protected:
+  /*!
+   *    @brief  Bind the interface to its storage
+   *    @param  storage Array of size items
+   *    @param  size Capacity, a power of two no larger than 128
+   */
+  Adafruit_TCS3430_RingBase(T* storage, uint8_t size)
+      : _buf(storage), _mask(size - 1) {}
+
+ private:
+  T* _buf;                      ///< Item storage
+  uint8_t _mask;                ///< Capacity - 1
+  volatile uint8_t _head = 0;   ///< Free-running write index
+  volatile uint8_t _tail = 0;   ///< Free-running read index
+  volatile uint32_t _overruns = 0; ///< Items dropped on a full ring
+};
+
+/*!
+ *    @brief  Statically sized ring buffer
+ *    @tparam T Item type
+ *    @tparam N Capacity, a power of two from 2 to 128
+ */
+template <typename T, uint8_t N>
+class Adafruit_TCS3430_Ring : public Adafruit_TCS3430_RingBase<T> {
+  static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0,
+                "Ring capacity must be a power of two from 2 to 128");
+
+ public:
+  /*!
+   *    @brief  Create an empty ring
+   */
+  Adafruit_TCS3430_Ring() : Adafruit_TCS3430_RingBase<T>(_storage, N) {}
+
+ private:
+  T _storage[N]; ///< Item storage
+};
+
+#endif
@@ -0,0 +1,284 @@
+/*!
+ *  @file Adafruit_TCS3430_Scheduler.cpp
+ *
+ * 	Deadline read scheduler for the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Scheduler.h"
+
+/** Read scheduler phase */
+enum {
+  kSchedUnknown, ///< Looking for the end of the cycle a change landed in
+  kSchedStarted, ///< Cycle restarted at _edge, its end not yet seen
+  kSchedTracking ///< _edge is the end of the last integration
+};
+
+/** Largest error, Q16, a first learned cycle length may have: each end it
+ *  is learned from is only known to within about one frame read */
+#define TCS3430_SCHED_MAX_ERROR (65536 / 400)
+/** Cycles after which the learning baseline is moved up, so the learned
+ *  length follows slow oscillator drift */
+#define TCS3430_SCHED_MAX_SPAN 1024
+
+/*!
+ *    @brief  Instantiates a read scheduler
+ *    @param  sensor Sensor to read, already begun
+ */
+Adafruit_TCS3430_Scheduler::Adafruit_TCS3430_Scheduler(
+    Adafruit_TCS3430* sensor)
+    : _sensor(sensor) {}
+
+/*!
+ *    @brief  Restart the ALS cycle (Adafruit_TCS3430::restartCycle()).
+ *            The cycle starts at a known time, so its end can be
+ *            bracketed straight away instead of searched for.
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_Scheduler::restartCycle() {
+  if (!_sensor->restartCycle()) {
+    return false;
+  }
+  prepare();
+  _state = kSchedStarted;
+  _edge = micros();
+  uint32_t integration = scale(_integration);
+  _window = integration / 16 + TCS3430_STEP_MICROS / 4;
+  _next = _edge + integration - _window;
+  return true;
+}
+
+/*!
+ *    @brief  When poll() next wants the bus: just after the predicted
+ *            end of the next integration, or a little before it while
+ *            the scheduler is measuring where cycles end
+ *    @return Time in micros()
+ */
+uint32_t Adafruit_TCS3430_Scheduler::nextSampleAt() {
+  prepare();
+  return _next;
+}
+
+/*!
+ *    @brief  Check whether poll() has a read to do
+ *    @return true once micros() has reached nextSampleAt()
+ */
+bool Adafruit_TCS3430_Scheduler::isFreshDataDue() {
+  prepare();
+  return (int32_t)(micros() - _next) >= 0;
+}
+
+/*!
+ *    @brief  Read each new integration once, as soon as it ends. After a
+ *            configuration change the scheduler finds where cycles end by
+ *            reading until the channels change, discarding that cycle as
+ *            it straddles the change. From then on each integration end
+ *            is predicted from the last, and the real cycle length (the
+ *            oscillator may be off nominal) is learned from ends it
+ *            brackets between a read of old data and one of new. Once the
+ *            prediction is tight, each sample is a single frame read just
+ *            after the predicted end, with one bracketing sample in 16 to
+ *            follow drift. A static scene (e.g. dark or saturated) never
+ *            changes the data; its samples are taken on prediction alone.
+ *    @param  frame Filled in on READY
+ *    @return READY with a new sample, PENDING (nothing new yet: call
+ *            again at nextSampleAt()) or ERROR on a bus error
+ */
+tcs3430_poll_t Adafruit_TCS3430_Scheduler::poll(tcs3430_frame_t* frame) {
+  prepare();
+  if ((int32_t)(micros() - _next) < 0) {
+    return TCS3430_POLL_PENDING;
+  }
+  // Ends are kept as the time a read has to start to see the new data.
+  // The data is latched at the same point into every burst, so comparing
+  // read starts cancels it: an end lies between the start of a read of
+  // old data and the start of the next read, which finds new data.
+  uint32_t start = micros();
+  if (!_sensor->readFrame(frame)) {
+    return TCS3430_POLL_ERROR;
+  }
+  uint32_t now = frame->timestamp;
+  uint16_t raw[4] = {frame->z, frame->y, frame->ir1, frame->ch3};
+  bool repeat = memcmp(raw, _last, sizeof(raw)) == 0;
+  memcpy(_last, raw, sizeof(raw));
+  uint32_t period = scale(_nominal);
+  const uint32_t fine = TCS3430_STEP_MICROS / 8;
+
+  if (_state == kSchedUnknown) {
+    // The first read only fixes what the old data looks like
+    if (_stale && !repeat) {
+      _edge = _stale_at + (start - _stale_at) / 2;
+      _window = start - _stale_at + fine;
+      _state = kSchedTracking;
+      _stale = false;
+      _next = _edge + period - _window;
+    } else if (_stale && now - _changed_at > 2 * period + period / 4) {
+      // Nothing has changed for over two cycles: a static scene
+      _edge = start;
+      _window = period / 8;
+      _state = kSchedTracking;
+      _stale = false;
+      _static = true;
+      _next = now + period;
+    } else {
+      _stale = true;
+      _stale_at = start;
+      _next = now + (period / 16 > fine ? period / 16 : fine);
+    }
+    return TCS3430_POLL_PENDING;
+  }
+
+  bool started = _state == kSchedStarted;
+  uint32_t predicted = _edge + (started ? scale(_integration) : period);
+  uint16_t late = 0;
+  if (!_stale && !started && (int32_t)(now - predicted) >= 0) {
+    // Called late: the newest end is a later one
+    late = (now - predicted) / period;
+    predicted += late * period;
+  }
+
+  if (repeat) {
+    // As far off as a learnable oscillator error, plus the edge error
+    uint32_t slack = period / 4 + _window;
+    if (started) {
+      slack += (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS;
+    }
+    if (!_static && (int32_t)(now - predicted) <= (int32_t)slack) {
+      if (_window == 0) {
+        _window = 2 * fine;
+      }
+      // Still the previous integration: look again shortly, backing off
+      // once past the prediction in case the scene is static
+      uint32_t gap = _window / 4 > fine ? _window / 4 : fine;
+      if ((int32_t)(now - predicted) > (int32_t)gap) {
+        gap = now - predicted;
+      }
+      _stale = true;
+      _stale_at = start;
+      _next = now + gap;
+      return TCS3430_POLL_PENDING;
+    }
+  }
+
+  uint32_t end = predicted;
+  bool measured = false;
+  if (!repeat && _stale) {
+    end = _stale_at + (start - _stale_at) / 2;
+    measured = true;
+  } else if (!repeat && _window && (int32_t)(start - predicted) < 0) {
+    // New on the first read: the end came before the probe window. Guess
+    // a window further back and probe twice as wide; the gap closes
+    // within a few samples.
+    end = predicted - 2 * _window;
+    _window *= 2;
+  }
+
+  uint32_t elapsed = (uint32_t)_cycles + 1 + late;
+  uint32_t width = start - _stale_at;
+  if (measured && !started) {
+    // The base stays put, so estimates get better as the cycles between
+    // it and the end add up; keep whichever has the smallest error
+    uint64_t span = (uint64_t)elapsed * _nominal;
+    if (_have_base) {
+      uint32_t error = (uint64_t)(_base_width + width) * 32768 / span;
+      uint64_t ratio = (uint64_t)(end - _base) * 65536 / span;
+      // Outside +-25% is a misread edge, not the oscillator
+      if (error <= TCS3430_SCHED_MAX_ERROR && error < _error &&
+          ratio > 49152 && ratio < 81920) {
+        _ratio = ratio;
+        _error = error;
+      }
+    }
+    _window /= 2;
+    if (_window <= 2 * fine) {
+      _window = 0;
+      _locked = 0;
+    }
+  }
+  if (measured &&
+      (started || !_have_base || elapsed >= TCS3430_SCHED_MAX_SPAN)) {
+    _base = end;
+    _base_width = width;
+    _have_base = true;
+    _cycles = 0;
+  } else {
+    _cycles = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+  }
+  if (_window == 0 && ++_locked >= 16) {
+    _window = 2 * fine;
+  }
+  if (_window > period / 4) {
+    _window = period / 4;
+  }
+
+  _edge = end;
+  _state = kSchedTracking;
+  _stale = false;
+  // A static scene cannot be bracketed: read once per predicted cycle
+  // until the data moves again
+  _static = repeat;
+  period = scale(_nominal);
+  _next = end + period;
+  if (_window && !repeat) {
+    _next -= _window;
+  } else {
+    _next += fine;
+  }
+  return TCS3430_POLL_READY;
+}
+
+/*!
+ *    @brief  The ALS cycle length the scheduler has learned: the nominal
+ *            getCycleMicros() corrected for the oscillator
+ *    @return Cycle length in microseconds
+ */
+uint32_t Adafruit_TCS3430_Scheduler::getLearnedCycleMicros() {
+  prepare();
+  return scale(_nominal);
+}
+
+/*!
+ *    @brief  Start over after a configuration change, and fetch the
+ *            nominal cycle and integration lengths once per change
+ */
+void Adafruit_TCS3430_Scheduler::prepare() {
+  uint16_t changes = _sensor->getConfigChangeCount();
+  if (changes != _changes) {
+    _changes = changes;
+    _changed_at = _sensor->getConfigChangeMicros();
+    _state = kSchedUnknown;
+    _nominal = 0;
+    _stale = false;
+    _static = false;
+    _have_base = false;
+    _next = _changed_at;
+  }
+  if (_nominal != 0) {
+    return;
+  }
+  uint8_t atime = _sensor->getIntegrationCycles();
+  bool wait_enable = _sensor->isWaitEnabled();
+  // AEN 0 -> 1 runs an auto-zero pass before the first integration
+  _integration = (uint32_t)(TCS3430_AZ_STEPS + atime + 1) * TCS3430_STEP_MICROS;
+  _nominal = Adafruit_TCS3430::cycleMicros(
+      atime, wait_enable, wait_enable ? _sensor->getWaitCycles() : 0,
+      wait_enable && _sensor->getWaitLong());
+}
+
+/*!
+ *    @brief  Scale a nominal duration by the learned oscillator speed
+ *    @param  us Nominal duration
+ *    @return Expected real duration
+ */
+uint32_t Adafruit_TCS3430_Scheduler::scale(uint32_t us) {
+  return (uint64_t)us * _ratio >> 16;
+}
@@ -0,0 +1,66 @@
+/*!
+ *  @file Adafruit_TCS3430_Scheduler.h
+ *
+ * 	Deadline read scheduler for the TCS3430: predicts where each ALS
+ * 	integration ends and reads it once, just after
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_SCHEDULER_H
+#define _ADAFRUIT_TCS3430_SCHEDULER_H
+
+#include "Adafruit_TCS3430.h"
+
+/*!
+ *    @brief  Read scheduler. Keeps its own state, so a driver that does
+ *            not schedule reads carries none of it; it follows the
+ *            driver's configuration changes through
+ *            getConfigChangeCount() and starts over after each one. The
+ *            learned oscillator speed is kept across changes.
+ */
+class Adafruit_TCS3430_Scheduler {
+ public:
+  Adafruit_TCS3430_Scheduler(Adafruit_TCS3430* sensor);
+
+  bool restartCycle();
+  uint32_t nextSampleAt();
+  bool isFreshDataDue();
+  tcs3430_poll_t poll(tcs3430_frame_t* frame);
+  uint32_t getLearnedCycleMicros();
+
+ private:
+  void prepare();
+  uint32_t scale(uint32_t us);
+
+  Adafruit_TCS3430* _sensor; ///< Sensor being read
+  uint16_t _changes = 0;     ///< getConfigChangeCount() last seen
+  uint32_t _changed_at = 0;  ///< micros() of that change
+  uint8_t _state = 0;        ///< Phase, kSched*
+  uint32_t _ratio = 65536;   ///< Learned cycle / nominal cycle, Q16
+  uint16_t _error = 0xFFFF;  ///< Error bound of _ratio, Q16
+  uint32_t _nominal = 0;     ///< Nominal cycle in us, 0 to recompute
+  uint32_t _integration = 0; ///< Nominal restart to first end in us
+  uint32_t _edge = 0;        ///< Last integration end (or restart)
+  uint32_t _next = 0;        ///< micros() of the next scheduled read
+  uint32_t _window = 0;      ///< Measuring: probe this early; 0 locked
+  bool _stale = false;       ///< A read of this sample found old data
+  uint32_t _stale_at = 0;    ///< When it last did
+  bool _static = false;      ///< Last sample repeated: a static scene
+  bool _have_base = false;   ///< _base holds a measured end
+  uint32_t _base = 0;        ///< Measured integration end
+  uint32_t _base_width = 0;  ///< Bracket _base was found in
+  uint16_t _cycles = 0;      ///< Cycles from _base to the edge
+  uint8_t _locked = 0;       ///< Samples since the last measurement
+  uint16_t _last[4] = {0};   ///< Channels of the last scheduled read
+};
+
+#endif
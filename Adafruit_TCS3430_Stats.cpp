@@ -0,0 +1,113 @@
+/*!
+ *  @file Adafruit_TCS3430_Stats.cpp
+ *
+ * 	Register mapping and printing for the TCS3430 bus instrumentation
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Stats.h"
+
+#include "Adafruit_TCS3430.h"
+
+/** switch case mapping a register address to its row */
+#define TCS3430_STATS_REG_CASE(name)                                           \
+  case TCS3430_REG_##name:                                                     \
+    return TCS3430_STATS_REG_##name;
+/** switch case printing a method name */
+#define TCS3430_STATS_API_NAME(id, name)                                       \
+  case TCS3430_API_##id:                                                       \
+    n += out.print(F(#name));                                                  \
+    break;
+/** switch case printing a register name */
+#define TCS3430_STATS_REG_NAME(name)                                           \
+  case TCS3430_STATS_REG_##name:                                               \
+    n += out.print(F(#name));                                                  \
+    break;
+
+/*!
+ *    @brief  Row a transaction starting at a register is counted under
+ *    @param  reg Register address
+ *    @return tcs3430_stats_reg_t row
+ */
+uint8_t Adafruit_TCS3430_Stats::registerRow(uint8_t reg) {
+  switch (reg) {
+    TCS3430_STATS_REG_LIST(TCS3430_STATS_REG_CASE)
+    default:
+      return TCS3430_STATS_REG_OTHER;
+  }
+}
+
+/*!
+ *    @brief  Print the totals and every method and register with traffic,
+ *            one per line: calls (methods only), transactions, bytes
+ *            read, bytes written and bus microseconds
+ *    @param  stats Snapshot to print
+ *    @param  out Stream to print to, e.g. Serial
+ */
+void Adafruit_TCS3430_Stats::print(const tcs3430_stats_t* stats,
+                                   Print& out) {
+  out.print(F("TCS3430 bus: "));
+  printRow(out, &stats->total);
+
+  for (uint8_t i = 0; i < TCS3430_API_COUNT; i++) {
+    if (!stats->calls[i] && !stats->api[i].transactions) {
+      continue;
+    }
+    size_t n = 0;
+    switch (i) {
+      TCS3430_STATS_API_LIST(TCS3430_STATS_API_NAME)
+      default:
+        break;
+    }
+    while (n++ < 24) {
+      out.print(' ');
+    }
+    out.print(F("calls "));
+    out.print(stats->calls[i]);
+    out.print(' ');
+    printRow(out, &stats->api[i]);
+  }
+
+  for (uint8_t i = 0; i < TCS3430_STATS_REG_COUNT; i++) {
+    if (!stats->reg[i].transactions) {
+      continue;
+    }
+    size_t n = out.print(F("reg "));
+    switch (i) {
+      TCS3430_STATS_REG_LIST(TCS3430_STATS_REG_NAME)
+      default:
+        n += out.print(F("other"));
+        break;
+    }
+    while (n++ < 24) {
+      out.print(' ');
+    }
+    printRow(out, &stats->reg[i]);
+  }
+}
+
+/*!
+ *    @brief  Print one set of counters and end the line
+ *    @param  out Stream to print to
+ *    @param  io Counters
+ */
+void Adafruit_TCS3430_Stats::printRow(Print& out,
+                                      const tcs3430_io_stats_t* io) {
+  out.print(F("xfers "));
+  out.print(io->transactions);
+  out.print(F(" rd "));
+  out.print(io->bytes_read);
+  out.print(F(" wr "));
+  out.print(io->bytes_written);
+  out.print(F(" us "));
+  out.println(io->micros);
+}
@@ -0,0 +1,180 @@
+/*!
+ *  @file Adafruit_TCS3430_Stats.h
+ *
+ * 	Optional bus instrumentation for the TCS3430 driver: transactions,
+ * 	bytes and bus time per public method and per register.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_STATS_H
+#define _ADAFRUIT_TCS3430_STATS_H
+
+#include "Arduino.h"
+
+/*
+ * Build with -DTCS3430_INSTRUMENT (a compiler flag, like
+ * TCS3430_FIXED_POINT) to count the driver's bus traffic. Every register
+ * access goes through one read or one write helper; each is one
+ * transaction. A read moves the register address (1 byte written) then
+ * the data; a write moves the address and the data. Bursts are charged to
+ * the register they start at.
+ *
+ * Per method, traffic is charged to the outermost public call only, so
+ * getIR2() includes the polls and mux writes it makes and the method rows
+ * add up to the totals. Time is bus time: micros() around each
+ * transaction, not time spent waiting for the sensor.
+ *
+ * Costs about 1.7 KB of RAM per sensor and two micros() calls per
+ * transaction. Without the flag none of the counters or bookkeeping are
+ * compiled in; getStats() reports zeros and printStats() prints nothing.
+ */
+
+/** Public Adafruit_TCS3430 methods that can touch the bus: id, name */
+#define TCS3430_STATS_API_LIST(M)                                              \
+  M(BEGIN, begin)                                                              \
+  M(RESUME, resume)                                                            \
+  M(SAVE_SNAPSHOT, saveSnapshot)                                               \
+  M(SET_INTEGRATION_CYCLES, setIntegrationCycles)                              \
+  M(GET_INTEGRATION_CYCLES, getIntegrationCycles)                              \
+  M(SET_INTEGRATION_TIME, setIntegrationTime)                                  \
+  M(GET_INTEGRATION_TIME, getIntegrationTime)                                  \
+  M(SET_WAIT_CYCLES, setWaitCycles)                                            \
+  M(GET_WAIT_CYCLES, getWaitCycles)                                            \
+  M(SET_WAIT_TIME, setWaitTime)                                                \
+  M(GET_WAIT_TIME, getWaitTime)                                                \
+  M(SET_ALS_THRESHOLD_LOW, setALSThresholdLow)                                 \
+  M(GET_ALS_THRESHOLD_LOW, getALSThresholdLow)                                 \
+  M(SET_ALS_THRESHOLD_HIGH, setALSThresholdHigh)                               \
+  M(GET_ALS_THRESHOLD_HIGH, getALSThresholdHigh)                               \
+  M(SET_ALS_THRESHOLDS, setALSThresholds)                                      \
+  M(SET_THRESHOLD_TRACKING, setThresholdTracking)                              \
+  M(SET_INTERRUPT_PERSISTENCE, setInterruptPersistence)                        \
+  M(GET_INTERRUPT_PERSISTENCE, getInterruptPersistence)                        \
+  M(SET_WAIT_LONG, setWaitLong)                                                \
+  M(GET_WAIT_LONG, getWaitLong)                                                \
+  M(SET_ALSMUX_IR2, setALSMUX_IR2)                                             \
+  M(GET_ALSMUX_IR2, getALSMUX_IR2)                                             \
+  M(SET_ALS_GAIN, setALSGain)                                                  \
+  M(GET_ALS_GAIN, getALSGain)                                                  \
+  M(IS_ALS_SATURATED, isALSSaturated)                                          \
+  M(CLEAR_ALS_SATURATED, clearALSSaturated)                                    \
+  M(IS_ALS_INTERRUPT, isALSInterrupt)                                          \
+  M(CLEAR_ALS_INTERRUPT, clearALSInterrupt)                                    \
+  M(GET_CHANNELS, getChannels)                                                 \
+  M(GET_IR2, getIR2)                                                           \
+  M(READ_FRAME, readFrame)                                                     \
+  M(READ_FRAME_ASYNC, readFrameAsync)                                          \
+  M(IS_FRAME_ASYNC_PENDING, isFrameAsyncPending)                               \
+  M(GET_CIE, getCIE)                                                           \
+  M(GET_CCT, getCCT)                                                           \
+  M(GET_LUX, getLux)                                                           \
+  M(GET_CIE_FIXED, getCIEFixed)                                                \
+  M(GET_CCT_FIXED, getCCTFixed)                                                \
+  M(GET_LUX_FIXED, getLuxFixed)                                                \
+  M(START_IR2, startIR2)                                                       \
+  M(START_FRAME, startFrame)                                                   \
+  M(POLL, poll)                                                                \
+  M(CANCEL_MEASUREMENT, cancelMeasurement)                                     \
+  M(GET_CYCLE_MICROS, getCycleMicros)                                          \
+  M(RESTART_CYCLE, restartCycle)                                               \
+  M(IS_SETTLING, isSettling)                                                   \
+  M(BEGIN_CAPTURE, beginCapture)                                               \
+  M(END_CAPTURE, endCapture)                                                   \
+  M(BEGIN_EVENTS, beginEvents)                                                 \
+  M(END_EVENTS, endEvents)                                                     \
+  M(SERVICE, service)                                                          \
+  M(SET_INTERRUPT_CLEAR_ON_READ, setInterruptClearOnRead)                      \
+  M(GET_INTERRUPT_CLEAR_ON_READ, getInterruptClearOnRead)                      \
+  M(SET_SLEEP_AFTER_INTERRUPT, setSleepAfterInterrupt)                         \
+  M(GET_SLEEP_AFTER_INTERRUPT, getSleepAfterInterrupt)                         \
+  M(SET_AUTO_ZERO_MODE, setAutoZeroMode)                                       \
+  M(GET_AUTO_ZERO_MODE, getAutoZeroMode)                                       \
+  M(SET_RUN_AUTO_ZERO_EVERY_N, setRunAutoZeroEveryN)                           \
+  M(GET_RUN_AUTO_ZERO_EVERY_N, getRunAutoZeroEveryN)                           \
+  M(ENABLE_SATURATION_INT, enableSaturationInt)                                \
+  M(ENABLE_ALS_INT, enableALSInt)                                              \
+  M(WAIT_ENABLE, waitEnable)                                                   \
+  M(IS_WAIT_ENABLED, isWaitEnabled)                                            \
+  M(ALS_ENABLE, ALSEnable)                                                     \
+  M(IS_ALS_ENABLED, isALSEnabled)                                              \
+  M(POWER_ON, powerOn)                                                         \
+  M(IS_POWERED_ON, isPoweredOn)                                                \
+  M(APPLY_CONFIG, applyConfig)                                                 \
+  M(READ_CONFIG, readConfig)                                                   \
+  M(ENABLE_REGISTER_CACHE, enableRegisterCache)                                \
+  M(RESYNC, resync)
+
+/** Registers counted individually, as TCS3430_REG_ suffixes */
+#define TCS3430_STATS_REG_LIST(M)                                              \
+  M(ENABLE)                                                                    \
+  M(ATIME)                                                                     \
+  M(WTIME)                                                                     \
+  M(AILTL)                                                                     \
+  M(AIHTL)                                                                     \
+  M(PERS)                                                                      \
+  M(CFG0)                                                                      \
+  M(CFG1)                                                                      \
+  M(REVID)                                                                     \
+  M(ID)                                                                        \
+  M(STATUS)                                                                    \
+  M(CH0DATAL)                                                                  \
+  M(CFG2)                                                                      \
+  M(CFG3)                                                                      \
+  M(AZ_CONFIG)                                                                 \
+  M(INTENAB)
+
+/** Enum entry for a method */
+#define TCS3430_STATS_API_ENUM(id, name) TCS3430_API_##id,
+/** Enum entry for a register */
+#define TCS3430_STATS_REG_ENUM(name) TCS3430_STATS_REG_##name,
+
+/** Instrumented public methods */
+typedef enum {
+  TCS3430_STATS_API_LIST(TCS3430_STATS_API_ENUM) TCS3430_API_COUNT ///< None
+} tcs3430_api_t;
+
+/** Register rows in the statistics */
+typedef enum {
+  TCS3430_STATS_REG_LIST(TCS3430_STATS_REG_ENUM)
+      TCS3430_STATS_REG_OTHER, ///< Any other start address
+  TCS3430_STATS_REG_COUNT      ///< Number of register rows
+} tcs3430_stats_reg_t;
+
+/** Bus traffic counters */
+typedef struct {
+  uint32_t transactions;  ///< Register reads and writes
+  uint32_t bytes_read;    ///< Data bytes received
+  uint32_t bytes_written; ///< Bytes sent, register addresses included
+  uint32_t micros;        ///< Time spent in bus transactions
+} tcs3430_io_stats_t;
+
+/** Snapshot of everything counted since the last resetStats() */
+typedef struct {
+  tcs3430_io_stats_t total;                        ///< All traffic
+  uint32_t calls[TCS3430_API_COUNT];               ///< Outermost calls
+  tcs3430_io_stats_t api[TCS3430_API_COUNT];       ///< Traffic per method
+  tcs3430_io_stats_t reg[TCS3430_STATS_REG_COUNT]; ///< Traffic per register
+} tcs3430_stats_t;
+
+/*!
+ *    @brief  Register mapping and printing for tcs3430_stats_t
+ */
+class Adafruit_TCS3430_Stats {
+ public:
+  static uint8_t registerRow(uint8_t reg);
+  static void print(const tcs3430_stats_t* stats, Print& out);
+
+ private:
+  static void printRow(Print& out, const tcs3430_io_stats_t* io);
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*!
+ *  @file Adafruit_TCS3430_Transport.cpp
+ *
+ * 	Register transport interface for the TCS3430 driver
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Transport.h"
+
+#include <Adafruit_BusIO_Register.h>
+
+/*!
+ *    @brief  Start a transfer without waiting for it. Blocking transports
+ *            run it here and call its callback before returning; queued
+ *            ones (Adafruit_TCS3430_Async.h) return at once.
+ *    @param  transfer Transfer to run; must stay valid until its callback
+ *    @return false if it could not be started (the callback is not called)
+ */
+bool Adafruit_TCS3430_Transport::submit(tcs3430_transfer_t* transfer) {
+  bool ok = transfer->write
+                ? write(transfer->reg, transfer->data, transfer->len)
+                : read(transfer->reg, transfer->data, transfer->len);
+  if (transfer->done) {
+    transfer->done(transfer, ok);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Instantiates a BusIO transport
+ *    @param  addr The I2C address to be used.
+ *    @param  theWire The Wire object to be used for I2C connections.
+ */
+Adafruit_TCS3430_BusIO::Adafruit_TCS3430_BusIO(uint8_t addr, TwoWire* theWire)
+    : _dev(addr, theWire) {}
+
+/*!
+ *    @brief  Start the Wire bus
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_BusIO::begin() {
+  return _dev.begin(false);
+}
+
+/*!
+ *    @brief  Read registers in one transaction
+ *    @param  reg First register address
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_BusIO::read(uint8_t reg, uint8_t* buffer, uint8_t len) {
+  Adafruit_BusIO_Register reg_obj = Adafruit_BusIO_Register(&_dev, reg);
+  return reg_obj.read(buffer, len);
+}
+
+/*!
+ *    @brief  Write registers in one transaction
+ *    @param  reg First register address
+ *    @param  buffer Data
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_TCS3430_BusIO::write(uint8_t reg, const uint8_t* buffer,
+                                   uint8_t len) {
+  Adafruit_BusIO_Register reg_obj = Adafruit_BusIO_Register(&_dev, reg);
+  return reg_obj.write((uint8_t*)buffer, len);
+}
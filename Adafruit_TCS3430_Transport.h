@@ -0,0 +1,104 @@
+/*!
+ *  @file Adafruit_TCS3430_Transport.h
+ *
+ * 	Register transport interface for the TCS3430 driver, and the
+ * 	Adafruit BusIO (TwoWire) backend begin() uses by default
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_TRANSPORT_H
+#define _ADAFRUIT_TCS3430_TRANSPORT_H
+
+#include <Adafruit_I2CDevice.h>
+
+#include "Arduino.h"
+
+/*
+ * All of the driver's bus traffic is register bursts: write the register
+ * address, then either read or write len bytes. A transport does exactly
+ * that and nothing else, so the driver runs unchanged over TwoWire
+ * (Adafruit_TCS3430_BusIO), Linux i2c-dev (Adafruit_TCS3430_LinuxI2C) or
+ * a queued, interrupt/DMA-completed bus (Adafruit_TCS3430_Async.h).
+ */
+
+struct tcs3430_transfer;
+
+/** Called when a submitted transfer finishes, possibly from an interrupt */
+typedef void (*tcs3430_transfer_cb_t)(struct tcs3430_transfer* transfer,
+                                      bool ok);
+
+/** One register burst for Adafruit_TCS3430_Transport::submit(). The
+ *  caller owns it and its data until the callback runs. */
+typedef struct tcs3430_transfer {
+  uint8_t reg;                ///< First register address
+  uint8_t len;                ///< Data bytes
+  bool write;                 ///< true to write data, false to read into it
+  uint8_t* data;              ///< Bytes to write, or where to read to
+  tcs3430_transfer_cb_t done; ///< Completion callback, may be NULL
+  void* context;              ///< For the callback
+  struct tcs3430_transfer* next; ///< Queue link, owned by the transport
+} tcs3430_transfer_t;
+
+/*!
+ *    @brief  How the driver reaches the sensor's registers
+ */
+class Adafruit_TCS3430_Transport {
+ public:
+  virtual ~Adafruit_TCS3430_Transport() {}
+
+  /*!
+   *    @brief  Prepare the bus. Called by Adafruit_TCS3430::begin() and
+   *            resume(); the chip ID read that follows is the presence
+   *            check.
+   *    @return true on success
+   */
+  virtual bool begin() {
+    return true;
+  }
+
+  /*!
+   *    @brief  Read registers in one transaction, blocking
+   *    @param  reg First register address
+   *    @param  buffer Destination
+   *    @param  len Number of bytes
+   *    @return true on success
+   */
+  virtual bool read(uint8_t reg, uint8_t* buffer, uint8_t len) = 0;
+
+  /*!
+   *    @brief  Write registers in one transaction, blocking
+   *    @param  reg First register address
+   *    @param  buffer Data
+   *    @param  len Number of bytes
+   *    @return true on success
+   */
+  virtual bool write(uint8_t reg, const uint8_t* buffer, uint8_t len) = 0;
+
+  virtual bool submit(tcs3430_transfer_t* transfer);
+};
+
+/*!
+ *    @brief  Transport over an Adafruit_I2CDevice on a TwoWire bus
+ */
+class Adafruit_TCS3430_BusIO : public Adafruit_TCS3430_Transport {
+ public:
+  Adafruit_TCS3430_BusIO(uint8_t addr, TwoWire* theWire = &Wire);
+
+  bool begin();
+  bool read(uint8_t reg, uint8_t* buffer, uint8_t len);
+  bool write(uint8_t reg, const uint8_t* buffer, uint8_t len);
+
+ private:
+  Adafruit_I2CDevice _dev; ///< The sensor on the bus
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*!\
+ * @file async_frames.ino
+ *
+ * Non-blocking reads for TCS3430 XYZ Tristimulus Color Sensor. The driver
+ * runs over a queued transport: readFrameAsync() returns at once and the
+ * callback prints the frame when the transfer completes. Here the
+ * transfers run from bus.service() in loop(); a DMA or interrupt-driven
+ * I2C backend derived from Adafruit_TCS3430_AsyncTransport completes them
+ * in the background instead, with the same sketch code.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_Async.h"
+
+Adafruit_TCS3430_BusIO wire_bus(TCS3430_DEFAULT_ADDR, &Wire);
+Adafruit_TCS3430_AsyncLoop bus(&wire_bus);
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+
+tcs3430_frame_t frame;
+uint32_t last_read = 0;
+
+void frameDone(tcs3430_frame_t* f, bool ok, void* context) {
+  (void)context;
+  if (!ok) {
+    Serial.println(F("Read failed"));
+    return;
+  }
+  Serial.print(F("t="));
+  Serial.print(f->timestamp);
+  Serial.print(F(" Z="));
+  Serial.print(f->z);
+  Serial.print(F(" Y="));
+  Serial.print(f->y);
+  Serial.print(F(" IR1="));
+  Serial.print(f->ir1);
+  Serial.print(F(" X="));
+  Serial.println(f->ch3);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Async Frames"));
+
+  // Set-up calls block until their transfers are done, as usual
+  if (!tcs.begin(&bus)) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+  tcs.setIntegrationTime(100.0);
+}
+
+void loop() {
+  if (millis() - last_read >= 250 && !tcs.isFrameAsyncPending()) {
+    last_read = millis();
+    tcs.readFrameAsync(&frame, frameDone);
+  }
+  // Other work goes here; the bus transfer waits for service()
+  bus.service();
+}
@@ -0,0 +1,51 @@
+/*!\
+ * @file binary_log.ino
+ *
+ * Binary frame logger for TCS3430 XYZ Tristimulus Color Sensor. Streams
+ * every frame with its gain and ATIME as a compact delta-coded log (about
+ * 8 bytes a frame instead of 40 as text) on Serial. Capture it on the host
+ * and decode it there:
+ *
+ *   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > run.tcsl
+ *   tcs3430_log csv run.tcsl
+ *
+ * tcs3430_log is built by extras/host. To log to an SD card instead, pass
+ * the open File to logger.begin(); call logger.flush() before closing it.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_Log.h"
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_LogWriter<128> logger;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  // No text on the port: everything after this is log data
+  tcs.enableRegisterCache(true);
+  if (!tcs.begin()) {
+    while (1) {
+      delay(10);
+    }
+  }
+  tcs.setIntegrationTime(100.0);
+  // AINT every cycle, cleared by the frame read: marks fresh frames
+  tcs.setInterruptPersistence(TCS3430_PERS_EVERY);
+  tcs.setInterruptClearOnRead(true);
+  logger.begin(&Serial);
+}
+
+void loop() {
+  tcs3430_frame_t frame;
+  if (tcs.readFrame(&frame) && (frame.flags & TCS3430_FRAME_INTERRUPT)) {
+    // Register cache on: gain and ATIME come from the cache, not the bus
+    logger.append(&frame, tcs.getALSGain(), tcs.getIntegrationCycles());
+  }
+  delay(10);
+}
@@ -0,0 +1,112 @@
+/*!\
+ * @file calibrate.ino
+ *
+ * Per-device color matrix calibration for TCS3430 XYZ Tristimulus Color
+ * Sensor. Point the sensor and a reference colorimeter at the same light,
+ * type the reference "X Y Z" (Y in lux) into the serial monitor, and
+ * repeat for at least four sources of different spectra (daylight, warm
+ * LED, cool LED, incandescent...). Type "f" to fit: the sketch prints the
+ * fit error and a calibration blob. Paste the blob into kStoredBlob below
+ * and from then on this unit uses its own matrix; a real product would
+ * keep the blob in EEPROM or flash instead.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_Calibration.h"
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_Calibration cal;
+tcs3430_matrix_t matrix;
+
+// Paste the blob printed by "f" here
+static const tcs3430_cal_blob_t kStoredBlob = {};
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Color Matrix Calibration"));
+
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+  tcs.setALSGain(TCS3430_GAIN_16X);
+  tcs.setIntegrationTime(100.0f);
+
+  if (Adafruit_TCS3430_Calibration::load(&kStoredBlob, &matrix)) {
+    tcs.setColorMatrix(&matrix);
+    Serial.println(F("Using stored calibration"));
+  } else {
+    Serial.println(F("No stored calibration, using the default matrix"));
+  }
+  Serial.println(F("Enter reference X Y Z (Y in lux), or f to fit"));
+}
+
+void fitAndPrint() {
+  tcs3430_cal_t result = cal.fit(&matrix);
+  if (result != TCS3430_CAL_OK) {
+    Serial.print(F("Fit failed: "));
+    Serial.println(result == TCS3430_CAL_TOO_FEW    ? F("need 4 samples")
+                   : result == TCS3430_CAL_SINGULAR ? F("sources too alike")
+                                                    : F("matrix out of range"));
+    return;
+  }
+  Serial.print(F("RMS error (counts): "));
+  Serial.println(cal.getRMSError(), 2);
+
+  tcs3430_cal_blob_t blob;
+  Adafruit_TCS3430_Calibration::save(&matrix, &blob);
+  const uint8_t* bytes = (const uint8_t*)&blob;
+  Serial.print(F("Blob: {"));
+  for (uint8_t i = 0; i < sizeof(blob); i++) {
+    if (i) {
+      Serial.print(F(", "));
+    }
+    Serial.print(F("0x"));
+    if (bytes[i] < 0x10) {
+      Serial.print('0');
+    }
+    Serial.print(bytes[i], HEX);
+  }
+  Serial.println(F("}"));
+  tcs.setColorMatrix(&matrix);
+}
+
+void loop() {
+  if (Serial.available()) {
+    if (Serial.peek() == 'f') {
+      Serial.read();
+      fitAndPrint();
+      return;
+    }
+    tcs3430_xyz_t reference;
+    reference.X = Serial.parseFloat();
+    reference.Y = Serial.parseFloat();
+    reference.Z = Serial.parseFloat();
+    delay(tcs.getCycleMicros() / 1000 * 2);
+    if (cal.addReading(&tcs, &reference)) {
+      Serial.print(F("Sample "));
+      Serial.print(cal.getSampleCount());
+      Serial.println(F(" added"));
+    }
+    return;
+  }
+
+  float cie_x, cie_y;
+  if (tcs.getCIE(&cie_x, &cie_y)) {
+    Serial.print(F("CIE x: "));
+    Serial.print(cie_x, 4);
+    Serial.print(F("  y: "));
+    Serial.print(cie_y, 4);
+    Serial.print(F("  Lux: "));
+    Serial.println(tcs.getLux(), 1);
+  }
+  delay(1000);
+}
@@ -0,0 +1,80 @@
+/*!\
+ * @file deep_sleep_resume.ino
+ *
+ * Warm resume for TCS3430 XYZ Tristimulus Color Sensor. The first boot
+ * configures the sensor and saves a snapshot; every wake after that
+ * checks the sensor against the snapshot in one burst read and only
+ * reconfigures if it lost power. On ESP32 the snapshot lives in RTC RAM
+ * across deep sleep; elsewhere the sketch just loops, calling resume()
+ * each time to show the cost.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+
+#define SLEEP_SECONDS 5
+
+#if defined(ARDUINO_ARCH_ESP32)
+RTC_DATA_ATTR tcs3430_snapshot_t snapshot;
+#else
+tcs3430_snapshot_t snapshot;
+#endif
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+
+void configure() {
+  tcs.setALSGain(TCS3430_GAIN_16X);
+  tcs.setIntegrationTime(100.0f);
+  tcs.saveSnapshot(&snapshot);
+}
+
+void wake() {
+  uint32_t start = micros();
+  tcs3430_resume_t result = tcs.resume(&snapshot);
+  uint32_t elapsed = micros() - start;
+
+  if (result == TCS3430_RESUME_FAILED) {
+    // First boot, or no sensor: the slow path
+    if (!tcs.begin()) {
+      Serial.println(F("Failed to find TCS3430 chip"));
+      return;
+    }
+    configure();
+    Serial.println(F("Configured from scratch"));
+  } else {
+    Serial.print(result == TCS3430_RESUME_MATCHED ? F("Resumed in ")
+                                                  : F("Restored in "));
+    Serial.print(elapsed);
+    Serial.println(F(" us"));
+  }
+
+  // Wait for a full integration before reading
+  delay(tcs.getCycleMicros() / 1000 + 1);
+  uint16_t x, y, z, ir1;
+  if (tcs.getChannels(&x, &y, &z, &ir1)) {
+    Serial.print(F("X="));
+    Serial.print(x);
+    Serial.print(F("  Y="));
+    Serial.print(y);
+    Serial.print(F("  Z="));
+    Serial.println(z);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  Wire.begin();
+  wake();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  Serial.flush();
+  esp_sleep_enable_timer_wakeup((uint64_t)SLEEP_SECONDS * 1000000);
+  esp_deep_sleep_start();
+#endif
+}
+
+void loop() {
+  delay(SLEEP_SECONDS * 1000);
+  wake();
+}
@@ -0,0 +1,65 @@
+/*!\
+ * @file duty_cycle.ino
+ *
+ * Low power sampling for TCS3430 XYZ Tristimulus Color Sensor. Asks the
+ * planner for one sample every 5 seconds, no more than 200 ms late, and
+ * prints the scheme it chose (wait, WLONG, sleep after interrupt or
+ * power-down), the achieved period and the estimated sensor current.
+ * Try a longer latency, or host_timed = false, to see the other schemes.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_DutyCycle.h"
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_DutyCycle duty(&tcs);
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Duty Cycle"));
+
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+  tcs.setIntegrationTime(100.0);
+
+  if (!duty.begin(5000, 200)) {
+    Serial.println(F("No scheme meets that period and latency"));
+    while (1) {
+      delay(10);
+    }
+  }
+  const tcs3430_duty_plan_t* plan = duty.getPlan();
+  const char* modes[] = {"continuous", "wait", "wait long", "SAI",
+                         "power-down"};
+  Serial.print(F("Mode: "));
+  Serial.print(modes[plan->mode]);
+  Serial.print(F("  Period: "));
+  Serial.print(plan->period_us / 1000);
+  Serial.print(F(" ms  Latency: "));
+  Serial.print(plan->latency_us / 1000);
+  Serial.print(F(" ms  Current: "));
+  Serial.print(plan->current_ua, 2);
+  Serial.println(F(" uA"));
+}
+
+void loop() {
+  tcs3430_frame_t frame;
+  if (duty.poll(&frame) == TCS3430_POLL_READY) {
+    Serial.print(F("t: "));
+    Serial.print(frame.timestamp / 1000);
+    Serial.print(F(" ms  Y: "));
+    Serial.println(frame.y);
+  }
+  // A low power sketch would sleep the MCU here until the next sample
+  delay(10);
+}
@@ -0,0 +1,69 @@
+/*!\
+ * @file flicker.ino
+ *
+ * Flicker meter for TCS3430 XYZ Tristimulus Color Sensor. Captures one
+ * second of Y (a third on AVR) at the fastest integration time (about 360
+ * samples/s), then prints the dominant flicker frequency, percent flicker
+ * and flicker index. Mains ripple (100/120 Hz) and slow LED PWM show up;
+ * anything above about 180 Hz aliases.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_Flicker.h"
+
+#if defined(__AVR__)
+// 6 bytes per sample: a third of a second fits in an Uno's 2KB of SRAM
+#define SAMPLES 120
+#else
+#define SAMPLES 360
+#endif
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_Flicker flicker(&tcs);
+tcs3430_flicker_sample_t samples[SAMPLES];
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Flicker Meter"));
+
+  Wire.setClock(400000); // shorter reads, tighter timestamps
+  tcs.enableRegisterCache(true);
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+  // ATIME=0 tops out at 1023 counts; pick a gain that keeps Y well below
+  tcs.setALSGain(TCS3430_GAIN_16X);
+}
+
+void loop() {
+  if (!flicker.capture(samples, SAMPLES)) {
+    Serial.println(F("Capture failed"));
+    delay(1000);
+    return;
+  }
+
+  tcs3430_flicker_t result;
+  Adafruit_TCS3430_Flicker::analyze(samples, SAMPLES, &result);
+  Serial.print(F("Freq: "));
+  Serial.print(result.frequency_mhz / 1000.0f, 2);
+  Serial.print(F(" Hz  Flicker: "));
+  Serial.print(result.percent / 256.0f, 1);
+  Serial.print(F("%  Index: "));
+  Serial.print(result.index / 32768.0f, 3);
+  Serial.print(F("  Y: "));
+  Serial.print(result.min);
+  Serial.print(F("-"));
+  Serial.print(result.max);
+  Serial.print(F("  Sample us: "));
+  Serial.println(result.interval_us);
+  delay(1000);
+}
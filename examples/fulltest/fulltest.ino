@@ -170,6 +170,14 @@ void setup() {
 }
 
 void loop() {
+  // An IR2 read started last time round is still integrating; the rest of
+  // the sketch can keep running meanwhile
+  tcs3430_frame_t frame;
+  tcs3430_poll_t ir2 = tcs.poll(&frame);
+  if (ir2 == TCS3430_POLL_PENDING) {
+    return;
+  }
+
   if (tcs.isALSSaturated()) {
     Serial.println(F("ALS saturated - clearing"));
     tcs.clearALSSaturated();
@@ -194,5 +202,15 @@ void loop() {
     Serial.println(F("Failed to read channels"));
   }
 
+  if (ir2 == TCS3430_POLL_READY) {
+    Serial.print(F("IR2: "));
+    Serial.println(frame.ch3);
+  }
+
+  // IR2 shares CH3 with X. startIR2() switches the mux and returns at
+  // once; poll() reads it after a full integration and switches back.
+  // getIR2() does the same but blocks for up to two cycles.
+  tcs.startIR2();
+
   delay(1000);
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*!\
+ * @file hdr.ino
+ *
+ * Extended-range measurement for TCS3430 XYZ Tristimulus Color Sensor.
+ * Alternates a 128x gain exposure for dim light with a 1x exposure for
+ * bright light and prints the fused channels and lux, from starlight to
+ * direct sun without changing settings.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_HDR.h"
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_HDR hdr(&tcs);
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 HDR"));
+
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+  tcs.enableRegisterCache(true);
+  if (!hdr.begin()) {
+    Serial.println(F("Failed to start HDR mode"));
+    while (1) {
+      delay(10);
+    }
+  }
+  Serial.print(F("Dynamic range: "));
+  Serial.print(hdr.getDynamicRange());
+  Serial.println(F(":1"));
+}
+
+void loop() {
+  tcs3430_hdr_frame_t frame;
+  if (hdr.poll(&frame) != TCS3430_POLL_READY) {
+    return;
+  }
+  tcs3430_xyz_t xyz;
+  Adafruit_TCS3430_HDR::toXYZ(&frame, &xyz);
+
+  Serial.print(F("Y="));
+  Serial.print(frame.y / 65536.0, 4);
+  Serial.print(F(" lux="));
+  Serial.print(Adafruit_TCS3430_Color::lux(xyz.Y, TCS3430_GAIN_1X, 0), 3);
+  Serial.print(F(" low=0x"));
+  Serial.print(frame.low_mask, HEX);
+  if (frame.flags & TCS3430_FRAME_SATURATED) {
+    Serial.print(F(" saturated"));
+  }
+  if (frame.flags & TCS3430_FRAME_CHANGED) {
+    Serial.print(F(" changed"));
+  }
+  Serial.println();
+}
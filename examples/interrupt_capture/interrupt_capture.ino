@@ -0,0 +1,75 @@
+/*!\
+ * @file interrupt_capture.ino
+ *
+ * INT-pin driven capture for TCS3430 XYZ Tristimulus Color Sensor.
+ * The ISR only notes the edge; service() reads STATUS + all channels in
+ * one burst (which also clears the interrupt) into a ring buffer, and
+ * loop() pulls frames out in batches.
+ * Connect INT to pin 2. The Adafruit breakout has an open-drain inverter
+ * on INT, so active-HIGH at MCU. Needs INPUT_PULLUP.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+
+#define INT_PIN 2
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_Ring<tcs3430_frame_t, 16> frames;
+
+void onSensorInt() {
+  tcs.handleInterrupt();
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Interrupt Capture"));
+
+  tcs.enableRegisterCache(true);
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+
+  tcs.setALSGain(TCS3430_GAIN_16X);
+  tcs.setIntegrationTime(50.0f);
+
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onSensorInt, RISING);
+
+  // One frame per integration cycle
+  tcs.beginCapture(&frames);
+}
+
+void loop() {
+  tcs.service();
+
+  // Print in batches of 8 to show the batch API
+  if (frames.available() >= 8) {
+    tcs3430_frame_t batch[8];
+    uint8_t n = frames.popBatch(batch, 8);
+    for (uint8_t i = 0; i < n; i++) {
+      Serial.print(batch[i].timestamp);
+      Serial.print(F(" us  Z="));
+      Serial.print(batch[i].z);
+      Serial.print(F("  Y="));
+      Serial.print(batch[i].y);
+      Serial.print(F("  IR1="));
+      Serial.print(batch[i].ir1);
+      Serial.print(batch[i].flags & TCS3430_FRAME_CH3_IR2 ? F("  IR2=")
+                                                          : F("  X="));
+      Serial.println(batch[i].ch3);
+    }
+    Serial.print(F("Overruns: "));
+    Serial.print(frames.overruns());
+    Serial.print(F("  Missed: "));
+    Serial.println(tcs.getMissedInterrupts());
+  }
+}
@@ -0,0 +1,73 @@
+/*!\
+ * @file interrupt_events.ino
+ *
+ * Threshold events for TCS3430 XYZ Tristimulus Color Sensor. The ISR only
+ * notes the edge; service() reads STATUS and CH0 in one burst, works out
+ * whether the light went above or below the window or saturated the
+ * sensor, clears just those flags and queues the event for loop().
+ * Connect INT to pin 2. The Adafruit breakout has an open-drain inverter
+ * on INT, so active-HIGH at MCU. Needs INPUT_PULLUP.
+ *
+ * MIT License
+ */
+
+#include "Adafruit_TCS3430.h"
+
+#define INT_PIN 2
+
+Adafruit_TCS3430 tcs = Adafruit_TCS3430();
+Adafruit_TCS3430_Ring<tcs3430_event_t, 8> events;
+
+void onSensorInt() {
+  tcs.handleInterrupt();
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println(F("TCS3430 Interrupt Events"));
+
+  if (!tcs.begin()) {
+    Serial.println(F("Failed to find TCS3430 chip"));
+    while (1) {
+      delay(10);
+    }
+  }
+
+  tcs.setALSGain(TCS3430_GAIN_16X);
+  tcs.setIntegrationTime(100.0f);
+  // Report when CH0 (Z) leaves 200..20000 for 3 cycles in a row
+  tcs.setALSThresholds(200, 20000);
+  tcs.setInterruptPersistence(TCS3430_PERS_3);
+
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onSensorInt, RISING);
+  tcs.beginEvents(&events);
+}
+
+void loop() {
+  tcs.service();
+
+  tcs3430_event_t event;
+  while (events.pop(&event)) {
+    Serial.print(event.timestamp);
+    switch (event.type) {
+      case TCS3430_EVENT_CROSSED_HIGH:
+        Serial.print(F(" us  brighter, Z="));
+        break;
+      case TCS3430_EVENT_CROSSED_LOW:
+        Serial.print(F(" us  darker, Z="));
+        break;
+      case TCS3430_EVENT_SATURATED:
+        Serial.print(F(" us  saturated, Z="));
+        break;
+      default:
+        Serial.print(F(" us  data ready, Z="));
+        break;
+    }
+    Serial.println(event.ch0);
+  }
+}
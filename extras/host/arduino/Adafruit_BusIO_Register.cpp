@@ -0,0 +1,191 @@
+/*!
+ *  @file Adafruit_BusIO_Register.cpp
+ *
+ * 	Host stand-in for Adafruit BusIO's register helpers (I2C only)
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_BusIO_Register.h"
+
+/*!
+ *    @brief  Describe a register
+ *    @param  i2cdevice Device holding the register
+ *    @param  reg_addr Register address
+ *    @param  width Width in bytes (up to 4 for the integer accessors)
+ *    @param  byteorder LSBFIRST or MSBFIRST
+ *    @param  address_width Width of the register address in bytes
+ */
+Adafruit_BusIO_Register::Adafruit_BusIO_Register(Adafruit_I2CDevice* i2cdevice,
+                                                 uint16_t reg_addr,
+                                                 uint8_t width,
+                                                 uint8_t byteorder,
+                                                 uint8_t address_width)
+    : _i2cdevice(i2cdevice),
+      _address(reg_addr),
+      _width(width),
+      _addrwidth(address_width),
+      _byteorder(byteorder),
+      _cached(0) {}
+
+/*!
+ *    @brief  Write raw bytes, prefixed by the register address
+ *    @param  buffer Data
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_BusIO_Register::write(uint8_t* buffer, uint8_t len) {
+  uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF),
+                           (uint8_t)(_address >> 8)};
+  return _i2cdevice->write(buffer, len, true, addrbuffer, _addrwidth);
+}
+
+/*!
+ *    @brief  Write an integer value
+ *    @param  value Value
+ *    @param  numbytes Number of bytes, 0 for the register width
+ *    @return true on success
+ */
+bool Adafruit_BusIO_Register::write(uint32_t value, uint8_t numbytes) {
+  if (numbytes == 0) {
+    numbytes = _width;
+  }
+  if (numbytes > 4) {
+    return false;
+  }
+  _cached = value;
+  for (int i = 0; i < numbytes; i++) {
+    if (_byteorder == LSBFIRST) {
+      _buffer[i] = value & 0xFF;
+    } else {
+      _buffer[numbytes - i - 1] = value & 0xFF;
+    }
+    value >>= 8;
+  }
+  return write(_buffer, numbytes);
+}
+
+/*!
+ *    @brief  Read the register as an integer
+ *    @return Value, or all ones on failure
+ */
+uint32_t Adafruit_BusIO_Register::read(void) {
+  if (!read(_buffer, _width)) {
+    return -1;
+  }
+  uint32_t value = 0;
+  for (int i = 0; i < _width; i++) {
+    value <<= 8;
+    if (_byteorder == LSBFIRST) {
+      value |= _buffer[_width - i - 1];
+    } else {
+      value |= _buffer[i];
+    }
+  }
+  return value;
+}
+
+/*!
+ *    @brief  The last value written or read
+ *    @return Value
+ */
+uint32_t Adafruit_BusIO_Register::readCached(void) {
+  return _cached;
+}
+
+/*!
+ *    @brief  Read raw bytes starting at the register address
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @return true on success
+ */
+bool Adafruit_BusIO_Register::read(uint8_t* buffer, uint8_t len) {
+  uint8_t addrbuffer[2] = {(uint8_t)(_address & 0xFF),
+                           (uint8_t)(_address >> 8)};
+  return _i2cdevice->write_then_read(addrbuffer, _addrwidth, buffer, len);
+}
+
+/*!
+ *    @brief  Read a 16-bit register
+ *    @param  value Destination
+ *    @return true on success
+ */
+bool Adafruit_BusIO_Register::read(uint16_t* value) {
+  if (!read(_buffer, 2)) {
+    return false;
+  }
+  if (_byteorder == LSBFIRST) {
+    *value = _buffer[1];
+    *value <<= 8;
+    *value |= _buffer[0];
+  } else {
+    *value = _buffer[0];
+    *value <<= 8;
+    *value |= _buffer[1];
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Read an 8-bit register
+ *    @param  value Destination
+ *    @return true on success
+ */
+bool Adafruit_BusIO_Register::read(uint8_t* value) {
+  if (!read(_buffer, 1)) {
+    return false;
+  }
+  *value = _buffer[0];
+  return true;
+}
+
+/*!
+ *    @brief  Register width
+ *    @return Width in bytes
+ */
+uint8_t Adafruit_BusIO_Register::width(void) {
+  return _width;
+}
+
+/*!
+ *    @brief  Describe a bit field
+ *    @param  reg Register holding the field
+ *    @param  bits Field width
+ *    @param  shift Position of the field's LSB
+ */
+Adafruit_BusIO_RegisterBits::Adafruit_BusIO_RegisterBits(
+    Adafruit_BusIO_Register* reg, uint8_t bits, uint8_t shift)
+    : _register(reg), _bits(bits), _shift(shift) {}
+
+/*!
+ *    @brief  Read the field
+ *    @return Field value
+ */
+uint32_t Adafruit_BusIO_RegisterBits::read(void) {
+  uint32_t val = _register->read();
+  val >>= _shift;
+  return val & ((1 << (_bits)) - 1);
+}
+
+/*!
+ *    @brief  Read-modify-write the field
+ *    @param  data Field value
+ *    @return true on success
+ */
+bool Adafruit_BusIO_RegisterBits::write(uint32_t data) {
+  uint32_t val = _register->read();
+  uint32_t mask = (1 << (_bits)) - 1;
+  data &= mask;
+  mask <<= _shift;
+  val &= ~mask;
+  val |= data << _shift;
+  return _register->write(val, _register->width());
+}
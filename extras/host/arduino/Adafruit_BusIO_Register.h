@@ -0,0 +1,64 @@
+/*!
+ *  @file Adafruit_BusIO_Register.h
+ *
+ * 	Host stand-in for Adafruit BusIO's register helpers (I2C only)
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_BUSIO_REGISTER_H
+#define _ADAFRUIT_TCS3430_HOST_BUSIO_REGISTER_H
+
+#include <Adafruit_I2CDevice.h>
+
+/*!
+ *    @brief  A register of one or more bytes on an I2C device
+ */
+class Adafruit_BusIO_Register {
+ public:
+  Adafruit_BusIO_Register(Adafruit_I2CDevice* i2cdevice, uint16_t reg_addr,
+                          uint8_t width = 1, uint8_t byteorder = LSBFIRST,
+                          uint8_t address_width = 1);
+
+  bool read(uint8_t* buffer, uint8_t len);
+  bool read(uint8_t* value);
+  bool read(uint16_t* value);
+  uint32_t read(void);
+  uint32_t readCached(void);
+  bool write(uint8_t* buffer, uint8_t len);
+  bool write(uint32_t value, uint8_t numbytes = 0);
+
+  uint8_t width(void);
+
+ private:
+  Adafruit_I2CDevice* _i2cdevice;
+  uint16_t _address;
+  uint8_t _width, _addrwidth, _byteorder;
+  uint8_t _buffer[4];
+  uint32_t _cached;
+};
+
+/*!
+ *    @brief  A bit field within an Adafruit_BusIO_Register
+ */
+class Adafruit_BusIO_RegisterBits {
+ public:
+  Adafruit_BusIO_RegisterBits(Adafruit_BusIO_Register* reg, uint8_t bits,
+                              uint8_t shift);
+  bool write(uint32_t value);
+  uint32_t read(void);
+
+ private:
+  Adafruit_BusIO_Register* _register;
+  uint8_t _bits, _shift;
+};
+
+#endif
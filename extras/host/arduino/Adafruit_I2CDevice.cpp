@@ -0,0 +1,166 @@
+/*!
+ *  @file Adafruit_I2CDevice.cpp
+ *
+ * 	Host stand-in for Adafruit BusIO's Adafruit_I2CDevice
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_I2CDevice.h"
+
+/*!
+ *    @brief  Create a device handle
+ *    @param  addr 7-bit address
+ *    @param  theWire Bus the device sits on
+ */
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire)
+    : _addr(addr),
+      _wire(theWire),
+      _begun(false),
+      _maxBufferSize(WIRE_BUFFER_SIZE) {}
+
+/*!
+ *    @brief  The device's address
+ *    @return 7-bit address
+ */
+uint8_t Adafruit_I2CDevice::address(void) {
+  return _addr;
+}
+
+/*!
+ *    @brief  Start the bus and optionally probe for the device
+ *    @param  addr_detect Whether to probe
+ *    @return true if the device answered (or was not probed)
+ */
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  _wire->begin();
+  _begun = true;
+  if (addr_detect) {
+    return detected();
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Release the bus
+ */
+void Adafruit_I2CDevice::end(void) {
+  _begun = false;
+}
+
+/*!
+ *    @brief  Probe with an empty write
+ *    @return true if the address was ACKed
+ */
+bool Adafruit_I2CDevice::detected(void) {
+  if (!_begun && !begin()) {
+    return false;
+  }
+  _wire->beginTransmission(_addr);
+  return _wire->endTransmission() == 0;
+}
+
+/*!
+ *    @brief  Write a buffer, optionally preceded by a prefix, in one
+ *            transaction
+ *    @param  buffer Data
+ *    @param  len Length of data
+ *    @param  stop Whether to end with STOP
+ *    @param  prefix_buffer Bytes sent first (typically a register address)
+ *    @param  prefix_len Length of the prefix
+ *    @return true on ACK
+ */
+bool Adafruit_I2CDevice::write(const uint8_t* buffer, size_t len, bool stop,
+                               const uint8_t* prefix_buffer,
+                               size_t prefix_len) {
+  if ((len + prefix_len) > maxBufferSize()) {
+    return false;
+  }
+  _wire->beginTransmission(_addr);
+  if ((prefix_len != 0) && (prefix_buffer != NULL)) {
+    if (_wire->write(prefix_buffer, prefix_len) != prefix_len) {
+      return false;
+    }
+  }
+  if (_wire->write(buffer, len) != len) {
+    return false;
+  }
+  return _wire->endTransmission(stop) == 0;
+}
+
+/*!
+ *    @brief  Read into a buffer, split into bus-buffer sized chunks
+ *    @param  buffer Destination
+ *    @param  len Number of bytes
+ *    @param  stop Whether to end the last chunk with STOP
+ *    @return true if every byte arrived
+ */
+bool Adafruit_I2CDevice::read(uint8_t* buffer, size_t len, bool stop) {
+  size_t pos = 0;
+  while (pos < len) {
+    size_t read_len =
+        ((len - pos) > maxBufferSize()) ? maxBufferSize() : (len - pos);
+    bool read_stop = (pos < (len - read_len)) ? false : stop;
+    if (!_read(buffer + pos, read_len, read_stop)) {
+      return false;
+    }
+    pos += read_len;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  One read transaction
+ *    @param  buffer Destination
+ *    @param  len Number of bytes, at most maxBufferSize()
+ *    @param  stop Whether to end with STOP
+ *    @return true if every byte arrived
+ */
+bool Adafruit_I2CDevice::_read(uint8_t* buffer, size_t len, bool stop) {
+  size_t recv = _wire->requestFrom(_addr, len, stop);
+  if (recv != len) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    buffer[i] = _wire->read();
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Write (usually a register address) then read back, with a
+ *            repeated start in between
+ *    @param  write_buffer Bytes to write
+ *    @param  write_len Number of bytes to write
+ *    @param  read_buffer Destination
+ *    @param  read_len Number of bytes to read
+ *    @param  stop Whether the write ends with STOP
+ *    @return true on success
+ */
+bool Adafruit_I2CDevice::write_then_read(const uint8_t* write_buffer,
+                                         size_t write_len,
+                                         uint8_t* read_buffer,
+                                         size_t read_len, bool stop) {
+  if (!write(write_buffer, write_len, stop)) {
+    return false;
+  }
+  return read(read_buffer, read_len);
+}
+
+/*!
+ *    @brief  Change the bus clock
+ *    @param  desiredclk Clock in Hz
+ *    @return true
+ */
+bool Adafruit_I2CDevice::setSpeed(uint32_t desiredclk) {
+  _wire->setClock(desiredclk);
+  return true;
+}
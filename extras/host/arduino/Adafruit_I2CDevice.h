@@ -0,0 +1,58 @@
+/*!
+ *  @file Adafruit_I2CDevice.h
+ *
+ * 	Host stand-in for Adafruit BusIO's Adafruit_I2CDevice, with the same
+ * 	transaction shapes as the real one so bus counts carry over
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_I2CDEVICE_H
+#define _ADAFRUIT_TCS3430_HOST_I2CDEVICE_H
+
+#include <Wire.h>
+
+/*!
+ *    @brief  One I2C target on a TwoWire bus
+ */
+class Adafruit_I2CDevice {
+ public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire = &Wire);
+  uint8_t address(void);
+  bool begin(bool addr_detect = true);
+  void end(void);
+  bool detected(void);
+
+  bool read(uint8_t* buffer, size_t len, bool stop = true);
+  bool write(const uint8_t* buffer, size_t len, bool stop = true,
+             const uint8_t* prefix_buffer = NULL, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t* write_buffer, size_t write_len,
+                       uint8_t* read_buffer, size_t read_len,
+                       bool stop = false);
+  bool setSpeed(uint32_t desiredclk);
+
+  /*!
+   *    @brief  Largest single transfer the bus buffer allows
+   *    @return Size in bytes
+   */
+  size_t maxBufferSize() {
+    return _maxBufferSize;
+  }
+
+ private:
+  uint8_t _addr;
+  TwoWire* _wire;
+  bool _begun;
+  size_t _maxBufferSize;
+  bool _read(uint8_t* buffer, size_t len, bool stop);
+};
+
+#endif
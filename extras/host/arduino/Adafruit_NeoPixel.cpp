@@ -0,0 +1,138 @@
+/*!
+ *  @file Adafruit_NeoPixel.cpp
+ *
+ * 	Host stand-in for the NeoPixel ring in the hw_tests rig
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_NeoPixel.h"
+
+#include "SimHost.h"
+
+// Light per unit of (brightness-scaled) drive level on each LED die, in
+// counts per step at 1x. Chosen so the rig's white at brightness 80 gives
+// the X:Y:Z:IR1 ratios and levels recorded in hw_tests/*/test_output.txt.
+static const sim_light_t led_red = {0.0160f, 0.0100f, 0.0010f, 0.0036f,
+                                    0.0030f};
+static const sim_light_t led_green = {0.0030f, 0.0560f, 0.0036f, 0.0010f,
+                                      0.0008f};
+static const sim_light_t led_blue = {0.0071f, 0.0087f, 0.0370f, 0.0010f,
+                                     0.0008f};
+
+/*!
+ *    @brief  A dark strip
+ *    @param  n Number of pixels
+ *    @param  pin Data pin (unused)
+ *    @param  type Pixel type (unused)
+ */
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type)
+    : _count(n > NEOPIXEL_HOST_MAX ? NEOPIXEL_HOST_MAX : n), _brightness(0) {
+  (void)pin;
+  (void)type;
+  memset(_pixels, 0, sizeof(_pixels));
+}
+
+/*!
+ *    @brief  Nothing to set up on the host
+ */
+void Adafruit_NeoPixel::begin(void) {}
+
+/*!
+ *    @brief  Push the strip's average colour into the scene
+ */
+void Adafruit_NeoPixel::show(void) {
+  float level[3] = {0, 0, 0};
+  for (uint16_t i = 0; i < _count; i++) {
+    for (uint8_t c = 0; c < 3; c++) {
+      level[c] += _pixels[i][c];
+    }
+  }
+  for (uint8_t c = 0; c < 3; c++) {
+    level[c] = _count ? level[c] / _count : 0;
+  }
+  sim_light_t light;
+  light.x = led_red.x * level[0] + led_green.x * level[1] +
+            led_blue.x * level[2];
+  light.y = led_red.y * level[0] + led_green.y * level[1] +
+            led_blue.y * level[2];
+  light.z = led_red.z * level[0] + led_green.z * level[1] +
+            led_blue.z * level[2];
+  light.ir1 = led_red.ir1 * level[0] + led_green.ir1 * level[1] +
+              led_blue.ir1 * level[2];
+  light.ir2 = led_red.ir2 * level[0] + led_green.ir2 * level[1] +
+              led_blue.ir2 * level[2];
+  SimHost::instance().setSource(light);
+}
+
+/*!
+ *    @brief  Turn every pixel off (takes effect on show())
+ */
+void Adafruit_NeoPixel::clear(void) {
+  memset(_pixels, 0, sizeof(_pixels));
+}
+
+/*!
+ *    @brief  Set one pixel, scaled by the current brightness like the
+ *            real library does
+ *    @param  n Pixel index
+ *    @param  r Red
+ *    @param  g Green
+ *    @param  b Blue
+ */
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g,
+                                      uint8_t b) {
+  if (n >= _count) {
+    return;
+  }
+  if (_brightness) {
+    r = (r * _brightness) >> 8;
+    g = (g * _brightness) >> 8;
+    b = (b * _brightness) >> 8;
+  }
+  _pixels[n][0] = r;
+  _pixels[n][1] = g;
+  _pixels[n][2] = b;
+}
+
+/*!
+ *    @brief  Set one pixel from a packed colour
+ *    @param  n Pixel index
+ *    @param  c 0x00RRGGBB
+ */
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+  setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+/*!
+ *    @brief  Set the brightness applied to later setPixelColor() calls
+ *    @param  b 0-255
+ */
+void Adafruit_NeoPixel::setBrightness(uint8_t b) {
+  // Stored +1 so 255 means "unscaled" and 0 means "off", as upstream
+  _brightness = b + 1;
+}
+
+/*!
+ *    @brief  Current brightness
+ *    @return 0-255
+ */
+uint8_t Adafruit_NeoPixel::getBrightness(void) const {
+  return _brightness - 1;
+}
+
+/*!
+ *    @brief  Strip length
+ *    @return Number of pixels
+ */
+uint16_t Adafruit_NeoPixel::numPixels(void) const {
+  return _count;
+}
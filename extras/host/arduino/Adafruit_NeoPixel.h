@@ -0,0 +1,60 @@
+/*!
+ *  @file Adafruit_NeoPixel.h
+ *
+ * 	Host stand-in for the NeoPixel ring in the hw_tests rig. show() turns
+ * 	the ring's average colour into light at the simulated sensors.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_NEOPIXEL_H
+#define _ADAFRUIT_TCS3430_HOST_NEOPIXEL_H
+
+#include "Arduino.h"
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2)) ///< Wire order
+#define NEO_KHZ800 0x0000                             ///< 800 KHz stream
+
+#define NEOPIXEL_HOST_MAX 64 ///< Pixels the stand-in can hold
+
+/*!
+ *    @brief  NeoPixel strip that lights the simulated scene
+ */
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, uint16_t type = NEO_GRB);
+  void begin(void);
+  void show(void);
+  void clear(void);
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+  void setPixelColor(uint16_t n, uint32_t c);
+  void setBrightness(uint8_t b);
+  uint8_t getBrightness(void) const;
+  uint16_t numPixels(void) const;
+
+  /*!
+   *    @brief  Pack a colour
+   *    @param  r Red
+   *    @param  g Green
+   *    @param  b Blue
+   *    @return 0x00RRGGBB
+   */
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+ private:
+  uint16_t _count;
+  uint8_t _brightness;
+  uint8_t _pixels[NEOPIXEL_HOST_MAX][3];
+};
+
+#endif
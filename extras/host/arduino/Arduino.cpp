@@ -0,0 +1,332 @@
+/*!
+ *  @file Arduino.cpp
+ *
+ * 	Host stand-in for the Arduino core: virtual time, pins, interrupts and
+ * 	a capturing Serial
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Arduino.h"
+
+#include <stdio.h>
+
+#include <string>
+
+#include "SimHost.h"
+
+HostSerial Serial;
+
+static std::string serial_capture;
+
+/*!
+ *    @brief  Milliseconds since reset; each call costs a little virtual time
+ *    @return Time, wrapping at 32 bits as on the MCU even where unsigned
+ *            long is 64 bits
+ */
+unsigned long millis(void) {
+  SimHost::instance().advance(SIMHOST_CALL_COST_US);
+  return (uint32_t)(SimHost::instance().now() / 1000);
+}
+
+/*!
+ *    @brief  Microseconds since reset; each call costs a little virtual time
+ *            so busy-wait loops make progress
+ *    @return Time, wrapping at 32 bits
+ */
+unsigned long micros(void) {
+  SimHost::instance().advance(SIMHOST_CALL_COST_US);
+  return (uint32_t)SimHost::instance().now();
+}
+
+/*!
+ *    @brief  Advance virtual time
+ *    @param  ms Milliseconds
+ */
+void delay(unsigned long ms) {
+  SimHost::instance().advance((uint64_t)ms * 1000);
+}
+
+/*!
+ *    @brief  Advance virtual time
+ *    @param  us Microseconds
+ */
+void delayMicroseconds(unsigned int us) {
+  SimHost::instance().advance(us);
+}
+
+/*!
+ *    @brief  Let simulated time and interrupts run
+ */
+void yield(void) {
+  SimHost::instance().advance(SIMHOST_CALL_COST_US);
+}
+
+/*!
+ *    @brief  Hold off pin interrupt handlers
+ */
+void noInterrupts(void) {
+  SimHost::instance().setInterruptsEnabled(false);
+}
+
+/*!
+ *    @brief  Allow pin interrupt handlers, running any that are pending
+ */
+void interrupts(void) {
+  SimHost::instance().setInterruptsEnabled(true);
+}
+
+/*!
+ *    @brief  Configure a pin
+ *    @param  pin Pin number
+ *    @param  mode INPUT, OUTPUT or INPUT_PULLUP
+ */
+void pinMode(uint8_t pin, uint8_t mode) {
+  SimHost::instance().pinMode(pin, mode);
+}
+
+/*!
+ *    @brief  Sample a pin
+ *    @param  pin Pin number
+ *    @return HIGH or LOW
+ */
+int digitalRead(uint8_t pin) {
+  SimHost::instance().advance(SIMHOST_CALL_COST_US);
+  return SimHost::instance().pinLevel(pin) ? HIGH : LOW;
+}
+
+/*!
+ *    @brief  Drive a pin
+ *    @param  pin Pin number
+ *    @param  val HIGH or LOW
+ */
+void digitalWrite(uint8_t pin, uint8_t val) {
+  SimHost::instance().drivePin(pin, val != LOW);
+}
+
+/*!
+ *    @brief  Run a handler on pin edges
+ *    @param  interrupt Pin number (digitalPinToInterrupt() is the identity)
+ *    @param  isr Handler
+ *    @param  mode RISING, FALLING or CHANGE
+ */
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode) {
+  SimHost::instance().attachInterrupt(interrupt, isr, mode);
+}
+
+/*!
+ *    @brief  Remove a pin's handler
+ *    @param  interrupt Pin number
+ */
+void detachInterrupt(uint8_t interrupt) {
+  SimHost::instance().attachInterrupt(interrupt, NULL, 0);
+}
+
+// The print()/println() overloads below follow the Arduino core: integers
+// in the given base, floats with the given number of decimals, println()
+// adding CR LF. Each returns the number of characters written.
+
+size_t Print::write(const char* str) {
+  if (!str) {
+    return 0;
+  }
+  return write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const char* str) {
+  return write(str);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base) {
+  return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 0) {
+    return write((uint8_t)n);
+  }
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber((unsigned long)-n, 10);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if (base == 0) {
+    return write((uint8_t)n);
+  }
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  return printFloat(n, digits);
+}
+
+size_t Print::println(void) {
+  return write("\r\n");
+}
+
+size_t Print::println(const char* str) {
+  size_t n = print(str);
+  return n + println();
+}
+
+size_t Print::println(char c) {
+  size_t n = print(c);
+  return n + println();
+}
+
+size_t Print::println(unsigned char n, int base) {
+  size_t t = print(n, base);
+  return t + println();
+}
+
+size_t Print::println(int n, int base) {
+  size_t t = print(n, base);
+  return t + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+  size_t t = print(n, base);
+  return t + println();
+}
+
+size_t Print::println(long n, int base) {
+  size_t t = print(n, base);
+  return t + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+  size_t t = print(n, base);
+  return t + println();
+}
+
+size_t Print::println(double n, int digits) {
+  size_t t = print(n, digits);
+  return t + println();
+}
+
+/*!
+ *    @brief  Print an unsigned number in any base
+ *    @param  n Number
+ *    @param  base Base, 2-36
+ *    @return Characters written
+ */
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+/*!
+ *    @brief  Print a float with a fixed number of decimals
+ *    @param  number Value
+ *    @param  digits Decimal places
+ *    @return Characters written
+ */
+size_t Print::printFloat(double number, uint8_t digits) {
+  if (isnan(number)) {
+    return print("nan");
+  }
+  if (isinf(number)) {
+    return print("inf");
+  }
+  size_t n = 0;
+  if (number < 0.0) {
+    n += print('-');
+    number = -number;
+  }
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) {
+    rounding /= 10.0;
+  }
+  number += rounding;
+
+  unsigned long int_part = (unsigned long)number;
+  double remainder = number - (double)int_part;
+  n += print(int_part);
+  if (digits > 0) {
+    n += print('.');
+  }
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int to_print = (unsigned int)remainder;
+    n += print(to_print);
+    remainder -= to_print;
+  }
+  return n;
+}
+
+/*!
+ *    @brief  Nothing to set up on the host
+ *    @param  baud Ignored
+ */
+void HostSerial::begin(unsigned long baud) {
+  (void)baud;
+}
+
+/*!
+ *    @brief  Print one character to stdout and the capture buffer
+ *    @param  c Character
+ *    @return 1
+ */
+size_t HostSerial::write(uint8_t c) {
+  if (c != '\r') {
+    fputc(c, stdout);
+    serial_capture.push_back((char)c);
+  }
+  return 1;
+}
+
+/*!
+ *    @brief  Everything printed since the last clearOutput()
+ *    @return NUL-terminated text, carriage returns stripped
+ */
+const char* HostSerial::output() const {
+  return serial_capture.c_str();
+}
+
+/*!
+ *    @brief  Forget the captured output
+ */
+void HostSerial::clearOutput() {
+  serial_capture.clear();
+}
@@ -0,0 +1,129 @@
+/*!
+ *  @file Arduino.h
+ *
+ * 	Host stand-in for the parts of the Arduino core used by the TCS3430
+ * 	library and its hw_tests sketches. Time is virtual: it only moves when
+ * 	the program delays, polls micros()/millis() or talks on the bus, and
+ * 	the simulated devices are stepped along with it (see SimHost.h).
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_ARDUINO_H
+#define _ADAFRUIT_TCS3430_HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define F(string_literal) (string_literal)
+#define digitalPinToInterrupt(p) (p)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+void noInterrupts(void);
+void interrupts(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+/*!
+ *    @brief  Minimal Print, formatting numbers the way the Arduino core does
+ */
+class Print {
+ public:
+  virtual ~Print() {}
+  /*!
+   *    @brief  Emit one byte
+   *    @param  c Byte to emit
+   *    @return Number of bytes written
+   */
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const char* str);
+  size_t write(const uint8_t* buffer, size_t size);
+
+  size_t print(const char* str);
+  size_t print(char c);
+  size_t print(unsigned char n, int base = DEC);
+  size_t print(int n, int base = DEC);
+  size_t print(unsigned int n, int base = DEC);
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println(void);
+  size_t println(const char* str);
+  size_t println(char c);
+  size_t println(unsigned char n, int base = DEC);
+  size_t println(int n, int base = DEC);
+  size_t println(unsigned int n, int base = DEC);
+  size_t println(long n, int base = DEC);
+  size_t println(unsigned long n, int base = DEC);
+  size_t println(double n, int digits = 2);
+
+ private:
+  size_t printNumber(unsigned long n, uint8_t base);
+  size_t printFloat(double number, uint8_t digits);
+};
+
+/*!
+ *    @brief  Serial port that writes to stdout and keeps a copy of
+ *            everything printed so a test runner can inspect it
+ */
+class HostSerial : public Print {
+ public:
+  void begin(unsigned long baud);
+  size_t write(uint8_t c);
+  using Print::write;
+  /*!
+   *    @brief  The host port is always connected
+   */
+  operator bool() const {
+    return true;
+  }
+  const char* output() const;
+  void clearOutput();
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,217 @@
+/*!
+ *  @file Wire.cpp
+ *
+ * 	Host stand-in for TwoWire
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Wire.h"
+
+#include "SimHost.h"
+
+TwoWire Wire;
+
+/*!
+ *    @brief  Standard-mode bus with nothing in flight
+ */
+TwoWire::TwoWire()
+    : _clock_hz(100000),
+      _tx_addr(0),
+      _tx_len(0),
+      _tx_overflow(false),
+      _rx_len(0),
+      _rx_pos(0),
+      _transactions(0),
+      _bytes(0) {}
+
+/*!
+ *    @brief  Nothing to set up on the host
+ */
+void TwoWire::begin(void) {}
+
+/*!
+ *    @brief  Nothing to tear down on the host
+ */
+void TwoWire::end(void) {}
+
+/*!
+ *    @brief  Set the SCL rate used to charge bus time
+ *    @param  hz Clock in Hz
+ */
+void TwoWire::setClock(uint32_t hz) {
+  if (hz) {
+    _clock_hz = hz;
+  }
+}
+
+/*!
+ *    @brief  Current SCL rate
+ *    @return Clock in Hz
+ */
+uint32_t TwoWire::getClock(void) const {
+  return _clock_hz;
+}
+
+/*!
+ *    @brief  Start buffering a write to a target
+ *    @param  address 7-bit target address
+ */
+void TwoWire::beginTransmission(uint8_t address) {
+  _tx_addr = address;
+  _tx_len = 0;
+  _tx_overflow = false;
+}
+
+/*!
+ *    @brief  Queue one byte of the pending write
+ *    @param  data Byte to send
+ *    @return 1, or 0 if the transmit buffer is full
+ */
+size_t TwoWire::write(uint8_t data) {
+  if (_tx_len >= sizeof(_tx_buf)) {
+    _tx_overflow = true;
+    return 0;
+  }
+  _tx_buf[_tx_len++] = data;
+  return 1;
+}
+
+/*!
+ *    @brief  Queue several bytes of the pending write
+ *    @param  data Bytes to send
+ *    @param  quantity Number of bytes
+ *    @return Number of bytes queued
+ */
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+  size_t n = 0;
+  while (n < quantity && write(data[n])) {
+    n++;
+  }
+  return n;
+}
+
+/*!
+ *    @brief  Put the queued write on the bus
+ *    @param  stop Whether to end with STOP (false for a repeated start)
+ *    @return 0 on success, 1 if the data did not fit, 2 on address NACK,
+ *            3 on data NACK
+ */
+uint8_t TwoWire::endTransmission(bool stop) {
+  (void)stop;
+  if (_tx_overflow) {
+    return 1;
+  }
+  SimHost& host = SimHost::instance();
+  SimI2CTarget* target = host.findTarget(_tx_addr);
+  _transactions++;
+  if (!target) {
+    busTime(0);
+    return 2;
+  }
+  busTime(_tx_len);
+  _bytes += _tx_len;
+  return target->i2cWrite(_tx_buf, _tx_len) ? 0 : 3;
+}
+
+/*!
+ *    @brief  Read bytes from a target into the receive buffer
+ *    @param  address 7-bit target address
+ *    @param  quantity Number of bytes wanted
+ *    @param  stop Whether to end with STOP
+ *    @return Number of bytes received
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stop) {
+  (void)stop;
+  _rx_len = 0;
+  _rx_pos = 0;
+  if (quantity > sizeof(_rx_buf)) {
+    quantity = sizeof(_rx_buf);
+  }
+  SimHost& host = SimHost::instance();
+  SimI2CTarget* target = host.findTarget(address);
+  _transactions++;
+  if (!target) {
+    busTime(0);
+    return 0;
+  }
+  busTime(quantity);
+  if (!target->i2cRead(_rx_buf, quantity)) {
+    return 0;
+  }
+  _bytes += quantity;
+  _rx_len = quantity;
+  return (uint8_t)quantity;
+}
+
+/*!
+ *    @brief  Bytes left in the receive buffer
+ *    @return Count
+ */
+int TwoWire::available(void) {
+  return (int)(_rx_len - _rx_pos);
+}
+
+/*!
+ *    @brief  Take the next received byte
+ *    @return Byte, or -1 if none are left
+ */
+int TwoWire::read(void) {
+  if (_rx_pos >= _rx_len) {
+    return -1;
+  }
+  return _rx_buf[_rx_pos++];
+}
+
+/*!
+ *    @brief  Look at the next received byte without taking it
+ *    @return Byte, or -1 if none are left
+ */
+int TwoWire::peek(void) {
+  if (_rx_pos >= _rx_len) {
+    return -1;
+  }
+  return _rx_buf[_rx_pos];
+}
+
+/*!
+ *    @brief  Number of START conditions issued (repeated starts included)
+ *    @return Count since the last resetCounters()
+ */
+uint32_t TwoWire::transactions(void) const {
+  return _transactions;
+}
+
+/*!
+ *    @brief  Number of data bytes moved, address bytes excluded
+ *    @return Count since the last resetCounters()
+ */
+uint32_t TwoWire::bytes(void) const {
+  return _bytes;
+}
+
+/*!
+ *    @brief  Zero the transaction and byte counters
+ */
+void TwoWire::resetCounters(void) {
+  _transactions = 0;
+  _bytes = 0;
+}
+
+/*!
+ *    @brief  Charge the virtual clock for one transaction: START, address
+ *            and data bytes at 9 clocks each, and STOP
+ *    @param  bytes Number of data bytes
+ */
+void TwoWire::busTime(size_t bytes) {
+  uint64_t clocks = 2 + 9 * (uint64_t)(bytes + 1);
+  SimHost::instance().advance((clocks * 1000000 + _clock_hz - 1) / _clock_hz);
+}
@@ -0,0 +1,67 @@
+/*!
+ *  @file Wire.h
+ *
+ * 	Host stand-in for TwoWire. Transactions are routed to the simulated
+ * 	targets registered with SimHost and take bus time on the virtual clock.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_WIRE_H
+#define _ADAFRUIT_TCS3430_HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_SIZE 32 ///< Same as the AVR core
+
+/*!
+ *    @brief  I2C controller backed by the simulated bus
+ */
+class TwoWire {
+ public:
+  TwoWire();
+  void begin(void);
+  void end(void);
+  void setClock(uint32_t hz);
+  uint32_t getClock(void) const;
+
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t quantity);
+  uint8_t endTransmission(bool stop = true);
+
+  uint8_t requestFrom(uint8_t address, size_t quantity, bool stop = true);
+  int available(void);
+  int read(void);
+  int peek(void);
+
+  uint32_t transactions(void) const;
+  uint32_t bytes(void) const;
+  void resetCounters(void);
+
+ private:
+  uint32_t _clock_hz;
+  uint8_t _tx_addr;
+  uint8_t _tx_buf[WIRE_BUFFER_SIZE];
+  size_t _tx_len;
+  bool _tx_overflow;
+  uint8_t _rx_buf[WIRE_BUFFER_SIZE];
+  size_t _rx_len;
+  size_t _rx_pos;
+  uint32_t _transactions;
+  uint32_t _bytes;
+
+  void busTime(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+#endif
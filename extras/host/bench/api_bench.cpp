@@ -0,0 +1,832 @@
+/*!
+ *  @file api_bench.cpp
+ *
+ * 	Cost of every public Adafruit_TCS3430 method, the read scheduler and
+ * 	interleaving helpers, the color conversions and common call sequences
+ * 	on the simulated bus:
+ * 	transactions, bytes, bus time at 100 kHz, 400 kHz and 1 MHz, and host
+ * 	CPU time per call.
+ * 	Checks them against checked-in budgets and exits non-zero on a
+ * 	regression.
+ *
+ * 	  api_bench [--budgets FILE] [--json FILE] [--update FILE]
+ * 	            [--filter TEXT]
+ *
+ * 	--budgets fails the run when a case moves more transactions or bytes
+ * 	than its budget, or has none; --json writes the results; --update
+ * 	writes the measurements as a new budget file. Cases that depend on
+ * 	timing (the read scheduler, interleaving) then get a little headroom
+ * 	by hand, since micros() costs virtual time and TCS3430_INSTRUMENT
+ * 	builds call it more. CPU time depends on the host (and includes the
+ * 	simulator) so it is reported, not budgeted.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Adafruit_TCS3430.h"
+#include "Adafruit_TCS3430_Color.h"
+#include "Adafruit_TCS3430_Ring.h"
+#include "Adafruit_TCS3430_Interleave.h"
+#include "Adafruit_TCS3430_Scheduler.h"
+#include "Arduino.h"
+#include "SimHost.h"
+#include "SimTCS3430.h"
+#include "Wire.h"
+
+#define BENCH_INT_PIN 2 ///< Simulated INT wiring for the capture cases
+
+/** Bus clocks the bus time is reported at */
+static const uint32_t kClocks[] = {100000, 400000, 1000000};
+/** JSON keys for kClocks */
+static const char* const kClockKeys[] = {"bus_us_100k", "bus_us_400k",
+                                         "bus_us_1m"};
+
+/** One measured call or sequence */
+typedef struct {
+  const char* name;   ///< Method, helper (Scheduler::, Interleave::) or
+                      ///< Color:: call, or seq:
+  void (*setup)();    ///< Run once first, not counted; may be NULL
+  void (*before)();   ///< Run before each call, not counted; may be NULL
+  void (*run)();      ///< The call being measured
+  uint32_t calls;     ///< Times run() is repeated
+} bench_case_t;
+
+/** Measurements per call */
+typedef struct {
+  double transactions; ///< Bus transactions
+  double bytes;        ///< Bytes on the wire, register addresses included
+  double cpu_ns;       ///< Host time
+} bench_result_t;
+
+/** Budget for one case */
+typedef struct {
+  double transactions; ///< Most transactions per call allowed
+  double bytes;        ///< Most bytes per call allowed
+} bench_budget_t;
+
+static SimTCS3430 sensor;
+static Adafruit_TCS3430* dut = NULL;
+static Adafruit_TCS3430_Scheduler* scheduler = NULL;
+static Adafruit_TCS3430_Interleave* interleave = NULL;
+static Adafruit_TCS3430_Ring<tcs3430_frame_t, 16> ring;
+static Adafruit_TCS3430_Ring<tcs3430_event_t, 16> events;
+static tcs3430_snapshot_t snapshot;
+static tcs3430_config_t config;
+static tcs3430_frame_t frame;
+static tcs3430_frame5_t frame5;
+static uint32_t counter;
+static uint32_t cycle_us;
+static volatile uint32_t sink;
+
+/** Settings the configure sequences apply */
+static const tcs3430_config_t kConfigured = {
+    true,  true,  false, 35,    0,     false, 1000,  60000, TCS3430_PERS_2,
+    TCS3430_GAIN_16X,    false, false, false, false, 0x7F,  false, true};
+
+/*!
+ *    @brief  Monotonic host time
+ *    @return Nanoseconds
+ */
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*!
+ *    @brief  Bus time of some traffic, with the simulator's bit timing
+ *            (START, 9 clocks per byte with the address byte, STOP)
+ *    @param  transactions Transactions
+ *    @param  bytes Bytes after each address byte
+ *    @param  hz Bus clock
+ *    @return Microseconds
+ */
+static double busMicros(double transactions, double bytes, uint32_t hz) {
+  return (11 * transactions + 9 * bytes) * 1e6 / hz;
+}
+
+/*!
+ *    @brief  Interrupt handler for the capture cases
+ */
+static void onSensorInt() {
+  dut->handleInterrupt();
+}
+
+/*!
+ *    @brief  Completion callback for readFrameAsync()
+ *    @param  f Frame
+ *    @param  ok Result
+ *    @param  context Unused
+ */
+static void frameDone(tcs3430_frame_t* f, bool ok, void* context) {
+  (void)context;
+  sink += ok ? f->y : 0;
+}
+
+/*!
+ *    @brief  Fresh driver on a sensor out of power-on reset that has
+ *            integrated once at the begin() settings
+ */
+static void fresh() {
+  sensor.reset();
+  ring.clear();
+  events.clear();
+  delete interleave;
+  delete scheduler;
+  delete dut;
+  dut = new Adafruit_TCS3430();
+  scheduler = new Adafruit_TCS3430_Scheduler(dut);
+  interleave = new Adafruit_TCS3430_Interleave(dut);
+  dut->begin();
+  cycle_us = dut->getCycleMicros();
+  delay(200);
+}
+
+/*!
+ *    @brief  Wait for the next integration at the begin() settings to end
+ */
+static void nextCycle() {
+  delayMicroseconds(cycle_us + 500);
+}
+
+/*!
+ *    @brief  Wait until the read scheduler wants to be called
+ */
+static void waitScheduled() {
+  int32_t wait = (int32_t)(scheduler->nextSampleAt() - micros());
+  if (wait > 0) {
+    delayMicroseconds(wait);
+  }
+}
+
+/*!
+ *    @brief  INT-driven capture of every cycle into the ring
+ */
+static void startCapture() {
+  dut->setInterruptPersistence(TCS3430_PERS_EVERY);
+  dut->beginCapture(&ring);
+  attachInterrupt(digitalPinToInterrupt(BENCH_INT_PIN), onSensorInt, RISING);
+}
+
+/*!
+ *    @brief  INT-driven event decoding, every cycle a data-ready event
+ */
+static void startEvents() {
+  dut->setInterruptPersistence(TCS3430_PERS_EVERY);
+  dut->beginEvents(&events);
+  attachInterrupt(digitalPinToInterrupt(BENCH_INT_PIN), onSensorInt, RISING);
+}
+
+/** Next value of the running counter, for setters that alternate */
+#define NEXT (counter++)
+/** Alternates between two values on each call */
+#define TOGGLE(a, b) ((NEXT & 1) ? (a) : (b))
+
+static const bench_case_t kCases[] = {
+    // Set-up and persistence
+    {"begin", NULL, NULL, [] { dut->begin(); }, 20},
+    {"resume", [] { dut->saveSnapshot(&snapshot); }, NULL,
+     [] { dut->resume(&snapshot); }, 20},
+    {"saveSnapshot", NULL, NULL, [] { dut->saveSnapshot(&snapshot); }, 50},
+    {"applyConfig", NULL, NULL,
+     [] {
+       tcs3430_config_t c = kConfigured;
+       c.atime = TOGGLE(35, 71);
+       dut->applyConfig(&c);
+     },
+     50},
+    {"readConfig", NULL, NULL, [] { dut->readConfig(&config); }, 50},
+    {"resync", NULL, NULL, [] { dut->resync(); }, 50},
+    {"enableRegisterCache", NULL, NULL,
+     [] { dut->enableRegisterCache(TOGGLE(true, false)); }, 50},
+
+    // Settings
+    {"setIntegrationCycles", NULL, NULL,
+     [] { dut->setIntegrationCycles(TOGGLE(35, 71)); }, 100},
+    {"getIntegrationCycles", NULL, NULL,
+     [] { sink += dut->getIntegrationCycles(); }, 100},
+    {"setIntegrationTime", NULL, NULL,
+     [] { dut->setIntegrationTime(TOGGLE(100.0f, 200.0f)); }, 100},
+    {"getIntegrationTime", NULL, NULL,
+     [] { sink += (uint32_t)dut->getIntegrationTime(); }, 100},
+    {"setWaitCycles", NULL, NULL, [] { dut->setWaitCycles(TOGGLE(10, 20)); },
+     100},
+    {"getWaitCycles", NULL, NULL, [] { sink += dut->getWaitCycles(); }, 100},
+    {"setWaitTime", NULL, NULL, [] { dut->setWaitTime(TOGGLE(50.0f, 100.0f)); },
+     100},
+    {"getWaitTime", NULL, NULL, [] { sink += (uint32_t)dut->getWaitTime(); },
+     100},
+    {"setALSThresholdLow", NULL, NULL,
+     [] { dut->setALSThresholdLow(TOGGLE(100, 200)); }, 100},
+    {"getALSThresholdLow", NULL, NULL,
+     [] { sink += dut->getALSThresholdLow(); }, 100},
+    {"setALSThresholdHigh", NULL, NULL,
+     [] { dut->setALSThresholdHigh(TOGGLE(60000, 50000)); }, 100},
+    {"getALSThresholdHigh", NULL, NULL,
+     [] { sink += dut->getALSThresholdHigh(); }, 100},
+    {"setALSThresholds", NULL, NULL,
+     [] { dut->setALSThresholds(TOGGLE(100, 200), 60000); }, 100},
+    {"setThresholdTracking", NULL, NULL,
+     [] { dut->setThresholdTracking(10, 20); }, 100},
+    {"setInterruptPersistence", NULL, NULL,
+     [] {
+       dut->setInterruptPersistence(TOGGLE(TCS3430_PERS_2, TCS3430_PERS_EVERY));
+     },
+     100},
+    {"getInterruptPersistence", NULL, NULL,
+     [] { sink += dut->getInterruptPersistence(); }, 100},
+    {"setWaitLong", NULL, NULL, [] { dut->setWaitLong(TOGGLE(true, false)); },
+     100},
+    {"getWaitLong", NULL, NULL, [] { sink += dut->getWaitLong(); }, 100},
+    {"setALSMUX_IR2", NULL, NULL,
+     [] { dut->setALSMUX_IR2(TOGGLE(true, false)); }, 100},
+    {"getALSMUX_IR2", NULL, NULL, [] { sink += dut->getALSMUX_IR2(); }, 100},
+    {"setALSGain", NULL, NULL,
+     [] { dut->setALSGain(TOGGLE(TCS3430_GAIN_128X, TCS3430_GAIN_16X)); }, 100},
+    {"getALSGain", NULL, NULL, [] { sink += dut->getALSGain(); }, 100},
+    {"setInterruptClearOnRead", NULL, NULL,
+     [] { dut->setInterruptClearOnRead(TOGGLE(true, false)); }, 100},
+    {"getInterruptClearOnRead", NULL, NULL,
+     [] { sink += dut->getInterruptClearOnRead(); }, 100},
+    {"setSleepAfterInterrupt", NULL, NULL,
+     [] { dut->setSleepAfterInterrupt(TOGGLE(true, false)); }, 100},
+    {"getSleepAfterInterrupt", NULL, NULL,
+     [] { sink += dut->getSleepAfterInterrupt(); }, 100},
+    {"setAutoZeroMode", NULL, NULL,
+     [] { dut->setAutoZeroMode(TOGGLE(true, false)); }, 100},
+    {"getAutoZeroMode", NULL, NULL, [] { sink += dut->getAutoZeroMode(); },
+     100},
+    {"setRunAutoZeroEveryN", NULL, NULL,
+     [] { dut->setRunAutoZeroEveryN(TOGGLE(0x7F, 0)); }, 100},
+    {"getRunAutoZeroEveryN", NULL, NULL,
+     [] { sink += dut->getRunAutoZeroEveryN(); }, 100},
+    {"enableSaturationInt", NULL, NULL,
+     [] { dut->enableSaturationInt(TOGGLE(true, false)); }, 100},
+    {"enableALSInt", NULL, NULL, [] { dut->enableALSInt(TOGGLE(true, false)); },
+     100},
+    {"waitEnable", NULL, NULL, [] { dut->waitEnable(TOGGLE(true, false)); },
+     100},
+    {"isWaitEnabled", NULL, NULL, [] { sink += dut->isWaitEnabled(); }, 100},
+    {"ALSEnable", NULL, NULL, [] { dut->ALSEnable(true); }, 100},
+    {"isALSEnabled", NULL, NULL, [] { sink += dut->isALSEnabled(); }, 100},
+    {"powerOn", NULL, NULL, [] { dut->powerOn(true); }, 100},
+    {"isPoweredOn", NULL, NULL, [] { sink += dut->isPoweredOn(); }, 100},
+
+    // Status
+    {"isALSSaturated", NULL, NULL, [] { sink += dut->isALSSaturated(); }, 100},
+    {"clearALSSaturated", NULL, NULL, [] { dut->clearALSSaturated(); }, 100},
+    {"isALSInterrupt", NULL, NULL, [] { sink += dut->isALSInterrupt(); }, 100},
+    {"clearALSInterrupt", NULL, NULL, [] { dut->clearALSInterrupt(); }, 100},
+
+    // Data
+    {"getChannels", NULL, NULL,
+     [] {
+       uint16_t x, y, z, ir1;
+       dut->getChannels(&x, &y, &z, &ir1);
+       sink += y;
+     },
+     100},
+    {"getIR2", NULL, NULL, [] { sink += dut->getIR2(); }, 10},
+    {"readFrame", NULL, NULL, [] { dut->readFrame(&frame); }, 100},
+    {"readFrameAsync", NULL, NULL,
+     [] { dut->readFrameAsync(&frame, frameDone); }, 100},
+    {"isFrameAsyncPending", NULL, NULL,
+     [] { sink += dut->isFrameAsyncPending(); }, 100},
+    {"getCIE", NULL, NULL,
+     [] {
+       float x, y;
+       dut->getCIE(&x, &y);
+     },
+     100},
+    {"getCCT", NULL, NULL, [] { sink += (uint32_t)dut->getCCT(); }, 100},
+    {"getLux", NULL, NULL, [] { sink += (uint32_t)dut->getLux(); }, 100},
+    {"getCIEFixed", NULL, NULL,
+     [] {
+       uint16_t x, y;
+       dut->getCIEFixed(&x, &y);
+     },
+     100},
+    {"getCCTFixed", NULL, NULL, [] { sink += dut->getCCTFixed(); }, 100},
+    {"getLuxFixed", NULL, NULL, [] { sink += dut->getLuxFixed(); }, 100},
+
+    // Measurement state machine and scheduling
+    {"startIR2", NULL, [] { dut->cancelMeasurement(); },
+     [] { dut->startIR2(); }, 50},
+    {"startFrame", NULL, [] { dut->cancelMeasurement(); },
+     [] { dut->startFrame(); }, 50},
+    {"poll", NULL,
+     [] {
+       dut->startFrame();
+       nextCycle();
+     },
+     [] { dut->poll(&frame); }, 50},
+    {"cancelMeasurement", NULL, NULL, [] { dut->cancelMeasurement(); }, 100},
+    {"getCycleMicros", NULL, NULL, [] { sink += dut->getCycleMicros(); }, 100},
+    {"restartCycle", NULL, NULL, [] { dut->restartCycle(); }, 50},
+    {"isSettling", NULL, NULL, [] { sink += dut->isSettling(); }, 100},
+    {"Scheduler::restartCycle", NULL, NULL,
+     [] { scheduler->restartCycle(); }, 50},
+    {"Scheduler::nextSampleAt", NULL, NULL,
+     [] { sink += scheduler->nextSampleAt(); }, 100},
+    {"Scheduler::isFreshDataDue", NULL, NULL,
+     [] { sink += scheduler->isFreshDataDue(); }, 100},
+    // Whole periods of the scheduler's bracketing read (one in 16)
+    {"Scheduler::poll", NULL, waitScheduled, [] { scheduler->poll(&frame); },
+     160},
+    {"Scheduler::getLearnedCycleMicros", NULL, NULL,
+     [] { sink += scheduler->getLearnedCycleMicros(); }, 100},
+    {"Interleave::begin", NULL, [] { interleave->end(); },
+     [] { interleave->begin(); }, 50},
+    {"Interleave::poll", [] { interleave->begin(); }, nextCycle,
+     [] { sink += interleave->poll(&frame5); }, 100},
+    {"Interleave::end", NULL, NULL, [] { interleave->end(); }, 100},
+    {"beginCapture", NULL, [] { dut->endCapture(); },
+     [] { dut->beginCapture(&ring); }, 50},
+    {"endCapture", NULL, NULL, [] { dut->endCapture(); }, 100},
+    {"service", startCapture, nextCycle, [] { sink += dut->service(); }, 100},
+    {"beginEvents", NULL, [] { dut->endEvents(); },
+     [] { dut->beginEvents(&events); }, 50},
+    {"endEvents", NULL, NULL, [] { dut->endEvents(); }, 100},
+
+    // Color conversions, no bus
+    {"Color::rawToXYZ", NULL, NULL,
+     [] {
+       tcs3430_xyz_t xyz;
+       Adafruit_TCS3430_Color::rawToXYZ(NEXT & 0xFFFF, 900, 800, 100, &xyz);
+       sink += (uint32_t)xyz.Y;
+     },
+     100000},
+    {"Color::xyzToCIE", NULL, NULL,
+     [] {
+       tcs3430_xyz_t xyz = {(float)(NEXT & 0xFFF) + 1, 1000, 900};
+       float x, y;
+       Adafruit_TCS3430_Color::xyzToCIE(&xyz, &x, &y);
+       sink += (uint32_t)(x * 1000);
+     },
+     100000},
+    {"Color::cieToCCT", NULL, NULL,
+     [] {
+       sink += (uint32_t)Adafruit_TCS3430_Color::cieToCCT(
+           0.3f + (NEXT & 0xFF) * 1e-4f, 0.33f);
+     },
+     100000},
+    {"Color::lux", NULL, NULL,
+     [] {
+       sink += (uint32_t)Adafruit_TCS3430_Color::lux(
+           (float)(NEXT & 0xFFFF), TCS3430_GAIN_16X, 35);
+     },
+     100000},
+    {"Color::rawToXYZFixed", NULL, NULL,
+     [] {
+       tcs3430_xyz_fixed_t xyz;
+       Adafruit_TCS3430_Color::rawToXYZFixed(NEXT & 0xFFFF, 900, 800, 100,
+                                             &xyz);
+       sink += xyz.Y;
+     },
+     100000},
+    {"Color::xyzToCIEFixed", NULL, NULL,
+     [] {
+       tcs3430_xyz_fixed_t xyz;
+       Adafruit_TCS3430_Color::rawToXYZFixed(1000 + (NEXT & 0xFFF), 900, 800,
+                                             100, &xyz);
+       uint16_t x, y;
+       Adafruit_TCS3430_Color::xyzToCIEFixed(&xyz, &x, &y);
+       sink += x;
+     },
+     100000},
+    {"Color::cieToCCTFixed", NULL, NULL,
+     [] {
+       sink += Adafruit_TCS3430_Color::cieToCCTFixed(19660 + (NEXT & 0xFF),
+                                                     21627);
+     },
+     100000},
+    {"Color::luxFixed", NULL, NULL,
+     [] {
+       sink += Adafruit_TCS3430_Color::luxFixed(NEXT & 0xFFFFF,
+                                                TCS3430_GAIN_16X, 35);
+     },
+     100000},
+
+    // Sequences
+    {"seq:begin_configure", NULL, NULL,
+     [] {
+       dut->begin();
+       dut->setIntegrationCycles(kConfigured.atime);
+       dut->setALSGain(kConfigured.gain);
+       dut->setALSThresholds(kConfigured.threshold_low,
+                             kConfigured.threshold_high);
+       dut->setInterruptPersistence(kConfigured.persistence);
+       dut->enableALSInt(true);
+     },
+     20},
+    {"seq:begin_configure_cached", NULL, NULL,
+     [] {
+       dut->begin();
+       dut->enableRegisterCache(true);
+       dut->setIntegrationCycles(kConfigured.atime);
+       dut->setALSGain(kConfigured.gain);
+       dut->setALSThresholds(kConfigured.threshold_low,
+                             kConfigured.threshold_high);
+       dut->setInterruptPersistence(kConfigured.persistence);
+       dut->enableALSInt(true);
+       dut->enableRegisterCache(false);
+     },
+     20},
+    {"seq:begin_apply_config", NULL, NULL,
+     [] {
+       dut->begin();
+       dut->applyConfig(&kConfigured);
+     },
+     20},
+    {"seq:sample_loop", NULL, NULL,
+     [] {
+       nextCycle();
+       dut->readFrame(&frame);
+       tcs3430_xyz_t xyz;
+       float x, y;
+       Adafruit_TCS3430_Color::rawToXYZ(frame.ch3, frame.y, frame.z,
+                                        frame.ir1, &xyz);
+       Adafruit_TCS3430_Color::xyzToCIE(&xyz, &x, &y);
+       sink += (uint32_t)Adafruit_TCS3430_Color::cieToCCT(x, y);
+       sink += (uint32_t)Adafruit_TCS3430_Color::lux(xyz.Y, kConfigured.gain,
+                                                     kConfigured.atime);
+     },
+     50},
+    {"seq:sample_loop_fixed", NULL, NULL,
+     [] {
+       nextCycle();
+       sink += dut->getLuxFixed() + dut->getCCTFixed();
+     },
+     50},
+    {"seq:scheduled_sample", NULL, NULL,
+     [] {
+       do {
+         waitScheduled();
+       } while (scheduler->poll(&frame) != TCS3430_POLL_READY);
+     },
+     160},
+    {"seq:interrupt_service", startCapture, NULL,
+     [] {
+       nextCycle();
+       dut->service();
+       tcs3430_frame_t f;
+       while (ring.pop(&f)) {
+         sink += f.y;
+       }
+     },
+     50},
+    {"seq:event_service", startEvents, NULL,
+     [] {
+       nextCycle();
+       dut->service();
+       tcs3430_event_t e;
+       while (events.pop(&e)) {
+         sink += e.type;
+       }
+     },
+     50},
+};
+
+/*!
+ *    @brief  Run one case
+ *    @param  c Case
+ *    @return Per-call measurements
+ */
+static bench_result_t measure(const bench_case_t& c) {
+  fresh();
+  if (c.setup) {
+    c.setup();
+  }
+  // One call first, so lazy state (AMUX readback, learned cycle) is warm
+  if (c.before) {
+    c.before();
+  }
+  c.run();
+  uint32_t transactions = 0;
+  uint32_t bytes = 0;
+  double elapsed = 0;
+  for (uint32_t i = 0; i < c.calls; i++) {
+    if (c.before) {
+      c.before();
+    }
+    Wire.resetCounters();
+    double start = nowNs();
+    c.run();
+    elapsed += nowNs() - start;
+    transactions += Wire.transactions();
+    bytes += Wire.bytes();
+  }
+  detachInterrupt(digitalPinToInterrupt(BENCH_INT_PIN));
+  bench_result_t r;
+  r.transactions = (double)transactions / c.calls;
+  r.bytes = (double)bytes / c.calls;
+  r.cpu_ns = elapsed / c.calls;
+  return r;
+}
+
+/*!
+ *    @brief  Minimal reader for the budget file: an object of objects of
+ *            numbers, e.g. {"readFrame": {"transactions": 1, "bytes": 11}}
+ */
+class BudgetParser {
+ public:
+  /*!
+   *    @brief  Instantiates a parser
+   *    @param  text File contents
+   */
+  BudgetParser(const std::string& text) : _s(text.c_str()), _p(_s) {}
+
+  /*!
+   *    @brief  Parse the whole file
+   *    @param  out Budgets by case name
+   *    @return true on success; otherwise error() says where
+   */
+  bool parse(std::map<std::string, bench_budget_t>* out) {
+    if (!expect('{')) {
+      return false;
+    }
+    if (peek() == '}') {
+      _p++;
+      return end();
+    }
+    do {
+      std::string name;
+      bench_budget_t budget = {-1, -1};
+      if (!string(&name) || !expect(':') || !entry(&budget)) {
+        return false;
+      }
+      if (budget.transactions < 0 || budget.bytes < 0) {
+        return fail("\"transactions\" and \"bytes\" are both required");
+      }
+      (*out)[name] = budget;
+    } while (next());
+    return expect('}') && end();
+  }
+
+  /*!
+   *    @brief  Why parse() failed
+   *    @return Message with the byte offset
+   */
+  const std::string& error() const {
+    return _error;
+  }
+
+ private:
+  bool entry(bench_budget_t* budget) {
+    if (!expect('{')) {
+      return false;
+    }
+    do {
+      std::string key;
+      double value;
+      if (!string(&key) || !expect(':') || !number(&value)) {
+        return false;
+      }
+      if (key == "transactions") {
+        budget->transactions = value;
+      } else if (key == "bytes") {
+        budget->bytes = value;
+      }
+    } while (next());
+    return expect('}');
+  }
+
+  bool string(std::string* out) {
+    if (!expect('"')) {
+      return false;
+    }
+    while (*_p && *_p != '"') {
+      if (*_p == '\\') {
+        return fail("escapes are not supported");
+      }
+      *out += *_p++;
+    }
+    return expect('"');
+  }
+
+  bool number(double* out) {
+    peek();
+    char* end;
+    *out = strtod(_p, &end);
+    if (end == _p) {
+      return fail("number expected");
+    }
+    _p = end;
+    return true;
+  }
+
+  bool next() {
+    if (peek() == ',') {
+      _p++;
+      return true;
+    }
+    return false;
+  }
+
+  char peek() {
+    while (isspace((unsigned char)*_p)) {
+      _p++;
+    }
+    return *_p;
+  }
+
+  bool expect(char c) {
+    if (peek() != c) {
+      return fail(std::string("'") + c + "' expected");
+    }
+    _p++;
+    return true;
+  }
+
+  bool end() {
+    return peek() == '\0' || fail("trailing characters");
+  }
+
+  bool fail(const std::string& what) {
+    char where[32];
+    snprintf(where, sizeof(where), " at byte %ld", (long)(_p - _s));
+    _error = what + where;
+    return false;
+  }
+
+  const char* _s;
+  const char* _p;
+  std::string _error;
+};
+
+/*!
+ *    @brief  Read a whole file
+ *    @param  path File name
+ *    @param  out Contents
+ *    @return true on success
+ */
+static bool readFile(const char* path, std::string* out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    out->append(buf, n);
+  }
+  fclose(f);
+  return true;
+}
+
+/*!
+ *    @brief  Round a measurement up to the two decimals a budget keeps
+ *    @param  v Measurement
+ *    @return v rounded up to 0.01
+ */
+static double budgetOf(double v) {
+  double b = ceil(v * 100 - 1e-6) / 100;
+  return b > 0 ? b : 0;
+}
+
+int main(int argc, char** argv) {
+  const char* budgets_path = NULL;
+  const char* json_path = NULL;
+  const char* update_path = NULL;
+  const char* filter = NULL;
+  for (int i = 1; i < argc; i++) {
+    const char** target = NULL;
+    if (!strcmp(argv[i], "--budgets")) {
+      target = &budgets_path;
+    } else if (!strcmp(argv[i], "--json")) {
+      target = &json_path;
+    } else if (!strcmp(argv[i], "--update")) {
+      target = &update_path;
+    } else if (!strcmp(argv[i], "--filter")) {
+      target = &filter;
+    }
+    if (!target || i + 1 >= argc) {
+      fprintf(stderr,
+              "usage: %s [--budgets FILE] [--json FILE] [--update FILE] "
+              "[--filter TEXT]\n",
+              argv[0]);
+      return 2;
+    }
+    *target = argv[++i];
+  }
+
+  std::map<std::string, bench_budget_t> budgets;
+  if (budgets_path) {
+    std::string text;
+    if (!readFile(budgets_path, &text)) {
+      fprintf(stderr, "%s: cannot read\n", budgets_path);
+      return 2;
+    }
+    BudgetParser parser(text);
+    if (!parser.parse(&budgets)) {
+      fprintf(stderr, "%s: %s\n", budgets_path, parser.error().c_str());
+      return 2;
+    }
+  }
+
+  SimHost::instance().addTarget(&sensor, TCS3430_DEFAULT_ADDR);
+  sensor.connectInterrupt(BENCH_INT_PIN);
+  SimHost::instance().setAmbient(sim_light_t{40, 50, 35, 8, 6});
+
+  std::vector<const bench_case_t*> run;
+  std::vector<bench_result_t> results;
+  int failures = 0;
+  printf("%-33s %8s %8s %10s %10s %10s %12s\n", "case", "txn", "bytes",
+         "us@100k", "us@400k", "us@1M", "cpu ns");
+  for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+    const bench_case_t& c = kCases[i];
+    if (filter && !strstr(c.name, filter)) {
+      continue;
+    }
+    bench_result_t r = measure(c);
+    run.push_back(&c);
+    results.push_back(r);
+    printf("%-33s %8.2f %8.2f %10.1f %10.1f %10.1f %12.0f", c.name,
+           r.transactions, r.bytes, busMicros(r.transactions, r.bytes, 100000),
+           busMicros(r.transactions, r.bytes, 400000),
+           busMicros(r.transactions, r.bytes, 1000000), r.cpu_ns);
+    if (budgets_path) {
+      std::map<std::string, bench_budget_t>::const_iterator b =
+          budgets.find(c.name);
+      if (b == budgets.end()) {
+        printf("  NO BUDGET");
+        failures++;
+      } else if (r.transactions > b->second.transactions + 1e-6 ||
+                 r.bytes > b->second.bytes + 1e-6) {
+        printf("  OVER BUDGET (%.2f txn, %.2f bytes)",
+               b->second.transactions, b->second.bytes);
+        failures++;
+      } else if (budgetOf(r.transactions) < b->second.transactions ||
+                 budgetOf(r.bytes) < b->second.bytes) {
+        printf("  under budget, tighten with --update");
+      }
+    }
+    printf("\n");
+  }
+  delete dut;
+
+  if (json_path) {
+    FILE* f = fopen(json_path, "w");
+    if (!f) {
+      fprintf(stderr, "%s: cannot write\n", json_path);
+      return 2;
+    }
+    fprintf(f, "{\n  \"cases\": [\n");
+    for (size_t i = 0; i < run.size(); i++) {
+      const bench_result_t& r = results[i];
+      fprintf(f,
+              "    {\"name\": \"%s\", \"calls\": %u, \"transactions\": %.2f, "
+              "\"bytes\": %.2f",
+              run[i]->name, (unsigned)run[i]->calls, r.transactions, r.bytes);
+      for (uint8_t k = 0; k < 3; k++) {
+        fprintf(f, ", \"%s\": %.1f", kClockKeys[k],
+                busMicros(r.transactions, r.bytes, kClocks[k]));
+      }
+      fprintf(f, ", \"cpu_ns\": %.0f}%s\n", r.cpu_ns,
+              i + 1 < run.size() ? "," : "");
+    }
+    fprintf(f, "  ],\n  \"failures\": %d\n}\n", failures);
+    fclose(f);
+  }
+
+  if (update_path) {
+    FILE* f = fopen(update_path, "w");
+    if (!f) {
+      fprintf(stderr, "%s: cannot write\n", update_path);
+      return 2;
+    }
+    fprintf(f, "{\n");
+    for (size_t i = 0; i < run.size(); i++) {
+      fprintf(f, "  \"%s\": {\"transactions\": %.2f, \"bytes\": %.2f}%s\n",
+              run[i]->name, budgetOf(results[i].transactions),
+              budgetOf(results[i].bytes), i + 1 < run.size() ? "," : "");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+  }
+
+  if (failures) {
+    printf("%d case(s) over or without a budget\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*!
+ *  @file batch_bench.cpp
+ *
+ * 	Conversions per second of Adafruit_TCS3430_Batch::convert() against
+ * 	the per-sample Adafruit_TCS3430_Color float functions, and the largest
+ * 	difference between the two. Build with CMAKE_BUILD_TYPE=Release; add
+ * 	-DTCS3430_SIMD=ON for the hand-written SSE2/NEON kernel.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "Adafruit_TCS3430_Batch.h"
+
+static const uint32_t kSamples = 1 << 20;
+static const int kRounds = 5;
+
+/*!
+ *    @brief  Monotonic time
+ *    @return Seconds
+ */
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*!
+ *    @brief  Largest relative difference between two arrays
+ *    @param  a First array
+ *    @param  b Second array
+ *    @param  n Length
+ *    @return max |a - b| / max(|a|, 1)
+ */
+static double maxDiff(const float* a, const float* b, uint32_t n) {
+  double worst = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    double d = fabs((double)a[i] - b[i]) / fmax(fabs(a[i]), 1.0);
+    if (d > worst) {
+      worst = d;
+    }
+  }
+  return worst;
+}
+
+int main() {
+  std::vector<uint16_t> x(kSamples), y(kSamples), z(kSamples), ir1(kSamples);
+  std::vector<uint8_t> gain(kSamples), atime(kSamples);
+  srand(1);
+  for (uint32_t i = 0; i < kSamples; i++) {
+    // Plausible light: Y and Z track X, IR1 a fraction of them
+    uint16_t level = rand() % 60000;
+    x[i] = level;
+    y[i] = level * (80 + rand() % 40) / 100 % 65536;
+    z[i] = level * (60 + rand() % 60) / 100 % 65536;
+    ir1[i] = level * (rand() % 30) / 100;
+    gain[i] = rand() % 5;
+    atime[i] = rand() % 256;
+  }
+
+  std::vector<float> sX(kSamples), sY(kSamples), sZ(kSamples);
+  std::vector<float> scx(kSamples), scy(kSamples), scct(kSamples),
+      slux(kSamples);
+  double scalar = 1e9;
+  for (int r = 0; r < kRounds; r++) {
+    double t0 = now();
+    for (uint32_t i = 0; i < kSamples; i++) {
+      tcs3430_xyz_t xyz;
+      Adafruit_TCS3430_Color::rawToXYZ(x[i], y[i], z[i], ir1[i], &xyz);
+      Adafruit_TCS3430_Color::xyzToCIE(&xyz, &scx[i], &scy[i]);
+      scct[i] = Adafruit_TCS3430_Color::cieToCCT(scx[i], scy[i]);
+      slux[i] = Adafruit_TCS3430_Color::lux(xyz.Y, (tcs3430_gain_t)gain[i],
+                                            atime[i]);
+      sX[i] = xyz.X;
+      sY[i] = xyz.Y;
+      sZ[i] = xyz.Z;
+    }
+    double t = now() - t0;
+    scalar = t < scalar ? t : scalar;
+  }
+
+  std::vector<float> bX(kSamples), bY(kSamples), bZ(kSamples);
+  std::vector<float> bcx(kSamples), bcy(kSamples), bcct(kSamples),
+      blux(kSamples);
+  tcs3430_raw_batch_t in = {x.data(),    y.data(),         z.data(),
+                            ir1.data(),  gain.data(),      atime.data(),
+                            TCS3430_GAIN_1X, 0};
+  tcs3430_color_batch_t out = {bX.data(),  bY.data(),   bZ.data(),
+                               bcx.data(), bcy.data(),  bcct.data(),
+                               blux.data()};
+  double batch = 1e9;
+  for (int r = 0; r < kRounds; r++) {
+    double t0 = now();
+    Adafruit_TCS3430_Batch::convert(&in, &out, kSamples);
+    double t = now() - t0;
+    batch = t < batch ? t : batch;
+  }
+
+#ifndef __OPTIMIZE__
+  printf("warning: unoptimised build, use CMAKE_BUILD_TYPE=Release\n");
+#endif
+  printf("samples          %u\n", kSamples);
+  printf("scalar           %.1f M conversions/s\n", kSamples / scalar / 1e6);
+  printf("batch (%s) %*s%.1f M conversions/s (%.2fx)\n",
+         Adafruit_TCS3430_Batch::kernel(),
+         (int)(8 - strlen(Adafruit_TCS3430_Batch::kernel())), "",
+         kSamples / batch / 1e6, scalar / batch);
+  printf("max rel diff     XYZ %.2g  x,y %.2g  CCT %.2g  lux %.2g\n",
+         fmax(fmax(maxDiff(sX.data(), bX.data(), kSamples),
+                   maxDiff(sY.data(), bY.data(), kSamples)),
+              maxDiff(sZ.data(), bZ.data(), kSamples)),
+         fmax(maxDiff(scx.data(), bcx.data(), kSamples),
+              maxDiff(scy.data(), bcy.data(), kSamples)),
+         maxDiff(scct.data(), bcct.data(), kSamples),
+         maxDiff(slux.data(), blux.data(), kSamples));
+  return 0;
+}
@@ -0,0 +1,316 @@
+/*!
+ *  @file SimHost.cpp
+ *
+ * 	Virtual clock, GPIO, interrupt and I2C bus model for the host build
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "SimHost.h"
+
+#include <string.h>
+
+#include "Arduino.h"
+
+// The rig's enclosure: a little stray light, well below the sensor's own
+// dark signal at any ATIME the tests use
+static const sim_light_t dark_box = {0.02f, 0.02f, 0.02f, 0.01f, 0.01f};
+
+/*!
+ *    @brief  The one simulated board
+ *    @return Reference to the host
+ */
+SimHost& SimHost::instance() {
+  static SimHost host;
+  return host;
+}
+
+/*!
+ *    @brief  Fresh board at time zero
+ */
+SimHost::SimHost() {
+  reset();
+}
+
+/*!
+ *    @brief  Detach all targets, release all pins and restart the clock
+ *    @param  start_us Initial virtual time, e.g. just below 2^32 to
+ *            exercise micros() wraparound
+ */
+void SimHost::reset(uint64_t start_us) {
+  _now = start_us;
+  _busy = false;
+  _irq_enabled = true;
+  _irq_count = 0;
+  _target_count = 0;
+  memset(_pins, 0, sizeof(_pins));
+  _ambient = dark_box;
+  memset(&_source, 0, sizeof(_source));
+}
+
+/*!
+ *    @brief  Current virtual time
+ *    @return Microseconds since reset
+ */
+uint64_t SimHost::now() const {
+  return _now;
+}
+
+/*!
+ *    @brief  Move the clock forward, stepping every target through each
+ *            of its internal events in order and running interrupt
+ *            handlers at the time their edge occurs. Calls made from
+ *            inside a handler do not move the clock.
+ *    @param  us Microseconds to advance
+ */
+void SimHost::advance(uint64_t us) {
+  if (_busy) {
+    return;
+  }
+  _busy = true;
+  uint64_t target_time = _now + us;
+  for (;;) {
+    uint64_t next = target_time;
+    for (uint8_t i = 0; i < _target_count; i++) {
+      uint64_t event = _targets[i].target->nextEvent();
+      if (event < next) {
+        next = event;
+      }
+    }
+    if (next > _now) {
+      _now = next;
+    }
+    for (uint8_t i = 0; i < _target_count; i++) {
+      _targets[i].target->advance(_now);
+    }
+    deliverInterrupts();
+    if (_now >= target_time) {
+      break;
+    }
+  }
+  _busy = false;
+}
+
+/*!
+ *    @brief  Attach a target to the bus
+ *    @param  target The device
+ *    @param  addr 7-bit address
+ *    @param  behind Bus switch the device sits behind, or NULL
+ *    @param  channel Switch channel
+ *    @return false if the bus is full
+ */
+bool SimHost::addTarget(SimI2CTarget* target, uint8_t addr,
+                        SimI2CTarget* behind, uint8_t channel) {
+  if (_target_count >= SIMHOST_MAX_TARGETS) {
+    return false;
+  }
+  target->advance(_now);
+  entry_t& e = _targets[_target_count++];
+  e.target = target;
+  e.behind = behind;
+  e.addr = addr;
+  e.channel = channel;
+  return true;
+}
+
+/*!
+ *    @brief  Detach a target from the bus
+ *    @param  target The device
+ */
+void SimHost::removeTarget(SimI2CTarget* target) {
+  uint8_t out = 0;
+  for (uint8_t i = 0; i < _target_count; i++) {
+    if (_targets[i].target != target) {
+      _targets[out++] = _targets[i];
+    }
+  }
+  _target_count = out;
+}
+
+/*!
+ *    @brief  Find the device that would ACK an address right now, taking
+ *            bus switch state into account
+ *    @param  addr 7-bit address
+ *    @return The device, or NULL if nothing answers
+ */
+SimI2CTarget* SimHost::findTarget(uint8_t addr) const {
+  for (uint8_t i = 0; i < _target_count; i++) {
+    const entry_t& e = _targets[i];
+    if (e.addr != addr) {
+      continue;
+    }
+    if (!e.behind || e.behind->routes(e.channel)) {
+      return e.target;
+    }
+  }
+  return NULL;
+}
+
+/*!
+ *    @brief  Configure a pin from the sketch side
+ *    @param  pin Pin number
+ *    @param  mode INPUT, OUTPUT or INPUT_PULLUP
+ */
+void SimHost::pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= SIMHOST_MAX_PINS) {
+    return;
+  }
+  bool before = pinLevel(pin);
+  _pins[pin].mode = mode;
+  checkEdge(pin, before);
+}
+
+/*!
+ *    @brief  Drive a pin, from a simulated device or digitalWrite()
+ *    @param  pin Pin number
+ *    @param  level Level to drive
+ */
+void SimHost::drivePin(uint8_t pin, bool level) {
+  if (pin >= SIMHOST_MAX_PINS) {
+    return;
+  }
+  bool before = pinLevel(pin);
+  _pins[pin].driven = true;
+  _pins[pin].level = level;
+  checkEdge(pin, before);
+}
+
+/*!
+ *    @brief  Stop driving a pin, leaving it to its pull (if any)
+ *    @param  pin Pin number
+ */
+void SimHost::releasePin(uint8_t pin) {
+  if (pin >= SIMHOST_MAX_PINS) {
+    return;
+  }
+  bool before = pinLevel(pin);
+  _pins[pin].driven = false;
+  checkEdge(pin, before);
+}
+
+/*!
+ *    @brief  Level a digitalRead() would see
+ *    @param  pin Pin number
+ *    @return true for HIGH
+ */
+bool SimHost::pinLevel(uint8_t pin) const {
+  if (pin >= SIMHOST_MAX_PINS) {
+    return false;
+  }
+  const pin_t& p = _pins[pin];
+  if (p.driven) {
+    return p.level;
+  }
+  return p.mode == INPUT_PULLUP;
+}
+
+/*!
+ *    @brief  Latch a pending handler call if a pin change matches the
+ *            attached edge
+ *    @param  pin Pin number
+ *    @param  before Level before the change
+ */
+void SimHost::checkEdge(uint8_t pin, bool before) {
+  pin_t& p = _pins[pin];
+  bool after = pinLevel(pin);
+  if (before == after || !p.isr) {
+    return;
+  }
+  if (p.isr_mode == CHANGE || (p.isr_mode == RISING && after) ||
+      (p.isr_mode == FALLING && !after)) {
+    p.isr_pending = true;
+  }
+}
+
+/*!
+ *    @brief  Attach or detach an edge handler
+ *    @param  pin Pin number
+ *    @param  isr Handler, NULL to detach
+ *    @param  mode RISING, FALLING or CHANGE
+ */
+void SimHost::attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+  if (pin >= SIMHOST_MAX_PINS) {
+    return;
+  }
+  _pins[pin].isr = isr;
+  _pins[pin].isr_mode = isr ? mode : 0;
+  _pins[pin].isr_pending = false;
+}
+
+/*!
+ *    @brief  Global interrupt enable; edges seen while disabled run their
+ *            handler (once) when re-enabled, like a latched AVR flag
+ *    @param  enabled New state
+ */
+void SimHost::setInterruptsEnabled(bool enabled) {
+  _irq_enabled = enabled;
+  if (enabled && !_busy) {
+    _busy = true;
+    deliverInterrupts();
+    _busy = false;
+  }
+}
+
+/*!
+ *    @brief  Number of handler invocations since reset
+ *    @return Count
+ */
+uint32_t SimHost::interruptCount() const {
+  return _irq_count;
+}
+
+/*!
+ *    @brief  Run pending edge handlers
+ */
+void SimHost::deliverInterrupts() {
+  if (!_irq_enabled) {
+    return;
+  }
+  for (uint8_t i = 0; i < SIMHOST_MAX_PINS; i++) {
+    pin_t& p = _pins[i];
+    if (p.isr_pending && p.isr) {
+      p.isr_pending = false;
+      _irq_count++;
+      p.isr();
+    }
+  }
+}
+
+/*!
+ *    @brief  Set the room light every sensor sees
+ *    @param  light Light level
+ */
+void SimHost::setAmbient(const sim_light_t& light) {
+  _ambient = light;
+}
+
+/*!
+ *    @brief  Set the light added by a controllable source (the NeoPixel
+ *            ring in the hw_tests rig)
+ *    @param  light Light level
+ */
+void SimHost::setSource(const sim_light_t& light) {
+  _source = light;
+}
+
+/*!
+ *    @brief  Total light at the sensors right now
+ *    @return Ambient plus source
+ */
+sim_light_t SimHost::light() const {
+  sim_light_t total;
+  total.x = _ambient.x + _source.x;
+  total.y = _ambient.y + _source.y;
+  total.z = _ambient.z + _source.z;
+  total.ir1 = _ambient.ir1 + _source.ir1;
+  total.ir2 = _ambient.ir2 + _source.ir2;
+  return total;
+}
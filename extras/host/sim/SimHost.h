@@ -0,0 +1,152 @@
+/*!
+ *  @file SimHost.h
+ *
+ * 	Virtual clock, GPIO, interrupt and I2C bus model that the host build's
+ * 	Arduino/Wire stand-ins run on. Simulated targets register here and are
+ * 	stepped in time order, so every cycle boundary and pin edge lands at
+ * 	its exact microsecond regardless of how coarsely the sketch polls.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_SIMHOST_H
+#define _ADAFRUIT_TCS3430_SIMHOST_H
+
+#include <stdint.h>
+
+#define SIMHOST_CALL_COST_US 1 ///< Time charged per micros()/yield() call
+#define SIMHOST_MAX_TARGETS 64 ///< Targets on one bus, muxed ones included
+#define SIMHOST_MAX_PINS 64    ///< GPIO pins
+#define SIMHOST_NEVER UINT64_MAX ///< nextEvent() value for "nothing pending"
+
+/*!
+ *    @brief  Light reaching a sensor, in counts per 2.78 ms step at 1x gain
+ *            for each photodiode
+ */
+typedef struct {
+  float x;   ///< X photodiode
+  float y;   ///< Y photodiode
+  float z;   ///< Z photodiode
+  float ir1; ///< IR1 photodiode
+  float ir2; ///< IR2 photodiode
+} sim_light_t;
+
+/*!
+ *    @brief  Something on the simulated I2C bus
+ */
+class SimI2CTarget {
+ public:
+  virtual ~SimI2CTarget() {}
+  /*!
+   *    @brief  Handle a write transaction
+   *    @param  data Bytes after the address byte
+   *    @param  len Number of bytes, 0 for an address probe
+   *    @return false to NACK
+   */
+  virtual bool i2cWrite(const uint8_t* data, uint32_t len) = 0;
+  /*!
+   *    @brief  Handle a read transaction
+   *    @param  data Destination
+   *    @param  len Number of bytes requested
+   *    @return false to NACK
+   */
+  virtual bool i2cRead(uint8_t* data, uint32_t len) = 0;
+  /*!
+   *    @brief  Bring internal state up to the given time
+   *    @param  now Virtual time in microseconds
+   */
+  virtual void advance(uint64_t now) {
+    (void)now;
+  }
+  /*!
+   *    @brief  When the next internal state change is due. After
+   *            advance(now) this must be later than now.
+   *    @return Virtual time in microseconds, or SIMHOST_NEVER
+   */
+  virtual uint64_t nextEvent() const {
+    return SIMHOST_NEVER;
+  }
+  /*!
+   *    @brief  For bus switches: whether a downstream channel is connected
+   *    @param  channel Downstream channel
+   *    @return true if targets on that channel are reachable
+   */
+  virtual bool routes(uint8_t channel) const {
+    (void)channel;
+    return false;
+  }
+};
+
+/*!
+ *    @brief  The simulated board: one clock, one I2C bus, a bank of GPIO
+ *            and the light in the room
+ */
+class SimHost {
+ public:
+  static SimHost& instance();
+
+  void reset(uint64_t start_us = 0);
+
+  uint64_t now() const;
+  void advance(uint64_t us);
+
+  bool addTarget(SimI2CTarget* target, uint8_t addr,
+                 SimI2CTarget* behind = 0, uint8_t channel = 0);
+  void removeTarget(SimI2CTarget* target);
+  SimI2CTarget* findTarget(uint8_t addr) const;
+
+  void pinMode(uint8_t pin, uint8_t mode);
+  void drivePin(uint8_t pin, bool level);
+  void releasePin(uint8_t pin);
+  bool pinLevel(uint8_t pin) const;
+  void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+  void setInterruptsEnabled(bool enabled);
+  uint32_t interruptCount() const;
+
+  void setAmbient(const sim_light_t& light);
+  void setSource(const sim_light_t& light);
+  sim_light_t light() const;
+
+ private:
+  SimHost();
+  void checkEdge(uint8_t pin, bool before);
+  void deliverInterrupts();
+
+  /** A bus target and where it hangs off the bus */
+  typedef struct {
+    SimI2CTarget* target; ///< The device
+    SimI2CTarget* behind; ///< Switch in front of it, or NULL
+    uint8_t addr;         ///< 7-bit address
+    uint8_t channel;      ///< Switch channel when behind a switch
+  } entry_t;
+
+  /** One GPIO */
+  typedef struct {
+    uint8_t mode;       ///< INPUT, OUTPUT or INPUT_PULLUP
+    bool driven;        ///< Something is driving the pin
+    bool level;         ///< Driven level
+    int isr_mode;       ///< RISING/FALLING/CHANGE, 0 when detached
+    void (*isr)(void);  ///< Attached handler
+    bool isr_pending;   ///< Edge seen, handler not yet run
+  } pin_t;
+
+  uint64_t _now;
+  bool _busy;
+  bool _irq_enabled;
+  uint32_t _irq_count;
+  entry_t _targets[SIMHOST_MAX_TARGETS];
+  uint8_t _target_count;
+  pin_t _pins[SIMHOST_MAX_PINS];
+  sim_light_t _ambient;
+  sim_light_t _source;
+};
+
+#endif
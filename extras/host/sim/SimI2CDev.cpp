@@ -0,0 +1,121 @@
+/*!
+ *  @file SimI2CDev.cpp
+ *
+ * 	In-process fake of the Linux i2c-dev interface
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "SimI2CDev.h"
+
+#include <Wire.h>
+
+/*!
+ *    @brief  A fake adapter with the sensor at addr
+ *    @param  addr 7-bit sensor address
+ *    @param  smbus_only Report SMBus functions only, like i2c-stub
+ */
+SimI2CDev::SimI2CDev(uint8_t addr, bool smbus_only)
+    : Adafruit_TCS3430_LinuxI2C("sim", addr), _smbus_only(smbus_only),
+      _ioctls(0) {}
+
+/*!
+ *    @brief  Number of transfer ioctls served
+ *    @return Count since construction
+ */
+uint32_t SimI2CDev::ioctls() const {
+  return _ioctls;
+}
+
+/*!
+ *    @brief  "Open" the adapter
+ *    @return true
+ */
+bool SimI2CDev::openBus() {
+  _fd = 0;
+  return true;
+}
+
+/*!
+ *    @brief  "Close" the adapter
+ */
+void SimI2CDev::closeBus() {
+  _fd = -1;
+}
+
+/*!
+ *    @brief  Adapter functions, as I2C_FUNCS would report them
+ *    @return I2C_FUNC_* bits
+ */
+unsigned long SimI2CDev::functions() {
+  unsigned long smbus = I2C_FUNC_SMBUS_BYTE_DATA | I2C_FUNC_SMBUS_I2C_BLOCK;
+  return _smbus_only ? smbus : smbus | I2C_FUNC_I2C;
+}
+
+/*!
+ *    @brief  Serve I2C_RDWR: each message is one transaction on the
+ *            simulated bus, with a repeated start between them
+ *    @param  msgs Messages
+ *    @param  count Number of messages
+ *    @return true if every message was acknowledged
+ */
+bool SimI2CDev::transfer(struct i2c_msg* msgs, uint8_t count) {
+  _ioctls++;
+  if (_smbus_only) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    bool last = i == count - 1;
+    if (msgs[i].flags & I2C_M_RD) {
+      if (Wire.requestFrom(msgs[i].addr, msgs[i].len, last) != msgs[i].len) {
+        return false;
+      }
+      for (uint16_t j = 0; j < msgs[i].len; j++) {
+        msgs[i].buf[j] = Wire.read();
+      }
+    } else {
+      Wire.beginTransmission(msgs[i].addr);
+      Wire.write(msgs[i].buf, msgs[i].len);
+      if (Wire.endTransmission(last) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Serve I2C_SMBUS I2C block transfers the way i2c-dev turns
+ *            them into bus traffic
+ *    @param  read_write I2C_SMBUS_READ or I2C_SMBUS_WRITE
+ *    @param  command Register address
+ *    @param  data Length in block[0], then the data
+ *    @return true on success
+ */
+bool SimI2CDev::smbus(uint8_t read_write, uint8_t command,
+                      union i2c_smbus_data* data) {
+  _ioctls++;
+  uint8_t len = data->block[0];
+  Wire.beginTransmission(_addr);
+  Wire.write(command);
+  if (read_write == I2C_SMBUS_WRITE) {
+    Wire.write(data->block + 1, len);
+    return Wire.endTransmission() == 0;
+  }
+  if (Wire.endTransmission(false) != 0 ||
+      Wire.requestFrom(_addr, len) != len) {
+    return false;
+  }
+  for (uint8_t j = 0; j < len; j++) {
+    data->block[1 + j] = Wire.read();
+  }
+  return true;
+}
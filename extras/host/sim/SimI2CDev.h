@@ -0,0 +1,50 @@
+/*!
+ *  @file SimI2CDev.h
+ *
+ * 	In-process fake of the Linux i2c-dev interface behind
+ * 	Adafruit_TCS3430_LinuxI2C: its ioctls are served by the simulated bus
+ * 	instead of the kernel, so the Linux transport runs against
+ * 	SimTCS3430 without hardware or root
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_SIMI2CDEV_H
+#define _ADAFRUIT_TCS3430_SIMI2CDEV_H
+
+#include "Adafruit_TCS3430_LinuxI2C.h"
+
+/*!
+ *    @brief  Adafruit_TCS3430_LinuxI2C on the simulated bus. Combined
+ *            I2C_RDWR messages become one write and one read on Wire;
+ *            with smbus_only the adapter reports SMBus functions only,
+ *            like the kernel's i2c-stub, and block transfers are served
+ *            the way i2c-dev would send them.
+ */
+class SimI2CDev : public Adafruit_TCS3430_LinuxI2C {
+ public:
+  SimI2CDev(uint8_t addr = TCS3430_DEFAULT_ADDR, bool smbus_only = false);
+
+  uint32_t ioctls() const;
+
+ protected:
+  bool openBus();
+  void closeBus();
+  unsigned long functions();
+  bool transfer(struct i2c_msg* msgs, uint8_t count);
+  bool smbus(uint8_t read_write, uint8_t command, union i2c_smbus_data* data);
+
+ private:
+  bool _smbus_only;
+  uint32_t _ioctls;
+};
+
+#endif
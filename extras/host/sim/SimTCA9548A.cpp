@@ -0,0 +1,74 @@
+/*!
+ *  @file SimTCA9548A.cpp
+ *
+ * 	Model of a TCA9548A 1-to-8 I2C switch
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "SimTCA9548A.h"
+
+/*!
+ *    @brief  All channels disconnected, as after power-on
+ */
+SimTCA9548A::SimTCA9548A() : _control(0), _writes(0) {}
+
+/*!
+ *    @brief  Current control register
+ *    @return One bit per connected channel
+ */
+uint8_t SimTCA9548A::control() const {
+  return _control;
+}
+
+/*!
+ *    @brief  Number of writes to the control register
+ *    @return Count since construction
+ */
+uint32_t SimTCA9548A::controlWrites() const {
+  return _writes;
+}
+
+/*!
+ *    @brief  Write transaction: the last byte becomes the control register
+ *    @param  data Bytes after the address byte
+ *    @param  len Number of bytes, 0 for an address probe
+ *    @return true
+ */
+bool SimTCA9548A::i2cWrite(const uint8_t* data, uint32_t len) {
+  if (len) {
+    _control = data[len - 1];
+    _writes++;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Read transaction: every byte is the control register
+ *    @param  data Destination
+ *    @param  len Number of bytes
+ *    @return true
+ */
+bool SimTCA9548A::i2cRead(uint8_t* data, uint32_t len) {
+  for (uint32_t i = 0; i < len; i++) {
+    data[i] = _control;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Whether a downstream channel is connected
+ *    @param  channel Channel 0-7
+ *    @return true if its control bit is set
+ */
+bool SimTCA9548A::routes(uint8_t channel) const {
+  return channel < 8 && (_control & (1 << channel));
+}
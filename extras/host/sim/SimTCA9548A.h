@@ -0,0 +1,43 @@
+/*!
+ *  @file SimTCA9548A.h
+ *
+ * 	Model of a TCA9548A 1-to-8 I2C switch, for putting several simulated
+ * 	TCS3430s (which all live at 0x39) on one bus
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_SIMTCA9548A_H
+#define _ADAFRUIT_TCS3430_SIMTCA9548A_H
+
+#include "SimHost.h"
+
+/*!
+ *    @brief  Simulated TCA9548A. Register targets behind it with
+ *            SimHost::addTarget(target, addr, &mux, channel).
+ */
+class SimTCA9548A : public SimI2CTarget {
+ public:
+  SimTCA9548A();
+
+  uint8_t control() const;
+  uint32_t controlWrites() const;
+
+  bool i2cWrite(const uint8_t* data, uint32_t len);
+  bool i2cRead(uint8_t* data, uint32_t len);
+  bool routes(uint8_t channel) const;
+
+ private:
+  uint8_t _control;
+  uint32_t _writes;
+};
+
+#endif
@@ -0,0 +1,555 @@
+/*!
+ *  @file SimTCS3430.cpp
+ *
+ * 	Register-level model of the TCS3430
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "SimTCS3430.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "Adafruit_TCS3430.h"
+
+// Characterised AGAIN multipliers; HGAIN with AGAIN=64x gives 137x
+static const float again_mult[4] = {1.0f, 4.0f, 16.0f, 66.0f};
+#define SIMTCS3430_HGAIN_MULT 137.0f
+
+// Residual dark signal per channel at 1x after auto-zero. It is amplified
+// like light, so it dominates dark readings at high gain and short ATIME.
+static const sim_light_t default_offset = {5.0f, 5.5f, 6.0f, 3.0f, 2.0f};
+
+/*!
+ *    @brief  A powered-down sensor with no INT wiring and nominal clock
+ */
+SimTCS3430::SimTCS3430()
+    : _int_pin(SIMTCS3430_NO_PIN),
+      _scale(1.0f),
+      _noise_rms(0.0f),
+      _rng(1),
+      _step_us(SIMTCS3430_STEP_US),
+      _offset(default_offset) {
+  reset();
+}
+
+/*!
+ *    @brief  Power-on reset: every register back to its DESIGN.md reset
+ *            value and the state machine stopped
+ */
+void SimTCS3430::reset() {
+  memset(_regs, 0, sizeof(_regs));
+  memset(_writes, 0, sizeof(_writes));
+  memset(_write_order, 0, sizeof(_write_order));
+  _write_count = 0;
+  _regs[TCS3430_REG_CFG0] = 0x80;
+  _regs[TCS3430_REG_REVID] = 0x41;
+  _regs[TCS3430_REG_ID] = 0xDC;
+  _regs[TCS3430_REG_CFG2] = 0x04;
+  _regs[TCS3430_REG_CFG3] = 0x0C;
+  _regs[TCS3430_REG_AZ_CONFIG] = 0x7F;
+  _ptr = 0;
+  _phase = SIMTCS3430_OFF;
+  _phase_end = SIMHOST_NEVER;
+  _last = SimHost::instance().now();
+  _last_cycle_end = 0;
+  _cycles = 0;
+  _az_count = 0;
+  _pers_count = 0;
+  _steps = 1;
+  memset(_acc, 0, sizeof(_acc));
+  _fail_reg = 0;
+  _fail_count = 0;
+  _fail_write_reg = 0;
+  _fail_write_count = 0;
+  statusChanged();
+}
+
+/*!
+ *    @brief  Wire the breakout's INT output to a GPIO. The breakout
+ *            inverts the open-drain INT, so the MCU sees it active-high.
+ *    @param  pin GPIO number, or SIMTCS3430_NO_PIN
+ */
+void SimTCS3430::connectInterrupt(uint8_t pin) {
+  if (_int_pin != SIMTCS3430_NO_PIN) {
+    SimHost::instance().releasePin(_int_pin);
+  }
+  _int_pin = pin;
+  statusChanged();
+}
+
+/*!
+ *    @brief  Scale the host's light for this sensor, e.g. for sensors at
+ *            different distances from the source
+ *    @param  scale Multiplier on SimHost::light()
+ */
+void SimTCS3430::setLightScale(float scale) {
+  _scale = scale;
+}
+
+/*!
+ *    @brief  Add Gaussian read noise to every conversion
+ *    @param  rms_counts Standard deviation in counts, 0 for none
+ *    @param  seed Generator seed, so runs are repeatable
+ */
+void SimTCS3430::setNoise(float rms_counts, uint32_t seed) {
+  _noise_rms = rms_counts;
+  _rng = seed ? seed : 1;
+}
+
+/*!
+ *    @brief  Run the sensor's oscillator fast or slow
+ *    @param  ppm Error in parts per million; positive makes cycles longer
+ */
+void SimTCS3430::setClockSkew(int32_t ppm) {
+  _step_us = SIMTCS3430_STEP_US * (1.0 + ppm * 1e-6);
+}
+
+/*!
+ *    @brief  Set the counts each channel reads with no light at all
+ *    @param  counts Offset per channel
+ */
+void SimTCS3430::setDarkOffset(const sim_light_t& counts) {
+  _offset = counts;
+}
+
+/*!
+ *    @brief  NACK the next read transactions that start at a register,
+ *            as a glitch on the bus would. The register pointer is left
+ *            where it was and nothing is cleared.
+ *    @param  reg Register address the failing reads start at
+ *    @param  count Number of reads to fail
+ */
+void SimTCS3430::failReads(uint8_t reg, uint8_t count) {
+  _fail_reg = reg;
+  _fail_count = count;
+}
+
+/*!
+ *    @brief  NACK the next write transactions that carry data to a
+ *            register. Nothing is written; setting the register pointer
+ *            for a read still works.
+ *    @param  reg Register address the failing writes start at
+ *    @param  count Number of writes to fail
+ */
+void SimTCS3430::failWrites(uint8_t reg, uint8_t count) {
+  _fail_write_reg = reg;
+  _fail_write_count = count;
+}
+
+/*!
+ *    @brief  Look at a register without a bus transaction or side effects
+ *    @param  reg Register address
+ *    @return Register value
+ */
+uint8_t SimTCS3430::peek(uint8_t reg) const {
+  return _regs[reg];
+}
+
+/*!
+ *    @brief  Current state machine phase
+ *    @return Phase
+ */
+sim_tcs3430_phase_t SimTCS3430::phase() const {
+  return _phase;
+}
+
+/*!
+ *    @brief  Number of integrations completed since reset
+ *    @return Count
+ */
+uint32_t SimTCS3430::completedCycles() const {
+  return _cycles;
+}
+
+/*!
+ *    @brief  When the most recent integration completed
+ *    @return Virtual time in microseconds
+ */
+uint64_t SimTCS3430::lastCycleEnd() const {
+  return _last_cycle_end;
+}
+
+/*!
+ *    @brief  Number of bus writes that targeted a register
+ *    @param  reg Register address
+ *    @return Count since reset
+ */
+uint32_t SimTCS3430::registerWrites(uint8_t reg) const {
+  return _writes[reg];
+}
+
+/*!
+ *    @brief  When a register was last written, to check the order of
+ *            writes: each register write (a burst writes several) is
+ *            numbered from 1 since reset
+ *    @param  reg Register address
+ *    @return Number of the last write to it, 0 if never written
+ */
+uint32_t SimTCS3430::lastWriteOrder(uint8_t reg) const {
+  return _write_order[reg];
+}
+
+/*!
+ *    @brief  Write transaction: a register address, then data written
+ *            with auto-increment
+ *    @param  data Bytes after the address byte
+ *    @param  len Number of bytes
+ *    @return false if failWrites() asked for this one to fail
+ */
+bool SimTCS3430::i2cWrite(const uint8_t* data, uint32_t len) {
+  if (len == 0) {
+    return true;
+  }
+  if (len > 1 && _fail_write_count && data[0] == _fail_write_reg) {
+    _fail_write_count--;
+    return false;
+  }
+  _ptr = data[0];
+  for (uint32_t i = 1; i < len; i++) {
+    writeRegister(_ptr++, data[i]);
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Read transaction from the current register pointer, with
+ *            auto-increment. With INT_READ_CLEAR set, a read that covers
+ *            STATUS clears it afterwards.
+ *    @param  data Destination
+ *    @param  len Number of bytes
+ *    @return false if failReads() asked for this one to fail
+ */
+bool SimTCS3430::i2cRead(uint8_t* data, uint32_t len) {
+  if (_fail_count && _ptr == _fail_reg) {
+    _fail_count--;
+    return false;
+  }
+  bool saw_status = false;
+  for (uint32_t i = 0; i < len; i++) {
+    if (_ptr == TCS3430_REG_STATUS) {
+      saw_status = true;
+    }
+    data[i] = _regs[_ptr++];
+  }
+  if (saw_status && (_regs[TCS3430_REG_CFG3] & 0x80)) {
+    _regs[TCS3430_REG_STATUS] = 0;
+    statusChanged();
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Run the state machine up to the given time
+ *    @param  now Virtual time in microseconds
+ */
+void SimTCS3430::advance(uint64_t now) {
+  while (_phase_end <= now) {
+    uint64_t at = _phase_end;
+    switch (_phase) {
+      case SIMTCS3430_AUTOZERO:
+        startIntegration(at);
+        break;
+      case SIMTCS3430_INTEGRATING:
+        integrate(at);
+        finishIntegration();
+        break;
+      case SIMTCS3430_WAITING:
+        startCycle(at);
+        break;
+      default:
+        _phase_end = SIMHOST_NEVER;
+        break;
+    }
+  }
+  if (_phase == SIMTCS3430_INTEGRATING) {
+    integrate(now);
+  }
+  _last = now;
+}
+
+/*!
+ *    @brief  When the current phase ends
+ *    @return Virtual time in microseconds, or SIMHOST_NEVER
+ */
+uint64_t SimTCS3430::nextEvent() const {
+  return _phase_end;
+}
+
+/*!
+ *    @brief  Apply one register write
+ *    @param  reg Register address
+ *    @param  value Value written
+ */
+void SimTCS3430::writeRegister(uint8_t reg, uint8_t value) {
+  _writes[reg]++;
+  _write_order[reg] = ++_write_count;
+  switch (reg) {
+    case TCS3430_REG_ENABLE:
+      _regs[reg] = value & 0x0B;
+      enableChanged();
+      break;
+    case TCS3430_REG_STATUS:
+      _regs[reg] &= ~value;
+      statusChanged();
+      break;
+    case TCS3430_REG_INTENAB:
+      _regs[reg] = value;
+      statusChanged();
+      break;
+    case TCS3430_REG_ATIME:
+    case TCS3430_REG_WTIME:
+    case TCS3430_REG_AILTL:
+    case TCS3430_REG_AILTH:
+    case TCS3430_REG_AIHTL:
+    case TCS3430_REG_AIHTH:
+    case TCS3430_REG_PERS:
+    case TCS3430_REG_CFG0:
+    case TCS3430_REG_CFG1:
+    case TCS3430_REG_CFG2:
+    case TCS3430_REG_CFG3:
+    case TCS3430_REG_AZ_CONFIG:
+      _regs[reg] = value;
+      break;
+    default:
+      // Read-only and reserved addresses ignore writes
+      break;
+  }
+}
+
+/*!
+ *    @brief  React to PON/AEN changes. Powering down clears the data
+ *            registers; enabling ALS starts a fresh cycle and resets the
+ *            persistence filter.
+ */
+void SimTCS3430::enableChanged() {
+  uint8_t enable = _regs[TCS3430_REG_ENABLE];
+  uint64_t now = SimHost::instance().now();
+  if (!(enable & 0x01)) {
+    if (_phase != SIMTCS3430_OFF) {
+      memset(&_regs[TCS3430_REG_CH0DATAL], 0, 8);
+    }
+    _phase = SIMTCS3430_OFF;
+    _phase_end = SIMHOST_NEVER;
+    return;
+  }
+  if (!(enable & 0x02)) {
+    _phase = SIMTCS3430_IDLE;
+    _phase_end = SIMHOST_NEVER;
+    return;
+  }
+  if (_phase == SIMTCS3430_OFF || _phase == SIMTCS3430_IDLE) {
+    _pers_count = 0;
+    _az_count = 0;
+    startCycle(now);
+  }
+}
+
+/*!
+ *    @brief  Begin a measurement cycle, with an auto-zero pass first when
+ *            AZ_NTH_ITERATION calls for one
+ *    @param  at Virtual time the cycle starts
+ */
+void SimTCS3430::startCycle(uint64_t at) {
+  uint8_t nth = _regs[TCS3430_REG_AZ_CONFIG] & 0x7F;
+  bool autozero = false;
+  if (nth == 0x7F) {
+    autozero = (_az_count == 0);
+  } else if (nth != 0) {
+    autozero = (_az_count % nth) == 0;
+  }
+  _az_count++;
+  if (autozero) {
+    _phase = SIMTCS3430_AUTOZERO;
+    _phase_end = at + stepsToMicros(SIMTCS3430_AZ_STEPS);
+    return;
+  }
+  startIntegration(at);
+}
+
+/*!
+ *    @brief  Latch ATIME and start collecting light
+ *    @param  at Virtual time the integration starts
+ */
+void SimTCS3430::startIntegration(uint64_t at) {
+  _steps = (uint16_t)_regs[TCS3430_REG_ATIME] + 1;
+  memset(_acc, 0, sizeof(_acc));
+  _last = at;
+  _phase = SIMTCS3430_INTEGRATING;
+  _phase_end = at + stepsToMicros(_steps);
+}
+
+/*!
+ *    @brief  Analog gain selected right now by AGAIN and HGAIN
+ *    @return Multiplier
+ */
+float SimTCS3430::gain() const {
+  uint8_t again = _regs[TCS3430_REG_CFG1] & 0x03;
+  if (again == 3 && (_regs[TCS3430_REG_CFG2] & 0x10)) {
+    return SIMTCS3430_HGAIN_MULT;
+  }
+  return again_mult[again];
+}
+
+/*!
+ *    @brief  Accumulate light from the last update up to a time. Gain and
+ *            AMUX act on the analog path, so a change part way through an
+ *            integration produces a blend of the old and new settings.
+ *    @param  until Virtual time in microseconds
+ */
+void SimTCS3430::integrate(uint64_t until) {
+  if (until <= _last) {
+    return;
+  }
+  sim_light_t light = SimHost::instance().light();
+  double steps = (double)(until - _last) / _step_us * _scale * gain();
+  bool ir2 = (_regs[TCS3430_REG_CFG1] & 0x08) != 0;
+  _acc[0] += light.z * steps;
+  _acc[1] += light.y * steps;
+  _acc[2] += light.ir1 * steps;
+  _acc[3] += (ir2 ? light.ir2 : light.x) * steps;
+  _last = until;
+}
+
+/*!
+ *    @brief  End of integration: convert, update STATUS and the
+ *            persistence filter, then move on to wait, sleep or the next
+ *            integration
+ */
+void SimTCS3430::finishIntegration() {
+  uint64_t at = _phase_end;
+  uint32_t full = (uint32_t)_steps * 1024 - 1;
+  if (full > 65535) {
+    full = 65535;
+  }
+
+  float g = gain();
+  bool ir2 = (_regs[TCS3430_REG_CFG1] & 0x08) != 0;
+  uint32_t counts[4];
+  counts[0] = convert(_acc[0] + _offset.z * g);
+  counts[1] = convert(_acc[1] + _offset.y * g);
+  counts[2] = convert(_acc[2] + _offset.ir1 * g);
+  counts[3] = convert(_acc[3] + (ir2 ? _offset.ir2 : _offset.x) * g);
+  bool saturated = false;
+  for (uint8_t i = 0; i < 4; i++) {
+    if (counts[i] >= full) {
+      counts[i] = full;
+      saturated = true;
+    }
+    _regs[TCS3430_REG_CH0DATAL + 2 * i] = counts[i] & 0xFF;
+    _regs[TCS3430_REG_CH0DATAH + 2 * i] = counts[i] >> 8;
+  }
+  if (saturated) {
+    _regs[TCS3430_REG_STATUS] |= TCS3430_STATUS_ASAT;
+  }
+
+  uint8_t pers = _regs[TCS3430_REG_PERS] & 0x0F;
+  uint16_t low = _regs[TCS3430_REG_AILTL] | (_regs[TCS3430_REG_AILTH] << 8);
+  uint16_t high = _regs[TCS3430_REG_AIHTL] | (_regs[TCS3430_REG_AIHTH] << 8);
+  if (counts[0] < low || counts[0] > high) {
+    if (_pers_count < 0xFF) {
+      _pers_count++;
+    }
+  } else {
+    _pers_count = 0;
+  }
+  uint8_t needed = (pers <= 3) ? pers : (pers - 3) * 5;
+  if (pers == 0 || _pers_count >= needed) {
+    _regs[TCS3430_REG_STATUS] |= TCS3430_STATUS_AINT;
+  }
+
+  _cycles++;
+  _last_cycle_end = at;
+  statusChanged();
+
+  if ((_regs[TCS3430_REG_CFG3] & 0x10) && interruptAsserted()) {
+    _phase = SIMTCS3430_SLEEPING;
+    _phase_end = SIMHOST_NEVER;
+  } else if (_regs[TCS3430_REG_ENABLE] & 0x08) {
+    uint32_t steps = (uint32_t)_regs[TCS3430_REG_WTIME] + 1;
+    if (_regs[TCS3430_REG_CFG0] & 0x04) {
+      steps *= 12;
+    }
+    _phase = SIMTCS3430_WAITING;
+    _phase_end = at + stepsToMicros(steps);
+  } else {
+    startCycle(at);
+  }
+}
+
+/*!
+ *    @brief  Turn an accumulated signal into ADC counts
+ *    @param  signal Signal in counts, gain already applied
+ *    @return Counts before full-scale clipping
+ */
+uint16_t SimTCS3430::convert(double signal) {
+  double value = signal + noise();
+  if (value <= 0) {
+    return 0;
+  }
+  if (value >= 65535) {
+    return 65535;
+  }
+  return (uint16_t)lround(value);
+}
+
+/*!
+ *    @brief  Whether the INT output is active
+ *    @return true if an enabled STATUS flag is set
+ */
+bool SimTCS3430::interruptAsserted() const {
+  uint8_t status = _regs[TCS3430_REG_STATUS];
+  uint8_t intenab = _regs[TCS3430_REG_INTENAB];
+  return ((status & TCS3430_STATUS_AINT) && (intenab & 0x10)) ||
+         ((status & TCS3430_STATUS_ASAT) && (intenab & 0x80));
+}
+
+/*!
+ *    @brief  Update the INT pin after STATUS or INTENAB changed, and wake
+ *            from SAI sleep once the interrupt is gone
+ */
+void SimTCS3430::statusChanged() {
+  bool asserted = interruptAsserted();
+  if (_int_pin != SIMTCS3430_NO_PIN) {
+    SimHost::instance().drivePin(_int_pin, asserted);
+  }
+  if (_phase == SIMTCS3430_SLEEPING && !asserted) {
+    startCycle(SimHost::instance().now());
+  }
+}
+
+/*!
+ *    @brief  Length of a number of steps on this sensor's oscillator
+ *    @param  steps Number of 2.78 ms steps
+ *    @return Microseconds
+ */
+uint64_t SimTCS3430::stepsToMicros(uint32_t steps) const {
+  return (uint64_t)llround(steps * _step_us);
+}
+
+/*!
+ *    @brief  One sample of read noise (xorshift32 + Box-Muller)
+ *    @return Noise in counts
+ */
+float SimTCS3430::noise() {
+  if (_noise_rms <= 0.0f) {
+    return 0.0f;
+  }
+  double u[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    u[i] = (_rng + 1.0) / 4294967297.0;
+  }
+  return _noise_rms * sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
@@ -0,0 +1,113 @@
+/*!
+ *  @file SimTCS3430.h
+ *
+ * 	Register-level model of the TCS3430 following the DESIGN.md register
+ * 	map: ATIME/WTIME/WLONG cycle timing on the virtual clock, ATIME latched
+ * 	per integration while AGAIN/HGAIN and AMUX act immediately, STATUS
+ * 	write-1-to-clear and INT_READ_CLEAR, threshold persistence, SAI,
+ * 	saturation and the (inverted, active-high) INT pin of the breakout.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_SIMTCS3430_H
+#define _ADAFRUIT_TCS3430_SIMTCS3430_H
+
+#include "SimHost.h"
+
+#define SIMTCS3430_STEP_US 2780.0 ///< Nominal integration/wait step
+#define SIMTCS3430_AZ_STEPS 5     ///< Extra steps an auto-zero pass takes
+#define SIMTCS3430_NO_PIN 0xFF    ///< INT not wired
+
+/*!
+ *    @brief  Where the model is in its measurement cycle
+ */
+typedef enum {
+  SIMTCS3430_OFF,         ///< PON clear
+  SIMTCS3430_IDLE,        ///< Powered, AEN clear
+  SIMTCS3430_AUTOZERO,    ///< Auto-zero pass before an integration
+  SIMTCS3430_INTEGRATING, ///< Collecting light
+  SIMTCS3430_WAITING,     ///< WTIME gap between integrations
+  SIMTCS3430_SLEEPING     ///< Stopped by SAI until the interrupt clears
+} sim_tcs3430_phase_t;
+
+/*!
+ *    @brief  Simulated TCS3430
+ */
+class SimTCS3430 : public SimI2CTarget {
+ public:
+  SimTCS3430();
+
+  void reset();
+  void connectInterrupt(uint8_t pin);
+  void setLightScale(float scale);
+  void setNoise(float rms_counts, uint32_t seed = 1);
+  void setClockSkew(int32_t ppm);
+  void setDarkOffset(const sim_light_t& counts);
+  void failReads(uint8_t reg, uint8_t count = 1);
+  void failWrites(uint8_t reg, uint8_t count = 1);
+
+  uint8_t peek(uint8_t reg) const;
+  sim_tcs3430_phase_t phase() const;
+  uint32_t completedCycles() const;
+  uint64_t lastCycleEnd() const;
+  uint32_t registerWrites(uint8_t reg) const;
+  uint32_t lastWriteOrder(uint8_t reg) const;
+
+  bool i2cWrite(const uint8_t* data, uint32_t len);
+  bool i2cRead(uint8_t* data, uint32_t len);
+  void advance(uint64_t now);
+  uint64_t nextEvent() const;
+
+ private:
+  void writeRegister(uint8_t reg, uint8_t value);
+  void enableChanged();
+  void startCycle(uint64_t at);
+  void startIntegration(uint64_t at);
+  void finishIntegration();
+  void integrate(uint64_t until);
+  float gain() const;
+  uint16_t convert(double signal);
+  bool interruptAsserted() const;
+  void statusChanged();
+  uint64_t stepsToMicros(uint32_t steps) const;
+  float noise();
+
+  uint8_t _regs[256];
+  uint32_t _writes[256];
+  uint32_t _write_order[256]; ///< _write_count when each was last written
+  uint32_t _write_count;      ///< Register writes since reset
+  uint8_t _ptr;
+  sim_tcs3430_phase_t _phase;
+  uint64_t _phase_end;
+  uint64_t _last;
+  uint64_t _last_cycle_end;
+  uint32_t _cycles;
+  uint32_t _az_count;
+  uint8_t _pers_count;
+  uint8_t _int_pin;
+
+  uint16_t _steps; ///< ATIME+1, latched at integration start
+  double _acc[4];  ///< Signal so far on CH0..CH3
+
+  uint8_t _fail_reg;         ///< Register failing reads start at
+  uint8_t _fail_count;       ///< Reads still to fail
+  uint8_t _fail_write_reg;   ///< Register failing writes start at
+  uint8_t _fail_write_count; ///< Writes still to fail
+
+  float _scale;
+  float _noise_rms;
+  uint32_t _rng;
+  double _step_us;
+  sim_light_t _offset;
+};
+
+#endif
@@ -0,0 +1,189 @@
+/*!
+ *  @file autorange_test.cpp
+ *
+ * 	Auto-range convergence on the simulated sensor. Frames are read once
+ * 	per ALS cycle regardless of settling, the way the capture ring
+ * 	delivers them, so the controller has to skip stale data itself,
+ * 	including the long integration still running when ATIME steps down.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_AutoRange.h"
+#include "host_test.h"
+
+#define FEED_MS 2000 ///< Time each scenario runs for
+
+static Adafruit_TCS3430 tcs;
+
+/** What one scenario ended with */
+typedef struct {
+  tcs3430_agc_t last; ///< Result for the last valid frame
+  uint8_t limited;    ///< LIMITED results seen
+  uint16_t skipped;   ///< Frames skipped while settling
+  uint8_t flags;      ///< Flags of the last frame
+  uint16_t peak;      ///< Largest channel of the last frame
+} agc_run_t;
+
+/*!
+ *    @brief  Feed the controller one frame per cycle for FEED_MS
+ *    @param  agc Controller, already begun
+ *    @param  run Filled in with the outcome
+ */
+static void feed(Adafruit_TCS3430_AutoRange* agc, agc_run_t* run) {
+  memset(run, 0, sizeof(*run));
+  uint32_t start = millis();
+  while (millis() - start < FEED_MS) {
+    delayMicroseconds(tcs.getCycleMicros());
+    tcs3430_frame_t frame;
+    CHECK(tcs.readFrame(&frame));
+    tcs3430_agc_t result = agc->update(&frame);
+    if (result == TCS3430_AGC_SKIPPED) {
+      run->skipped++;
+      continue;
+    }
+    if (result == TCS3430_AGC_LIMITED) {
+      run->limited++;
+    }
+    run->last = result;
+    run->flags = frame.flags;
+    // The controller ranges on the largest channel
+    run->peak = frame.z;
+    uint16_t others[3] = {frame.y, frame.ir1, frame.ch3};
+    for (uint8_t i = 0; i < 3; i++) {
+      if (others[i] > run->peak) {
+        run->peak = others[i];
+      }
+    }
+  }
+}
+
+/*!
+ *    @brief  Start from a given setting and check the controller reaches
+ *            the band, within max_cycles frames, and stays there
+ *    @param  counts Light in counts per step at 1x
+ *    @param  gain Starting gain
+ *    @param  atime Starting ATIME
+ *    @param  max_cycles Frames convergence may take
+ */
+static void converges(float counts, tcs3430_gain_t gain, uint8_t atime,
+                      uint8_t max_cycles) {
+  hostTestLight(counts);
+  CHECK(tcs.setALSGain(gain));
+  CHECK(tcs.setIntegrationCycles(atime));
+  CHECK(tcs.clearALSSaturated());
+
+  Adafruit_TCS3430_AutoRange agc(&tcs);
+  CHECK(agc.begin());
+  agc_run_t run;
+  feed(&agc, &run);
+
+  uint32_t full = Adafruit_TCS3430::fullScale(agc.getATIME());
+  printf("  %7.1f from %ux/%3u: %ux/%2u peak=%5u (%2u%%) in %u, %u skipped\n",
+         counts, Adafruit_TCS3430::gainMultiplier(gain), atime,
+         Adafruit_TCS3430::gainMultiplier(agc.getGain()), agc.getATIME(),
+         run.peak, (unsigned)(run.peak * 100UL / full),
+         agc.getConvergenceCycles(), run.skipped);
+  CHECK(agc.isConverged());
+  CHECK(run.last == TCS3430_AGC_SETTLED);
+  CHECK(run.limited == 0);
+  CHECK(!(run.flags & TCS3430_FRAME_SATURATED));
+  CHECK(run.peak * 100UL >= full * 20 && run.peak * 100UL <= full * 80);
+  CHECK(agc.getConvergenceCycles() >= 1);
+  CHECK(agc.getConvergenceCycles() <= max_cycles);
+}
+
+/*!
+ *    @brief  Step ATIME down from a long integration and check the first
+ *            frame accepted afterwards was integrated at the new setting,
+ *            not the long integration still running at the change
+ *    @param  counts Light in counts per step at 1x, over the band at 1x/255
+ */
+static void stepsDown(float counts) {
+  hostTestLight(counts);
+  CHECK(tcs.setALSGain(TCS3430_GAIN_1X));
+  CHECK(tcs.setIntegrationCycles(255));
+  delay(2000);
+
+  Adafruit_TCS3430_AutoRange agc(&tcs);
+  CHECK(agc.begin(255));
+  bool adjusted = false;
+  uint16_t skipped = 0;
+  uint32_t start = millis();
+  while (millis() - start < FEED_MS) {
+    // Polled far faster than the cycle, so a stale frame would be seen
+    delay(5);
+    tcs3430_frame_t frame;
+    CHECK(tcs.readFrame(&frame));
+    uint8_t atime = agc.getATIME();
+    tcs3430_gain_t gain = agc.getGain();
+    tcs3430_agc_t result = agc.update(&frame);
+    if (result == TCS3430_AGC_SKIPPED) {
+      skipped += adjusted;
+      continue;
+    }
+    if (!adjusted) {
+      CHECK(result == TCS3430_AGC_ADJUSTED);
+      CHECK(agc.getATIME() < 255);
+      adjusted = true;
+      continue;
+    }
+    // Dark offset 5.5 on Y, scaled by gain like the light
+    uint8_t mult = Adafruit_TCS3430::gainMultiplier(gain);
+    uint16_t expected = (counts * (atime + 1) + 5.5f) * mult + 0.5f;
+    printf("  %7.1f from 1x/255: %ux/%3u Y=%5u (expected %u), %u skipped\n",
+           counts, mult, atime, frame.y, expected, skipped);
+    CHECK(frame.y + 1 >= expected && frame.y <= expected + 1);
+    CHECK(result == TCS3430_AGC_SETTLED);
+    break;
+  }
+  CHECK(adjusted);
+  CHECK(skipped > 0);
+}
+
+int main() {
+  hostTestSensor();
+  CHECK(tcs.begin());
+
+  // One jump from an unsaturated reading: the frame that triggers it and
+  // the one that lands in band
+  converges(3, TCS3430_GAIN_1X, 0, 2);
+  converges(20, TCS3430_GAIN_1X, 0, 2);
+  converges(200, TCS3430_GAIN_1X, 0, 2);
+  converges(3, TCS3430_GAIN_1X, 63, 2);
+  converges(200, TCS3430_GAIN_4X, 3, 2);
+  converges(600, TCS3430_GAIN_1X, 3, 2);
+  // 1x/63 would stay under the band here; 4x/39 lands in it
+  converges(200, TCS3430_GAIN_1X, 63, 2);
+
+  // Starting saturated, the first jump has to guess; one more to land
+  converges(200, TCS3430_GAIN_16X, 63, 3);
+  converges(600, TCS3430_GAIN_128X, 63, 3);
+  converges(20, TCS3430_GAIN_128X, 63, 3);
+
+  // Stepping down from a long integration: the one running at the
+  // change is not taken as the first sample at the new setting
+  stepsDown(220);
+
+  // Too dark for the range: LIMITED at the most sensitive setting
+  hostTestLight(0.2f);
+  CHECK(tcs.setALSGain(TCS3430_GAIN_1X));
+  CHECK(tcs.setIntegrationCycles(0));
+  Adafruit_TCS3430_AutoRange dark(&tcs);
+  CHECK(dark.begin());
+  agc_run_t run;
+  feed(&dark, &run);
+  CHECK(run.last == TCS3430_AGC_LIMITED);
+  CHECK(dark.getGain() == TCS3430_GAIN_128X);
+  CHECK(dark.getATIME() == 63);
+
+  return hostTestResult("autorange_test");
+}
@@ -0,0 +1,112 @@
+/*!
+ *  @file cache_test.cpp
+ *
+ * 	Shadow register cache on the simulated sensor: with the cache on,
+ * 	getters make no bus traffic and setters are a single write; a failed
+ * 	write drops the register from the cache so the next getter reads the
+ * 	chip; resync() picks up a change made behind the driver's back; and
+ * 	turning the cache off goes back to the bus.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Wire.h"
+#include "host_test.h"
+
+static Adafruit_TCS3430 tcs;   ///< Driver under test
+static Adafruit_TCS3430 other; ///< Another bus master, without the cache
+
+/*!
+ *    @brief  Read the gain and count the bus transactions it took
+ *    @param  gain Set to the gain read
+ *    @return Number of transactions
+ */
+static uint32_t gainReads(tcs3430_gain_t* gain) {
+  uint32_t before = Wire.transactions();
+  *gain = tcs.getALSGain();
+  return Wire.transactions() - before;
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  hostTestLight(4.3f);
+  CHECK(tcs.begin());
+  CHECK(other.begin());
+  CHECK(!tcs.isRegisterCacheEnabled());
+
+  // Without the cache every getter goes to the chip
+  tcs3430_gain_t gain;
+  CHECK(gainReads(&gain) > 0);
+  CHECK(gain == TCS3430_GAIN_1X);
+
+  // With it, getters are hits: no transactions at all
+  tcs.enableRegisterCache(true);
+  CHECK(tcs.isRegisterCacheEnabled());
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_1X);
+  uint32_t before = Wire.transactions();
+  CHECK(tcs.getIntegrationCycles() == other.getIntegrationCycles());
+  CHECK(!tcs.isWaitEnabled());
+  CHECK(Wire.transactions() == before + 2); // other's ATIME read
+
+  // A setter is one write to CFG1; HGAIN is already right, so CFG2 is
+  // left alone
+  uint32_t cfg1 = sensor->registerWrites(TCS3430_REG_CFG1);
+  uint32_t cfg2 = sensor->registerWrites(TCS3430_REG_CFG2);
+  before = Wire.transactions();
+  CHECK(tcs.setALSGain(TCS3430_GAIN_16X));
+  CHECK(Wire.transactions() == before + 1);
+  CHECK(sensor->registerWrites(TCS3430_REG_CFG1) == cfg1 + 1);
+  CHECK(sensor->registerWrites(TCS3430_REG_CFG2) == cfg2);
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_16X);
+  CHECK(other.getALSGain() == TCS3430_GAIN_16X);
+
+  // 128x needs HGAIN, so CFG2 is written too
+  CHECK(tcs.setALSGain(TCS3430_GAIN_128X));
+  CHECK(sensor->registerWrites(TCS3430_REG_CFG2) == cfg2 + 1);
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_128X);
+  CHECK(tcs.setALSGain(TCS3430_GAIN_16X));
+  CHECK(other.getALSGain() == TCS3430_GAIN_16X);
+
+  // A failed write leaves CFG1 unknown: the next getter is a miss and
+  // reads what the chip really holds (one register read: the address,
+  // then the data), then hits again
+  sensor->failWrites(TCS3430_REG_CFG1);
+  CHECK(!tcs.setALSGain(TCS3430_GAIN_64X));
+  CHECK(gainReads(&gain) == 2);
+  CHECK(gain == TCS3430_GAIN_16X);
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_16X);
+
+  // A change behind the driver's back is not seen until resync()
+  CHECK(other.setALSGain(TCS3430_GAIN_4X));
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_16X);
+  CHECK(tcs.resync());
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_4X);
+
+  // begin() reloads the cache too
+  CHECK(other.setALSGain(TCS3430_GAIN_64X));
+  CHECK(tcs.begin());
+  CHECK(gainReads(&gain) == 0);
+  CHECK(gain == TCS3430_GAIN_64X);
+
+  // Off again, the chip is read every time
+  tcs.enableRegisterCache(false);
+  CHECK(!tcs.resync());
+  CHECK(other.setALSGain(TCS3430_GAIN_1X));
+  CHECK(gainReads(&gain) > 0);
+  CHECK(gain == TCS3430_GAIN_1X);
+  return hostTestResult("cache_test");
+}
@@ -0,0 +1,166 @@
+/*!
+ *  @file calibration_test.cpp
+ *
+ * 	Color matrix fitting and storage: a fit over patches generated from a
+ * 	known matrix must recover it, noisy references must show up in the
+ * 	RMS error, degenerate sample sets must be refused, and a saved blob
+ * 	must load back bit for bit and reject corruption.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <math.h>
+
+#include "Adafruit_TCS3430_Calibration.h"
+#include "host_test.h"
+
+#define PATCHES 24 ///< Patches per fit, like a ColorChecker
+
+/** The matrix the synthetic references are made with */
+static const float kTruth[3][4] = {{0.39f, -0.05f, 0.12f, -0.04f},
+                                   {0.15f, 0.45f, -0.02f, -0.03f},
+                                   {-0.01f, 0.02f, 0.55f, -0.06f}};
+
+static uint32_t rng = 1; ///< Patch generator state
+
+/*!
+ *    @brief  Next pseudo-random number
+ *    @param  limit Exclusive upper bound
+ *    @return 0 to limit - 1
+ */
+static uint32_t next(uint32_t limit) {
+  rng = rng * 1664525 + 1013904223;
+  return (rng >> 8) % limit;
+}
+
+/*!
+ *    @brief  Add PATCHES samples of random raw counts with references made
+ *            by a matrix
+ *    @param  cal Calibration to add to
+ *    @param  m Matrix, row major
+ *    @param  noise Uniform error added to each reference, +/-
+ */
+static void addPatches(Adafruit_TCS3430_Calibration* cal, const float* m,
+                       float noise) {
+  for (uint8_t i = 0; i < PATCHES; i++) {
+    // Bright and dim patches, and every channel well away from the others
+    uint16_t raw[4];
+    for (uint8_t c = 0; c < 4; c++) {
+      raw[c] = 200 + next(60000);
+    }
+    float out[3];
+    for (uint8_t o = 0; o < 3; o++) {
+      out[o] = 0;
+      for (uint8_t c = 0; c < 4; c++) {
+        out[o] += m[o * 4 + c] * raw[c];
+      }
+      out[o] += noise * ((int32_t)next(2001) - 1000) / 1000;
+    }
+    tcs3430_xyz_t reference = {out[0], out[1], out[2]};
+    cal->addSample(raw[0], raw[1], raw[2], raw[3], &reference);
+  }
+}
+
+/*!
+ *    @brief  Check a matrix against kTruth
+ *    @param  matrix Fitted matrix
+ *    @param  tolerance Largest error allowed per coefficient
+ */
+static void checkMatrix(const tcs3430_matrix_t* matrix, float tolerance) {
+  float worst = 0;
+  for (uint8_t i = 0; i < 12; i++) {
+    float error = fabsf(matrix->m[i] - kTruth[i / 4][i % 4]);
+    if (error > worst) {
+      worst = error;
+    }
+    CHECK(matrix->q14[i] == (int16_t)lroundf(matrix->m[i] * 16384));
+  }
+  printf("  worst coefficient error %.2e\n", worst);
+  CHECK(worst <= tolerance);
+}
+
+int main() {
+  Adafruit_TCS3430_Calibration cal;
+  tcs3430_matrix_t matrix;
+
+  // Exact references: the fit reproduces the matrix in single precision
+  addPatches(&cal, kTruth[0], 0);
+  CHECK(cal.getSampleCount() == PATCHES);
+  CHECK(cal.fit(&matrix) == TCS3430_CAL_OK);
+  checkMatrix(&matrix, 1e-4f);
+  CHECK(cal.getRMSError() < 1.0f);
+
+  // Noisy references: still close, and the error is reported
+  cal.reset();
+  addPatches(&cal, kTruth[0], 50);
+  CHECK(cal.fit(&matrix) == TCS3430_CAL_OK);
+  checkMatrix(&matrix, 2e-3f);
+  printf("  RMS error %.1f for +/-50 noise\n", cal.getRMSError());
+  CHECK(cal.getRMSError() > 10 && cal.getRMSError() < 50);
+
+  // Too few samples, and samples that cannot separate the channels
+  tcs3430_matrix_t untouched = matrix;
+  cal.reset();
+  tcs3430_xyz_t reference = {100, 100, 100};
+  for (uint8_t i = 1; i <= 3; i++) {
+    cal.addSample(i * 100, i * 100, i * 100, i * 10, &reference);
+  }
+  CHECK(cal.fit(&matrix) == TCS3430_CAL_TOO_FEW);
+  for (uint8_t i = 4; i <= 10; i++) {
+    cal.addSample(i * 100, i * 100, i * 100, i * 10, &reference);
+  }
+  CHECK(cal.fit(&matrix) == TCS3430_CAL_SINGULAR);
+  CHECK(memcmp(&matrix, &untouched, sizeof(matrix)) == 0);
+
+  // A gain the Q14 format cannot hold
+  float big[12];
+  for (uint8_t i = 0; i < 12; i++) {
+    big[i] = kTruth[i / 4][i % 4] * 8;
+  }
+  cal.reset();
+  addPatches(&cal, big, 0);
+  CHECK(cal.fit(&matrix) == TCS3430_CAL_RANGE);
+
+  // Blob round trip
+  tcs3430_cal_blob_t blob;
+  Adafruit_TCS3430_Calibration::save(&untouched, &blob);
+  tcs3430_matrix_t loaded;
+  CHECK(Adafruit_TCS3430_Calibration::load(&blob, &loaded));
+  CHECK(memcmp(loaded.q14, untouched.q14, sizeof(loaded.q14)) == 0);
+  for (uint8_t i = 0; i < 12; i++) {
+    CHECK(fabsf(loaded.m[i] - untouched.m[i]) <= 1.0f / 32768);
+  }
+
+  // Every single-bit error, a blank EEPROM and a newer version are refused
+  tcs3430_matrix_t before = loaded;
+  uint8_t* bytes = (uint8_t*)&blob;
+  uint16_t accepted = 0;
+  for (uint8_t i = 0; i < sizeof(blob); i++) {
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      bytes[i] ^= 1 << bit;
+      accepted += Adafruit_TCS3430_Calibration::load(&blob, &loaded);
+      bytes[i] ^= 1 << bit;
+    }
+  }
+  CHECK(accepted == 0);
+  tcs3430_cal_blob_t blank;
+  memset(&blank, 0xFF, sizeof(blank));
+  CHECK(!Adafruit_TCS3430_Calibration::load(&blank, &loaded));
+  blob.version = TCS3430_CAL_VERSION + 1;
+  for (uint16_t check = 0; check <= 0xFF; check++) {
+    blob.check = check;
+    accepted += Adafruit_TCS3430_Calibration::load(&blob, &loaded);
+  }
+  CHECK(accepted == 0);
+  CHECK(memcmp(&loaded, &before, sizeof(loaded)) == 0);
+
+  return hostTestResult("calibration_test");
+}
@@ -0,0 +1,165 @@
+/*!
+ *  @file color_test.cpp
+ *
+ * 	Fixed-point colour conversions against a double-precision reference:
+ * 	over a sweep of random channel sets with positive XYZ, the Q4 XYZ,
+ * 	Q15 CIE x,y, McCamy CCT and Q8 lux must stay within the bounds stated
+ * 	in Adafruit_TCS3430_Color.h.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Color.h"
+#include "host_test.h"
+
+#include <math.h>
+
+#define SETS 1000000   ///< Random channel sets tried
+#define LUX_MAX 16.7e6 ///< Top of Q8 lux in 32 bits
+
+/** The default matrix, in double */
+#define TCS3430_CM_DOUBLE(v) (v),
+static const double matrix[12] = {TCS3430_DEFAULT_MATRIX(TCS3430_CM_DOUBLE)};
+
+/** Worst errors seen in one signal regime, and the bounds for it */
+typedef struct {
+  const char* name;  ///< Regime, for the report
+  double min_sum;    ///< Smallest X+Y+Z in the regime
+  double cie_bound;  ///< Allowed CIE x,y error
+  double cct_bound;  ///< Allowed CCT error, kelvin
+  double lux_bound;  ///< Allowed lux error, relative
+  double cie;        ///< Worst CIE x,y error seen
+  double cct;        ///< Worst CCT error seen
+  double lux;        ///< Worst relative lux error seen
+  uint32_t sets;     ///< Channel sets in the regime
+  uint32_t cct_sets; ///< Of those, with a CCT in 2000-12000 K
+} regime_t;
+
+static regime_t regimes[2] = {
+    {">= 1000", 1000, 0.0015, 20, 0.005, 0, 0, 0, 0, 0},
+    {">= 10000", 10000, 0.00015, 7, 0.0008, 0, 0, 0, 0, 0},
+};
+
+static const tcs3430_gain_t gains[4] = {TCS3430_GAIN_1X, TCS3430_GAIN_4X,
+                                        TCS3430_GAIN_16X, TCS3430_GAIN_64X};
+
+static uint32_t seed = 12345; ///< xorshift state, fixed for repeatable runs
+
+/*!
+ *    @brief  Next pseudo-random number
+ *    @return 32 random bits
+ */
+static uint32_t nextRandom() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+/*!
+ *    @brief  Random count, spread over every signal level up to full scale
+ *    @param  top Largest count for this set
+ *    @return Count in 0..top
+ */
+static uint16_t randomCount(uint32_t top) {
+  return nextRandom() % (top + 1);
+}
+
+/*!
+ *    @brief  McCamy's CCT approximation in double
+ *    @param  x CIE x
+ *    @param  y CIE y
+ *    @return CCT in kelvin, or -1 off the main branch (n <= -1.28), where
+ *            the cubic turns back and the value means nothing
+ */
+static double mccamy(double x, double y) {
+  double n = (x - 0.3320) / (0.1858 - y);
+  if (n <= -1.28) {
+    return -1;
+  }
+  return 449 * n * n * n + 3525 * n * n + 6823.3 * n + 5520.33;
+}
+
+int main() {
+  for (uint32_t i = 0; i < SETS; i++) {
+    // Top of the range from 2^6 to full scale, so low signals are covered
+    uint32_t top = (1UL << (6 + nextRandom() % 11)) - 1;
+    uint16_t raw[4] = {randomCount(top), randomCount(top), randomCount(top),
+                       randomCount(top)};
+
+    double ref[3];
+    for (uint8_t row = 0; row < 3; row++) {
+      ref[row] = 0;
+      for (uint8_t col = 0; col < 4; col++) {
+        ref[row] += matrix[row * 4 + col] * raw[col];
+      }
+    }
+    double sum = ref[0] + ref[1] + ref[2];
+    if (ref[0] <= 0 || ref[1] <= 0 || ref[2] <= 0 || sum < regimes[0].min_sum) {
+      continue;
+    }
+    double ref_x = ref[0] / sum;
+    double ref_y = ref[1] / sum;
+    double ref_cct = mccamy(ref_x, ref_y);
+    tcs3430_gain_t gain = gains[i % 4];
+    uint8_t atime = nextRandom() % 256;
+    double ref_lux = ref[1] * (16.0 / Adafruit_TCS3430::gainMultiplier(gain)) *
+                     (100.0 / ((atime + 1) * 2.78));
+
+    tcs3430_xyz_fixed_t xyz;
+    Adafruit_TCS3430_Color::rawToXYZFixed(raw[0], raw[1], raw[2], raw[3], &xyz);
+    uint16_t cie_x, cie_y;
+    CHECK(Adafruit_TCS3430_Color::xyzToCIEFixed(&xyz, &cie_x, &cie_y));
+    double cie = fmax(fabs(cie_x / 32768.0 - ref_x),
+                      fabs(cie_y / 32768.0 - ref_y));
+    double lux = Adafruit_TCS3430_Color::luxFixed(xyz.Y, gain, atime) / 256.0;
+    // Above LUX_MAX the fixed path saturates, checked separately
+    lux = ref_lux < LUX_MAX ? fabs(lux - ref_lux) / ref_lux : 0;
+    double cct = -1;
+    if (ref_cct >= 2000 && ref_cct <= 12000) {
+      cct = fabs(Adafruit_TCS3430_Color::cieToCCTFixed(cie_x, cie_y) - ref_cct);
+    }
+
+    for (uint8_t r = 0; r < 2; r++) {
+      regime_t* regime = &regimes[r];
+      if (sum < regime->min_sum) {
+        continue;
+      }
+      regime->sets++;
+      regime->cie = fmax(regime->cie, cie);
+      regime->lux = fmax(regime->lux, lux);
+      if (cct >= 0) {
+        regime->cct_sets++;
+        regime->cct = fmax(regime->cct, cct);
+      }
+    }
+  }
+
+  for (uint8_t r = 0; r < 2; r++) {
+    regime_t* regime = &regimes[r];
+    printf("  X+Y+Z %s: %lu sets (%lu with CCT), CIE %.6f, CCT %.2f K, "
+           "lux %.4f%%\n",
+           regime->name, (unsigned long)regime->sets,
+           (unsigned long)regime->cct_sets, regime->cie, regime->cct,
+           regime->lux * 100);
+    CHECK(regime->sets > SETS / 100);
+    CHECK(regime->cct_sets > regime->sets / 10);
+    CHECK(regime->cie <= regime->cie_bound);
+    CHECK(regime->cct <= regime->cct_bound);
+    CHECK(regime->lux <= regime->lux_bound);
+  }
+
+  // Lux saturates rather than wrapping
+  CHECK(Adafruit_TCS3430_Color::luxFixed(0x7FFFFFFF, TCS3430_GAIN_1X, 0) ==
+        0xFFFFFFFF);
+  CHECK(Adafruit_TCS3430_Color::luxFixed(0, TCS3430_GAIN_1X, 0) == 0);
+  return hostTestResult("color_test");
+}
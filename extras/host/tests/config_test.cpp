@@ -0,0 +1,195 @@
+/*!
+ *  @file config_test.cpp
+ *
+ * 	applyConfig() on the simulated sensor: only registers whose value
+ * 	changes are written, adjacent changed ones go out as one burst, and ADC
+ * 	changes with ALS running drop AEN first and write ENABLE last, while
+ * 	threshold and interrupt changes leave ENABLE alone.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Wire.h"
+#include "host_test.h"
+
+/** Registers in tcs3430_config_t, in TCS3430_CHANGED_* bit order */
+static const uint8_t regs[TCS3430_CONFIG_REGS] = {
+    TCS3430_REG_ENABLE,    TCS3430_REG_ATIME,   TCS3430_REG_WTIME,
+    TCS3430_REG_AILTL,     TCS3430_REG_AILTH,   TCS3430_REG_AIHTL,
+    TCS3430_REG_AIHTH,     TCS3430_REG_PERS,    TCS3430_REG_CFG0,
+    TCS3430_REG_CFG1,      TCS3430_REG_CFG2,    TCS3430_REG_CFG3,
+    TCS3430_REG_AZ_CONFIG, TCS3430_REG_INTENAB};
+
+static Adafruit_TCS3430 tcs;
+static SimTCS3430* sensor;
+static uint32_t read_cost; ///< Transactions applyConfig() spends reading
+
+/** What one applyConfig() call did on the bus */
+typedef struct {
+  uint16_t changed; ///< Mask applyConfig() reported
+  uint16_t written; ///< TCS3430_CHANGED_* mask of registers written
+  uint32_t bursts;  ///< Write transactions
+  uint8_t enables;  ///< Writes to ENABLE
+} apply_t;
+
+/*!
+ *    @brief  Apply a configuration and record what reached the chip
+ *    @param  config Settings to apply
+ *    @param  result Filled in
+ */
+static void apply(const tcs3430_config_t* config, apply_t* result) {
+  uint32_t before[TCS3430_CONFIG_REGS];
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    before[i] = sensor->registerWrites(regs[i]);
+  }
+  uint32_t transactions = Wire.transactions();
+  CHECK(tcs.applyConfig(config, &result->changed));
+  result->bursts = Wire.transactions() - transactions - read_cost;
+  result->written = 0;
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    uint32_t writes = sensor->registerWrites(regs[i]) - before[i];
+    CHECK(writes <= (i == 0 ? 2 : 1));
+    if (writes) {
+      result->written |= (uint16_t)1 << i;
+    }
+  }
+  result->enables = sensor->registerWrites(TCS3430_REG_ENABLE) - before[0];
+  printf("  changed 0x%04x, written 0x%04x, %lu write bursts, %u ENABLE\n",
+         result->changed, result->written, (unsigned long)result->bursts,
+         result->enables);
+}
+
+/*!
+ *    @brief  Check readConfig() gives back what was applied
+ *    @param  config Settings applied
+ */
+static void checkReadback(const tcs3430_config_t* config) {
+  tcs3430_config_t got;
+  CHECK(tcs.readConfig(&got));
+  CHECK(got.power == config->power && got.als_enable == config->als_enable &&
+        got.wait_enable == config->wait_enable);
+  CHECK(got.atime == config->atime && got.wtime == config->wtime &&
+        got.wait_long == config->wait_long);
+  CHECK(got.threshold_low == config->threshold_low &&
+        got.threshold_high == config->threshold_high &&
+        got.persistence == config->persistence);
+  CHECK(got.gain == config->gain && got.amux_ir2 == config->amux_ir2);
+  CHECK(got.int_read_clear == config->int_read_clear &&
+        got.sleep_after_int == config->sleep_after_int);
+  CHECK(got.az_mode == config->az_mode && got.az_nth == config->az_nth);
+  CHECK(got.saturation_int == config->saturation_int &&
+        got.als_int == config->als_int);
+}
+
+int main() {
+  sensor = hostTestSensor();
+  hostTestLight(4.3f);
+  CHECK(tcs.begin());
+  tcs3430_config_t config;
+  memset(&config, 0, sizeof(config));
+  CHECK(tcs.readConfig(&config));
+  CHECK(config.power && config.als_enable);
+  CHECK(config.atime == tcs.getIntegrationCycles());
+  CHECK(config.gain == tcs.getALSGain());
+
+  // The same settings again: nothing is written, so the transactions are
+  // all readback
+  uint32_t transactions = Wire.transactions();
+  uint16_t changed = 0xFFFF;
+  CHECK(tcs.applyConfig(&config, &changed));
+  CHECK(changed == 0);
+  read_cost = Wire.transactions() - transactions;
+  apply_t result;
+  apply(&config, &result);
+  CHECK(result.changed == 0 && result.written == 0 && result.bursts == 0);
+
+  // Thresholds only: one 4-byte burst, ALS left running
+  config.threshold_low = 0x0102;
+  config.threshold_high = 0x0304;
+  apply(&config, &result);
+  uint16_t thresholds = TCS3430_CHANGED_AILTL | TCS3430_CHANGED_AILTH |
+                        TCS3430_CHANGED_AIHTL | TCS3430_CHANGED_AIHTH;
+  CHECK(result.changed == thresholds && result.written == thresholds);
+  CHECK(result.bursts == 1 && result.enables == 0);
+  CHECK(sensor->phase() != SIMTCS3430_AUTOZERO);
+  checkReadback(&config);
+
+  // WTIME and one threshold byte: unchanged bytes between them are not
+  // rewritten, so they are two writes. WTIME is an ADC setting, so AEN
+  // drops first and ENABLE goes last, restarting the cycle.
+  config.wtime = 9;
+  config.threshold_high = 0x0305;
+  apply(&config, &result);
+  uint16_t wtime = TCS3430_CHANGED_WTIME | TCS3430_CHANGED_AIHTL;
+  CHECK(result.changed == wtime);
+  CHECK(result.written == (wtime | TCS3430_CHANGED_ENABLE));
+  CHECK(result.bursts == 4 && result.enables == 2);
+  CHECK(sensor->lastWriteOrder(TCS3430_REG_ENABLE) >
+        sensor->lastWriteOrder(TCS3430_REG_AIHTL));
+  CHECK(sensor->phase() == SIMTCS3430_AUTOZERO);
+  checkReadback(&config);
+
+  // ATIME, PERS, WLONG, gain and AMUX: ATIME alone (0x82 is reserved),
+  // PERS and CFG0 together, CFG1 alone, then ENABLE twice around them
+  config.atime = 63;
+  config.persistence = TCS3430_PERS_5;
+  config.wait_long = true;
+  config.gain = TCS3430_GAIN_16X;
+  config.amux_ir2 = true;
+  apply(&config, &result);
+  uint16_t adc = TCS3430_CHANGED_ATIME | TCS3430_CHANGED_PERS |
+                 TCS3430_CHANGED_CFG0 | TCS3430_CHANGED_CFG1;
+  CHECK(result.changed == adc);
+  CHECK(result.written == (adc | TCS3430_CHANGED_ENABLE));
+  CHECK(result.bursts == 5 && result.enables == 2);
+  CHECK(sensor->lastWriteOrder(TCS3430_REG_ENABLE) >
+        sensor->lastWriteOrder(TCS3430_REG_CFG1));
+  CHECK(sensor->lastWriteOrder(TCS3430_REG_PERS) + 1 ==
+        sensor->lastWriteOrder(TCS3430_REG_CFG0));
+  CHECK(tcs.getALSMUX_IR2());
+  checkReadback(&config);
+
+  // 128x is AGAIN 64x in CFG1 plus HGAIN in CFG2
+  config.gain = TCS3430_GAIN_128X;
+  apply(&config, &result);
+  CHECK(result.changed == (TCS3430_CHANGED_CFG1 | TCS3430_CHANGED_CFG2));
+  CHECK(result.written == (result.changed | TCS3430_CHANGED_ENABLE));
+  CHECK(result.bursts == 4);
+  checkReadback(&config);
+
+  // Interrupt enables and CFG3 are not ADC settings: no restart
+  config.als_int = true;
+  config.int_read_clear = true;
+  apply(&config, &result);
+  CHECK(result.changed == (TCS3430_CHANGED_CFG3 | TCS3430_CHANGED_INTENAB));
+  CHECK(result.written == result.changed);
+  CHECK(result.bursts == 2 && result.enables == 0);
+  checkReadback(&config);
+
+  // Turning ALS off with an ADC change: dropping AEN first already gives
+  // the final ENABLE, so it is written once, before ATIME
+  config.als_enable = false;
+  config.atime = 15;
+  apply(&config, &result);
+  CHECK(result.changed == (TCS3430_CHANGED_ENABLE | TCS3430_CHANGED_ATIME));
+  CHECK(result.bursts == 2 && result.enables == 1);
+  CHECK(sensor->lastWriteOrder(TCS3430_REG_ENABLE) <
+        sensor->lastWriteOrder(TCS3430_REG_ATIME));
+
+  // With ALS off, ADC changes leave ENABLE alone
+  config.atime = 31;
+  apply(&config, &result);
+  CHECK(result.changed == TCS3430_CHANGED_ATIME);
+  CHECK(result.bursts == 1 && result.enables == 0);
+  CHECK(sensor->phase() == SIMTCS3430_IDLE);
+  checkReadback(&config);
+  return hostTestResult("config_test");
+}
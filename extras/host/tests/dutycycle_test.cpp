@@ -0,0 +1,175 @@
+/*!
+ *  @file dutycycle_test.cpp
+ *
+ * 	Duty cycle planning: plan() picks the lowest-current scheme that
+ * 	meets the period and latency limits, falls back to the closest
+ * 	free-running one when none does, and does not overflow at the top of
+ * 	its range; setIntegrationTime()/setWaitTime() clamp to 1-256 steps at
+ * 	both ends; and a free-running and a host-timed plan deliver one sample
+ * 	per period on the simulated sensor.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_DutyCycle.h"
+#include "host_test.h"
+
+#define ATIME 15     ///< 16 steps, 44.48 ms per integration
+#define RUN_MS 3000  ///< Each plan is run for this long
+#define POLL_US 500  ///< Time between poll() calls
+
+static Adafruit_TCS3430 tcs;
+static Adafruit_TCS3430_DutyCycle duty(&tcs);
+
+/*!
+ *    @brief  Plan and print the result
+ *    @param  period_ms Longest time between samples
+ *    @param  latency_ms Longest latency
+ *    @param  host_timed Allow SAI and POWER_DOWN
+ *    @param  plan Filled in
+ *    @return plan()'s result
+ */
+static bool planFor(uint32_t period_ms, uint32_t latency_ms, bool host_timed,
+                    tcs3430_duty_plan_t* plan) {
+  bool met = Adafruit_TCS3430_DutyCycle::plan(period_ms, latency_ms, ATIME,
+                                              host_timed, plan);
+  printf("  %lu/%lu ms%s: mode %u, wtime %u, period %lu us, latency %lu us, "
+         "%.2f uA%s\n",
+         (unsigned long)period_ms, (unsigned long)latency_ms,
+         host_timed ? " host timed" : "", plan->mode, plan->wtime,
+         (unsigned long)plan->period_us, (unsigned long)plan->latency_us,
+         plan->current_ua, met ? "" : " (not met)");
+  CHECK(plan->atime == ATIME);
+  CHECK(plan->current_ua >= TCS3430_IDD_SLEEP_UA &&
+        plan->current_ua <= TCS3430_IDD_ACTIVE_UA);
+  return met;
+}
+
+/*!
+ *    @brief  Run the plan in force and count the samples
+ *    @return Number of READY results in RUN_MS
+ */
+static uint16_t run() {
+  uint16_t samples = 0;
+  uint32_t start = millis();
+  while (millis() - start < RUN_MS) {
+    tcs3430_frame_t frame;
+    tcs3430_poll_t result = duty.poll(&frame);
+    CHECK(result == TCS3430_POLL_READY || result == TCS3430_POLL_PENDING);
+    if (result == TCS3430_POLL_READY) {
+      CHECK(frame.flags & TCS3430_FRAME_VALID);
+      CHECK(frame.y > 0);
+      samples++;
+    }
+    delayMicroseconds(POLL_US);
+  }
+  return samples;
+}
+
+int main() {
+  hostTestSensor();
+  hostTestLight(4.3f);
+  CHECK(tcs.begin());
+  uint32_t integration = (ATIME + 1) * TCS3430_STEP_MICROS;
+
+  // ms to steps rounds down and clamps at both ends instead of wrapping
+  CHECK(tcs.setIntegrationTime(100.0f));
+  CHECK(tcs.getIntegrationCycles() == 34);
+  CHECK(tcs.setIntegrationTime(711.68f));
+  CHECK(tcs.getIntegrationCycles() == 255);
+  CHECK(tcs.setIntegrationTime(5000.0f));
+  CHECK(tcs.getIntegrationCycles() == 255);
+  CHECK(tcs.setIntegrationTime(1.0f));
+  CHECK(tcs.getIntegrationCycles() == 0);
+  CHECK(tcs.setIntegrationTime(-10.0f));
+  CHECK(tcs.getIntegrationCycles() == 0);
+  CHECK(tcs.setWaitTime(1e9f));
+  CHECK(tcs.getWaitCycles() == 255);
+  CHECK(tcs.setWaitTime(0.0f));
+  CHECK(tcs.getWaitCycles() == 0);
+  CHECK(tcs.setIntegrationCycles(ATIME));
+
+  // Sampling faster than one integration cannot be met: back to back is
+  // the closest
+  tcs3430_duty_plan_t plan;
+  CHECK(!planFor(10, 10, true, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_CONTINUOUS);
+  CHECK(plan.period_us == integration);
+  CHECK(plan.current_ua == TCS3430_IDD_ACTIVE_UA);
+
+  // A little spare time goes to a short wait
+  CHECK(planFor(50, 50, false, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_WAIT);
+  CHECK(plan.wtime == 0);
+  CHECK(plan.period_us == integration + TCS3430_STEP_MICROS);
+  CHECK(plan.current_ua < TCS3430_IDD_ACTIVE_UA);
+
+  // Past the longest WTIME, WLONG; the longest cycle within the limits
+  tcs3430_duty_plan_t wait = plan;
+  CHECK(planFor(2000, 2000, false, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_WAIT_LONG);
+  CHECK(plan.period_us <= 2000000UL);
+  CHECK(plan.period_us + 12 * TCS3430_STEP_MICROS > 2000000UL);
+  CHECK(plan.current_ua < wait.current_ua);
+
+  // Sampling more often than asked is allowed: a period past the longest
+  // WLONG cycle gets that cycle
+  CHECK(planFor(60000, 60000, false, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_WAIT_LONG && plan.wtime == 255);
+  CHECK(plan.period_us == integration + 256UL * 12 * TCS3430_STEP_MICROS);
+
+  // Host timed, SAI sleeps between samples, if the latency allows the
+  // result to wait for the next read...
+  tcs3430_duty_plan_t sai;
+  CHECK(planFor(60000, 60000, true, &sai));
+  CHECK(sai.mode == TCS3430_DUTY_SAI);
+  CHECK(sai.period_us == 60000000UL);
+  CHECK(sai.latency_us == 60000000UL - integration);
+  CHECK(sai.current_ua < plan.current_ua);
+
+  // ...otherwise powering down, which pays for auto-zero each time
+  CHECK(planFor(60000, 100, true, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_POWER_DOWN);
+  CHECK(plan.active_us ==
+        integration + (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS);
+  CHECK(plan.latency_us == plan.active_us);
+  CHECK(plan.current_ua > sai.current_ua);
+
+  // A latency shorter than a sample is never met, and the closest plan
+  // is back to back
+  CHECK(!planFor(60000, 10, true, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_CONTINUOUS);
+
+  // The longest period does not overflow
+  CHECK(planFor(0xFFFFFFFF, 0xFFFFFFFF, true, &plan));
+  CHECK(plan.mode == TCS3430_DUTY_SAI);
+  CHECK(plan.period_us == (0xFFFFFFFF / 1000) * 1000);
+
+  // On the sensor: a free-running plan, then a host-timed one, each one
+  // sample per period
+  CHECK(duty.begin(100, 100, false));
+  CHECK(duty.getPlan()->mode == TCS3430_DUTY_WAIT);
+  uint32_t period = duty.getPlan()->period_us;
+  uint16_t samples = run();
+  uint16_t expected = RUN_MS * 1000UL / period;
+  printf("  WAIT: %u samples (%u expected)\n", samples, expected);
+  CHECK(samples + 1 >= expected && samples <= expected + 1);
+  CHECK(tcs.isWaitEnabled());
+
+  CHECK(duty.begin(250, 100, true));
+  CHECK(duty.getPlan()->mode == TCS3430_DUTY_POWER_DOWN);
+  samples = run();
+  expected = RUN_MS / 250;
+  printf("  POWER_DOWN: %u samples (%u expected)\n", samples, expected);
+  CHECK(samples + 1 >= expected && samples <= expected + 1);
+  CHECK(!tcs.isPoweredOn());
+  return hostTestResult("dutycycle_test");
+}
@@ -0,0 +1,157 @@
+/*!
+ *  @file events_test.cpp
+ *
+ * 	Interrupt event classification on the simulated sensor: each INT
+ * 	edge must become one event per flag raised, classified against the
+ * 	threshold window, stamped with the edge time and read in one short
+ * 	burst, with nothing missed (even after a failed read) and nothing
+ * 	left after endEvents().
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Wire.h"
+#include "host_test.h"
+
+#define INT_PIN 2           ///< Simulated INT wiring
+#define ATIME 15            ///< 16 steps per integration
+#define THRESH_LOW 1000     ///< Window CH0 is classified against
+#define THRESH_HIGH 3000    ///< Top of that window
+#define SETTLE_MS 100       ///< Let a light change reach the registers
+#define WATCH_MS 1000       ///< How long each scene is watched for
+#define TRANSACTIONS_EACH 3 ///< STATUS+CH0 register write and read, and the
+                            ///< STATUS clear
+
+static Adafruit_TCS3430 tcs;
+static Adafruit_TCS3430_Ring<tcs3430_event_t, 8> queue;
+
+/*!
+ *    @brief  INT handler
+ */
+static void onSensorInt() {
+  tcs.handleInterrupt();
+}
+
+/*!
+ *    @brief  Service the sensor for a while and count the events by type
+ *    @param  ms How long to run for
+ *    @param  counts Events of each tcs3430_event_type_t, filled in
+ *    @param  last Set to the last event, if any
+ *    @return Number of interrupts serviced
+ */
+static uint16_t run(uint32_t ms, uint16_t counts[4], tcs3430_event_t* last) {
+  memset(counts, 0, 4 * sizeof(counts[0]));
+  uint16_t interrupts = 0;
+  uint32_t previous = 0;
+  uint32_t start = millis();
+  while (millis() - start < ms) {
+    delayMicroseconds(500);
+    interrupts += tcs.service() > 0;
+    tcs3430_event_t event;
+    while (queue.pop(&event)) {
+      CHECK(event.type <= TCS3430_EVENT_SATURATED);
+      // Events from one edge share its time, later edges come later
+      CHECK(event.timestamp - previous < 0x80000000UL);
+      previous = event.timestamp;
+      counts[event.type]++;
+      *last = event;
+    }
+  }
+  return interrupts;
+}
+
+/*!
+ *    @brief  Set a scene and check every integration reports it the same
+ *            way
+ *    @param  light Counts per step at 1x
+ *    @param  type Event every integration should raise
+ *    @param  saturated true if each should also raise SATURATED
+ */
+static void expect(float light, tcs3430_event_type_t type, bool saturated) {
+  hostTestLight(light);
+  uint16_t counts[4];
+  tcs3430_event_t event;
+  uint16_t cycles = WATCH_MS * 1000UL / tcs.getCycleMicros();
+  run(SETTLE_MS, counts, &event);
+  Wire.resetCounters();
+  uint16_t interrupts = run(WATCH_MS, counts, &event);
+  printf("  light %6.1f: %u interrupts, Z=%u, status 0x%02X\n", light,
+         interrupts, event.ch0, event.status);
+  CHECK(interrupts + 1 >= cycles && interrupts <= cycles + 1);
+  CHECK(counts[type] == interrupts);
+  CHECK(counts[TCS3430_EVENT_SATURATED] == (saturated ? interrupts : 0));
+  uint16_t total = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    total += counts[i];
+  }
+  CHECK(total == interrupts * (saturated ? 2 : 1));
+  CHECK(Wire.transactions() == interrupts * TRANSACTIONS_EACH);
+  if (!interrupts) {
+    return;
+  }
+  uint16_t z = light * (ATIME + 1) + 5.5f + 0.5f;
+  CHECK(event.ch0 == (saturated ? (ATIME + 1) * 1024 - 1 : z));
+  CHECK(event.status & TCS3430_STATUS_AINT);
+  CHECK((bool)(event.status & TCS3430_STATUS_ASAT) == saturated);
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  sensor->connectInterrupt(INT_PIN);
+  hostTestLight(100);
+
+  CHECK(tcs.begin());
+  CHECK(tcs.setALSGain(TCS3430_GAIN_1X));
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  CHECK(tcs.setALSThresholds(THRESH_LOW, THRESH_HIGH));
+  CHECK(tcs.setInterruptPersistence(TCS3430_PERS_EVERY));
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onSensorInt, RISING);
+  bool clear_on_read = tcs.getInterruptClearOnRead();
+  CHECK(tcs.beginEvents(&queue));
+  CHECK(!tcs.getInterruptClearOnRead());
+
+  // Every integration fires; inside the window it is just data
+  expect(100, TCS3430_EVENT_DATA_READY, false);
+  expect(250, TCS3430_EVENT_CROSSED_HIGH, false);
+  expect(30, TCS3430_EVENT_CROSSED_LOW, false);
+  // Full scale raises both flags on one edge
+  expect(2000, TCS3430_EVENT_CROSSED_HIGH, true);
+
+  // Persistence 1: only integrations outside the window fire
+  CHECK(tcs.setInterruptPersistence(TCS3430_PERS_1));
+  uint16_t counts[4];
+  tcs3430_event_t event;
+  hostTestLight(100);
+  run(SETTLE_MS, counts, &event);
+  CHECK(run(WATCH_MS, counts, &event) == 0);
+  expect(250, TCS3430_EVENT_CROSSED_HIGH, false);
+
+  // A failed STATUS read leaves INT asserted, so no new edge comes: the
+  // interrupt has to be retried, not dropped
+  sensor->failReads(TCS3430_REG_STATUS);
+  uint16_t cycles = WATCH_MS * 1000UL / tcs.getCycleMicros();
+  uint16_t serviced = run(WATCH_MS, counts, &event);
+  printf("  after a failed read: %u interrupts\n", serviced);
+  CHECK(serviced + 2 >= cycles);
+  CHECK(counts[TCS3430_EVENT_CROSSED_HIGH] == serviced);
+  CHECK(tcs.getMissedInterrupts() == 0);
+  CHECK(queue.overruns() == 0);
+
+  // Not alongside capture, and quiet once stopped
+  Adafruit_TCS3430_Ring<tcs3430_frame_t, 4> ring;
+  CHECK(!tcs.beginCapture(&ring));
+  tcs.endEvents();
+  CHECK(tcs.getInterruptClearOnRead() == clear_on_read);
+  CHECK(run(WATCH_MS, counts, &event) == 0);
+  CHECK(queue.available() == 0);
+  return hostTestResult("events_test");
+}
@@ -0,0 +1,92 @@
+/*!
+ *  @file filter_test.cpp
+ *
+ * 	Step response of the streaming filter: for every IIR shift the output
+ * 	must rise (or fall) monotonically to the new level and settle on it
+ * 	exactly, without overshoot.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Filter.h"
+#include "host_test.h"
+
+/*!
+ *    @brief  A valid frame with the same count on every channel
+ *    @param  counts Channel value
+ *    @return The frame
+ */
+static tcs3430_frame_t constant(uint16_t counts) {
+  tcs3430_frame_t frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.flags = TCS3430_FRAME_VALID;
+  frame.z = frame.y = frame.ir1 = frame.ch3 = counts;
+  return frame;
+}
+
+/*!
+ *    @brief  Settle the filter on one level, step to another and check the
+ *            response
+ *    @param  shift IIR shift
+ *    @param  from Level before the step
+ *    @param  to Level after the step
+ */
+static void step(uint8_t shift, uint16_t from, uint16_t to) {
+  Adafruit_TCS3430_Filter<3> filter;
+  CHECK(filter.begin(1, shift, 1));
+  tcs3430_frame_t frame = constant(from);
+  tcs3430_filtered_t out;
+  CHECK(filter.update(&frame, &out));
+  CHECK(out.y == from);
+
+  frame = constant(to);
+  uint32_t frames = (uint32_t)24 << shift;
+  uint16_t prev = from;
+  bool monotonic = true;
+  for (uint32_t i = 0; i < frames; i++) {
+    CHECK(filter.update(&frame, &out));
+    if (to >= from ? (out.y < prev || out.y > to)
+                   : (out.y > prev || out.y < to)) {
+      monotonic = false;
+    }
+    prev = out.y;
+  }
+  if (out.y != to || !monotonic) {
+    printf("  shift %2u, %5u -> %5u: settled at %5u%s\n", shift, from, to,
+           out.y, monotonic ? "" : ", not monotonic");
+  }
+  CHECK(monotonic);
+  CHECK(out.y == to && out.z == to && out.ir1 == to && out.ch3 == to);
+}
+
+int main() {
+  for (uint8_t shift = 0; shift <= 15; shift++) {
+    step(shift, 0, 100);
+    step(shift, 100, 0);
+    step(shift, 0, 1);
+    step(shift, 0, 65535);
+    step(shift, 65535, 0);
+    step(shift, 1000, 1003);
+    step(shift, 1003, 1000);
+  }
+
+  // A single spike through a 3-tap median never reaches the IIR
+  Adafruit_TCS3430_Filter<3> filter;
+  CHECK(filter.begin(1, 2, 3));
+  tcs3430_filtered_t out;
+  for (uint8_t i = 0; i < 10; i++) {
+    tcs3430_frame_t frame = constant(i == 5 ? 60000 : 500);
+    CHECK(filter.update(&frame, &out));
+    CHECK(out.y == 500);
+  }
+
+  return hostTestResult("filter_test");
+}
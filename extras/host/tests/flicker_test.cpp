@@ -0,0 +1,159 @@
+/*!
+ *  @file flicker_test.cpp
+ *
+ * 	Flicker capture and analysis on the simulated sensor, under a light
+ * 	whose level follows a sine wave: the frequency must be recovered
+ * 	below half the sample rate and alias predictably above it, and a
+ * 	steady light must report no flicker at all.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <math.h>
+
+#include "Adafruit_TCS3430_Flicker.h"
+#include "host_test.h"
+
+#define SAMPLES 360          ///< About one second of samples
+#define LIGHT 100.0f         ///< Mean light in counts per step at 1x
+#define MODULATOR_ADDR 0x7E  ///< Bus address the modulator sits at
+#define MODULATOR_STEP_US 50 ///< How often the modulated light is updated
+
+/*!
+ *    @brief  Not a real device: rides on the bus only to get advanced with
+ *            the simulated clock, and sets the room light to a sine wave.
+ *            Added after the sensor, so the sensor has integrated up to
+ *            each step before the light changes.
+ */
+class LightModulator : public SimI2CTarget {
+ public:
+  /*!
+   *    @brief  Set the modulation
+   *    @param  hz Frequency, 0 for steady light
+   *    @param  depth Swing either side of LIGHT, as a fraction of it
+   */
+  void set(float hz, float depth) {
+    _hz = hz;
+    _depth = depth;
+  }
+  /*!
+   *    @brief  Ignore writes
+   *    @param  data Unused
+   *    @param  len Unused
+   *    @return false: NACK
+   */
+  bool i2cWrite(const uint8_t* data, uint32_t len) {
+    (void)data;
+    (void)len;
+    return false;
+  }
+  /*!
+   *    @brief  Ignore reads
+   *    @param  data Unused
+   *    @param  len Unused
+   *    @return false: NACK
+   */
+  bool i2cRead(uint8_t* data, uint32_t len) {
+    (void)data;
+    (void)len;
+    return false;
+  }
+  /*!
+   *    @brief  Set the light for the step starting now
+   *    @param  now Virtual time in microseconds
+   */
+  void advance(uint64_t now) {
+    if (now < _next) {
+      return;
+    }
+    double phase = 2 * M_PI * _hz * (now + MODULATOR_STEP_US / 2) / 1e6;
+    hostTestLight(LIGHT * (1 + _depth * sin(phase)));
+    _next = now + MODULATOR_STEP_US;
+  }
+  /*!
+   *    @brief  When the light changes next
+   *    @return Virtual time in microseconds
+   */
+  uint64_t nextEvent() const {
+    return _next;
+  }
+
+ private:
+  float _hz = 0;      ///< Modulation frequency
+  float _depth = 0;   ///< Modulation depth
+  uint64_t _next = 0; ///< Time of the next light step
+};
+
+static Adafruit_TCS3430 tcs;
+static LightModulator modulator;
+static tcs3430_flicker_sample_t samples[SAMPLES];
+
+/*!
+ *    @brief  Capture under a modulated light and analyze the samples
+ *    @param  hz Modulation frequency, 0 for steady light
+ *    @param  depth Modulation depth
+ *    @param  result Filled with the analysis
+ */
+static void measure(float hz, float depth, tcs3430_flicker_t* result) {
+  modulator.set(hz, depth);
+  Adafruit_TCS3430_Flicker flicker(&tcs);
+  CHECK(flicker.capture(samples, SAMPLES));
+  CHECK(Adafruit_TCS3430_Flicker::analyze(samples, SAMPLES, result));
+  printf("  %5.1f Hz at %2.0f%%: %7.3f Hz, %5.1f%% flicker, every %u us\n", hz,
+         depth * 100, result->frequency_mhz / 1000.0, result->percent / 256.0,
+         (unsigned)result->interval_us);
+}
+
+/*!
+ *    @brief  Check a measured frequency
+ *    @param  result Analysis
+ *    @param  hz Frequency expected
+ */
+static void checkFrequency(const tcs3430_flicker_t* result, float hz) {
+  float measured = result->frequency_mhz / 1000.0f;
+  CHECK(fabsf(measured - hz) <= hz / 100);
+}
+
+int main() {
+  hostTestSensor();
+  SimHost::instance().addTarget(&modulator, MODULATOR_ADDR);
+
+  CHECK(tcs.begin());
+  CHECK(tcs.setALSGain(TCS3430_GAIN_4X));
+  CHECK(tcs.setIntegrationCycles(63));
+  tcs3430_flicker_t result;
+
+  // Steady light: no swing, no frequency
+  measure(0, 0, &result);
+  CHECK(result.frequency_mhz == 0);
+  CHECK(result.percent < 256);
+  CHECK(result.interval_us >= TCS3430_STEP_MICROS &&
+        result.interval_us <= TCS3430_STEP_MICROS + TCS3430_STEP_MICROS / 20);
+
+  // Mains flicker: twice the line frequency, and a dimmer at 50 Hz
+  measure(100, 0.3f, &result);
+  checkFrequency(&result, 100);
+  measure(120, 0.3f, &result);
+  checkFrequency(&result, 120);
+  measure(50, 0.5f, &result);
+  checkFrequency(&result, 50);
+  // Percent flicker is reduced by the 2.78 ms integration, not inflated
+  CHECK(result.percent <= 50 * 256 && result.percent >= 40 * 256);
+
+  // Above half the sample rate it folds back about the sample rate
+  measure(250, 0.5f, &result);
+  checkFrequency(&result, 1e6f / result.interval_us - 250);
+
+  // The settings from before the capture are back
+  CHECK(tcs.getIntegrationCycles() == 63);
+  CHECK(tcs.getALSGain() == TCS3430_GAIN_4X);
+  return hostTestResult("flicker_test");
+}
@@ -0,0 +1,129 @@
+/*!
+ *  @file frame_test.cpp
+ *
+ * 	readFrame() flag decoding on the simulated sensor: SATURATED follows
+ * 	ASAT in the burst's STATUS byte until it is cleared, CH3_IR2 follows
+ * 	the mux and comes with IR2 counts on CH3, a frame read while the mux
+ * 	is unknown is not VALID, and a failed burst clears the flags.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "host_test.h"
+
+#define ATIME 15         ///< 16 steps per integration
+#define X_LIGHT 40.3f    ///< Counts per step at 1x on X, Y, Z and IR1
+#define IR2_LIGHT 20.3f  ///< Counts per step at 1x on IR2
+#define BRIGHT 5000.0f   ///< Counts per step at 1x, past full scale
+#define FULL_SCALE 16383 ///< (ATIME + 1) * 1024 - 1
+
+static Adafruit_TCS3430 tcs;
+
+/*!
+ *    @brief  Set the scene
+ *    @param  x Counts per step at 1x on X, Y, Z and IR1
+ *    @param  ir2 Counts per step at 1x on IR2
+ */
+static void setLight(float x, float ir2) {
+  sim_light_t light = {x, x, x, x, ir2};
+  SimHost::instance().setAmbient(light);
+}
+
+/*!
+ *    @brief  Flags other than INTERRUPT, which the default 0/0 thresholds
+ *            raise on every integration
+ *    @param  frame Frame
+ *    @return TCS3430_FRAME_* flags
+ */
+static uint8_t flags(const tcs3430_frame_t* frame) {
+  return frame->flags & ~TCS3430_FRAME_INTERRUPT;
+}
+
+/*!
+ *    @brief  Wait out two cycles, so a whole integration sees the scene
+ *    @param  frame Filled in
+ */
+static void nextFrame(tcs3430_frame_t* frame) {
+  delay(2 * (ATIME + 1) * 3);
+  CHECK(tcs.readFrame(frame));
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  setLight(X_LIGHT, IR2_LIGHT);
+  CHECK(tcs.begin());
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  // Plus the simulated dark offsets, 5 on X and 2 on IR2
+  uint16_t x_counts = X_LIGHT * (ATIME + 1) + 5.0f + 0.5f;
+  uint16_t ir2_counts = IR2_LIGHT * (ATIME + 1) + 2.0f + 0.5f;
+
+  // begin() leaves the mux unknown; if it cannot be read, the frame is
+  // read but not VALID, and says nothing about CH3
+  tcs3430_frame_t frame;
+  delay(200);
+  sensor->failReads(TCS3430_REG_CFG1);
+  CHECK(tcs.readFrame(&frame));
+  CHECK(!(frame.flags & TCS3430_FRAME_VALID));
+  CHECK(!(frame.flags & TCS3430_FRAME_CH3_IR2));
+
+  // The next frame reads it
+  CHECK(tcs.readFrame(&frame));
+  CHECK(flags(&frame) == TCS3430_FRAME_VALID);
+  CHECK(frame.ch3 == x_counts);
+
+  // CH3_IR2 follows the mux, with IR2 counts on CH3
+  CHECK(tcs.setALSMUX_IR2(true));
+  nextFrame(&frame);
+  printf("  CH3 on IR2: %u (expected %u), flags 0x%02x\n", frame.ch3,
+         ir2_counts, frame.flags);
+  CHECK(flags(&frame) == (TCS3430_FRAME_VALID | TCS3430_FRAME_CH3_IR2));
+  CHECK(frame.ch3 == ir2_counts);
+  CHECK(tcs.setALSMUX_IR2(false));
+  nextFrame(&frame);
+  CHECK(flags(&frame) == TCS3430_FRAME_VALID);
+  CHECK(frame.ch3 == x_counts);
+
+  // SATURATED follows ASAT, with the channels at full scale
+  setLight(BRIGHT, BRIGHT);
+  nextFrame(&frame);
+  printf("  bright: status 0x%02x, flags 0x%02x, y %u\n", frame.status,
+         frame.flags, frame.y);
+  CHECK(frame.status & TCS3430_STATUS_ASAT);
+  CHECK(flags(&frame) == (TCS3430_FRAME_VALID | TCS3430_FRAME_SATURATED));
+  CHECK(frame.y == FULL_SCALE);
+  CHECK(!(frame.status & TCS3430_STATUS_AINT) ==
+        !(frame.flags & TCS3430_FRAME_INTERRUPT));
+
+  // ASAT is sticky, so the flag stays after the light drops...
+  setLight(X_LIGHT, IR2_LIGHT);
+  nextFrame(&frame);
+  CHECK(frame.flags & TCS3430_FRAME_SATURATED);
+  CHECK(frame.ch3 == x_counts);
+
+  // ...until STATUS is cleared
+  CHECK(tcs.clearALSInterrupt());
+  nextFrame(&frame);
+  CHECK(flags(&frame) == TCS3430_FRAME_VALID);
+
+  // SATURATED and CH3_IR2 together
+  CHECK(tcs.setALSMUX_IR2(true));
+  setLight(BRIGHT, BRIGHT);
+  nextFrame(&frame);
+  CHECK(flags(&frame) == (TCS3430_FRAME_VALID | TCS3430_FRAME_SATURATED |
+                          TCS3430_FRAME_CH3_IR2));
+  CHECK(frame.ch3 == FULL_SCALE);
+
+  // A failed burst returns false with no flags set
+  sensor->failReads(TCS3430_REG_STATUS);
+  CHECK(!tcs.readFrame(&frame));
+  CHECK(frame.flags == 0);
+  return hostTestResult("frame_test");
+}
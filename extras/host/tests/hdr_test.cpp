@@ -0,0 +1,142 @@
+/*!
+ *  @file hdr_test.cpp
+ *
+ * 	HDR fusion over a light ramp spanning both exposures: the fused value
+ * 	must track the light from the high exposure's floor to the low
+ * 	exposure's knee, rise monotonically, stay continuous through the
+ * 	crossfade, and flag moved and saturated frames.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <math.h>
+
+#include "Adafruit_TCS3430_HDR.h"
+#include "host_test.h"
+
+#define MIN_RANGE 4000000 ///< Default exposures: 8064 counts at 1x over 9
+                          ///< steps, against one count at HGAIN over 36
+#define TOLERANCE 0.02f   ///< Fused error allowed, relative to the light
+#define FLOOR 0.001f      ///< Plus this, for the high exposure's rounding
+#define POLL_US 500       ///< Time between poll() calls
+
+static Adafruit_TCS3430 tcs;
+static Adafruit_TCS3430_HDR hdr(&tcs);
+
+/*!
+ *    @brief  Poll until the next fused frame
+ *    @param  frame Filled in
+ *    @return true if one arrived within a second
+ */
+static bool nextFrame(tcs3430_hdr_frame_t* frame) {
+  uint32_t start = millis();
+  while (millis() - start < 1000) {
+    tcs3430_poll_t result = hdr.poll(frame);
+    CHECK(result != TCS3430_POLL_ERROR && result != TCS3430_POLL_IDLE);
+    if (result == TCS3430_POLL_READY) {
+      return true;
+    }
+    delayMicroseconds(POLL_US);
+  }
+  return false;
+}
+
+/*!
+ *    @brief  Change the light and return the first frame made entirely of
+ *            exposures taken under it
+ *    @param  light Counts per step at 1x on every channel
+ *    @param  frame Filled in
+ *    @param  changed Set if a frame on the way was flagged CHANGED
+ */
+static void settle(float light, tcs3430_hdr_frame_t* frame, bool* changed) {
+  hostTestLight(light);
+  *changed = false;
+  // The exposure integrating now mixes the old light in, the other is
+  // still from before: the third frame is the first clean one
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(nextFrame(frame));
+    *changed |= frame->flags & TCS3430_FRAME_CHANGED;
+  }
+}
+
+/*!
+ *    @brief  Check every channel of a fused frame against the light
+ *    @param  frame Fused frame
+ *    @param  light Counts per step at 1x
+ */
+static void checkFused(const tcs3430_hdr_frame_t* frame, float light) {
+  const uint32_t ch[4] = {frame->x, frame->y, frame->z, frame->ir1};
+  for (uint8_t i = 0; i < 4; i++) {
+    float fused = ch[i] / 65536.0f;
+    CHECK(fabsf(fused - light) <= light * TOLERANCE + FLOOR);
+  }
+  CHECK(frame->flags & TCS3430_FRAME_VALID);
+  CHECK(!(frame->flags & TCS3430_FRAME_SATURATED));
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  // Without the dark offset the fused value should be the light itself
+  sim_light_t dark = {0, 0, 0, 0, 0};
+  sensor->setDarkOffset(dark);
+  CHECK(tcs.begin());
+  CHECK(tcs.setALSGain(TCS3430_GAIN_16X));
+
+  tcs3430_hdr_frame_t frame;
+  CHECK(hdr.poll(&frame) == TCS3430_POLL_IDLE);
+  CHECK(hdr.begin());
+  uint32_t range = hdr.getDynamicRange();
+  printf("  dynamic range %lu:1\n", (unsigned long)range);
+  CHECK(range >= MIN_RANGE);
+
+  // Coarse ramp from the high exposure's floor to near the low one's knee
+  bool changed;
+  uint32_t previous = 0;
+  uint16_t levels = 0;
+  for (float light = 0.01f; light < 850; light *= 1.5f) {
+    settle(light, &frame, &changed);
+    checkFused(&frame, light);
+    CHECK(frame.y > previous);
+    // A 1.5x step moves every exposure; the first level has no earlier
+    // read to compare with
+    CHECK(changed || levels == 0);
+    CHECK(!(frame.flags & TCS3430_FRAME_CHANGED));
+    previous = frame.y;
+    levels++;
+  }
+  printf("  %u levels from 0.01 to %.0f counts per step\n", levels,
+         frame.y / 65536.0);
+  // Dim: high exposure only; bright: low exposure only
+  settle(0.5f, &frame, &changed);
+  CHECK(frame.low_mask == 0);
+  settle(500, &frame, &changed);
+  CHECK(frame.low_mask == 0x0F);
+
+  // Fine ramp through the crossfade: no step where the source changes
+  uint16_t blended = 0;
+  for (float light = 3; light < 8; light += 0.1f) {
+    settle(light, &frame, &changed);
+    checkFused(&frame, light);
+    blended += frame.low_mask == 0x0F;
+  }
+  CHECK(blended > 0);
+
+  // Past the low exposure's knee the result is a lower bound
+  settle(1000, &frame, &changed);
+  CHECK(frame.flags & TCS3430_FRAME_SATURATED);
+  CHECK(frame.low_mask == 0x0F);
+
+  // The settings from before begin() are back
+  CHECK(hdr.end());
+  CHECK(hdr.poll(&frame) == TCS3430_POLL_IDLE);
+  CHECK(tcs.getALSGain() == TCS3430_GAIN_16X);
+  return hostTestResult("hdr_test");
+}
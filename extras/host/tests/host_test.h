@@ -0,0 +1,76 @@
+/*!
+ *  @file host_test.h
+ *
+ * 	Minimal harness for the host-only tests in this directory: a check
+ * 	macro that reports in the hw_tests TEST_PASS / TEST_FAIL format, and
+ * 	the simulated sensor every test talks to.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_HOST_TEST_H
+#define _ADAFRUIT_TCS3430_HOST_TEST_H
+
+#include <stdio.h>
+
+#include "Adafruit_TCS3430.h"
+#include "Arduino.h"
+#include "SimHost.h"
+#include "SimTCS3430.h"
+
+static int host_test_failures = 0; ///< Failed CHECK()s so far
+
+/*!
+ *    @brief  Record a failure, with its location, if cond is false
+ *    @param  cond Condition that must hold
+ */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("TEST_FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond);             \
+      host_test_failures++;                                                    \
+    }                                                                          \
+  } while (0)
+
+/*!
+ *    @brief  Put a simulated TCS3430 on the bus at its default address
+ *    @return The sensor
+ */
+static inline SimTCS3430* hostTestSensor() {
+  static SimTCS3430 sensor;
+  static bool added = false;
+  if (!added) {
+    SimHost::instance().addTarget(&sensor, TCS3430_DEFAULT_ADDR);
+    added = true;
+  }
+  return &sensor;
+}
+
+/*!
+ *    @brief  Set a scene with the same light on every channel
+ *    @param  counts Counts per 2.78 ms step at 1x gain
+ */
+static inline void hostTestLight(float counts) {
+  sim_light_t light = {counts, counts, counts, counts, counts};
+  SimHost::instance().setAmbient(light);
+}
+
+/*!
+ *    @brief  Print the overall result
+ *    @param  name Test name
+ *    @return Exit code for main()
+ */
+static inline int hostTestResult(const char* name) {
+  printf("%s: %s\n", host_test_failures ? "TEST_FAIL" : "TEST_PASS", name);
+  return host_test_failures ? 1 : 0;
+}
+
+#endif
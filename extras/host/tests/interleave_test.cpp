@@ -0,0 +1,135 @@
+/*!
+ *  @file interleave_test.cpp
+ *
+ * 	Interleaved X/IR2 acquisition on the simulated sensor: one
+ * 	five-channel frame per two cycles, matching the separately read X and
+ * 	IR2 channels, CHANGED where the light moved between the halves, a
+ * 	restart after a settings change or a failed mux flip, and WEN/WTIME
+ * 	put back by end() or a failed begin().
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Interleave.h"
+#include "host_test.h"
+
+#define ATIME 15     ///< 16 steps per integration
+#define RUN_MS 3000  ///< Steady light watched for this long
+#define STEP_MS 500  ///< After a light step, watched for this long
+#define POLL_US 200  ///< Time between poll() calls
+#define WTIME 7      ///< Wait left configured (but off) before begin()
+
+static Adafruit_TCS3430 tcs;
+static Adafruit_TCS3430_Interleave interleave(&tcs);
+
+/*!
+ *    @brief  Poll for a while and count the frames
+ *    @param  ms How long to run for
+ *    @param  last Set to the last frame, if any
+ *    @param  changed Set to the number of frames flagged CHANGED
+ *    @return Number of frames
+ */
+static uint16_t run(uint32_t ms, tcs3430_frame5_t* last, uint16_t* changed) {
+  uint16_t frames = 0;
+  *changed = 0;
+  uint32_t start = millis();
+  while (millis() - start < ms) {
+    tcs3430_frame5_t frame;
+    tcs3430_poll_t result = interleave.poll(&frame);
+    CHECK(result == TCS3430_POLL_READY || result == TCS3430_POLL_PENDING);
+    if (result == TCS3430_POLL_READY) {
+      CHECK(frame.flags & TCS3430_FRAME_VALID);
+      *changed += (frame.flags & TCS3430_FRAME_CHANGED) != 0;
+      *last = frame;
+      frames++;
+    }
+    delayMicroseconds(POLL_US);
+  }
+  return frames;
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  // Clear of a rounding boundary, so every read of a channel is the same
+  hostTestLight(40.3f);
+  CHECK(tcs.begin());
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  CHECK(!tcs.isWaitEnabled());
+
+  // X and IR2 read the slow way, for comparison
+  delay(200);
+  uint16_t x, y, z, ir1;
+  CHECK(tcs.getChannels(&x, &y, &z, &ir1));
+  uint16_t ir2 = tcs.getIR2();
+
+  tcs3430_frame5_t frame;
+  CHECK(interleave.poll(&frame) == TCS3430_POLL_IDLE);
+  CHECK(interleave.begin());
+  CHECK(tcs.isWaitEnabled());
+  uint32_t cycle = tcs.getCycleMicros();
+
+  // Every cycle is used: one frame per X/IR2 pair
+  uint16_t changed;
+  uint16_t frames = run(RUN_MS, &frame, &changed);
+  uint16_t expected = RUN_MS * 1000UL / (2 * cycle);
+  printf("  %u frames in %u ms (%u expected), %u changed\n", frames, RUN_MS,
+         expected, changed);
+  CHECK(frames + 1 >= expected && frames <= expected + 1);
+  CHECK(changed == 0);
+  CHECK(frame.x == x && frame.y == y && frame.z == z && frame.ir1 == ir1);
+  CHECK(frame.ir2 == ir2);
+
+  // A step in the light lands between two halves once
+  hostTestLight(80.3f);
+  frames = run(STEP_MS, &frame, &changed);
+  CHECK(frames > 0);
+  CHECK(changed == 1);
+  CHECK(frame.y > y);
+
+  // A settings change restarts the cycle, so no frame mixes the two
+  CHECK(tcs.setALSGain(TCS3430_GAIN_4X));
+  frames = run(STEP_MS, &frame, &changed);
+  CHECK(frames > 0);
+  CHECK(changed == 0);
+  // Twice the light at four times the gain
+  CHECK(frame.y > 6 * y);
+  CHECK(!(frame.flags & TCS3430_FRAME_SATURATED));
+
+  // A failed mux flip is reported, and the cycle starts over cleanly
+  sensor->failReads(TCS3430_REG_CFG1);
+  tcs3430_poll_t result = TCS3430_POLL_PENDING;
+  uint32_t start = millis();
+  while (result != TCS3430_POLL_ERROR && millis() - start < STEP_MS) {
+    result = interleave.poll(&frame);
+    delayMicroseconds(POLL_US);
+  }
+  CHECK(result == TCS3430_POLL_ERROR);
+  frames = run(STEP_MS, &frame, &changed);
+  CHECK(frames > 0);
+  CHECK(changed == 0);
+  CHECK(frame.y > 6 * y);
+
+  // The mux and the wait are put back
+  CHECK(interleave.end());
+  CHECK(interleave.poll(&frame) == TCS3430_POLL_IDLE);
+  CHECK(!tcs.getALSMUX_IR2());
+  CHECK(!tcs.isWaitEnabled());
+
+  // So are they when begin() fails after enabling the wait
+  CHECK(tcs.setWaitCycles(WTIME));
+  sensor->failReads(TCS3430_REG_CFG1);
+  CHECK(!interleave.begin());
+  CHECK(interleave.poll(&frame) == TCS3430_POLL_IDLE);
+  CHECK(!tcs.isWaitEnabled());
+  CHECK(tcs.getWaitCycles() == WTIME);
+  CHECK(tcs.isALSEnabled());
+  return hostTestResult("interleave_test");
+}
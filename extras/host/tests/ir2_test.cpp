@@ -0,0 +1,71 @@
+/*!
+ *  @file ir2_test.cpp
+ *
+ * 	IR2 measurements on the simulated sensor: startIR2() refuses to start
+ * 	when the mux state cannot be read, since it could not be put back,
+ * 	and getIR2() returns IR2 (not X) and the mux ends up on X again.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "host_test.h"
+
+#define ATIME 15        ///< 16 steps per integration
+#define X_LIGHT 40.3f   ///< Counts per step at 1x on X
+#define IR2_LIGHT 20.3f ///< Counts per step at 1x on IR2
+
+static Adafruit_TCS3430 tcs;
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  sim_light_t light = {X_LIGHT, X_LIGHT, X_LIGHT, X_LIGHT, IR2_LIGHT};
+  SimHost::instance().setAmbient(light);
+  CHECK(tcs.begin());
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  // Plus the simulated dark offsets, 5 on X and 2 on IR2
+  uint16_t x_counts = X_LIGHT * (ATIME + 1) + 5.0f + 0.5f;
+  uint16_t ir2_counts = IR2_LIGHT * (ATIME + 1) + 2.0f + 0.5f;
+
+  // begin() leaves the mux unknown; a failed CFG1 read must not start a
+  // measurement or touch the mux
+  uint32_t writes = sensor->registerWrites(TCS3430_REG_CFG1);
+  sensor->failReads(TCS3430_REG_CFG1);
+  CHECK(!tcs.startIR2());
+  CHECK(sensor->registerWrites(TCS3430_REG_CFG1) == writes);
+  tcs3430_frame_t frame;
+  CHECK(tcs.poll(&frame) == TCS3430_POLL_IDLE);
+  sensor->failReads(TCS3430_REG_CFG1);
+  CHECK(tcs.getIR2() == 0);
+  CHECK(!TCS3430_FIELD_AMUX::get(sensor->peek(TCS3430_REG_CFG1)));
+
+  // Once the mux can be read, IR2 is measured and X put back
+  CHECK(tcs.startIR2());
+  tcs3430_poll_t result;
+  while ((result = tcs.poll(&frame)) == TCS3430_POLL_PENDING) {
+    delay(1);
+  }
+  CHECK(result == TCS3430_POLL_READY);
+  CHECK(frame.flags & TCS3430_FRAME_CH3_IR2);
+  printf("  IR2 %u (expected %u)\n", frame.ch3, ir2_counts);
+  CHECK(frame.ch3 == ir2_counts);
+  CHECK(!TCS3430_FIELD_AMUX::get(sensor->peek(TCS3430_REG_CFG1)));
+
+  // The blocking wrapper gives the same, and a frame read failure gives 0
+  CHECK(tcs.getIR2() == ir2_counts);
+  sensor->failReads(TCS3430_REG_STATUS);
+  CHECK(tcs.getIR2() == 0);
+  CHECK(!TCS3430_FIELD_AMUX::get(sensor->peek(TCS3430_REG_CFG1)));
+  delay(200);
+  CHECK(tcs.readFrame(&frame));
+  CHECK(!(frame.flags & TCS3430_FRAME_CH3_IR2));
+  CHECK(frame.ch3 == x_counts);
+  return hostTestResult("ir2_test");
+}
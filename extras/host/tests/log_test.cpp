@@ -0,0 +1,239 @@
+/*!
+ *  @file log_test.cpp
+ *
+ * 	Binary frame log round trip: every record written must decode to the
+ * 	same frame, gain and ATIME, and a damaged, truncated or padded log
+ * 	must lose only the blocks that were actually hit.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Log.h"
+#include "host_test.h"
+
+#define FRAMES 500      ///< Records in the test log
+#define BLOCK_BYTES 128 ///< Writer block payload capacity
+#define LOG_BYTES 16384 ///< Room for the encoded log
+#define JUNK_BYTES 37   ///< Garbage inserted between two blocks
+
+/*!
+ *    @brief  Print sink that collects the log in memory
+ */
+class MemoryPrint : public Print {
+ public:
+  /*!
+   *    @brief  Store one byte
+   *    @param  c Byte
+   *    @return 1, or 0 when full
+   */
+  size_t write(uint8_t c) {
+    if (length >= LOG_BYTES) {
+      return 0;
+    }
+    data[length++] = c;
+    return 1;
+  }
+  using Print::write;
+
+  uint8_t data[LOG_BYTES]; ///< Bytes written so far
+  uint32_t length = 0;     ///< Number of them
+};
+
+static tcs3430_log_record_t records[FRAMES];
+static MemoryPrint sink;
+static uint8_t damaged[LOG_BYTES + JUNK_BYTES];
+
+static uint32_t rng = 1; ///< Frame generator state
+
+/*!
+ *    @brief  Next pseudo-random number
+ *    @param  limit Exclusive upper bound
+ *    @return 0 to limit - 1
+ */
+static uint32_t next(uint32_t limit) {
+  rng = rng * 1664525 + 1013904223;
+  return (rng >> 8) % limit;
+}
+
+/*!
+ *    @brief  Fill records[] with a plausible capture: small channel moves
+ *            with the odd jump, settings and flag changes now and then,
+ *            and a micros() wrap part way through
+ */
+static void makeRecords() {
+  uint32_t timestamp = 0xFFFFFFFF - 100 * 44480UL;
+  uint16_t channels[4] = {1200, 1500, 300, 1400};
+  tcs3430_gain_t gain = TCS3430_GAIN_16X;
+  uint8_t atime = 15;
+  for (uint16_t i = 0; i < FRAMES; i++) {
+    timestamp += 44480 + next(200);
+    if (next(50) == 0) {
+      timestamp += next(10000000);
+    }
+    for (uint8_t c = 0; c < 4; c++) {
+      int32_t value = channels[c] + (int32_t)next(41) - 20;
+      if (next(40) == 0) {
+        value = next(65536);
+      }
+      channels[c] = value < 0 ? 0 : value > 65535 ? 65535 : value;
+    }
+    if (next(60) == 0) {
+      gain = (tcs3430_gain_t)next(4);
+      atime = next(256);
+    }
+    tcs3430_log_record_t* r = &records[i];
+    memset(r, 0, sizeof(*r));
+    r->frame.timestamp = timestamp;
+    r->frame.z = channels[0];
+    r->frame.y = channels[1];
+    r->frame.ir1 = channels[2];
+    r->frame.ch3 = channels[3];
+    r->frame.status = next(8) == 0 ? 0x91 : 0x11;
+    r->frame.flags = TCS3430_FRAME_VALID | (next(20) == 0 ? 0x80 : 0);
+    r->gain = gain;
+    r->atime = atime;
+  }
+}
+
+/*!
+ *    @brief  Whether a decoded record matches one written
+ *    @param  a Decoded record
+ *    @param  b Written record
+ *    @return true if every field matches
+ */
+static bool same(const tcs3430_log_record_t* a,
+                 const tcs3430_log_record_t* b) {
+  return a->frame.timestamp == b->frame.timestamp && a->frame.z == b->frame.z &&
+         a->frame.y == b->frame.y && a->frame.ir1 == b->frame.ir1 &&
+         a->frame.ch3 == b->frame.ch3 && a->frame.status == b->frame.status &&
+         a->frame.flags == b->frame.flags && a->gain == b->gain &&
+         a->atime == b->atime;
+}
+
+/*!
+ *    @brief  Decode a log and check what comes out is records[] in order,
+ *            less a run of lost records
+ *    @param  data Log bytes
+ *    @param  length Log length
+ *    @param  lost_from First record expected to be lost
+ *    @param  lost Number of records expected to be lost
+ *    @param  reader Reader to decode with, left at the end of the log
+ */
+static void decode(const uint8_t* data, uint32_t length, uint16_t lost_from,
+                   uint16_t lost, Adafruit_TCS3430_LogReader* reader) {
+  CHECK(reader->begin(data, length));
+  CHECK(reader->getBlockCapacity() == BLOCK_BYTES);
+  tcs3430_log_record_t record;
+  uint16_t want = 0;
+  uint16_t decoded = 0;
+  bool exact = true;
+  while (reader->next(&record)) {
+    if (want == lost_from) {
+      want += lost;
+    }
+    if (want >= FRAMES || !same(&record, &records[want])) {
+      exact = false;
+      break;
+    }
+    want++;
+    decoded++;
+  }
+  CHECK(exact);
+  CHECK(decoded == FRAMES - lost);
+}
+
+/*!
+ *    @brief  Find a block in an encoded log
+ *    @param  index Block number, from 0
+ *    @param  offset Set to where the block starts
+ *    @param  first Set to the index of its first record
+ *    @return Number of records in the block
+ */
+static uint16_t findBlock(uint32_t index, uint32_t* offset, uint16_t* first) {
+  uint32_t pos = TCS3430_LOG_HEADER_SIZE;
+  *first = 0;
+  for (;;) {
+    uint16_t payload = sink.data[pos + 1] | (sink.data[pos + 2] << 8);
+    uint16_t count = sink.data[pos + 3] | (sink.data[pos + 4] << 8);
+    if (index-- == 0) {
+      *offset = pos;
+      return count;
+    }
+    pos += payload + TCS3430_LOG_BLOCK_OVERHEAD;
+    *first += count;
+  }
+}
+
+int main() {
+  makeRecords();
+
+  Adafruit_TCS3430_LogWriter<BLOCK_BYTES> writer;
+  CHECK(writer.begin(&sink));
+  for (uint16_t i = 0; i < FRAMES; i++) {
+    CHECK(writer.append(&records[i].frame, records[i].gain,
+                        records[i].atime));
+  }
+  CHECK(writer.flush());
+  CHECK(writer.getFrameCount() == FRAMES);
+  CHECK(writer.getBytesWritten() == sink.length);
+  printf("  %u frames in %u bytes, %.1f bytes per frame\n", FRAMES,
+         (unsigned)sink.length, (double)sink.length / FRAMES);
+  // Well under the 16 bytes of timestamp, channels, status and flags
+  CHECK(sink.length < FRAMES * 12);
+
+  // Clean round trip
+  Adafruit_TCS3430_LogReader reader;
+  decode(sink.data, sink.length, 0, 0, &reader);
+  uint32_t blocks = reader.getBlockCount();
+  CHECK(blocks > 10);
+  CHECK(reader.getSkippedBytes() == 0);
+
+  // rewind() starts over
+  reader.rewind();
+  tcs3430_log_record_t record;
+  CHECK(reader.next(&record) && same(&record, &records[0]));
+
+  // One flipped payload byte loses exactly the block it is in
+  uint32_t offset;
+  uint16_t first;
+  uint16_t count = findBlock(blocks / 2, &offset, &first);
+  memcpy(damaged, sink.data, sink.length);
+  damaged[offset + TCS3430_LOG_BLOCK_OVERHEAD] ^= 0x10;
+  decode(damaged, sink.length, first, count, &reader);
+  CHECK(reader.getBlockCount() == blocks - 1);
+  CHECK(reader.getSkippedBytes() > 0);
+
+  // So does a damaged length field
+  memcpy(damaged, sink.data, sink.length);
+  damaged[offset + 2] ^= 0x01;
+  decode(damaged, sink.length, first, count, &reader);
+
+  // A power cut part way through the last block loses only that block
+  count = findBlock(blocks - 1, &offset, &first);
+  decode(sink.data, offset + 10, first, count, &reader);
+  CHECK(reader.getSkippedBytes() == 10);
+
+  // Garbage between two blocks is skipped and counted
+  findBlock(blocks / 3, &offset, &first);
+  memcpy(damaged, sink.data, offset);
+  for (uint8_t i = 0; i < JUNK_BYTES; i++) {
+    damaged[offset + i] = i == 5 ? TCS3430_LOG_BLOCK_MARKER : next(256);
+  }
+  memcpy(damaged + offset + JUNK_BYTES, sink.data + offset,
+         sink.length - offset);
+  decode(damaged, sink.length + JUNK_BYTES, 0, 0, &reader);
+  CHECK(reader.getSkippedBytes() == JUNK_BYTES);
+
+  // Not a log at all
+  CHECK(!reader.begin(sink.data + 1, sink.length - 1));
+
+  return hostTestResult("log_test");
+}
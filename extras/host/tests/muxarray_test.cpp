@@ -0,0 +1,123 @@
+/*!
+ *  @file muxarray_test.cpp
+ *
+ * 	Mux array harvesting on the simulated bus: three sensors behind a
+ * 	TCA9548A, each seeing a different amount of light. After startAll()
+ * 	every sensor must deliver one frame per cycle, the first one taken
+ * 	after the auto-zero pass and integration that follow the restart.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_MuxArray.h"
+#include "SimTCA9548A.h"
+#include "host_test.h"
+
+#define SENSORS 3     ///< Sensors in the array
+#define ATIME 15      ///< 16 steps per integration
+#define HARVEST_MS 1000 ///< How long to collect frames for
+
+static SimTCA9548A mux;
+static SimTCS3430 sims[SENSORS];
+static Adafruit_TCS3430_MuxArray<SENSORS> array;
+
+/*!
+ *    @brief  Y a sensor should read once its integration ran entirely
+ *            under the given light
+ *    @param  index Sensor index
+ *    @param  counts Light in counts per step at 1x
+ *    @return Expected Y, dark offset included
+ */
+static uint32_t expectedY(uint8_t index, float counts) {
+  return (uint32_t)(counts * (index + 1) * (ATIME + 1) + 5.5f);
+}
+
+/*!
+ *    @brief  Restart the array, harvest for HARVEST_MS and check what each
+ *            sensor delivered
+ *    @param  counts Light the sensors are under
+ *    @param  noisy Whether the scene is noisy (else identical every cycle)
+ */
+static void harvestAll(float counts, bool noisy) {
+  uint32_t cycle = (uint32_t)(ATIME + 1) * TCS3430_STEP_MICROS;
+  uint32_t start = micros();
+  CHECK(array.startAll());
+  uint32_t last[SENSORS] = {0};
+  uint16_t frames[SENSORS] = {0};
+  uint16_t bad_gap = 0;
+  while (micros() - start < HARVEST_MS * 1000UL) {
+    tcs3430_frame_t frame;
+    uint8_t index;
+    if (!array.harvest(&frame, &index)) {
+      delayMicroseconds(200);
+      continue;
+    }
+    CHECK(index < SENSORS);
+    uint32_t want = expectedY(index, counts);
+    uint32_t slack = noisy ? want / 20 + 20 : 1;
+    if (frames[index] == 0) {
+      // The first frame must come from after the restart: auto-zero plus
+      // one integration
+      uint32_t after = frame.timestamp - start;
+      CHECK(after >= (TCS3430_AZ_STEPS + ATIME + 1) * TCS3430_STEP_MICROS);
+      CHECK(frame.y + slack >= want && frame.y <= want + slack);
+    } else {
+      // One frame per cycle: no duplicates, no skipped cycles
+      uint32_t gap = frame.timestamp - last[index];
+      if (gap < cycle / 2 || gap > cycle + cycle / 2) {
+        bad_gap++;
+      }
+      CHECK(frame.y + slack >= want && frame.y <= want + slack);
+    }
+    last[index] = frame.timestamp;
+    frames[index]++;
+  }
+
+  uint32_t expected = (HARVEST_MS * 1000UL -
+                       (uint32_t)TCS3430_AZ_STEPS * TCS3430_STEP_MICROS) /
+                      cycle;
+  printf("  %s, %5.1f: frames %u %u %u (expect %u), %u bad gaps\n",
+         noisy ? "noisy " : "static", counts, frames[0], frames[1],
+         frames[2], (unsigned)expected, bad_gap);
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    CHECK((uint32_t)frames[i] + 1 >= expected && frames[i] <= expected + 1);
+  }
+  CHECK(bad_gap == 0);
+}
+
+int main() {
+  SimHost& host = SimHost::instance();
+  host.addTarget(&mux, TCS3430_MUX_DEFAULT_ADDR);
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    sims[i].setLightScale(i + 1);
+    host.addTarget(&sims[i], TCS3430_DEFAULT_ADDR, &mux, i);
+  }
+
+  hostTestLight(20);
+  CHECK(array.begin());
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    CHECK(array.select(i));
+    CHECK(array.sensor(i)->setIntegrationCycles(ATIME));
+  }
+  delay(500);
+
+  // A new scene just before the restart: nothing from before may leak in
+  hostTestLight(50);
+  harvestAll(50, false);
+
+  for (uint8_t i = 0; i < SENSORS; i++) {
+    sims[i].setNoise(3, i + 1);
+  }
+  hostTestLight(80);
+  harvestAll(80, true);
+
+  return hostTestResult("muxarray_test");
+}
@@ -0,0 +1,144 @@
+/*!
+ *  @file resume_test.cpp
+ *
+ * 	resume() on the simulated sensor: a chip that still holds the
+ * 	snapshot is MATCHED with one burst read and no writes; one that lost
+ * 	it to a power cycle, or had a register changed by another bus master,
+ * 	is RESTORED with only the differing registers written; a corrupt
+ * 	snapshot or a bus error is FAILED.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Wire.h"
+#include "host_test.h"
+
+#define ATIME 35      ///< Integration steps - 1 in the snapshot
+#define LIGHT 40.3f   ///< Counts per step at 1x
+#define SETTLE_MS 400 ///< Long enough for a fresh integration
+
+/** Registers in a snapshot, in TCS3430_CHANGED_* order */
+static const uint8_t regs[TCS3430_CONFIG_REGS] = {
+    TCS3430_REG_ENABLE,    TCS3430_REG_ATIME,   TCS3430_REG_WTIME,
+    TCS3430_REG_AILTL,     TCS3430_REG_AILTH,   TCS3430_REG_AIHTL,
+    TCS3430_REG_AIHTH,     TCS3430_REG_PERS,    TCS3430_REG_CFG0,
+    TCS3430_REG_CFG1,      TCS3430_REG_CFG2,    TCS3430_REG_CFG3,
+    TCS3430_REG_AZ_CONFIG, TCS3430_REG_INTENAB};
+
+static SimTCS3430* sensor;
+static tcs3430_snapshot_t snapshot;
+
+/*!
+ *    @brief  Total bus writes to the snapshot registers
+ *    @return Count since the sensor was last reset
+ */
+static uint32_t configWrites() {
+  uint32_t writes = 0;
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    writes += sensor->registerWrites(regs[i]);
+  }
+  return writes;
+}
+
+/*!
+ *    @brief  Check the chip holds the snapshot
+ */
+static void checkChip() {
+  for (uint8_t i = 0; i < TCS3430_CONFIG_REGS; i++) {
+    CHECK(sensor->peek(regs[i]) == snapshot.regs[i]);
+  }
+}
+
+/*!
+ *    @brief  Resume with a fresh driver, as after an MCU reset
+ *    @param  transactions Set to the bus transactions it took
+ *    @return resume() result
+ */
+static tcs3430_resume_t wake(uint32_t* transactions) {
+  Adafruit_TCS3430 tcs;
+  uint32_t before = Wire.transactions();
+  tcs3430_resume_t result = tcs.resume(&snapshot);
+  *transactions = Wire.transactions() - before;
+  if (result != TCS3430_RESUME_FAILED) {
+    // The driver is usable straight away, and knows the mux
+    CHECK(tcs.getALSGain() == TCS3430_GAIN_16X);
+    CHECK(tcs.getIntegrationCycles() == ATIME);
+    delay(SETTLE_MS);
+    tcs3430_frame_t frame;
+    CHECK(tcs.readFrame(&frame));
+    CHECK(frame.flags & TCS3430_FRAME_VALID);
+    CHECK(frame.y > LIGHT * (ATIME + 1) * 16 * 0.9f);
+  }
+  return result;
+}
+
+int main() {
+  sensor = hostTestSensor();
+  hostTestLight(LIGHT);
+  {
+    Adafruit_TCS3430 tcs;
+    CHECK(tcs.begin());
+    CHECK(tcs.setALSGain(TCS3430_GAIN_16X));
+    CHECK(tcs.setIntegrationCycles(ATIME));
+    CHECK(tcs.setALSThresholds(100, 20000));
+    CHECK(tcs.setInterruptPersistence(TCS3430_PERS_3));
+    CHECK(tcs.saveSnapshot(&snapshot));
+  }
+
+  // Chip untouched: one 17-byte burst (address, then data), no writes
+  uint32_t writes = configWrites();
+  uint32_t transactions;
+  CHECK(wake(&transactions) == TCS3430_RESUME_MATCHED);
+  printf("  matched: %lu transactions\n", (unsigned long)transactions);
+  CHECK(transactions == 2);
+  CHECK(configWrites() == writes);
+
+  // Power cycle: everything is back at reset values and is rewritten
+  sensor->reset();
+  CHECK(wake(&transactions) == TCS3430_RESUME_RESTORED);
+  printf("  restored after power cycle: %lu transactions, %lu writes\n",
+         (unsigned long)transactions, (unsigned long)configWrites());
+  checkChip();
+  CHECK(configWrites() > 0);
+
+  // ATIME changed by another master: only ATIME is rewritten, with AEN
+  // dropped around it
+  Wire.beginTransmission(TCS3430_DEFAULT_ADDR);
+  Wire.write(TCS3430_REG_ATIME);
+  Wire.write(ATIME + 1);
+  CHECK(Wire.endTransmission() == 0);
+  uint32_t atime = sensor->registerWrites(TCS3430_REG_ATIME);
+  uint32_t enable = sensor->registerWrites(TCS3430_REG_ENABLE);
+  writes = configWrites();
+  CHECK(wake(&transactions) == TCS3430_RESUME_RESTORED);
+  checkChip();
+  CHECK(sensor->registerWrites(TCS3430_REG_ATIME) == atime + 1);
+  CHECK(sensor->registerWrites(TCS3430_REG_ENABLE) == enable + 2);
+  CHECK(configWrites() == writes + 3);
+
+  // And matched again after that
+  CHECK(wake(&transactions) == TCS3430_RESUME_MATCHED);
+  CHECK(transactions == 2);
+
+  // A corrupt snapshot is refused without touching the bus
+  snapshot.regs[1]++;
+  CHECK(wake(&transactions) == TCS3430_RESUME_FAILED);
+  CHECK(transactions == 0);
+  snapshot.regs[1]--;
+
+  // So is a failed read, with nothing written
+  writes = configWrites();
+  sensor->failReads(TCS3430_REG_ENABLE);
+  CHECK(wake(&transactions) == TCS3430_RESUME_FAILED);
+  CHECK(configWrites() == writes);
+  CHECK(wake(&transactions) == TCS3430_RESUME_MATCHED);
+  return hostTestResult("resume_test");
+}
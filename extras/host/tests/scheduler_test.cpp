@@ -0,0 +1,161 @@
+/*!
+ *  @file scheduler_test.cpp
+ *
+ * 	Read scheduling against a sensor whose oscillator is off nominal: the
+ * 	scheduler must learn the real cycle length and then read every
+ * 	integration exactly once, shortly after it ends, with about one bus
+ * 	transaction per sample. Covers changing and static scenes.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Scheduler.h"
+#include "Wire.h"
+#include "host_test.h"
+
+#define ATIME 15             ///< 16 steps per integration
+#define LEARN_MS 1000        ///< Time allowed to lock on
+#define RUN_MS 3000          ///< Time each scenario runs for
+#define MEAN_LATENCY_US 1500 ///< Integration end to read completed: one
+                             ///< 1.1 ms frame read at 100 kHz, plus margin
+#define MAX_LATENCY_US 3500  ///< The same for a bracketing sample: a read of
+                             ///< old data, a short gap and a read of new
+
+/*!
+ *    @brief  Sample with the scheduler for RUN_MS and check the samples
+ *            taken after the first learn_ms
+ *    @param  tcs Driver
+ *    @param  scheduler Scheduler reading it
+ *    @param  sensor Simulated sensor
+ *    @param  ppm Oscillator error the sensor has
+ *    @param  noisy true for a scene that changes every cycle, false for a
+ *            static one
+ *    @param  learn_ms Time allowed to lock on
+ */
+static void schedule(Adafruit_TCS3430* tcs,
+                     Adafruit_TCS3430_Scheduler* scheduler, SimTCS3430* sensor,
+                     int32_t ppm, bool noisy, uint32_t learn_ms) {
+  sensor->setNoise(noisy ? 3 : 0, 7);
+  uint32_t start = millis();
+  bool locked = false;
+  uint32_t last_cycle = 0;
+  uint16_t samples = 0, repeated = 0, skipped = 0;
+  uint32_t total = 0, worst = 0;
+  while (millis() - start < RUN_MS) {
+    int32_t wait = (int32_t)(scheduler->nextSampleAt() - micros());
+    if (wait > 0) {
+      delayMicroseconds(wait);
+    }
+    tcs3430_frame_t frame;
+    tcs3430_poll_t result = scheduler->poll(&frame);
+    CHECK(result != TCS3430_POLL_ERROR);
+    if (result != TCS3430_POLL_READY) {
+      continue;
+    }
+    uint32_t cycle = sensor->completedCycles();
+    if (!locked) {
+      if (millis() - start >= learn_ms) {
+        locked = true;
+        Wire.resetCounters();
+        last_cycle = cycle;
+      }
+      continue;
+    }
+    samples++;
+    if (cycle == last_cycle) {
+      repeated++;
+    } else if (cycle != last_cycle + 1) {
+      skipped++;
+    }
+    last_cycle = cycle;
+    uint32_t latency = frame.timestamp - (uint32_t)sensor->lastCycleEnd();
+    total += latency;
+    if (latency > worst) {
+      worst = latency;
+    }
+  }
+
+  double actual = tcs->getCycleMicros() * (1 + ppm * 1e-6);
+  double learned = scheduler->getLearnedCycleMicros();
+  // A frame read is a register write and a 9-byte read
+  double per_sample = samples ? Wire.transactions() / 2.0 / samples : 0;
+  uint32_t mean = samples ? total / samples : 0;
+  printf("  %+6d ppm %s: cycle %.0f us, learned %.0f us; %u samples, "
+         "%u repeated, %u skipped, latency %u us (worst %u), "
+         "%.2f reads each\n",
+         (int)ppm, noisy ? "noisy " : "static", actual, learned, samples,
+         repeated, skipped, (unsigned)mean, (unsigned)worst, per_sample);
+  CHECK(learned >= actual * 0.999 && learned <= actual * 1.001);
+  int32_t expected = (RUN_MS - learn_ms) * 1000.0 / actual;
+  CHECK(samples + 2 >= expected && samples <= expected + 1);
+  CHECK(per_sample <= 1.25);
+  // Identical data cannot show which integration was read, so only a
+  // changing scene says whether each was read once and promptly
+  if (noisy) {
+    CHECK(repeated == 0);
+    CHECK(skipped == 0);
+    CHECK(mean <= MEAN_LATENCY_US);
+    CHECK(worst <= MAX_LATENCY_US);
+  }
+}
+
+/*!
+ *    @brief  Learn a sensor's cycle from a changing scene, then carry on
+ *            with a static one, where only the prediction says when data
+ *            is new, then restart the cycle
+ *    @param  sensor Simulated sensor
+ *    @param  ppm Oscillator error to give it
+ */
+static void oscillator(SimTCS3430* sensor, int32_t ppm) {
+  sensor->setClockSkew(ppm);
+  Adafruit_TCS3430 tcs;
+  CHECK(tcs.begin());
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  Adafruit_TCS3430_Scheduler scheduler(&tcs);
+  schedule(&tcs, &scheduler, sensor, ppm, true, LEARN_MS);
+  // Goes on from where the changing scene left off
+  schedule(&tcs, &scheduler, sensor, ppm, false, 0);
+  // A restart is a known boundary: the end of the integration it starts
+  // is read straight away, without searching for it
+  sensor->setNoise(3, 7);
+  CHECK(scheduler.restartCycle());
+  uint32_t restarted = micros();
+  tcs3430_frame_t frame;
+  tcs3430_poll_t result;
+  while ((result = scheduler.poll(&frame)) == TCS3430_POLL_PENDING) {
+    int32_t wait = (int32_t)(scheduler.nextSampleAt() - micros());
+    if (wait > 0) {
+      delayMicroseconds(wait);
+    }
+  }
+  CHECK(result == TCS3430_POLL_READY);
+  uint32_t latency = frame.timestamp - (uint32_t)sensor->lastCycleEnd();
+  printf("  %+6d ppm restart: first sample after %lu us, latency %lu us\n",
+         (int)ppm, (unsigned long)(frame.timestamp - restarted),
+         (unsigned long)latency);
+  // The auto-zero pass, one integration and a bracketing sample
+  uint32_t first =
+      TCS3430_AZ_STEPS * TCS3430_STEP_MICROS + tcs.getCycleMicros();
+  CHECK(frame.timestamp - restarted <= first + MAX_LATENCY_US);
+  CHECK(latency <= MAX_LATENCY_US);
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  // Clear of a rounding boundary, so without noise every read is the same
+  hostTestLight(20.3f);
+
+  oscillator(sensor, 0);
+  oscillator(sensor, 8000);
+  oscillator(sensor, -12000);
+
+  return hostTestResult("scheduler_test");
+}
@@ -0,0 +1,108 @@
+/*!
+ *  @file settle_test.cpp
+ *
+ * 	Fresh-data tracking on the simulated sensor: after power-up the
+ * 	auto-zero pass must be waited out, and after a change from a long
+ * 	integration to a short one, startFrame()/poll() and isSettling() must
+ * 	wait out the long integration still running, even when nothing asked
+ * 	about freshness before the change, and across several changes in a
+ * 	row.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "host_test.h"
+
+#define LIGHT 4.3f      ///< Counts per step at 1x
+#define LONG_ATIME 255  ///< 711 ms integration
+#define SHORT_ATIME 0   ///< 2.78 ms integration
+#define POLL_US 500     ///< Time between poll() calls
+
+static Adafruit_TCS3430 tcs;
+
+/*!
+ *    @brief  Wait for the first frame integrated entirely after the last
+ *            change
+ *    @param  frame Filled in
+ *    @return Time it took, in microseconds
+ */
+static uint32_t freshFrame(tcs3430_frame_t* frame) {
+  uint32_t start = micros();
+  CHECK(tcs.startFrame());
+  tcs3430_poll_t result;
+  while ((result = tcs.poll(frame)) == TCS3430_POLL_PENDING) {
+    delayMicroseconds(POLL_US);
+  }
+  CHECK(result == TCS3430_POLL_READY);
+  return micros() - start;
+}
+
+/*!
+ *    @brief  Check a frame came from a short integration
+ *    @param  frame Frame
+ */
+static void checkShort(const tcs3430_frame_t* frame) {
+  uint16_t expected = LIGHT * (SHORT_ATIME + 1) + 5.5f + 0.5f;
+  printf("  z=%u (expected %u)\n", frame->z, expected);
+  CHECK(frame->z == expected);
+  CHECK(frame->flags & TCS3430_FRAME_VALID);
+}
+
+int main() {
+  hostTestSensor();
+  hostTestLight(LIGHT);
+  CHECK(tcs.begin());
+  uint32_t long_cycle = (LONG_ATIME + 1) * TCS3430_STEP_MICROS;
+
+  // From power-up the auto-zero pass runs first, and is longer than the
+  // cycle
+  tcs3430_frame_t frame;
+  uint32_t took = freshFrame(&frame);
+  printf("  power-up: fresh after %lu us\n", (unsigned long)took);
+  CHECK(took >= (uint32_t)(TCS3430_AZ_STEPS + 1) * TCS3430_STEP_MICROS);
+  checkShort(&frame);
+
+  // Long to short with nothing asking about freshness in between: the
+  // long integration under way when ATIME changes must not count
+  CHECK(tcs.setIntegrationCycles(LONG_ATIME));
+  delay(2000);
+  CHECK(tcs.readFrame(&frame));
+  CHECK(frame.z > 1000);
+  CHECK(tcs.setIntegrationCycles(SHORT_ATIME));
+  CHECK(tcs.isSettling());
+  took = freshFrame(&frame);
+  printf("  long to short: fresh after %lu us\n", (unsigned long)took);
+  CHECK(took >= long_cycle / 2);
+  checkShort(&frame);
+  CHECK(!tcs.isSettling());
+
+  // Long, then two quick changes: the long integration may still be
+  // running at the last one
+  CHECK(tcs.setIntegrationCycles(LONG_ATIME));
+  delay(2000);
+  CHECK(tcs.setIntegrationCycles(SHORT_ATIME + 10));
+  delay(5);
+  CHECK(tcs.setIntegrationCycles(SHORT_ATIME));
+  took = freshFrame(&frame);
+  printf("  long, then two changes: fresh after %lu us\n", (unsigned long)took);
+  CHECK(took >= long_cycle / 2);
+  checkShort(&frame);
+
+  // Once a short cycle is running, a change waits for short cycles only
+  delay(100);
+  CHECK(tcs.setALSGain(TCS3430_GAIN_4X));
+  CHECK(tcs.setALSGain(TCS3430_GAIN_1X));
+  took = freshFrame(&frame);
+  printf("  short to short: fresh after %lu us\n", (unsigned long)took);
+  CHECK(took <= 3 * TCS3430_STEP_MICROS);
+  checkShort(&frame);
+  return hostTestResult("settle_test");
+}
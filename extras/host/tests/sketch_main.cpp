@@ -0,0 +1,58 @@
+/*!
+ *  @file sketch_main.cpp
+ *
+ * 	Runs one unmodified hw_tests sketch against the simulated rig: a
+ * 	TCS3430 at its default address with INT wired to pin 2, and the
+ * 	NeoPixel ring shining on it. Passes if the sketch prints TEST_PASS and
+ * 	never TEST_FAIL.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <stdio.h>
+
+#include "Adafruit_TCS3430.h"
+#include "Arduino.h"
+#include "SimHost.h"
+#include "SimTCS3430.h"
+#include "Wire.h"
+
+#define RIG_INT_PIN 2     ///< INT wiring used by every hw_tests sketch
+#define RIG_BOOT_MS 1000  ///< Reset to setup(), bootloader included
+
+void setup();
+void loop();
+
+static SimTCS3430 sensor;
+
+int main() {
+  SimHost& host = SimHost::instance();
+  host.addTarget(&sensor, TCS3430_DEFAULT_ADDR);
+  sensor.connectInterrupt(RIG_INT_PIN);
+
+  // The rig's sensor stays powered across sketch uploads, so it is already
+  // running (at its reset configuration) when the new sketch boots
+  Wire.beginTransmission(TCS3430_DEFAULT_ADDR);
+  Wire.write(TCS3430_REG_ENABLE);
+  Wire.write(0x03);
+  Wire.endTransmission();
+  delay(RIG_BOOT_MS);
+  Wire.resetCounters();
+
+  setup();
+  loop();
+
+  const char* out = Serial.output();
+  bool pass = strstr(out, "TEST_PASS") && !strstr(out, "TEST_FAIL");
+  printf("[%s after %.3f s virtual, %u integrations]\n", pass ? "PASS" : "FAIL",
+         host.now() / 1e6, (unsigned)sensor.completedCycles());
+  return pass ? 0 : 1;
+}
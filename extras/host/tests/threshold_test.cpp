@@ -0,0 +1,146 @@
+/*!
+ *  @file threshold_test.cpp
+ *
+ * 	Threshold tracking with INT-driven capture on the simulated sensor:
+ * 	the window has to centre itself on CH0 after the first interrupt and
+ * 	then only fire, and only fill the ring, when the light moves out of
+ * 	the band, even when the read after an interrupt fails.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "host_test.h"
+
+#define INT_PIN 2     ///< Simulated INT wiring
+#define ATIME 15      ///< 16 steps per integration
+#define BAND_PCT 10   ///< Half-width of the tracking band
+#define BAND_MIN 50   ///< Smallest half-width in counts
+#define QUIET_MS 1000 ///< How long a steady scene is watched for
+
+static Adafruit_TCS3430 tcs;
+static Adafruit_TCS3430_Ring<tcs3430_frame_t, 16> ring;
+
+/*!
+ *    @brief  INT handler
+ */
+static void onSensorInt() {
+  tcs.handleInterrupt();
+}
+
+/*!
+ *    @brief  Z the sensor reads under the given light
+ *    @param  counts Light in counts per step at 1x
+ *    @return Expected CH0, dark offset included, rounded like the ADC
+ */
+static uint16_t expectedZ(float counts) {
+  return (uint16_t)(counts * (ATIME + 1) + 5.5f + 0.5f);
+}
+
+/*!
+ *    @brief  Service the sensor for a while and collect what it captured
+ *    @param  ms How long to run for
+ *    @param  last Set to the last frame captured, if any
+ *    @return Number of frames captured
+ */
+static uint16_t run(uint32_t ms, tcs3430_frame_t* last) {
+  uint16_t frames = 0;
+  uint32_t start = millis();
+  while (millis() - start < ms) {
+    delayMicroseconds(500);
+    tcs.service();
+    tcs3430_frame_t frame;
+    while (ring.pop(&frame)) {
+      *last = frame;
+      frames++;
+    }
+  }
+  return frames;
+}
+
+/*!
+ *    @brief  Check the window is centred on a CH0 reading
+ *    @param  ch0 CH0 it should be centred on
+ */
+static void checkWindow(uint16_t ch0) {
+  uint16_t half = ch0 * BAND_PCT / 100;
+  if (half < BAND_MIN) {
+    half = BAND_MIN;
+  }
+  uint16_t low = tcs.getALSThresholdLow();
+  uint16_t high = tcs.getALSThresholdHigh();
+  printf("  Z=%5u: window %5u..%5u\n", ch0, low, high);
+  CHECK(low == (ch0 > half ? ch0 - half : 0));
+  CHECK(high == ch0 + half);
+}
+
+/*!
+ *    @brief  Change the light and check exactly one frame reports it, the
+ *            window follows, and a steady scene then stays quiet
+ *    @param  counts New light in counts per step at 1x
+ */
+static void moveTo(float counts) {
+  hostTestLight(counts);
+  tcs3430_frame_t frame;
+  uint16_t frames = run(QUIET_MS, &frame);
+  CHECK(frames == 1);
+  if (frames) {
+    CHECK(frame.z == expectedZ(counts));
+    checkWindow(frame.z);
+  }
+  CHECK(run(QUIET_MS, &frame) == 0);
+}
+
+int main() {
+  SimTCS3430* sensor = hostTestSensor();
+  sensor->connectInterrupt(INT_PIN);
+  hostTestLight(100);
+
+  CHECK(tcs.begin());
+  CHECK(tcs.setALSGain(TCS3430_GAIN_1X));
+  CHECK(tcs.setIntegrationCycles(ATIME));
+  CHECK(tcs.setInterruptPersistence(TCS3430_PERS_2));
+  CHECK(tcs.setThresholdTracking(BAND_PCT, BAND_MIN));
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), onSensorInt, RISING);
+  CHECK(tcs.beginCapture(&ring, false));
+
+  // The inverted window fires once and centres itself on the scene
+  tcs3430_frame_t frame;
+  CHECK(run(QUIET_MS, &frame) == 1);
+  CHECK(frame.z == expectedZ(100));
+  checkWindow(frame.z);
+  CHECK(run(QUIET_MS, &frame) == 0);
+
+  // Moves inside the band stay quiet
+  hostTestLight(105);
+  CHECK(run(QUIET_MS, &frame) == 0);
+  hostTestLight(95);
+  CHECK(run(QUIET_MS, &frame) == 0);
+
+  // Moves out of it fire once each, up or down
+  moveTo(130);
+  moveTo(60);
+  // In the dark the band is BAND_MIN wide, so noise does not fire
+  moveTo(0);
+  sensor->setNoise(5, 1);
+  CHECK(run(QUIET_MS, &frame) == 0);
+  sensor->setNoise(0);
+  moveTo(200);
+
+  // A failed frame read leaves INT asserted, so no new edge comes: the
+  // interrupt has to be retried, not dropped
+  sensor->failReads(TCS3430_REG_STATUS);
+  moveTo(100);
+
+  CHECK(tcs.getMissedInterrupts() == 0);
+  tcs.endCapture();
+  return hostTestResult("threshold_test");
+}
@@ -0,0 +1,185 @@
+/*!
+ *  @file transport_test.cpp
+ *
+ * 	The driver over its other transports: Linux i2c-dev (through the fake
+ * 	adapter in SimI2CDev, with and without plain I2C support) and the
+ * 	queued asynchronous backend. Each must read the same frames as the
+ * 	Wire transport; the queue must run transfers in order, one per
+ * 	service() call, and keep readFrameAsync() off the bus until then.
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_TCS3430_Async.h"
+#include "SimI2CDev.h"
+#include "Wire.h"
+#include "host_test.h"
+
+static Adafruit_TCS3430 reference; ///< The same sensor over Wire
+static uint8_t order[4];            ///< Transfer callbacks, in call order
+static uint8_t completed = 0;       ///< Number of them
+static uint8_t failed = 0;          ///< Callbacks with ok false
+
+/*!
+ *    @brief  Whether two frames carry the same data
+ *    @param  a First frame
+ *    @param  b Second frame
+ *    @return true if status and every channel match
+ */
+static bool sameData(const tcs3430_frame_t* a, const tcs3430_frame_t* b) {
+  return a->z == b->z && a->y == b->y && a->ir1 == b->ir1 &&
+         a->ch3 == b->ch3 && a->status == b->status;
+}
+
+/*!
+ *    @brief  Read a frame through a driver and compare it with the Wire
+ *            driver's reading of the same integration
+ *    @param  tcs Driver under test
+ */
+static void checkFrame(Adafruit_TCS3430* tcs) {
+  tcs3430_frame_t got, want;
+  CHECK(tcs->readFrame(&got));
+  CHECK(reference.readFrame(&want));
+  CHECK(got.flags & TCS3430_FRAME_VALID);
+  CHECK(sameData(&got, &want));
+}
+
+/*!
+ *    @brief  Run the driver over a fake i2c-dev adapter
+ *    @param  smbus_only Adapter without plain I2C, like i2c-stub
+ */
+static void linuxI2C(bool smbus_only) {
+  SimI2CDev dev(TCS3430_DEFAULT_ADDR, smbus_only);
+  Adafruit_TCS3430 tcs;
+  CHECK(tcs.begin(&dev));
+  CHECK(dev.isCombined() == !smbus_only);
+
+  // Writes land on the chip
+  CHECK(tcs.setALSGain(TCS3430_GAIN_16X));
+  CHECK(reference.getALSGain() == TCS3430_GAIN_16X);
+  CHECK(tcs.setIntegrationCycles(31));
+  CHECK(reference.getIntegrationCycles() == 31);
+  delay(300);
+
+  // The first frame also reads AMUX; after that, one ioctl per burst
+  // either way
+  checkFrame(&tcs);
+  uint32_t before = dev.ioctls();
+  checkFrame(&tcs);
+  CHECK(dev.ioctls() == before + 1);
+}
+
+/*!
+ *    @brief  Record a finished transfer
+ *    @param  transfer The transfer; its context holds its tag
+ *    @param  ok Whether it succeeded
+ */
+static void transferDone(tcs3430_transfer_t* transfer, bool ok) {
+  order[completed++] = *(uint8_t*)transfer->context;
+  failed += !ok;
+}
+
+/*!
+ *    @brief  Record a finished readFrameAsync()
+ *    @param  frame Frame, filled in when ok
+ *    @param  ok Whether the burst succeeded
+ *    @param  context Call counter
+ */
+static void frameDone(tcs3430_frame_t* frame, bool ok, void* context) {
+  (void)frame;
+  (*(uint8_t*)context)++;
+  failed += !ok;
+}
+
+/*!
+ *    @brief  Run the driver over the queued backend
+ */
+static void async() {
+  Adafruit_TCS3430_BusIO wire_bus(TCS3430_DEFAULT_ADDR);
+  Adafruit_TCS3430_AsyncLoop queue(&wire_bus);
+  Adafruit_TCS3430 tcs;
+  // Blocking calls drain the queue themselves
+  CHECK(tcs.begin(&queue));
+  CHECK(tcs.setIntegrationCycles(15));
+  delay(100);
+  checkFrame(&tcs);
+  CHECK(queue.isIdle());
+
+  // Nothing touches the bus until service()
+  tcs3430_frame_t frame, want;
+  uint8_t calls = 0;
+  failed = 0;
+  Wire.resetCounters();
+  CHECK(tcs.readFrameAsync(&frame, frameDone, &calls));
+  CHECK(tcs.isFrameAsyncPending());
+  CHECK(!tcs.readFrameAsync(&frame, frameDone, &calls));
+  CHECK(Wire.transactions() == 0);
+  CHECK(!queue.isIdle());
+  queue.service();
+  CHECK(calls == 1 && failed == 0);
+  CHECK(!tcs.isFrameAsyncPending());
+  CHECK(reference.readFrame(&want));
+  CHECK(sameData(&frame, &want));
+
+  // A blocking call queues behind a pending burst and finishes it first
+  CHECK(tcs.readFrameAsync(&frame, frameDone, &calls));
+  CHECK(tcs.getIntegrationCycles() == 15);
+  CHECK(calls == 2 && failed == 0);
+  CHECK(queue.isIdle());
+
+  // Submitted transfers run in order, one per service()
+  uint8_t tags[3] = {0, 1, 2};
+  uint8_t id = 0, atime = 0, gain = TCS3430_GAIN_64X;
+  tcs3430_transfer_t transfers[3] = {
+      {TCS3430_REG_ID, 1, false, &id, transferDone, &tags[0], NULL},
+      {TCS3430_REG_CFG1, 1, true, &gain, transferDone, &tags[1], NULL},
+      {TCS3430_REG_ATIME, 1, false, &atime, transferDone, &tags[2], NULL}};
+  completed = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(queue.submit(&transfers[i]));
+  }
+  for (uint8_t i = 0; i < 3; i++) {
+    CHECK(completed == i);
+    queue.service();
+  }
+  CHECK(completed == 3 && failed == 0);
+  CHECK(order[0] == 0 && order[1] == 1 && order[2] == 2);
+  CHECK(id == 0xDC);
+  CHECK(atime == 15);
+  CHECK(reference.getALSGain() == TCS3430_GAIN_64X);
+  CHECK(queue.isIdle());
+
+  // A sensor that does not answer fails the burst, not the queue
+  Adafruit_TCS3430_BusIO absent_bus(TCS3430_DEFAULT_ADDR + 1);
+  Adafruit_TCS3430_AsyncLoop absent(&absent_bus);
+  completed = 0;
+  CHECK(absent.submit(&transfers[0]));
+  absent.service();
+  CHECK(completed == 1 && failed == 1);
+  CHECK(absent.isIdle());
+}
+
+int main() {
+  hostTestSensor();
+  hostTestLight(40);
+  CHECK(reference.begin());
+
+  linuxI2C(false);
+  linuxI2C(true);
+
+  // No sensor at that address
+  SimI2CDev nobody(TCS3430_DEFAULT_ADDR + 1);
+  Adafruit_TCS3430 missing;
+  CHECK(!missing.begin(&nobody));
+
+  async();
+  return hostTestResult("transport_test");
+}
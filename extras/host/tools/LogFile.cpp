@@ -0,0 +1,74 @@
+/*!
+ *  @file LogFile.cpp
+ *
+ * 	Read-only memory mapping of a binary frame log
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "LogFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*!
+ *    @brief  Unmaps the file
+ */
+LogFile::~LogFile() {
+  close();
+}
+
+/*!
+ *    @brief  Map a log and check its header. The pages are read in by the
+ *            kernel as records are decoded; the file is never copied.
+ *    @param  path Log file
+ *    @return false if the file cannot be mapped, is over 4 GB or is not a
+ *            log of a known version
+ */
+bool LogFile::open(const char* path) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0 || st.st_size > UINT32_MAX) {
+    ::close(fd);
+    return false;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  // Records are decoded front to back
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  _data = (const uint8_t*)map;
+  _length = st.st_size;
+  if (!_reader.begin(_data, _length)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Unmap the file, if one is open
+ */
+void LogFile::close() {
+  if (_data) {
+    munmap((void*)_data, _length);
+    _data = NULL;
+    _length = 0;
+  }
+}
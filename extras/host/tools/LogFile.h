@@ -0,0 +1,54 @@
+/*!
+ *  @file LogFile.h
+ *
+ * 	Read-only memory mapping of a binary frame log, for decoding on a Linux
+ * 	host with Adafruit_TCS3430_LogReader without copying the file
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_TCS3430_LOGFILE_H
+#define _ADAFRUIT_TCS3430_LOGFILE_H
+
+#include "Adafruit_TCS3430_Log.h"
+
+/*!
+ *    @brief  A log file mapped into memory, with a reader over it
+ */
+class LogFile {
+ public:
+  ~LogFile();
+
+  bool open(const char* path);
+  void close();
+
+  /*!
+   *    @brief  Reader over the mapped bytes, valid until close()
+   *    @return The reader
+   */
+  Adafruit_TCS3430_LogReader* reader() {
+    return &_reader;
+  }
+  /*!
+   *    @brief  Mapped file length
+   *    @return Bytes
+   */
+  uint32_t length() {
+    return _length;
+  }
+
+ private:
+  const uint8_t* _data = NULL;        ///< Mapping, NULL when closed
+  uint32_t _length = 0;               ///< Mapping length
+  Adafruit_TCS3430_LogReader _reader; ///< Reader over the mapping
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*!
+ *  @file tcs3430_log.cpp
+ *
+ * 	Command line decoder for binary frame logs:
+ *
+ * 	  tcs3430_log info run.tcsl   block, frame and damage counts
+ * 	  tcs3430_log csv run.tcsl    one CSV line per frame
+ *
+ * 	This is a library for the Adafruit TCS3430 breakout:
+ * 	http://www.adafruit.com/
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "LogFile.h"
+
+/*!
+ *    @brief  Print a summary of the log
+ *    @param  file Open log
+ *    @return Exit status
+ */
+static int info(LogFile* file) {
+  Adafruit_TCS3430_LogReader* reader = file->reader();
+  tcs3430_log_record_t record;
+  uint64_t frames = 0;
+  uint32_t first = 0, last = 0;
+  while (reader->next(&record)) {
+    if (frames == 0) {
+      first = record.frame.timestamp;
+    }
+    last = record.frame.timestamp;
+    frames++;
+  }
+  printf("bytes           %" PRIu32 "\n", file->length());
+  printf("version         %d\n", TCS3430_LOG_VERSION);
+  printf("block capacity  %u\n", reader->getBlockCapacity());
+  printf("blocks          %" PRIu32 "\n", reader->getBlockCount());
+  printf("frames          %" PRIu64 "\n", frames);
+  if (frames) {
+    printf("bytes/frame     %.2f\n", (double)file->length() / frames);
+    printf("first, last us  %" PRIu32 ", %" PRIu32 "\n", first, last);
+  }
+  printf("skipped bytes   %" PRIu32 "\n", reader->getSkippedBytes());
+  return reader->getSkippedBytes() ? 2 : 0;
+}
+
+/*!
+ *    @brief  Print every frame as CSV
+ *    @param  file Open log
+ *    @return Exit status
+ */
+static int csv(LogFile* file) {
+  Adafruit_TCS3430_LogReader* reader = file->reader();
+  tcs3430_log_record_t record;
+  printf("timestamp,z,y,ir1,ch3,gain,atime,status,flags\n");
+  while (reader->next(&record)) {
+    const tcs3430_frame_t* f = &record.frame;
+    printf("%" PRIu32 ",%u,%u,%u,%u,%d,%u,0x%02X,0x%02X\n", f->timestamp,
+           f->z, f->y, f->ir1, f->ch3, record.gain, record.atime, f->status,
+           f->flags);
+  }
+  if (reader->getSkippedBytes()) {
+    fprintf(stderr, "skipped %" PRIu32 " damaged bytes\n",
+            reader->getSkippedBytes());
+    return 2;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3 || (strcmp(argv[1], "info") && strcmp(argv[1], "csv"))) {
+    fprintf(stderr, "usage: %s info|csv FILE\n", argv[0]);
+    return 64;
+  }
+  LogFile file;
+  if (!file.open(argv[2])) {
+    fprintf(stderr, "%s: not a TCS3430 log (version %d)\n", argv[2],
+            TCS3430_LOG_VERSION);
+    return 1;
+  }
+  return strcmp(argv[1], "info") ? csv(&file) : info(&file);
+}